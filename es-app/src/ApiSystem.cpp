@@ -14,6 +14,7 @@
 #include "utils/ThreadPool.h"
 #include "RetroAchievements.h"
 #include "utils/ZipFile.h"
+#include "utils/SevenZipFile.h"
 #include "Paths.h"
 #include "utils/VectorEx.h"
 #include "LocaleES.h"
@@ -76,6 +77,9 @@
 #define script_swissknife "batocera-es-swissknife"; // --emukill"
 */
 
+#define QUERY_NO_CACHE		0
+#define QUERY_PERMANENT		-1
+
 ApiSystem::ApiSystem() { }
 
 ApiSystem* ApiSystem::instance = nullptr;
@@ -92,11 +96,148 @@ ApiSystem *ApiSystem::getInstance()
 #endif
 		
 		IExternalActivity::Instance = ApiSystem::instance;
+
+#if !WIN32
+		// Stub scripts take precedence over the system ones
+		auto scriptsPath = getenv("ES_API_SCRIPTS_PATH");
+		if (scriptsPath != nullptr && *scriptsPath != 0)
+		{
+			auto path = getenv("PATH");
+			setenv("PATH", (std::string(scriptsPath) + (path != nullptr ? ":" + std::string(path) : "")).c_str(), 1);
+			LOG(LogInfo) << "ApiSystem : using helper scripts from " << scriptsPath;
+		}
+#endif
 	}
 
 	return ApiSystem::instance;
 }
 
+std::string ApiSystem::getScriptsPath()
+{
+	auto scriptsPath = getenv("ES_API_SCRIPTS_PATH");
+	if (scriptsPath != nullptr && *scriptsPath != 0)
+	{
+		std::string path(scriptsPath);
+		if (path.back() != '/')
+			path += "/";
+
+		return path;
+	}
+
+	return "/usr/bin/";
+}
+
+// How long the answer of a command can be reused, in ms
+int ApiSystem::getQueryTtl(const std::string& command)
+{
+	static const std::vector<std::pair<std::string, int>> ttls =
+	{
+		{ "batocera-version", QUERY_PERMANENT },
+		{ "batocera-overclock list", QUERY_PERMANENT },
+		{ "batocera-wine-runners", QUERY_PERMANENT },
+		{ "batocera-format listFstypes", QUERY_PERMANENT },
+		{ "uname -m", QUERY_PERMANENT },
+		{ "cat /boot/boot/batocera.board", QUERY_PERMANENT },
+		{ "batocera-config storage current", QUERY_PERMANENT }, // invalidated by setStorage
+		{ "batocera-config storage list", 30000 },              // removable drives
+		{ "batocera-config lsoutputs", 30000 },                 // screens can be hotplugged
+		{ "batocera-resolution", 30000 },
+		{ "batocera-audio list", 10000 },                       // bluetooth & hdmi outputs come and go
+		{ "batocera-audio get", 10000 },                        // the output changes with them. Also invalidated by setAudioOutputDevice & setAudioOutputProfile
+		{ "batocera-info", 10000 },                             // temperatures, uptime...
+	};
+
+	for (auto& ttl : ttls)
+		if (Utils::String::startsWith(command, ttl.first))
+			return ttl.second;
+
+	return QUERY_NO_CACHE;
+}
+
+std::shared_future<std::vector<std::string>> ApiSystem::queryAsync(const std::string& command)
+{
+	int now = (int)SDL_GetTicks();
+	int ttl = getQueryTtl(command);
+
+	std::unique_lock<std::mutex> lock(mQueriesLock);
+
+	auto it = mQueries.find(command);
+	if (it != mQueries.cend())
+	{
+		// A running query is always shared, even if its ttl has expired
+		bool running = it->second.result.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+		if (running || it->second.ttl == QUERY_PERMANENT || now - it->second.time < it->second.ttl)
+			return it->second.result;
+	}
+
+	auto task = std::make_shared<std::packaged_task<std::vector<std::string>()>>([this, command] { return executeEnumerationScript(command); });
+	std::shared_future<std::vector<std::string>> result = task->get_future().share();
+
+	std::thread([task] { (*task)(); }).detach();
+
+	if (ttl != QUERY_NO_CACHE)
+	{
+		QueryEntry entry;
+		entry.result = result;
+		entry.time = now;
+		entry.ttl = ttl;
+		mQueries[command] = entry;
+	}
+
+	return result;
+}
+
+std::vector<std::string> ApiSystem::query(const std::string& command)
+{
+	if (getQueryTtl(command) == QUERY_NO_CACHE)
+		return executeEnumerationScript(command);
+
+	return queryAsync(command).get();
+}
+
+void ApiSystem::invalidateQueries(const std::string& prefix)
+{
+	std::unique_lock<std::mutex> lock(mQueriesLock);
+
+	for (auto it = mQueries.begin(); it != mQueries.end(); )
+	{
+		if (prefix.empty() || Utils::String::startsWith(it->first, prefix))
+			it = mQueries.erase(it);
+		else
+			it++;
+	}
+}
+
+void ApiSystem::prefetchMenuQueries()
+{
+#if !WIN32
+	// None of the helpers accepts several keys in one call : the queries run side by side instead
+	std::vector<std::string> commands = { "batocera-config storage list", "batocera-config storage current", "batocera-config lsoutputs" };
+
+	if (isScriptingSupported(VERSIONINFO))
+		commands.push_back("batocera-version");
+
+	if (isScriptingSupported(AUDIODEVICE))
+	{
+		commands.push_back("batocera-audio list");
+		commands.push_back("batocera-audio get");
+	}
+
+	if (isScriptingSupported(OVERCLOCK))
+		commands.push_back("batocera-overclock list");
+
+	// The video mode lists are still read synchronously, by createVideoResolutionModeOptionList
+	if (isScriptingSupported(RESOLUTION))
+		commands.push_back("batocera-resolution listModes");
+
+	if (isScriptingSupported(DISKFORMAT))
+		commands.push_back("batocera-format listFstypes");
+
+	for (auto command : commands)
+		queryAsync(command);
+#endif
+}
+
 unsigned long ApiSystem::getFreeSpaceGB(std::string mountpoint) 
 {
 	LOG(LogDebug) << "ApiSystem::getFreeSpaceGB";
@@ -165,7 +306,7 @@ std::string ApiSystem::getVersion(bool extra)
 		if (extra) 
 			command += " --extra";
 
-		auto res = executeEnumerationScript(command);
+		auto res = query(command);
 		if (res.size() > 0 && !res[0].empty())
 			return res[0];
 	}
@@ -692,21 +833,21 @@ std::vector<std::string> ApiSystem::getPairedBluetoothDeviceList()
 
 std::vector<std::string> ApiSystem::getAvailableStorageDevices() 
 {
-	return executeEnumerationScript("batocera-config storage list");
+	return query("batocera-config storage list");
 }
 
 std::vector<std::string> ApiSystem::getVideoModes(const std::string output)
 {
   if(output == "") {
-    return executeEnumerationScript("batocera-resolution listModes");
+    return query("batocera-resolution listModes");
   } else {
-    return executeEnumerationScript("batocera-resolution --screen \"" + output + "\" listModes");
+    return query("batocera-resolution --screen \"" + output + "\" listModes");
   }
 }
 
 std::vector<std::string> ApiSystem::getCustomRunners() 
 {
-	return executeEnumerationScript("batocera-wine-runners");
+	return query("batocera-wine-runners");
 }
 
 std::vector<std::string> ApiSystem::getAvailableBackupDevices() 
@@ -726,12 +867,17 @@ std::vector<std::string> ApiSystem::getAvailableInstallArchitectures()
 
 std::vector<std::string> ApiSystem::getAvailableOverclocking() 
 {
-	return executeEnumerationScript("batocera-overclock list");
+	return query("batocera-overclock list");
 }
 
 std::vector<std::string> ApiSystem::getSystemInformations() 
 {
-	return executeEnumerationScript("batocera-info --full");
+	return query("batocera-info --full");
+}
+
+std::shared_future<std::vector<std::string>> ApiSystem::getSystemInformationsAsync()
+{
+	return runAsync<std::vector<std::string>>([this] { return getSystemInformations(); });
 }
 
 std::vector<BiosSystem> ApiSystem::getBiosInformations(const std::string system) 
@@ -798,24 +944,16 @@ std::string ApiSystem::getCurrentStorage()
 	return "DEFAULT";
 #endif
 
-	std::ostringstream oss;
-	oss << "batocera-config storage current";
-	FILE *pipe = popen(oss.str().c_str(), "r");
-	char line[1024];
-
-	if (pipe == NULL)
-		return "";	
+	auto res = query("batocera-config storage current");
+	if (res.size() > 0)
+		return res[0];
 
-	if (fgets(line, 1024, pipe)) {
-		strtok(line, "\n");
-		pclose(pipe);
-		return std::string(line);
-	}
 	return "INTERNAL";
 }
 
 bool ApiSystem::setStorage(std::string selected) 
 {
+	invalidateQueries("batocera-config storage");
 	return executeScript("batocera-config storage " + selected);
 }
 
@@ -884,7 +1022,7 @@ std::string ApiSystem::getRootPassword()
 
 std::vector<std::string> ApiSystem::getAvailableVideoOutputDevices() 
 {
-	return executeEnumerationScript("batocera-config lsoutputs");
+	return query("batocera-config lsoutputs");
 }
 
 std::vector<std::string> ApiSystem::getAvailableAudioOutputDevices() 
@@ -895,7 +1033,7 @@ std::vector<std::string> ApiSystem::getAvailableAudioOutputDevices()
 	return res;
 #endif
 
-	return executeEnumerationScript("batocera-audio list");
+	return query("batocera-audio list");
 }
 
 std::string ApiSystem::getCurrentAudioOutputDevice() 
@@ -906,20 +1044,9 @@ std::string ApiSystem::getCurrentAudioOutputDevice()
 
 	LOG(LogDebug) << "ApiSystem::getCurrentAudioOutputDevice";
 
-	std::ostringstream oss;
-	oss << "batocera-audio get";
-	FILE *pipe = popen(oss.str().c_str(), "r");
-	char line[1024];
-
-	if (pipe == NULL)
-		return "";	
-
-	if (fgets(line, 1024, pipe)) 
-	{
-		strtok(line, "\n");
-		pclose(pipe);
-		return std::string(line);
-	}
+	auto res = query("batocera-audio get");
+	if (res.size() > 0)
+		return res[0];
 
 	return "";
 }
@@ -933,6 +1060,8 @@ bool ApiSystem::setAudioOutputDevice(std::string selected)
 	oss << "batocera-audio set" << " '" << selected << "'";
 	int exitcode = system(oss.str().c_str());
 
+	invalidateQueries("batocera-audio get");
+
 	Sound::get(":/checksound.ogg")->play();
 
 	return exitcode == 0;
@@ -946,7 +1075,7 @@ std::vector<std::string> ApiSystem::getAvailableAudioOutputProfiles()
 	return res;
 #endif
 
-	return executeEnumerationScript("batocera-audio list-profiles");
+	return query("batocera-audio list-profiles");
 }
 
 std::string ApiSystem::getCurrentAudioOutputProfile() 
@@ -957,20 +1086,9 @@ std::string ApiSystem::getCurrentAudioOutputProfile()
 
 	LOG(LogDebug) << "ApiSystem::getCurrentAudioOutputProfile";
 
-	std::ostringstream oss;
-	oss << "batocera-audio get-profile";
-	FILE *pipe = popen(oss.str().c_str(), "r");
-	char line[1024];
-
-	if (pipe == NULL)
-		return "";	
-
-	if (fgets(line, 1024, pipe)) 
-	{
-		strtok(line, "\n");
-		pclose(pipe);
-		return std::string(line);
-	}
+	auto res = query("batocera-audio get-profile");
+	if (res.size() > 0)
+		return res[0];
 
 	return "";
 }
@@ -983,6 +1101,8 @@ bool ApiSystem::setAudioOutputProfile(std::string selected)
 
 	oss << "batocera-audio set-profile" << " '" << selected << "'";
 	int exitcode = system(oss.str().c_str());
+
+	invalidateQueries("batocera-audio get");
 	
 	Sound::get(":/checksound.ogg")->play();
 
@@ -1291,6 +1411,25 @@ std::pair<std::string, int> ApiSystem::uninstallBatoceraBezel(std::string bezels
 	return executeScript("batocera-es-thebezelproject remove " + bezelsystem, func);
 }
 
+// The only member of an archive that is not a text file or a folder, empty if there are several
+static std::string getSingleRomName(const std::vector<std::string>& names)
+{
+	std::string romName;
+
+	for (auto name : names)
+	{
+		if (Utils::FileSystem::getExtension(name) != ".txt" && !Utils::String::endsWith(name, "/"))
+		{
+			if (!romName.empty())
+				return "";
+
+			romName = name;
+		}
+	}
+
+	return romName;
+}
+
 std::string ApiSystem::getMD5(const std::string fileName, bool fromZipContents)
 {
 	LOG(LogDebug) << "getMD5 >> " << fileName;
@@ -1302,27 +1441,25 @@ std::string ApiSystem::getMD5(const std::string fileName, bool fromZipContents)
 		Utils::Zip::ZipFile file;
 		if (file.load(fileName))
 		{
-			std::string romName;
-
-			for (auto name : file.namelist())
-			{
-				if (Utils::FileSystem::getExtension(name) != ".txt" && !Utils::String::endsWith(name, "/"))
-				{
-					if (!romName.empty())
-					{
-						romName = "";
-						break;
-					}
-
-					romName = name;
-				}
-			}
-
+			std::string romName = getSingleRomName(file.namelist());
 			if (!romName.empty())
 				return file.getFileMd5(romName);
 		}
 	}
 
+	if (ext == ".7z" && fromZipContents)
+	{
+		Utils::Zip::SevenZipFile file;
+		if (file.load(fileName))
+		{
+			std::string romName = getSingleRomName(file.namelist());
+			std::string md5 = romName.empty() ? file.getAllFilesMd5() : file.getFileMd5(romName);
+			if (!md5.empty())
+				return md5;
+		}
+	}
+
+	// The 7z executable handles the codecs & block sizes SevenZipFile doesn't
 #if !WIN32
 	if (fromZipContents && ext == ".7z")
 	{
@@ -1374,6 +1511,26 @@ std::string ApiSystem::getCRC32(std::string fileName, bool fromZipContents)
 
 	if (ext == ".7z" && fromZipContents)
 	{
+		Utils::Zip::SevenZipFile file;
+		if (file.load(fileName))
+		{
+			LOG(LogDebug) << "getCRC32 is using SevenZipFile";
+
+			// Like 7z l -slt, use the first member if there are several roms
+			auto names = file.namelist();
+			std::string romName = getSingleRomName(names);
+			if (romName.empty())
+			{
+				auto it = std::find_if(names.cbegin(), names.cend(), [](const std::string& name) { return !Utils::String::endsWith(name, "/"); });
+				if (it != names.cend())
+					romName = *it;
+			}
+
+			std::string crc = file.getFileCrc(romName);
+			if (!crc.empty())
+				return crc;
+		}
+
 		LOG(LogDebug) << "getCRC32 is using 7z";
 
 		std::string fn = Utils::FileSystem::getFileName(fileName);
@@ -1395,22 +1552,7 @@ std::string ApiSystem::getCRC32(std::string fileName, bool fromZipContents)
 		Utils::Zip::ZipFile file;
 		if (file.load(fileName))
 		{
-			std::string romName;
-
-			for (auto name : file.namelist())
-			{
-				if (Utils::FileSystem::getExtension(name) != ".txt" && !Utils::String::endsWith(name, "/"))
-				{
-					if (!romName.empty())
-					{
-						romName = "";
-						break;
-					}
-
-					romName = name;
-				}
-			}
-
+			std::string romName = getSingleRomName(file.namelist());
 			if (!romName.empty())
 				return file.getFileCrc(romName);
 		}
@@ -1456,6 +1598,41 @@ bool ApiSystem::unzipFile(const std::string fileName, const std::string destFold
 		return false;
 	}
 	
+	if (Utils::String::toLower(Utils::FileSystem::getExtension(fileName)) == ".7z")
+	{
+		Utils::Zip::SevenZipFile file;
+		if (file.load(fileName))
+		{
+			LOG(LogDebug) << "unzipFile is using SevenZipFile";
+
+			bool success = true;
+
+			for (auto name : file.namelist())
+			{
+				if (Utils::String::endsWith(name, "/"))
+				{
+					Utils::FileSystem::createDirectory(Utils::FileSystem::combine(destFolder, name.substr(0, name.length() - 1)));
+					continue;
+				}
+
+				if (shouldExtract != nullptr && !shouldExtract(Utils::FileSystem::combine(destFolder, name)))
+					continue;
+
+				if (!file.extract(name, destFolder))
+				{
+					success = false;
+					break;
+				}
+			}
+
+			if (success)
+			{
+				LOG(LogDebug) << "unzipFile << OK";
+				return true;
+			}
+		}
+	}
+
 	LOG(LogDebug) << "unzipFile is using 7z";
 
 	std::string cmd = getSevenZipCommand() + " x \"" + Utils::FileSystem::getPreferredPath(fileName) + "\" -y -o\"" + Utils::FileSystem::getPreferredPath(destFolder) + "\"";
@@ -2184,7 +2361,7 @@ bool ApiSystem::isScriptingSupported(ScriptId script)
 		return true;
 
 	for (auto executable : executables)
-		if (!Utils::FileSystem::exists("/usr/bin/" + executable))
+		if (!Utils::FileSystem::exists(getScriptsPath() + executable))
 			return false;
 
 	return true;
@@ -2247,7 +2424,7 @@ std::vector<std::string> ApiSystem::getFormatFileSystems()
 	ret.push_back("brfs");
 	return ret;
 #endif
-	return executeEnumerationScript("batocera-format listFstypes");
+	return query("batocera-format listFstypes");
 }
 
 int ApiSystem::formatDisk(const std::string disk, const std::string format, const std::function<void(const std::string)>& func)
@@ -2647,7 +2824,7 @@ std::vector<PadInfo> ApiSystem::getPadsInfo()
 
 std::string ApiSystem::getRunningArchitecture()
 {
-	auto res = executeEnumerationScript("uname -m");
+	auto res = query("uname -m");
 	if (res.size() > 0)
 		return res[0];
 
@@ -2656,7 +2833,7 @@ std::string ApiSystem::getRunningArchitecture()
 
 std::string ApiSystem::getRunningBoard()
 {
-	auto res = executeEnumerationScript("cat /boot/boot/batocera.board");
+	auto res = query("cat /boot/boot/batocera.board");
 	if (res.size() > 0)
 		return res[0];
 
@@ -3,6 +3,10 @@
 
 #include <string>
 #include <map>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <functional>
 #include "Window.h"
 #include "components/BusyComponent.h"
 #include "resources/TextureData.h"
@@ -181,6 +185,29 @@ public:
     static ApiSystem* getInstance();
 	virtual void deinit() { };
 
+	// Helper scripts output, run on a background thread. Answers that don't change at runtime are cached ( see getQueryTtl )
+	std::shared_future<std::vector<std::string>> queryAsync(const std::string& command);
+	std::vector<std::string> query(const std::string& command);
+
+	// Runs func on a background thread, for the menus to fill in the values it returns once they arrive
+	template<typename T>
+	static std::shared_future<T> runAsync(const std::function<T()>& func)
+	{
+		auto task = std::make_shared<std::packaged_task<T()>>(func);
+		std::shared_future<T> result = task->get_future().share();
+		std::thread([task] { (*task)(); }).detach();
+		return result;
+	}
+
+	// Starts the queries the settings menus need, so they are answered when the menus open
+	void prefetchMenuQueries();
+
+	// Drops the cached answers of the commands starting with prefix ( all if empty )
+	void invalidateQueries(const std::string& prefix = "");
+
+	// Folder of the helper scripts. Can be redirected to stub scripts with ES_API_SCRIPTS_PATH
+	static std::string getScriptsPath();
+
     virtual unsigned long getFreeSpaceGB(std::string mountpoint);
 
     virtual std::string getFreeSpaceUserInfo();
@@ -274,6 +301,7 @@ public:
 
 	virtual std::vector<std::string> getAvailableStorageDevices();
 	virtual std::vector<std::string> getSystemInformations();
+	virtual std::shared_future<std::vector<std::string>> getSystemInformationsAsync();
 
     bool generateSupportFile();
 
@@ -426,6 +454,18 @@ protected:
 
 private:
 	static LED_TYPE mSystemLedType;
+
+	struct QueryEntry
+	{
+		std::shared_future<std::vector<std::string>> result;
+		int time;
+		int ttl;
+	};
+
+	static int getQueryTtl(const std::string& command);
+
+	std::map<std::string, QueryEntry> mQueries;
+	std::mutex mQueriesLock;
 };
 
 #endif
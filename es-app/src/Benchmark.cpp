@@ -0,0 +1,2036 @@
+#include "Benchmark.h"
+#include "Window.h"
+#include "InputManager.h"
+#include "InputConfig.h"
+#include "Settings.h"
+#include "Paths.h"
+#include "Log.h"
+#include "resources/ResourceManager.h"
+#include "resources/Font.h"
+#include "resources/VideoThumbnailExtractor.h"
+#include "resources/TextureResource.h"
+#include "components/VideoVlcComponent.h"
+#include "components/VideoVlcPreloader.h"
+#include "renderers/Renderer.h"
+#include "renderers/Renderer_Null.h"
+#include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+#include "utils/SevenZipFile.h"
+#include "utils/md5.h"
+#include "ApiSystem.h"
+#include "SystemData.h"
+#include "Gamelist.h"
+#include "GamelistWriter.h"
+#include "FileData.h"
+#include "FileFilterIndex.h"
+#include "CollectionSystemManager.h"
+#include "SaveStateRepository.h"
+#include "SaveStateConfigFile.h"
+#include "CheevosHashDatabase.h"
+#include "HttpReq.h"
+#include "services/httplib.h"
+
+#include <libcheevos/libretro-common/src/7zip/7zCrc.h>
+
+#include <SDL.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <new>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+#define BENCHMARK_SYSTEMS		4
+#define BENCHMARK_GAMES			500
+#define BENCHMARK_TEXTLIST_GAMES	5000
+#define BENCHMARK_FRAME_TIME	16 // deltaTime given to Window::update, so runs are reproducible
+#define BENCHMARK_ARCHIVES		100
+#define BENCHMARK_SEARCH_GAMES	50000
+#define BENCHMARK_ARCADE_GAMES	40000
+#define BENCHMARK_FOLDER_LEVELS	5
+#define BENCHMARK_FOLDER_FANOUT	4
+#define BENCHMARK_FOLDER_GAMES	8 // per leaf folder
+#define BENCHMARK_SAVESTATE_GAMES	2000
+#define BENCHMARK_SAVESTATE_SLOTS	8 // per game, with an autosave
+#define BENCHMARK_CHEEVOS_HASHES	150000
+#define BENCHMARK_CHEEVOS_GAMES		12000
+#define BENCHMARK_CHEEVOS_LOOKUPS	1000000
+#define BENCHMARK_VIDEOS			48
+#define BENCHMARK_VIDEO_LOADERS		4 // threads asking for thumbnails, as texture loaders do
+#define BENCHMARK_VIDEO_FRAMES_MS	3000 // playback time of each videoframes run
+#define BENCHMARK_VIDEO_STEPS		16 // cursor moves of each videostart run
+#define BENCHMARK_VIDEO_DWELL_MS	800 // time spent on each entry
+#define BENCHMARK_GAMELIST_RUNS		3 // parses of the gamelist with each reader
+#define BENCHMARK_WRITES_SPEEDUP	120 // the hour of use of gamelistwrites is replayed in 30 seconds
+
+static size_t sResidentBeforeLoad = 0;
+
+std::string Benchmark::sScenario;
+std::string Benchmark::sOutputPath;
+std::string Benchmark::sRenderer = "NULL";
+
+// Allocation counter : global operator new is replaced, counting is only enabled while a frame is measured
+static std::atomic<bool> sCountAllocations(false);
+static std::atomic<unsigned long long> sAllocations(0);
+
+void* operator new(std::size_t size)
+{
+	if (sCountAllocations.load(std::memory_order_relaxed))
+		sAllocations.fetch_add(1, std::memory_order_relaxed);
+
+	void* ptr = std::malloc(size == 0 ? 1 : size);
+	if (ptr == nullptr)
+		throw std::bad_alloc();
+
+	return ptr;
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+struct BenchmarkScenario;
+static const BenchmarkScenario* getScenario(const std::string& name);
+
+struct BenchmarkStep
+{
+	BenchmarkStep(const std::string& buttonName, int waitFrames) : button(buttonName), frames(waitFrames) { }
+
+	std::string button; // empty : idle
+	int			frames; // frames rendered after the button is released
+};
+
+struct BenchmarkFrame
+{
+	unsigned long long	cpuTime; // microseconds
+	unsigned int		drawCalls;
+	unsigned int		vertices;
+	unsigned int		textureUploads;
+	unsigned long long	textureUploadBytes;
+	unsigned long long	allocations;
+};
+
+static void addSteps(std::vector<BenchmarkStep>& steps, const std::string& button, int count, int frames)
+{
+	for (int i = 0; i < count; i++)
+		steps.push_back(BenchmarkStep(button, frames));
+}
+
+static std::vector<BenchmarkStep> getSteps(const std::string& scenario)
+{
+	std::vector<BenchmarkStep> steps;
+	steps.push_back(BenchmarkStep("", 60)); // Startup
+
+	if (scenario == "gamelist" || scenario == "grid" || scenario == "all")
+	{
+		steps.push_back(BenchmarkStep(BUTTON_OK, 60));
+		addSteps(steps, "down", 150, 2);
+		addSteps(steps, "pagedown", 10, 10);
+		addSteps(steps, "up", 50, 2);
+
+		if (scenario == "grid")
+			addSteps(steps, "right", 50, 2);
+
+		steps.push_back(BenchmarkStep(BUTTON_BACK, 60));
+	}
+
+	if (scenario == "textlist")
+	{
+		steps.push_back(BenchmarkStep(BUTTON_OK, 60));
+		addSteps(steps, "down", 300, 1);
+		addSteps(steps, "pagedown", 200, 2);
+		addSteps(steps, "pageup", 100, 2);
+		addSteps(steps, "up", 300, 1);
+		steps.push_back(BenchmarkStep(BUTTON_BACK, 60));
+	}
+
+	if (scenario == "systems" || scenario == "all")
+	{
+		addSteps(steps, "right", BENCHMARK_SYSTEMS * 4, 30);
+		addSteps(steps, "left", BENCHMARK_SYSTEMS * 2, 30);
+	}
+
+	if (scenario == "menus" || scenario == "all")
+	{
+		for (int i = 0; i < 5; i++)
+		{
+			steps.push_back(BenchmarkStep("start", 30));
+			addSteps(steps, "down", 8, 4);
+			steps.push_back(BenchmarkStep(BUTTON_OK, 30));
+			steps.push_back(BenchmarkStep(BUTTON_BACK, 20));
+			steps.push_back(BenchmarkStep(BUTTON_BACK, 30));
+		}
+	}
+
+	return steps;
+}
+
+static bool writeBinaryFile(const std::string& path, const ResourceData& data)
+{
+	std::ofstream file(path, std::ios::binary);
+	if (!file.is_open())
+		return false;
+
+	file.write((const char*)data.ptr.get(), data.length);
+	return true;
+}
+
+static std::string getThemeXml()
+{
+	return
+		"<theme>\n"
+		"	<formatVersion>6</formatVersion>\n"
+		"	<view name=\"system\">\n"
+		"		<carousel name=\"systemcarousel\">\n"
+		"			<type>horizontal</type>\n"
+		"			<pos>0 0.4</pos>\n"
+		"			<size>1 0.2</size>\n"
+		"			<logoSize>0.2 0.15</logoSize>\n"
+		"			<maxLogoCount>5</maxLogoCount>\n"
+		"		</carousel>\n"
+		"	</view>\n"
+		"	<view name=\"basic, detailed\">\n"
+		"		<textlist name=\"gamelist\">\n"
+		"			<pos>0.05 0.1</pos>\n"
+		"			<size>0.5 0.8</size>\n"
+		"			<fontSize>0.03</fontSize>\n"
+		"		</textlist>\n"
+		"	</view>\n"
+		"	<view name=\"detailed\">\n"
+		"		<image name=\"md_image\">\n"
+		"			<pos>0.6 0.2</pos>\n"
+		"			<maxSize>0.35 0.5</maxSize>\n"
+		"		</image>\n"
+		"	</view>\n"
+		"	<view name=\"grid\">\n"
+		"		<imagegrid name=\"gamegrid\">\n"
+		"			<pos>0.05 0.1</pos>\n"
+		"			<size>0.9 0.8</size>\n"
+		"		</imagegrid>\n"
+		"	</view>\n"
+		"</theme>\n";
+}
+
+// Game like names : a few words from a small vocabulary, so the searched words match a realistic share of the list
+static std::string getSearchName(int index)
+{
+	static const char* words[] =
+	{
+		"Super", "Mario", "Sonic", "Street", "Fighter", "Legend", "Zelda", "Final", "Fantasy", "Racing", "Soccer", "World", "Battle", "Dragon",
+		"Quest", "Star", "Wars", "Metal", "Gear", "Puzzle", "Castle", "Knight", "Ninja", "Turbo", "Space", "Invaders", "Kart", "Tennis",
+		"Golf", "Island", "Adventure", "Hero", "Shadow", "Warrior", "Double", "Galaxy", "Rally", "Pinball", "Bomber", "Kong"
+	};
+
+	const int count = sizeof(words) / sizeof(words[0]);
+
+	unsigned int seed = 0x2545F491 + index * 2654435761u;
+	auto next = [&seed]() { seed = seed * 1103515245 + 12345; return (seed >> 16) & 0x7FFF; };
+
+	std::string name = words[next() % count];
+
+	for (int i = next() % 3; i >= 0; i--)
+		name += std::string(" ") + words[next() % count];
+
+	return name + " " + std::to_string(index % 9 + 1);
+}
+
+// Rom names of arcaderoms.xml, without the devices & bioses : the MameNames lookups of the arcade scenario get a realistic share of hits
+static std::vector<std::string> getArcadeRomNames(size_t count)
+{
+	std::vector<std::string> names;
+
+	ResourceData data = ResourceManager::getInstance()->getFileData(":/arcaderoms.xml");
+	if (data.ptr == nullptr)
+		return names;
+
+	std::stringstream xml(std::string((const char*)data.ptr.get(), data.length));
+	std::string line;
+
+	while (names.size() < count && std::getline(xml, line))
+	{
+		auto start = line.find("<rom id=\"");
+		if (start == std::string::npos || line.find("device=\"true\"") != std::string::npos || line.find("bios=\"true\"") != std::string::npos)
+			continue;
+
+		start += 9;
+
+		auto end = line.find('"', start);
+		if (end != std::string::npos && end > start)
+			names.push_back(line.substr(start, end - start));
+	}
+
+	return names;
+}
+
+// Resident set size of the process, 0 when unknown
+static size_t getResidentMemory()
+{
+#if defined(__linux__)
+	std::ifstream file("/proc/self/statm");
+
+	size_t pages = 0, resident = 0;
+	if (file >> pages >> resident)
+		return resident * (size_t)sysconf(_SC_PAGESIZE);
+#endif
+	return 0;
+}
+
+// Highest resident set size since the last resetPeakResidentMemory, 0 when unknown
+static size_t getPeakResidentMemory()
+{
+#if defined(__linux__)
+	std::ifstream file("/proc/self/status");
+
+	std::string line;
+	while (std::getline(file, line))
+		if (Utils::String::startsWith(line, "VmHWM:"))
+			return (size_t)strtoull(line.c_str() + 6, nullptr, 10) * 1024;
+#endif
+	return 0;
+}
+
+static void resetPeakResidentMemory()
+{
+#if defined(__linux__)
+	std::ofstream file("/proc/self/clear_refs");
+	file << "5";
+#endif
+}
+
+bool Benchmark::setScenario(const std::string& scenario)
+{
+	if (getScenario(scenario) == nullptr)
+		return false;
+
+	sScenario = scenario;
+	return true;
+}
+
+std::string Benchmark::getHomePath()
+{
+#if WIN32
+	const char* tmp = getenv("TEMP");
+#else
+	const char* tmp = getenv("TMPDIR");
+#endif
+
+	std::string path = (tmp != nullptr && tmp[0] != 0) ? tmp : "/tmp";
+	return Utils::FileSystem::getGenericPath(Utils::FileSystem::combine(path, "es-benchmark"));
+}
+
+void Benchmark::setupEnvironment()
+{
+	// Don't override drivers set by the caller. A real renderer needs a window ( Xvfb & LIBGL_ALWAYS_SOFTWARE=1 on a headless machine )
+	if (sRenderer == "NULL")
+		SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+
+	SDL_setenv("SDL_AUDIODRIVER", "dummy", 0);
+}
+
+bool Benchmark::prepare()
+{
+	std::string home = getHomePath();
+	std::string esPath = Paths::getUserEmulationStationPath();
+
+	LOG(LogInfo) << "Benchmark : preparing synthetic library in " << home;
+
+	ResourceData image = ResourceManager::getInstance()->getFileData(":/frame.png");
+	if (image.ptr == nullptr)
+	{
+		LOG(LogError) << "Benchmark : unable to load the sample image";
+		return false;
+	}
+
+	// The text list scenario only needs a single, large system : no images, only names
+	const bool textList = (sScenario == "textlist");
+
+	// The memory scenarios load a single system of scraped entries from the gamelist only : no rom, no media on disk
+	// gamelistparse parses such a gamelist of 100k entries again
+	const int memoryGames = (sScenario == "memory100k" || sScenario == "gamelistparse") ? 100000 : sScenario == "memory250k" ? 250000 : 0;
+
+	// The search scenario filters a single system of varied names, also from the gamelist only
+	const bool searchList = (sScenario == "search");
+
+	// The arcade scenario loads a single arcade system of real rom names, also from the gamelist only
+	const bool arcadeList = (sScenario == "arcade40k");
+
+	std::vector<std::string> arcadeRoms;
+	if (arcadeList)
+	{
+		arcadeRoms = getArcadeRomNames(BENCHMARK_ARCADE_GAMES);
+		if (arcadeRoms.size() == 0)
+		{
+			LOG(LogError) << "Benchmark : unable to read the arcade rom names";
+			return false;
+		}
+	}
+
+	// The folders scenario spreads the games in a tree of folders, BENCHMARK_FOLDER_LEVELS deep
+	const bool folderTree = (sScenario == "folders");
+	int folderTreeGames = BENCHMARK_FOLDER_GAMES;
+	for (int i = 0; i < BENCHMARK_FOLDER_LEVELS; i++)
+		folderTreeGames *= BENCHMARK_FOLDER_FANOUT;
+
+	// The savestates scenario indexes the states of a single system, from the default save state layout
+	const bool saveStates = (sScenario == "savestates");
+
+	// The cheevoshashes & video scenarios don't use the library
+	const bool gamelistOnly = (memoryGames > 0 || searchList || arcadeList || folderTree || saveStates || sScenario == "cheevoshashes" || sScenario == "videothumbs" || sScenario == "videoframes" || sScenario == "videostart" || sScenario == "gamelistwrites");
+
+	const int systemCount = (textList || gamelistOnly) ? 1 : BENCHMARK_SYSTEMS;
+	const int gameCount = memoryGames > 0 ? memoryGames : folderTree ? folderTreeGames : arcadeList ? (int)arcadeRoms.size() : saveStates ? BENCHMARK_SAVESTATE_GAMES : searchList ? BENCHMARK_SEARCH_GAMES : textList ? BENCHMARK_TEXTLIST_GAMES : BENCHMARK_GAMES;
+
+	std::stringstream systems;
+	systems << "<?xml version=\"1.0\"?>\n<systemList>\n";
+
+	for (int sys = 1; sys <= systemCount; sys++)
+	{
+		std::string name = "bench" + std::to_string(sys);
+		std::string romPath = home + "/roms/" + name;
+		std::string imagePath = romPath + "/images";
+
+		systems <<
+			"	<system>\n"
+			"		<name>" << name << "</name>\n"
+			"		<fullname>Benchmark " << sys << "</fullname>\n"
+			"		<path>" << romPath << "</path>\n"
+			"		<extension>.bin</extension>\n"
+			"		<command>true</command>\n"
+			"		<platform>" << (arcadeList ? "arcade" : "pc") << "</platform>\n"
+			"		<theme>" << name << "</theme>\n"
+			"	</system>\n";
+
+		Utils::FileSystem::createDirectory(romPath);
+		Utils::FileSystem::createDirectory(imagePath);
+
+		// Streamed to the file : a 250k entries gamelist would otherwise stay in the heap & skew the memory baseline
+		std::ofstream gamelist(romPath + "/gamelist.xml", std::ios::binary);
+		gamelist << "<?xml version=\"1.0\"?>\n<gameList>\n";
+
+		for (int game = 1; game <= gameCount; game++)
+		{
+			char number[32];
+			snprintf(number, sizeof(number), "game%04d", game);
+
+			std::string fileName = arcadeList ? arcadeRoms[game - 1] : number;
+
+			std::string rom = romPath + "/" + fileName + ".bin";
+			if (!gamelistOnly && !Utils::FileSystem::exists(rom))
+				Utils::FileSystem::writeAllText(rom, "");
+
+			std::string folder;
+			if (folderTree)
+			{
+				int leaf = (game - 1) / BENCHMARK_FOLDER_GAMES;
+				for (int i = 0; i < BENCHMARK_FOLDER_LEVELS; i++, leaf /= BENCHMARK_FOLDER_FANOUT)
+					folder = "folder" + std::to_string(leaf % BENCHMARK_FOLDER_FANOUT) + "/" + folder;
+			}
+
+			gamelist <<
+				"	<game>\n"
+				"		<path>./" << folder << fileName << ".bin</path>\n"
+				"		<name>" << ((searchList || folderTree) ? getSearchName(game) : "Benchmark game " + std::to_string(sys) + "-" + std::to_string(game)) << "</name>\n"
+				"		<desc>Synthetic entry</desc>\n";
+
+			if (memoryGames > 0)
+			{
+				gamelist <<
+					"		<image>./images/" << fileName << ".png</image>\n"
+					"		<thumbnail>./images/" << fileName << "-thumb.png</thumbnail>\n"
+					"		<marquee>./images/" << fileName << "-marquee.png</marquee>\n"
+					"		<video>./videos/" << fileName << ".mp4</video>\n"
+					"		<rating>0.8</rating>\n"
+					"		<releasedate>19940101T000000</releasedate>\n"
+					"		<developer>Developer " << (game % 50) << "</developer>\n"
+					"		<publisher>Publisher " << (game % 20) << "</publisher>\n"
+					"		<genre>Genre " << (game % 12) << "</genre>\n"
+					"		<players>1-2</players>\n";
+			}
+			else if (arcadeList)
+			{
+				// A third of the games with achievements
+				if (game % 3 == 0)
+					gamelist << "		<cheevosId>" << game << "</cheevosId>\n";
+			}
+			else if (!textList && !gamelistOnly)
+			{
+				// Distinct files, so every image goes through the texture loader
+				std::string img = imagePath + "/" + fileName + ".png";
+				if (!Utils::FileSystem::exists(img) && !writeBinaryFile(img, image))
+				{
+					LOG(LogError) << "Benchmark : unable to write " << img;
+					return false;
+				}
+
+				gamelist << "		<image>./images/" << fileName << ".png</image>\n";
+			}
+
+			gamelist << "	</game>\n";
+		}
+
+		gamelist << "</gameList>\n";
+
+		if (saveStates)
+		{
+			// game0001.state, game0001.state1 .. state8 & game0001.state.auto, half of them with a screenshot
+			Paths::getSavesPath() = home + "/saves";
+
+			std::string savePath = Paths::getSavesPath() + "/" + name;
+			Utils::FileSystem::createDirectory(savePath);
+
+			for (int game = 1; game <= gameCount; game++)
+			{
+				char fileName[32];
+				snprintf(fileName, sizeof(fileName), "game%04d", game);
+
+				for (int slot = -1; slot <= BENCHMARK_SAVESTATE_SLOTS; slot++)
+				{
+					std::string state = savePath + "/" + fileName + (slot < 0 ? ".state.auto" : slot == 0 ? ".state" : ".state" + std::to_string(slot));
+					if (!Utils::FileSystem::exists(state))
+						Utils::FileSystem::writeAllText(state, "");
+
+					if ((game + slot) % 2 == 0 && !Utils::FileSystem::exists(state + ".png"))
+						Utils::FileSystem::writeAllText(state + ".png", "");
+				}
+			}
+		}
+	}
+
+	systems << "</systemList>\n";
+	Utils::FileSystem::writeAllText(esPath + "/es_systems.cfg", systems.str());
+
+	std::string themePath = esPath + "/themes/benchmark";
+	Utils::FileSystem::createDirectory(themePath);
+	Utils::FileSystem::writeAllText(themePath + "/theme.xml", getThemeXml());
+
+	Settings* settings = Settings::getInstance();
+	settings->setString("Renderer", sRenderer);
+	settings->setString("ThemeSet", "benchmark");
+	settings->setString("GamelistViewStyle", sScenario == "grid" ? "grid" : (textList || gamelistOnly) ? "basic" : "detailed");
+	settings->setBool("SplashScreen", false);
+	settings->setBool("Windowed", true);
+	settings->setBool("VSync", false);
+	settings->setInt("WindowWidth", 1280);
+	settings->setInt("WindowHeight", 720);
+	settings->setBool("audio.bgmusic", false);
+	settings->setInt("ScreenSaverTime", 0);
+
+	if (gamelistOnly)
+		settings->setBool("ParseGamelistOnly", true);
+
+	if (folderTree)
+		settings->setString("FolderViewMode", "always");
+
+	sResidentBeforeLoad = getResidentMemory();
+	return true;
+}
+
+static unsigned long long percentile(std::vector<unsigned long long> values, double pct)
+{
+	if (values.size() == 0)
+		return 0;
+
+	std::sort(values.begin(), values.end());
+
+	size_t index = (size_t)(pct * (values.size() - 1) + 0.5);
+	return values[std::min(index, values.size() - 1)];
+}
+
+static int writeReport(const std::string& report, const std::string& outputPath)
+{
+	if (outputPath.empty())
+	{
+		std::cout << report;
+		return 0;
+	}
+
+	std::ofstream file(outputPath, std::ios::binary);
+	if (!file.is_open())
+	{
+		LOG(LogError) << "Benchmark : unable to write " << outputPath;
+		return 1;
+	}
+
+	file << report;
+	LOG(LogInfo) << "Benchmark : report saved to " << outputPath;
+	return 0;
+}
+
+// Rom like contents : runs of repeated bytes mixed with noise, so the archives are neither trivial nor incompressible
+static std::string getArchiveMember(int index)
+{
+	unsigned int seed = 0x1234567 + index * 7919;
+	auto next = [&seed]() { seed = seed * 1103515245 + 12345; return (seed >> 16) & 0x7FFF; };
+
+	size_t size = 32 * 1024 + (next() % 16) * 32 * 1024;
+
+	std::string data;
+	data.reserve(size);
+
+	while (data.size() < size)
+	{
+		if (next() % 2)
+			data.append(std::min((size_t)(next() % 256 + 1), size - data.size()), (char)next());
+		else
+		{
+			for (int i = next() % 256; i >= 0 && data.size() < size; i--)
+				data += (char)next();
+		}
+	}
+
+	return data;
+}
+
+static unsigned long long elapsedUs(std::chrono::steady_clock::time_point start)
+{
+	return (unsigned long long) std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Hashes a 7z corpus in-process ( ApiSystem::getCRC32 & getMD5 ). The corpus is created with the 7z executable, the scenario is skipped without it
+static int runArchives(const std::string& outputPath)
+{
+	CrcGenerateTable();
+
+	std::string folder = Benchmark::getHomePath() + "/archives";
+	Utils::FileSystem::createDirectory(folder);
+
+	LOG(LogInfo) << "Benchmark : preparing archive corpus in " << folder;
+
+	ApiSystem* api = ApiSystem::getInstance();
+	std::string sevenZip = api->getSevenZipCommand();
+
+	std::vector<std::string> paths;
+	std::vector<std::string> crcs;
+	std::vector<std::string> md5s;
+	unsigned long long totalBytes = 0;
+	bool available = true;
+
+	for (int i = 0; i < BENCHMARK_ARCHIVES && available; i++)
+	{
+		char fileName[32];
+		snprintf(fileName, sizeof(fileName), "game%04d", i);
+
+		std::string data = getArchiveMember(i);
+		std::string path = folder + "/" + fileName + ".7z";
+
+		if (!Utils::FileSystem::exists(path))
+		{
+			// One member per archive, in a non solid block
+			std::string member = folder + "/" + fileName + ".bin";
+			Utils::FileSystem::writeAllText(member, data);
+
+			std::string cmd = sevenZip + " a -t7z -ms=off \"" + path + "\" \"" + member + "\"";
+#if WIN32
+			cmd += " > NUL 2>&1";
+#else
+			cmd += " > /dev/null 2>&1";
+#endif
+			available = system(cmd.c_str()) == 0 && Utils::FileSystem::exists(path);
+			Utils::FileSystem::removeFile(member);
+
+			if (!available)
+			{
+				LOG(LogWarning) << "Benchmark : unable to create " << path << " with " << sevenZip;
+				break;
+			}
+		}
+
+		char crc[10];
+		snprintf(crc, sizeof(crc), "%08X", CrcCalc(data.data(), data.size()));
+
+		MD5 md5;
+		md5.update(data.data(), (MD5::size_type)data.size());
+		md5.finalize();
+
+		paths.push_back(path);
+		crcs.push_back(crc);
+		md5s.push_back(md5.hexdigest());
+		totalBytes += data.size();
+	}
+
+	int errors = 0;
+	unsigned long long crcTime = 0;
+	unsigned long long md5Time = 0;
+
+	if (available)
+	{
+		LOG(LogInfo) << "Benchmark : running scenario archives";
+
+		auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < paths.size(); i++)
+			if (api->getCRC32(paths[i], true) != crcs[i])
+				errors++;
+
+		crcTime = elapsedUs(start);
+
+		start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < paths.size(); i++)
+			if (api->getMD5(paths[i], true) != md5s[i])
+				errors++;
+
+		md5Time = elapsedUs(start);
+	}
+
+	std::stringstream ss;
+	ss << "{\n";
+	ss << "  \"scenario\": \"archives\",\n";
+	ss << "  \"corpusAvailable\": " << (available ? "true" : "false") << ",\n";
+	ss << "  \"archiveCount\": " << (available ? paths.size() : 0) << ",\n";
+	ss << "  \"uncompressedBytes\": " << (available ? totalBytes : 0) << ",\n";
+	ss << "  \"summary\": { \"crcUs\": " << crcTime << ", \"md5Us\": " << md5Time << ", \"errors\": " << errors << " }\n";
+	ss << "}\n";
+
+	return writeReport(ss.str(), outputPath);
+}
+
+// Memory held by the loaded library, and the cost of reading metadata from every entry
+static int runMemory(const std::string& scenario, const std::string& outputPath)
+{
+	size_t resident = getResidentMemory();
+
+	LOG(LogInfo) << "Benchmark : running scenario " << scenario;
+
+	size_t entries = 0;
+	size_t valueBytes = 0;
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (auto system : SystemData::sSystemVector)
+	{
+		if (!system->isGameSystem() || system->isCollection())
+			continue;
+
+		for (auto file : system->getRootFolder()->getFilesRecursive(GAME))
+		{
+			valueBytes += file->getMetadata(MetaDataId::Image).size() + file->getMetadata(MetaDataId::Genre).size() + file->getMetadata(MetaDataId::Players).size();
+			entries++;
+		}
+	}
+
+	unsigned long long lookupTime = elapsedUs(start);
+
+	size_t loaded = resident > sResidentBeforeLoad ? resident - sResidentBeforeLoad : 0;
+
+	std::stringstream ss;
+	ss << "{\n";
+	ss << "  \"scenario\": \"" << scenario << "\",\n";
+	ss << "  \"entryCount\": " << entries << ",\n";
+	ss << "  \"summary\": {\n";
+	ss << "    \"residentBeforeLoadBytes\": " << sResidentBeforeLoad << ",\n";
+	ss << "    \"residentBytes\": " << resident << ",\n";
+	ss << "    \"bytesPerEntry\": " << (entries == 0 ? 0 : loaded / entries) << ",\n";
+	ss << "    \"metadataLookupUs\": " << lookupTime << ",\n";
+	ss << "    \"metadataValueBytes\": " << valueBytes << "\n";
+	ss << "  }\n}\n";
+
+	return writeReport(ss.str(), outputPath);
+}
+
+// Parses the 100k entries gamelist into the loaded library, with the streaming reader & with a pugixml document ( the path of gamelists
+// sent to the web api ) : entries per second, and the peak resident memory above the memory before the parse
+static int runGamelistParse(const std::string& outputPath)
+{
+	SystemData* system = nullptr;
+	for (auto sys : SystemData::sSystemVector)
+		if (sys->getName() == "bench1")
+			system = sys;
+
+	if (system == nullptr)
+	{
+		LOG(LogError) << "Benchmark : no benchmark system";
+		return 1;
+	}
+
+	LOG(LogInfo) << "Benchmark : running scenario gamelistparse";
+
+	std::unordered_map<std::string, FileData*> fileMap;
+	fileMap[system->getStartPath()] = system->getRootFolder();
+	for (auto file : system->getRootFolder()->getFilesRecursive(GAME | FOLDER))
+		fileMap[file->getPath()] = file;
+
+	std::string gamelistPath = system->getGamelistPath(false);
+	size_t fileSize = (size_t)Utils::FileSystem::getFileSize(gamelistPath);
+
+	struct Run
+	{
+		Run() : entries(0), bestUs(0), peakBytes(0) { }
+
+		size_t entries;
+		unsigned long long bestUs;
+		size_t peakBytes;
+	};
+
+	auto runParse = [&](bool stream)
+	{
+		Run run;
+
+		for (int i = 0; i < BENCHMARK_GAMELIST_RUNS; i++)
+		{
+			size_t resident = getResidentMemory();
+			resetPeakResidentMemory();
+
+			auto start = std::chrono::steady_clock::now();
+
+			std::vector<FileData*> files;
+			if (stream)
+				files = loadGamelistFile(gamelistPath, system, fileMap);
+			else
+				files = loadGamelistFile(Utils::FileSystem::readAllText(gamelistPath), system, fileMap, SIZE_MAX, false);
+
+			unsigned long long time = elapsedUs(start);
+
+			size_t peak = getPeakResidentMemory();
+
+			run.entries = files.size();
+			if (i == 0 || time < run.bestUs)
+				run.bestUs = time;
+
+			if (peak > resident)
+				run.peakBytes = std::max(run.peakBytes, peak - resident);
+		}
+
+		return run;
+	};
+
+	Run document = runParse(false);
+	Run streaming = runParse(true);
+
+	auto writeRun = [](std::stringstream& ss, const char* name, const Run& run, bool last)
+	{
+		ss << "  \"" << name << "\": {\n";
+		ss << "    \"entries\": " << run.entries << ",\n";
+		ss << "    \"bestUs\": " << run.bestUs << ",\n";
+		ss << "    \"entriesPerSecond\": " << (run.bestUs == 0 ? 0 : (unsigned long long)(run.entries * 1000000ULL / run.bestUs)) << ",\n";
+		ss << "    \"peakResidentAboveBaselineBytes\": " << run.peakBytes << "\n";
+		ss << "  }" << (last ? "" : ",") << "\n";
+	};
+
+	std::stringstream ss;
+	ss << "{\n";
+	ss << "  \"scenario\": \"gamelistparse\",\n";
+	ss << "  \"gamelistBytes\": " << fileSize << ",\n";
+	ss << "  \"runs\": " << BENCHMARK_GAMELIST_RUNS << ",\n";
+	writeRun(ss, "document", document, false);
+	writeRun(ss, "streaming", streaming, true);
+	ss << "}\n";
+
+	return writeReport(ss.str(), outputPath);
+}
+
+struct BenchmarkWriteEvent
+{
+	double		time; // seconds in the hour
+	FileData*	file;
+	MetaDataId	id;
+	std::string	value;
+};
+
+struct BenchmarkWriteRun
+{
+	BenchmarkWriteRun() : bytes(0), files(0), syncs(0), batches(0), coalesced(0) { }
+
+	std::vector<unsigned long long> stalls;
+	unsigned long long bytes;
+	int files;
+	int syncs;
+	int batches;
+	int coalesced;
+};
+
+// An hour of use : 10 games played, 20 favorites toggled, 30 games scraped 2 s apart, and 300 games hashed 0.2 s apart ( crc32, then cheevos hash )
+static std::vector<BenchmarkWriteEvent> getWriteEvents(SystemData* system)
+{
+	std::vector<FileData*> games = system->getRootFolder()->getFilesRecursive(GAME);
+	std::vector<BenchmarkWriteEvent> events;
+
+	unsigned int seed = 0x2545F491;
+	auto next = [&seed]() { seed = seed * 1103515245 + 12345; return (seed >> 16) & 0x7FFF; };
+
+	auto add = [&events](double time, FileData* file, MetaDataId id, const std::string& value)
+	{
+		BenchmarkWriteEvent event;
+		event.time = time;
+		event.file = file;
+		event.id = id;
+		event.value = value;
+		events.push_back(event);
+	};
+
+	for (int i = 0; i < 10; i++)
+		add(300 + i * 330, games[next() % games.size()], MetaDataId::PlayCount, std::to_string(i + 1));
+
+	for (int i = 0; i < 20; i++)
+		add(next() % 3600, games[next() % games.size()], MetaDataId::Favorite, i % 2 ? "false" : "true");
+
+	for (int i = 0; i < 30; i++)
+		add(1200 + i * 2, games[i % games.size()], MetaDataId::Desc, "Scraped description of the game, a few sentences long, as the scrapers return them.");
+
+	for (int i = 0; i < 300; i++)
+	{
+		FileData* file = games[(i + 100) % games.size()];
+		add(2000 + i * 0.2, file, MetaDataId::Crc32, "0123ABCD");
+		add(2000 + i * 0.2 + 0.05, file, MetaDataId::CheevosHash, "0123456789ABCDEF0123456789ABCDEF");
+	}
+
+	std::stable_sort(events.begin(), events.end(), [](const BenchmarkWriteEvent& a, const BenchmarkWriteEvent& b) { return a.time < b.time; });
+	return events;
+}
+
+// Replays the hour of use, in BENCHMARK_WRITES_SPEEDUP times less. Only the time spent saving is measured, it is spent on the UI thread
+static BenchmarkWriteRun runWrites(SystemData* system, const std::vector<BenchmarkWriteEvent>& events)
+{
+	BenchmarkWriteRun run;
+
+	std::string recoveryPath = Paths::getUserEmulationStationPath() + "/recovery/" + system->getName();
+	Utils::FileSystem::deleteDirectoryFiles(recoveryPath, true);
+
+	GamelistWriter* writer = GamelistWriter::getInstance();
+	writer->setDelays(2000 / BENCHMARK_WRITES_SPEEDUP, 10000 / BENCHMARK_WRITES_SPEEDUP);
+
+	GamelistWriter::Stats before = writer->getStats();
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (auto& event : events)
+	{
+		std::this_thread::sleep_until(start + std::chrono::microseconds((long long)(event.time * 1000000 / BENCHMARK_WRITES_SPEEDUP)));
+
+		event.file->getMetadata().set(event.id, event.value);
+
+		auto saveStart = std::chrono::steady_clock::now();
+		saveToGamelistRecovery(event.file);
+		run.stalls.push_back(elapsedUs(saveStart));
+	}
+
+	writer->flush();
+
+	GamelistWriter::Stats after = writer->getStats();
+	run.bytes = after.bytes - before.bytes;
+	run.files = after.written - before.written;
+	run.syncs = after.syncs - before.syncs;
+	run.batches = after.batches - before.batches;
+	run.coalesced = after.coalesced - before.coalesced;
+
+	Utils::FileSystem::deleteDirectoryFiles(recoveryPath, true);
+	return run;
+}
+
+// Recovery files written through GamelistWriter after play sessions, scraping, favorites & hashing.
+// Reports the time the saving thread is stalled and the bytes written, for an hour of use
+static int runGamelistWrites(const std::string& outputPath)
+{
+	SystemData* system = nullptr;
+	for (auto sys : SystemData::sSystemVector)
+		if (sys->getName() == "bench1")
+			system = sys;
+
+	if (system == nullptr)
+	{
+		LOG(LogError) << "Benchmark : no benchmark system";
+		return 1;
+	}
+
+	LOG(LogInfo) << "Benchmark : running scenario gamelistwrites";
+
+	Settings::getInstance()->setBool("SaveGamelistsOnExit", true);
+
+	auto events = getWriteEvents(system);
+
+	BenchmarkWriteRun run = runWrites(system, events);
+
+	unsigned long long total = 0;
+	for (auto stall : run.stalls)
+		total += stall;
+
+	std::stringstream ss;
+	ss << "{\n";
+	ss << "  \"scenario\": \"gamelistwrites\",\n";
+	ss << "  \"changesPerHour\": " << events.size() << ",\n";
+	ss << "  \"speedup\": " << BENCHMARK_WRITES_SPEEDUP << ",\n";
+	ss << "  \"summary\": {\n";
+	ss << "    \"callerStallUs\": " << total << ",\n";
+	ss << "    \"callerStallP50Us\": " << percentile(run.stalls, 0.5) << ",\n";
+	ss << "    \"callerStallP99Us\": " << percentile(run.stalls, 0.99) << ",\n";
+	ss << "    \"callerStallMaxUs\": " << percentile(run.stalls, 1.0) << ",\n";
+	ss << "    \"filesWritten\": " << run.files << ",\n";
+	ss << "    \"changesCoalesced\": " << run.coalesced << ",\n";
+	ss << "    \"batches\": " << run.batches << ",\n";
+	ss << "    \"syncs\": " << run.syncs << ",\n";
+	ss << "    \"bytesWrittenPerHour\": " << run.bytes << "\n";
+	ss << "  }\n}\n";
+
+	return writeReport(ss.str(), outputPath);
+}
+
+// Types a search letter by letter on the library : time to filter every game per keystroke with the text filter
+static int runSearch(const std::string& outputPath)
+{
+	const std::string text = "dragon quest";
+
+	SystemData* system = nullptr;
+	for (auto sys : SystemData::sSystemVector)
+		if (sys->getName() == "bench1")
+			system = sys;
+
+	if (system == nullptr)
+	{
+		LOG(LogError) << "Benchmark : no benchmark system";
+		return 1;
+	}
+
+	FileFilterIndex* index = system->getIndex(true);
+	std::vector<FileData*> games = system->getRootFolder()->getFilesRecursive(GAME);
+
+	LOG(LogInfo) << "Benchmark : running scenario search on " << games.size() << " games";
+
+	std::stringstream keystrokes;
+	unsigned long long totalIndexed = 0, maxIndexed = 0, firstIndexed = 0;
+
+	for (size_t i = 1; i <= text.size(); i++)
+	{
+		std::string filter = text.substr(0, i);
+
+		index->setTextFilter(filter);
+
+		auto start = std::chrono::steady_clock::now();
+
+		int matches = 0;
+		for (auto game : games)
+			if (index->showFile(game))
+				matches++;
+
+		unsigned long long indexedTime = elapsedUs(start);
+
+		// The first keystroke creates the index
+		if (i == 1)
+			firstIndexed = indexedTime;
+		else
+		{
+			totalIndexed += indexedTime;
+			maxIndexed = std::max(maxIndexed, indexedTime);
+		}
+
+		keystrokes << "    { \"text\": \"" << filter << "\", \"matches\": " << matches << ", \"indexedUs\": " << indexedTime << " }" << (i < text.size() ? "," : "") << "\n";
+	}
+
+	index->resetFilters();
+
+	size_t count = std::max((size_t)1, text.size() - 1);
+
+	std::stringstream ss;
+	ss << "{\n";
+	ss << "  \"scenario\": \"search\",\n";
+	ss << "  \"gameCount\": " << games.size() << ",\n";
+	ss << "  \"summary\": {\n";
+	ss << "    \"firstKeystrokeUs\": " << firstIndexed << ",\n";
+	ss << "    \"indexedUs\": { \"avg\": " << (totalIndexed / count) << ", \"max\": " << maxIndexed << " }\n";
+	ss << "  },\n";
+	ss << "  \"keystrokes\": [\n" << keystrokes.str() << "  ]\n}\n";
+
+	return writeReport(ss.str(), outputPath);
+}
+
+static void getFolders(FolderData* folder, std::vector<FolderData*>& folders)
+{
+	folders.push_back(folder);
+
+	for (auto child : folder->getChildren())
+		if (child->getType() == FOLDER)
+			getFolders((FolderData*)child, folders);
+}
+
+// Lists every folder of the tree with a text filter set, as when browsing a filtered system : the first listings of a filter,
+// the same listings again, and listings with a new filter generation each, which is what every listing cost before folders cached their visibility
+static int runFolders(const std::string& outputPath)
+{
+	SystemData* system = nullptr;
+	for (auto sys : SystemData::sSystemVector)
+		if (sys->getName() == "bench1")
+			system = sys;
+
+	if (system == nullptr)
+	{
+		LOG(LogError) << "Benchmark : no benchmark system";
+		return 1;
+	}
+
+	FileFilterIndex* index = system->getIndex(true);
+
+	std::vector<FolderData*> folders;
+	getFolders(system->getRootFolder(), folders);
+
+	LOG(LogInfo) << "Benchmark : running scenario folders on " << folders.size() << " folders";
+
+	const std::string filter = "zelda";
+	index->setTextFilter(filter);
+
+	size_t displayed = 0;
+
+	auto start = std::chrono::steady_clock::now();
+	for (auto folder : folders)
+		displayed += folder->getChildrenListToDisplay().size();
+
+	unsigned long long firstTime = elapsedUs(start);
+
+	start = std::chrono::steady_clock::now();
+	for (auto folder : folders)
+		folder->getChildrenListToDisplay();
+
+	unsigned long long cachedTime = elapsedUs(start);
+
+	start = std::chrono::steady_clock::now();
+	for (auto folder : folders)
+	{
+		index->setTextFilter(filter);
+		folder->getChildrenListToDisplay();
+	}
+
+	unsigned long long uncachedTime = elapsedUs(start);
+
+	index->resetFilters();
+
+	std::stringstream ss;
+	ss << "{\n";
+	ss << "  \"scenario\": \"folders\",\n";
+	ss << "  \"folderCount\": " << folders.size() << ",\n";
+	ss << "  \"displayedEntries\": " << displayed << ",\n";
+	ss << "  \"summary\": {\n";
+	ss << "    \"firstListingsUs\": " << firstTime << ",\n";
+	ss << "    \"cachedListingsUs\": " << cachedTime << ",\n";
+	ss << "    \"uncachedListingsUs\": " << uncachedTime << "\n";
+	ss << "  }\n}\n";
+
+	return writeReport(ss.str(), outputPath);
+}
+
+// Filters & auto collections of a 40k games arcade system, which read the classification flags of every game ( FileData::getNameFlags
+// & hasCheevos ). The first pass computes the flags that aren't computed at load, the second reads them,
+// and the third follows a metadata change of every game, which recomputes the cheevos flag
+static int runArcade(const std::string& outputPath)
+{
+	SystemData* system = nullptr;
+	for (auto sys : SystemData::sSystemVector)
+		if (sys->getName() == "bench1")
+			system = sys;
+
+	if (system == nullptr)
+	{
+		LOG(LogError) << "Benchmark : no benchmark system";
+		return 1;
+	}
+
+	FileFilterIndex* index = system->getIndex(true);
+	std::vector<FileData*> games = system->getRootFolder()->getFilesRecursive(GAME);
+
+	LOG(LogInfo) << "Benchmark : running scenario arcade40k on " << games.size() << " games";
+
+	struct ArcadeFilter
+	{
+		const char* name;
+		FilterIndexType type;
+	};
+
+	static const ArcadeFilter filters[] =
+	{
+		{ "vertical", VERTICAL_FILTER },
+		{ "lightgun", LIGHTGUN_FILTER },
+		{ "wheel", WHEEL_FILTER },
+		{ "trackball", TRACKBALL_FILTER },
+		{ "spinner", SPINNER_FILTER },
+		{ "cheevos", CHEEVOS_FILTER }
+	};
+
+	// Not displayed by default : they can be rebuilt without a view holding their entries
+	static const char* collections[] = { "vertical", "lightgun", "wheel", "trackball", "spinner", "retroachievements" };
+
+	auto& autoCollections = CollectionSystemManager::get()->getAutoCollectionSystems();
+
+	std::vector<std::string> values = { "TRUE" };
+	std::stringstream passes;
+
+	const char* passNames[] = { "first", "cached", "afterMetadataChange" };
+
+	for (int pass = 0; pass < 3; pass++)
+	{
+		if (pass == 2)
+			for (auto game : games)
+				game->getMetadata().set(MetaDataId::PlayCount, "1");
+
+		std::stringstream filterTimes;
+		unsigned long long filtersTime = 0;
+
+		for (auto& filter : filters)
+		{
+			index->setFilter(filter.type, &values);
+
+			auto start = std::chrono::steady_clock::now();
+
+			int matches = 0;
+			for (auto game : games)
+				if (index->showFile(game))
+					matches++;
+
+			unsigned long long time = elapsedUs(start);
+			filtersTime += time;
+
+			index->setFilter(filter.type, nullptr);
+
+			filterTimes << (filterTimes.tellp() > 0 ? ", " : "") << "\"" << filter.name << "\": { \"matches\": " << matches << ", \"us\": " << time << " }";
+		}
+
+		std::stringstream collectionTimes;
+		unsigned long long collectionsTime = 0;
+
+		for (auto name : collections)
+		{
+			auto it = autoCollections.find(name);
+			if (it == autoCollections.cend() || it->second.system == nullptr)
+				continue;
+
+			auto start = std::chrono::steady_clock::now();
+
+			it->second.system->getRootFolder()->clear();
+			CollectionSystemManager::get()->populateAutoCollection(&it->second);
+
+			unsigned long long time = elapsedUs(start);
+			collectionsTime += time;
+
+			collectionTimes << (collectionTimes.tellp() > 0 ? ", " : "") << "\"" << name << "\": { \"games\": " << it->second.system->getRootFolder()->getChildren().size() << ", \"us\": " << time << " }";
+		}
+
+		passes << "    \"" << passNames[pass] << "\": {\n";
+		passes << "      \"filtersUs\": " << filtersTime << ",\n";
+		passes << "      \"filters\": { " << filterTimes.str() << " },\n";
+		passes << "      \"collectionsUs\": " << collectionsTime << ",\n";
+		passes << "      \"collections\": { " << collectionTimes.str() << " }\n";
+		passes << "    }" << (pass < 2 ? "," : "") << "\n";
+	}
+
+	index->resetFilters();
+
+	std::stringstream ss;
+	ss << "{\n";
+	ss << "  \"scenario\": \"arcade40k\",\n";
+	ss << "  \"gameCount\": " << games.size() << ",\n";
+	ss << "  \"passes\": {\n" << passes.str() << "  }\n}\n";
+
+	return writeReport(ss.str(), outputPath);
+}
+
+// Save states of a system : file name matching, then the index build, the states of every game, and the same queries again
+static int runSaveStates(const std::string& outputPath)
+{
+	SystemData* system = nullptr;
+	for (auto sys : SystemData::sSystemVector)
+		if (sys->getName() == "bench1")
+			system = sys;
+
+	if (system == nullptr)
+	{
+		LOG(LogError) << "Benchmark : no benchmark system";
+		return 1;
+	}
+
+	auto config = SaveStateConfigFile::getSaveStateConfigs(system)[0];
+	std::string path = config->getDirectory(system);
+
+	std::vector<std::string> fileNames;
+	for (auto file : Utils::FileSystem::getDirectoryFiles(path))
+		if (!file.hidden && !file.directory)
+			fileNames.push_back(Utils::FileSystem::getFileName(file.path));
+
+	std::vector<FileData*> games = system->getRootFolder()->getFilesRecursive(GAME);
+
+	LOG(LogInfo) << "Benchmark : running scenario savestates on " << fileNames.size() << " files";
+
+	// File names of the states
+	std::string rom;
+	int slot;
+	int matches = 0;
+
+	auto start = std::chrono::steady_clock::now();
+	for (auto& fileName : fileNames)
+		if (config->matchSlotFile(fileName, rom, slot) || config->matchAutoFile(fileName, rom))
+			matches++;
+
+	unsigned long long matcherTime = elapsedUs(start);
+
+	SaveStateRepository* repository = system->getSaveStateRepository();
+	repository->refresh();
+
+	int withStates = 0;
+
+	start = std::chrono::steady_clock::now();
+	for (auto game : games)
+		if (repository->hasSaveStates(game))
+			withStates++;
+
+	unsigned long long indexTime = elapsedUs(start);
+
+	size_t stateCount = 0;
+
+	start = std::chrono::steady_clock::now();
+	for (auto game : games)
+		stateCount += repository->getSaveStates(game).size();
+
+	unsigned long long statesTime = elapsedUs(start);
+
+	start = std::chrono::steady_clock::now();
+	for (auto game : games)
+		if (repository->hasSaveStates(game))
+			repository->getSaveStates(game);
+
+	unsigned long long cachedTime = elapsedUs(start);
+
+	std::stringstream ss;
+	ss << "{\n";
+	ss << "  \"scenario\": \"savestates\",\n";
+	ss << "  \"fileCount\": " << fileNames.size() << ",\n";
+	ss << "  \"gameCount\": " << games.size() << ",\n";
+	ss << "  \"matches\": " << matches << ",\n";
+	ss << "  \"gamesWithStates\": " << withStates << ",\n";
+	ss << "  \"states\": " << stateCount << ",\n";
+	ss << "  \"summary\": {\n";
+	ss << "    \"matcherUs\": " << matcherTime << ",\n";
+	ss << "    \"indexUs\": " << indexTime << ",\n";
+	ss << "    \"statesUs\": " << statesTime << ",\n";
+	ss << "    \"cachedUs\": " << cachedTime << "\n";
+	ss << "  }\n}\n";
+
+	return writeReport(ss.str(), outputPath);
+}
+
+static std::string getCheevosOfficialGames(int removed)
+{
+	std::stringstream ss;
+	ss << "{\"Success\":true,\"Response\":{";
+
+	for (int game = 1 + removed; game <= BENCHMARK_CHEEVOS_GAMES; game++)
+		ss << (game > 1 + removed ? "," : "") << "\"" << game << "\":\"Game " << game << "\"";
+
+	ss << "}}";
+	return ss.str();
+}
+
+// RetroAchievements hash library : a local server stands in for retroachievements.org, with ETag validation.
+// Reports the first download into the database, a run where nothing changed ( 304 ), a run where only the official games list changed,
+// loading the file, and md5 lookups
+static int runCheevosHashes(const std::string& outputPath)
+{
+	std::vector<std::string> hashes;
+	std::stringstream library;
+	library << "{\"Success\":true,\"MD5List\":{";
+
+	for (int i = 0; i < BENCHMARK_CHEEVOS_HASHES; i++)
+	{
+		MD5 md5(std::to_string(i));
+		hashes.push_back(md5.hexdigest());
+
+		// 1 game in 10 is not official
+		library << (i > 0 ? "," : "") << "\"" << hashes.back() << "\":" << (1 + (i % (BENCHMARK_CHEEVOS_GAMES + BENCHMARK_CHEEVOS_GAMES / 10)));
+	}
+
+	library << "}}";
+
+	std::mutex serverLock;
+	std::string hashLibrary = library.str();
+	std::string officialGames = getCheevosOfficialGames(0);
+	std::string officialGamesETag = "\"official-1\"";
+	int requests = 0, notModified = 0;
+
+	httplib::Server server;
+	server.Get("/dorequest.php", [&](const httplib::Request& req, httplib::Response& res)
+	{
+		std::unique_lock<std::mutex> lock(serverLock);
+
+		bool official = req.get_param_value("r") == "officialgameslist";
+		std::string etag = official ? officialGamesETag : "\"library-1\"";
+
+		requests++;
+
+		res.set_header("ETag", etag.c_str());
+
+		if (req.get_header_value("If-None-Match") == etag)
+		{
+			notModified++;
+			res.status = 304;
+			return;
+		}
+
+		res.set_content(official ? officialGames : hashLibrary, "application/json");
+	});
+
+	int port = server.bind_to_any_port("127.0.0.1");
+	if (port <= 0)
+	{
+		LOG(LogError) << "Benchmark : unable to start the local server";
+		return 1;
+	}
+
+	std::thread serverThread([&server] { server.listen_after_bind(); });
+
+	std::string serverUrl = "http://127.0.0.1:" + std::to_string(port);
+
+	LOG(LogInfo) << "Benchmark : running scenario cheevoshashes on " << serverUrl;
+
+	CheevosHashDatabase* database = CheevosHashDatabase::getInstance();
+	CheevosHashDatabase::setServerUrl(serverUrl);
+
+	Utils::FileSystem::removeFile(CheevosHashDatabase::getDatabasePath());
+	database->unload();
+
+	auto start = std::chrono::steady_clock::now();
+	bool fullOk = database->refresh();
+	unsigned long long fullTime = elapsedUs(start);
+	size_t fullCount = database->size();
+
+	start = std::chrono::steady_clock::now();
+	bool unchangedOk = database->refresh();
+	unsigned long long unchangedTime = elapsedUs(start);
+
+	{
+		std::unique_lock<std::mutex> lock(serverLock);
+		officialGames = getCheevosOfficialGames(100);
+		officialGamesETag = "\"official-2\"";
+	}
+
+	start = std::chrono::steady_clock::now();
+	bool deltaOk = database->refresh();
+	unsigned long long deltaTime = elapsedUs(start);
+	size_t deltaCount = database->size();
+
+	database->unload();
+
+	start = std::chrono::steady_clock::now();
+	size_t loadedCount = database->size();
+	unsigned long long loadTime = elapsedUs(start);
+
+	server.stop();
+	serverThread.join();
+
+	// Lookups, upper case as the hasher stores them
+	std::vector<std::string> keys;
+	for (int i = 0; i < BENCHMARK_CHEEVOS_LOOKUPS; i++)
+		keys.push_back(Utils::String::toUpper(hashes[(i * 7919) % hashes.size()]));
+
+	int found = 0;
+
+	start = std::chrono::steady_clock::now();
+	for (auto& key : keys)
+		if (database->getGameId(key) > 0)
+			found++;
+
+	unsigned long long lookupTime = elapsedUs(start);
+
+	std::stringstream ss;
+	ss << "{\n";
+	ss << "  \"scenario\": \"cheevoshashes\",\n";
+	ss << "  \"hashCount\": " << hashes.size() << ",\n";
+	ss << "  \"databaseHashes\": { \"full\": " << fullCount << ", \"delta\": " << deltaCount << ", \"loaded\": " << loadedCount << " },\n";
+	ss << "  \"refreshOk\": " << ((fullOk && unchangedOk && deltaOk) ? "true" : "false") << ",\n";
+	ss << "  \"requests\": " << requests << ",\n";
+	ss << "  \"notModified\": " << notModified << ",\n";
+	ss << "  \"lookups\": { \"count\": " << keys.size() << ", \"found\": " << found << " },\n";
+	ss << "  \"summary\": {\n";
+	ss << "    \"fullRefreshUs\": " << fullTime << ",\n";
+	ss << "    \"unchangedRefreshUs\": " << unchangedTime << ",\n";
+	ss << "    \"officialDeltaRefreshUs\": " << deltaTime << ",\n";
+	ss << "    \"loadUs\": " << loadTime << ",\n";
+	ss << "    \"lookupUs\": " << lookupTime << "\n";
+	ss << "  }\n}\n";
+
+	return writeReport(ss.str(), outputPath);
+}
+
+// Uncompressed YUV4MPEG2 clip, demuxed by libvlc without any codec : 64x48, 25 fps, 2.4 seconds
+static bool writeY4mVideo(const std::string& path, int seed)
+{
+	const int width = 64, height = 48, frames = 60;
+
+	std::ofstream file(path, std::ios::binary);
+	if (!file.is_open())
+		return false;
+
+	file << "YUV4MPEG2 W" << width << " H" << height << " F25:1 Ip A1:1 C420jpeg\n";
+
+	std::string luma(width * height, 0);
+	std::string chroma(width * height / 2, (char)128);
+
+	for (int frame = 0; frame < frames; frame++)
+	{
+		for (int i = 0; i < width * height; i++)
+			luma[i] = (char)((i % width) * 4 + frame * 2 + seed * 16);
+
+		file << "FRAME\n";
+		file.write(luma.data(), luma.size());
+		file.write(chroma.data(), chroma.size());
+	}
+
+	return file.good();
+}
+
+// Thumbnails of a grid of videos, asked by BENCHMARK_VIDEO_LOADERS threads at once as the texture loaders do. Reports the cold population,
+// and the same population again
+static int runVideoThumbs(const std::string& outputPath)
+{
+	std::string folder = Benchmark::getHomePath() + "/videos";
+	Utils::FileSystem::createDirectory(folder);
+
+	std::vector<std::string> videos;
+	for (int i = 0; i < BENCHMARK_VIDEOS; i++)
+	{
+		char fileName[32];
+		snprintf(fileName, sizeof(fileName), "game%04d.y4m", i);
+
+		std::string path = folder + "/" + fileName;
+		if (!Utils::FileSystem::exists(path) && !writeY4mVideo(path, i))
+		{
+			LOG(LogError) << "Benchmark : unable to write " << path;
+			return 1;
+		}
+
+		videos.push_back(path);
+	}
+
+	LOG(LogInfo) << "Benchmark : running scenario videothumbs on " << videos.size() << " videos";
+
+	VideoThumbnailExtractor* extractor = VideoThumbnailExtractor::getInstance();
+
+	auto populate = [&videos, extractor]()
+	{
+		std::atomic<int> next(0);
+		std::atomic<int> found(0);
+
+		std::vector<std::thread> loaders;
+		for (int i = 0; i < BENCHMARK_VIDEO_LOADERS; i++)
+		{
+			loaders.push_back(std::thread([&]()
+			{
+				for (int index = next++; index < (int)videos.size(); index = next++)
+					if (!extractor->getThumbnail(videos[index]).empty())
+						found++;
+			}));
+		}
+
+		for (auto& loader : loaders)
+			loader.join();
+
+		return (int)found;
+	};
+
+	Utils::FileSystem::deleteDirectoryFiles(Paths::getUserEmulationStationPath() + "/tmp/videothumbs", true);
+	extractor->clearIndex();
+
+	auto start = std::chrono::steady_clock::now();
+	int coldFound = populate();
+	unsigned long long coldTime = elapsedUs(start);
+
+	auto coldStats = extractor->getStats();
+
+	start = std::chrono::steady_clock::now();
+	int warmFound = populate();
+	unsigned long long warmTime = elapsedUs(start);
+
+	auto warmStats = extractor->getStats();
+
+	std::stringstream ss;
+	ss << "{\n";
+	ss << "  \"scenario\": \"videothumbs\",\n";
+	ss << "  \"videoCount\": " << videos.size() << ",\n";
+	ss << "  \"loaderThreads\": " << BENCHMARK_VIDEO_LOADERS << ",\n";
+	ss << "  \"thumbnails\": { \"cold\": " << coldFound << ", \"warm\": " << warmFound << " },\n";
+	ss << "  \"vlcInstances\": " << coldStats.instances << ",\n";
+	ss << "  \"extracted\": " << coldStats.extracted << ",\n";
+	ss << "  \"failed\": " << coldStats.failed << ",\n";
+	ss << "  \"indexed\": " << (warmStats.indexed - coldStats.indexed) << ",\n";
+	ss << "  \"summary\": {\n";
+	ss << "    \"coldPopulationUs\": " << coldTime << ",\n";
+	ss << "    \"warmPopulationUs\": " << warmTime << "\n";
+	ss << "  }\n}\n";
+
+	return writeReport(ss.str(), outputPath);
+}
+
+// Video element of the videoframes scenario : size of the frames VLC decodes, and their rate
+struct BenchmarkVideo
+{
+	const char* name;
+	int width;
+	int height;
+	int fps;
+};
+
+static const BenchmarkVideo sBenchmarkVideos[] =
+{
+	{ "view", 640, 480, 30 },
+	{ "marquee", 320, 240, 25 },
+	{ "screensaver", 1280, 720, 30 }
+};
+
+struct BenchmarkVideoRun
+{
+	BenchmarkVideoRun() : published(0), uploaded(0), uploadBytes(0), processCpuUs(0) { }
+
+	unsigned long long published;
+	unsigned long long uploaded;
+	unsigned long long uploadBytes;
+	unsigned long long processCpuUs;
+	std::vector<unsigned long long> frameUs;	// render thread time spent on the videos, per frame
+};
+
+// Plays the videos of sBenchmarkVideos for BENCHMARK_VIDEO_FRAMES_MS : a thread per video stands for VLC and writes its frames at the video
+// rate, the render thread runs at 60 fps and uploads the new frames through the NULL renderer, then copies them as a software renderer would
+static BenchmarkVideoRun runVideoFrames()
+{
+	const int videoCount = sizeof(sBenchmarkVideos) / sizeof(sBenchmarkVideos[0]);
+
+	std::vector<VideoContext*> contexts;
+	std::vector<std::shared_ptr<TextureResource>> textures;
+	std::vector<std::vector<unsigned char>> softwareTextures;
+
+	for (int i = 0; i < videoCount; i++)
+	{
+		size_t size = sBenchmarkVideos[i].width * sBenchmarkVideos[i].height * 4;
+
+		VideoContext* ctx = new VideoContext();
+		for (int s = 0; s < 3; s++)
+			ctx->surfaces[s] = new unsigned char[size];
+
+		contexts.push_back(ctx);
+
+		textures.push_back(TextureResource::get("", false, false));
+		softwareTextures.push_back(std::vector<unsigned char>(size));
+	}
+
+	BenchmarkVideoRun result;
+
+	std::atomic<bool> exit(false);
+	std::atomic<unsigned long long> published(0);
+
+	std::vector<std::thread> decoders;
+	for (int i = 0; i < videoCount; i++)
+	{
+		decoders.push_back(std::thread([&, i]()
+		{
+			const BenchmarkVideo& video = sBenchmarkVideos[i];
+			size_t size = video.width * video.height * 4;
+
+			auto next = std::chrono::steady_clock::now();
+
+			for (int frame = 0; !exit; frame++)
+			{
+				memset(contexts[i]->lockFrame(), frame & 0xFF, size);
+				contexts[i]->unlockFrame();
+
+				published++;
+
+				next += std::chrono::microseconds(1000000 / video.fps);
+				std::this_thread::sleep_until(next);
+			}
+		}));
+	}
+
+	std::clock_t cpuStart = std::clock();
+	auto runStart = std::chrono::steady_clock::now();
+	auto next = runStart;
+
+	while (elapsedUs(runStart) < BENCHMARK_VIDEO_FRAMES_MS * 1000ULL)
+	{
+		auto start = std::chrono::steady_clock::now();
+
+		for (int i = 0; i < videoCount; i++)
+		{
+			const BenchmarkVideo& video = sBenchmarkVideos[i];
+			size_t size = video.width * video.height * 4;
+
+			auto upload = [&](unsigned char* pixels)
+			{
+				textures[i]->updateFromExternalPixels(pixels, video.width, video.height);
+				textures[i]->bind();
+				memcpy(softwareTextures[i].data(), pixels, size);
+				result.uploaded++;
+			};
+
+			unsigned char* frame = contexts[i]->takeFrame();
+			if (frame != nullptr)
+				upload(frame);
+		}
+
+		Renderer::swapBuffers();
+		result.uploadBytes += Renderer::NullRenderer::getFrameStats().textureUploadBytes;
+		result.frameUs.push_back(elapsedUs(start));
+
+		next += std::chrono::microseconds(16667);
+		std::this_thread::sleep_until(next);
+	}
+
+	exit = true;
+	for (auto& decoder : decoders)
+		decoder.join();
+
+	result.processCpuUs = (unsigned long long) ((std::clock() - cpuStart) * 1000000.0 / CLOCKS_PER_SEC);
+	result.published = published;
+
+	// Textures point to the surfaces
+	textures.clear();
+
+	for (auto ctx : contexts)
+		delete ctx;
+
+	return result;
+}
+
+static int runVideoFrames(const std::string& outputPath)
+{
+	LOG(LogInfo) << "Benchmark : running scenario videoframes";
+
+	BenchmarkVideoRun run = runVideoFrames();
+
+	unsigned long long total = 0;
+	for (auto us : run.frameUs)
+		total += us;
+
+	std::stringstream ss;
+	ss << "{\n";
+	ss << "  \"scenario\": \"videoframes\",\n";
+	ss << "  \"renderer\": \"" << Renderer::getDriverName() << "\",\n";
+	ss << "  \"durationMs\": " << BENCHMARK_VIDEO_FRAMES_MS << ",\n";
+	ss << "  \"videos\": [";
+
+	const int videoCount = sizeof(sBenchmarkVideos) / sizeof(sBenchmarkVideos[0]);
+	for (int i = 0; i < videoCount; i++)
+		ss << (i ? ", " : " ") << "{ \"name\": \"" << sBenchmarkVideos[i].name << "\", \"width\": " << sBenchmarkVideos[i].width << ", \"height\": " << sBenchmarkVideos[i].height << ", \"fps\": " << sBenchmarkVideos[i].fps << " }";
+
+	ss << " ],\n";
+	ss << "  \"summary\": {\n";
+	ss << "    \"renderFrames\": " << run.frameUs.size() << ",\n";
+	ss << "    \"publishedFrames\": " << run.published << ",\n";
+	ss << "    \"uploadedFrames\": " << run.uploaded << ",\n";
+	ss << "    \"supersededFrames\": " << (run.published > run.uploaded ? run.published - run.uploaded : 0) << ",\n";
+	ss << "    \"textureUploadBytes\": " << run.uploadBytes << ",\n";
+	ss << "    \"renderUs\": { \"avg\": " << (total / std::max((size_t)1, run.frameUs.size())) << ", \"p95\": " << percentile(run.frameUs, 0.95) << ", \"max\": " << percentile(run.frameUs, 1.0) << " },\n";
+	ss << "    \"processCpuUs\": " << run.processCpuUs << "\n";
+	ss << "  }\n}\n";
+
+	return writeReport(ss.str(), outputPath);
+}
+
+struct BenchmarkVideoStarts
+{
+	BenchmarkVideoStarts() : started(0) { }
+
+	int started;
+	VideoVlcPreloader::Stats stats;
+	std::vector<long long> firstFrameMs; // per cursor move, -1 when no frame came
+};
+
+// Moves a cursor over the videos, BENCHMARK_VIDEO_DWELL_MS on each, with a video element that starts without delay as the
+// gamelist does : the video is set, then the current entry & its neighbours are preloaded when asked
+static BenchmarkVideoStarts runVideoStarts(Window* window, const std::vector<std::string>& videos, bool preload)
+{
+	VideoVlcPreloader* preloader = VideoVlcPreloader::getInstance();
+	VideoVlcPreloader::clear();
+
+	auto before = preloader->getStats();
+
+	BenchmarkVideoStarts result;
+
+	VideoVlcComponent* video = new VideoVlcComponent(window);
+	video->setPosition(0, 0);
+	video->setResize(320, 240);
+	video->setStartDelay(0);
+	video->onShow();
+
+	int count = (int)videos.size();
+
+	for (int step = 0; step < BENCHMARK_VIDEO_STEPS; step++)
+	{
+		int index = step % count;
+
+		auto stats = preloader->getStats();
+
+		video->setVideo(videos[index]);
+		if (preload)
+			preloader->preload({ videos[index], videos[(index + 1) % count], videos[(index + count - 1) % count] });
+
+		auto start = std::chrono::steady_clock::now();
+		auto next = start;
+
+		while (elapsedUs(start) < BENCHMARK_VIDEO_DWELL_MS * 1000ULL)
+		{
+			video->update(BENCHMARK_FRAME_TIME);
+			video->render(Transform4x4f::Identity());
+			Renderer::swapBuffers();
+
+			next += std::chrono::milliseconds(BENCHMARK_FRAME_TIME);
+			std::this_thread::sleep_until(next);
+		}
+
+		auto after = preloader->getStats();
+
+		int starts = (after.warmStarts + after.coldStarts) - (stats.warmStarts + stats.coldStarts);
+		if (starts > 0)
+		{
+			result.started++;
+			result.firstFrameMs.push_back((long long)((after.warmFirstFrameMs + after.coldFirstFrameMs) - (stats.warmFirstFrameMs + stats.coldFirstFrameMs)));
+		}
+		else
+			result.firstFrameMs.push_back(-1);
+	}
+
+	video->onHide();
+	delete video;
+
+	VideoVlcPreloader::clear();
+
+	auto after = preloader->getStats();
+
+	result.stats.preloaded = after.preloaded - before.preloaded;
+	result.stats.released = after.released - before.released;
+	result.stats.warmStarts = after.warmStarts - before.warmStarts;
+	result.stats.coldStarts = after.coldStarts - before.coldStarts;
+	result.stats.warmFirstFrameMs = after.warmFirstFrameMs - before.warmFirstFrameMs;
+	result.stats.coldFirstFrameMs = after.coldFirstFrameMs - before.coldFirstFrameMs;
+
+	return result;
+}
+
+static int runVideoStart(Window* window, const std::string& outputPath)
+{
+	std::string folder = Benchmark::getHomePath() + "/videos";
+	Utils::FileSystem::createDirectory(folder);
+
+	std::vector<std::string> videos;
+	for (int i = 0; i < BENCHMARK_VIDEO_STEPS / 2; i++)
+	{
+		char fileName[32];
+		snprintf(fileName, sizeof(fileName), "game%04d.y4m", i);
+
+		std::string path = folder + "/" + fileName;
+		if (!Utils::FileSystem::exists(path) && !writeY4mVideo(path, i))
+		{
+			LOG(LogError) << "Benchmark : unable to write " << path;
+			return 1;
+		}
+
+		videos.push_back(path);
+	}
+
+	VideoVlcComponent::init();
+
+	LOG(LogInfo) << "Benchmark : running scenario videostart on " << videos.size() << " videos";
+
+	BenchmarkVideoStarts cold = runVideoStarts(window, videos, false);
+	BenchmarkVideoStarts warm = runVideoStarts(window, videos, true);
+
+	auto writeRun = [](std::stringstream& ss, const char* name, const BenchmarkVideoStarts& run, bool last)
+	{
+		const VideoVlcPreloader::Stats& stats = run.stats;
+
+		ss << "  \"" << name << "\": {\n";
+		ss << "    \"started\": " << run.started << ",\n";
+		ss << "    \"preloaded\": " << stats.preloaded << ",\n";
+		ss << "    \"releasedUnused\": " << stats.released << ",\n";
+		ss << "    \"warmStarts\": " << stats.warmStarts << ",\n";
+		ss << "    \"coldStarts\": " << stats.coldStarts << ",\n";
+		ss << "    \"firstFrameMs\": { \"warmAvg\": " << (stats.warmStarts ? stats.warmFirstFrameMs / stats.warmStarts : 0) << ", \"coldAvg\": " << (stats.coldStarts ? stats.coldFirstFrameMs / stats.coldStarts : 0) << " },\n";
+		ss << "    \"steps\": [";
+
+		for (size_t i = 0; i < run.firstFrameMs.size(); i++)
+			ss << (i ? ", " : " ") << run.firstFrameMs[i];
+
+		ss << " ]\n";
+		ss << "  }" << (last ? "" : ",") << "\n";
+	};
+
+	std::stringstream ss;
+	ss << "{\n";
+	ss << "  \"scenario\": \"videostart\",\n";
+	ss << "  \"videoCount\": " << videos.size() << ",\n";
+	ss << "  \"cursorMoves\": " << BENCHMARK_VIDEO_STEPS << ",\n";
+	ss << "  \"dwellMs\": " << BENCHMARK_VIDEO_DWELL_MS << ",\n";
+	writeRun(ss, "withoutPreload", cold, false);
+	writeRun(ss, "withPreload", warm, true);
+	ss << "}\n";
+
+	return writeReport(ss.str(), outputPath);
+}
+
+// Scenarios without a runner replay the input steps of getSteps & report per-frame statistics
+struct BenchmarkScenario
+{
+	const char* name;
+	int (*run)(Window* window, const std::string& outputPath);
+};
+
+static const BenchmarkScenario sBenchmarkScenarios[] =
+{
+	{ "gamelist", nullptr },
+	{ "grid", nullptr },
+	{ "textlist", nullptr },
+	{ "systems", nullptr },
+	{ "menus", nullptr },
+	{ "all", nullptr },
+	{ "archives", [](Window*, const std::string& outputPath) { return runArchives(outputPath); } },
+	{ "memory100k", [](Window*, const std::string& outputPath) { return runMemory("memory100k", outputPath); } },
+	{ "memory250k", [](Window*, const std::string& outputPath) { return runMemory("memory250k", outputPath); } },
+	{ "search", [](Window*, const std::string& outputPath) { return runSearch(outputPath); } },
+	{ "folders", [](Window*, const std::string& outputPath) { return runFolders(outputPath); } },
+	{ "arcade40k", [](Window*, const std::string& outputPath) { return runArcade(outputPath); } },
+	{ "savestates", [](Window*, const std::string& outputPath) { return runSaveStates(outputPath); } },
+	{ "cheevoshashes", [](Window*, const std::string& outputPath) { return runCheevosHashes(outputPath); } },
+	{ "videothumbs", [](Window*, const std::string& outputPath) { return runVideoThumbs(outputPath); } },
+	{ "videoframes", [](Window*, const std::string& outputPath) { return runVideoFrames(outputPath); } },
+	{ "videostart", [](Window* window, const std::string& outputPath) { return runVideoStart(window, outputPath); } },
+	{ "gamelistparse", [](Window*, const std::string& outputPath) { return runGamelistParse(outputPath); } },
+	{ "gamelistwrites", [](Window*, const std::string& outputPath) { return runGamelistWrites(outputPath); } }
+};
+
+static const BenchmarkScenario* getScenario(const std::string& name)
+{
+	for (auto& scenario : sBenchmarkScenarios)
+		if (name == scenario.name)
+			return &scenario;
+
+	return nullptr;
+}
+
+int Benchmark::run(Window* window)
+{
+	const BenchmarkScenario* scenario = getScenario(sScenario);
+	if (scenario != nullptr && scenario->run != nullptr)
+		return scenario->run(window, sOutputPath);
+
+	if (Renderer::getDriverName() != "NULL")
+		LOG(LogWarning) << "Benchmark : running with the " << Renderer::getDriverName() << " renderer, its draw counters are logged when the context is destroyed";
+
+	InputManager::getInstance()->loadDefaultKBConfig();
+
+	InputConfig* config = InputManager::getInstance()->getInputConfigByDevice(DEVICE_KEYBOARD);
+	if (config == nullptr)
+	{
+		LOG(LogError) << "Benchmark : no keyboard configuration";
+		return 1;
+	}
+
+	std::vector<BenchmarkFrame> frames;
+
+	auto runFrame = [window, &frames]()
+	{
+		// Nothing comes from the user, but SDL & background threads may post events
+		SDL_Event event;
+		while (SDL_PollEvent(&event))
+			;
+
+		sAllocations = 0;
+		sCountAllocations = true;
+
+		auto start = std::chrono::steady_clock::now();
+
+		window->update(BENCHMARK_FRAME_TIME);
+		window->render();
+		Renderer::swapBuffers();
+
+		auto end = std::chrono::steady_clock::now();
+
+		sCountAllocations = false;
+
+		const Renderer::NullRenderer::Stats& stats = Renderer::NullRenderer::getFrameStats();
+
+		BenchmarkFrame frame;
+		frame.cpuTime = (unsigned long long) std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+		frame.drawCalls = stats.drawCalls;
+		frame.vertices = stats.vertices;
+		frame.textureUploads = stats.textureUploads;
+		frame.textureUploadBytes = stats.textureUploadBytes;
+		frame.allocations = sAllocations;
+		frames.push_back(frame);
+	};
+
+	LOG(LogInfo) << "Benchmark : running scenario " << sScenario;
+
+	for (auto step : getSteps(sScenario))
+	{
+		if (!step.button.empty())
+		{
+			Input input;
+			if (!config->getInputByName(step.button, &input))
+			{
+				LOG(LogWarning) << "Benchmark : button " << step.button << " is not mapped";
+				continue;
+			}
+
+			input.value = 1;
+			window->input(config, input);
+			runFrame();
+
+			input.value = 0;
+			window->input(config, input);
+		}
+
+		for (int i = 0; i < step.frames; i++)
+			runFrame();
+	}
+
+	std::vector<unsigned long long> cpuTimes;
+	unsigned long long totalCpu = 0, totalDrawCalls = 0, totalUploads = 0, totalUploadBytes = 0, totalAllocations = 0;
+	unsigned int maxDrawCalls = 0;
+	unsigned long long maxAllocations = 0;
+
+	for (auto& frame : frames)
+	{
+		cpuTimes.push_back(frame.cpuTime);
+		totalCpu += frame.cpuTime;
+		totalDrawCalls += frame.drawCalls;
+		totalUploads += frame.textureUploads;
+		totalUploadBytes += frame.textureUploadBytes;
+		totalAllocations += frame.allocations;
+		maxDrawCalls = std::max(maxDrawCalls, frame.drawCalls);
+		maxAllocations = std::max(maxAllocations, frame.allocations);
+	}
+
+	size_t count = std::max((size_t)1, frames.size());
+
+	std::stringstream ss;
+	ss << "{\n";
+	ss << "  \"scenario\": \"" << sScenario << "\",\n";
+	ss << "  \"renderer\": \"" << Renderer::getDriverName() << "\",\n";
+	ss << "  \"frameCount\": " << frames.size() << ",\n";
+	ss << "  \"summary\": {\n";
+	ss << "    \"cpuTimeUs\": { \"avg\": " << (totalCpu / count) << ", \"p50\": " << percentile(cpuTimes, 0.50) << ", \"p95\": " << percentile(cpuTimes, 0.95) << ", \"p99\": " << percentile(cpuTimes, 0.99) << ", \"max\": " << percentile(cpuTimes, 1.0) << " },\n";
+	ss << "    \"drawCalls\": { \"avg\": " << (totalDrawCalls / count) << ", \"max\": " << maxDrawCalls << " },\n";
+	ss << "    \"textureUploads\": " << totalUploads << ",\n";
+	ss << "    \"textureUploadBytes\": " << totalUploadBytes << ",\n";
+	ss << "    \"allocations\": { \"avg\": " << (totalAllocations / count) << ", \"max\": " << maxAllocations << ", \"total\": " << totalAllocations << " },\n";
+	ss << "    \"fontDistanceField\": " << (Settings::getInstance()->getBool("FontDistanceField") ? "true" : "false") << ",\n";
+	ss << "    \"fontMemoryBytes\": " << Font::getTotalMemoryUsage() << ",\n";
+	ss << "    \"textLayoutCache\": { \"hits\": " << Font::getLayoutCacheHits() << ", \"misses\": " << Font::getLayoutCacheMisses() << " }\n";
+	ss << "  },\n";
+	ss << "  \"frames\": [\n";
+
+	for (size_t i = 0; i < frames.size(); i++)
+	{
+		auto& frame = frames[i];
+		ss << "    { \"cpuTimeUs\": " << frame.cpuTime << ", \"drawCalls\": " << frame.drawCalls << ", \"vertices\": " << frame.vertices
+			<< ", \"textureUploads\": " << frame.textureUploads << ", \"textureUploadBytes\": " << frame.textureUploadBytes
+			<< ", \"allocations\": " << frame.allocations << " }" << (i + 1 < frames.size() ? "," : "") << "\n";
+	}
+
+	ss << "  ]\n}\n";
+
+	return writeReport(ss.str(), sOutputPath);
+}
@@ -0,0 +1,56 @@
+#pragma once
+#ifndef ES_APP_BENCHMARK_H
+#define ES_APP_BENCHMARK_H
+
+#include <string>
+
+class Window;
+
+// Headless benchmark : emulationstation --benchmark <scenario> [--benchmark-output <file>]
+// Only built with the ENABLE_BENCHMARK cmake option.
+// Runs with the NULL renderer on a synthetic library & theme, replays scripted input and reports per-frame
+// CPU time, draw calls, texture uploads & allocations as JSON.
+// Scenarios : gamelist, grid, textlist, systems, menus, all, archives, memory100k, memory250k, search, arcade40k, folders, savestates, cheevoshashes, videothumbs, videoframes, videostart, gamelistparse, gamelistwrites
+// textlist scrolls a single 5000 entries text list ( text layout & caching cost ).
+// archives hashes a corpus of 7z archives in-process. The corpus is created with the 7z executable, the scenario is skipped without it.
+// memory100k & memory250k load that many scraped entries and report the resident memory they take.
+// search types a search on 50000 names and reports the filtering time per keystroke.
+// arcade40k applies the arcade filters & rebuilds the arcade auto collections of 40000 real rom names, before & after a metadata change.
+// folders lists every folder of a 5 levels deep tree with a text filter set.
+// savestates indexes 20000 save states & screenshots of 2000 games.
+// cheevoshashes refreshes the RetroAchievements hash database from a local stand-in server : full, unchanged & delta runs, and lookups.
+// videothumbs extracts the thumbnails of 48 videos from 4 threads, cold then from the index.
+// videoframes plays 3 videos into textures at 60 fps, and reports the render thread time.
+// videostart moves a cursor over videos, without then with the preloading of the current entry & its neighbours, and reports the time to first frame.
+// gamelistparse parses a gamelist of 100k scraped entries with the streaming reader & with a pugixml document, and reports entries per second & peak memory.
+// gamelistwrites replays an hour of play sessions, scraping & hashing, and reports the time the saving thread is stalled & the bytes written.
+class Benchmark
+{
+public:
+	static bool isEnabled() { return !sScenario.empty(); }
+
+	static bool setScenario(const std::string& scenario);
+	static void setOutputPath(const std::string& path) { sOutputPath = path; }
+
+	// NULL by default. A real renderer needs a window : the frame stats are then empty, the renderer logs its own counters at exit
+	static void setRenderer(const std::string& renderer) { sRenderer = renderer; }
+
+	// Synthetic home folder, must be set before Settings is loaded
+	static std::string getHomePath();
+
+	// Headless SDL drivers. Must be called before SDL is initialized
+	static void setupEnvironment();
+
+	// Creates the synthetic library & theme, and forces settings. Must be called once the home folder exists
+	static bool prepare();
+
+	// Replays the scenario & writes the report. Returns the process exit code
+	static int run(Window* window);
+
+private:
+	static std::string sScenario;
+	static std::string sOutputPath;
+	static std::string sRenderer;
+};
+
+#endif // ES_APP_BENCHMARK_H
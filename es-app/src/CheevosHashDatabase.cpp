@@ -0,0 +1,413 @@
+#include "CheevosHashDatabase.h"
+#include "RetroAchievements.h"
+#include "HttpReq.h"
+#include "Paths.h"
+#include "Log.h"
+#include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+
+#include <rapidjson/document.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#define CHEEVOS_HASH_DATABASE_MAGIC		0x44484345 // ECHD
+#define CHEEVOS_HASH_DATABASE_VERSION	1
+#define CHEEVOS_HASH_BUCKETS			65536
+#define OFFICIAL_GAME					0x80000000
+
+CheevosHashDatabase* CheevosHashDatabase::sInstance = nullptr;
+std::string CheevosHashDatabase::sServerUrl = "https://retroachievements.org";
+
+static std::mutex sInstanceLock;
+
+CheevosHashDatabase* CheevosHashDatabase::getInstance()
+{
+	std::unique_lock<std::mutex> lock(sInstanceLock);
+
+	if (sInstance == nullptr)
+		sInstance = new CheevosHashDatabase();
+
+	return sInstance;
+}
+
+CheevosHashDatabase::CheevosHashDatabase() : mLoaded(false)
+{
+
+}
+
+void CheevosHashDatabase::setServerUrl(const std::string& url)
+{
+	sServerUrl = url;
+}
+
+std::string CheevosHashDatabase::getDatabasePath()
+{
+	return Paths::getUserEmulationStationPath() + "/cheevos/hashes.db";
+}
+
+static int hexValue(char c)
+{
+	if (c >= '0' && c <= '9') return c - '0';
+	if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+	return -1;
+}
+
+bool CheevosHashDatabase::parseMd5(const std::string& hex, uint8_t* md5)
+{
+	if (hex.size() != 32)
+		return false;
+
+	for (int i = 0; i < 16; i++)
+	{
+		int hi = hexValue(hex[i * 2]);
+		int lo = hexValue(hex[i * 2 + 1]);
+		if (hi < 0 || lo < 0)
+			return false;
+
+		md5[i] = (uint8_t)((hi << 4) | lo);
+	}
+
+	return true;
+}
+
+void CheevosHashDatabase::ensureLoaded()
+{
+	if (mLoaded)
+		return;
+
+	mLoaded = true;
+	mTable = load();
+}
+
+int CheevosHashDatabase::getGameId(const std::string& md5)
+{
+	uint8_t key[16];
+	if (!parseMd5(md5, key))
+		return 0;
+
+	std::unique_lock<std::mutex> lock(mLock);
+	ensureLoaded();
+
+	if (mTable == nullptr)
+		return 0;
+
+	const Table& table = *mTable;
+
+	int bucket = (key[0] << 8) | key[1];
+	for (uint32_t i = table.buckets[bucket]; i < table.buckets[bucket + 1]; i++)
+	{
+		const Record& record = table.records[i];
+		if (memcmp(record.md5, key, sizeof(key)) == 0)
+			return (record.gameId & OFFICIAL_GAME) ? (int)(record.gameId & ~OFFICIAL_GAME) : 0;
+	}
+
+	return 0;
+}
+
+size_t CheevosHashDatabase::size()
+{
+	std::unique_lock<std::mutex> lock(mLock);
+	ensureLoaded();
+
+	return mTable == nullptr ? 0 : mTable->officialCount;
+}
+
+void CheevosHashDatabase::unload()
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	mTable = nullptr;
+	mLoaded = false;
+}
+
+// Sorts the records, flags the official ones & computes the buckets
+void CheevosHashDatabase::index(Table& table)
+{
+	std::sort(table.records.begin(), table.records.end(), [](const Record& a, const Record& b) { return memcmp(a.md5, b.md5, sizeof(a.md5)) < 0; });
+
+	table.officialCount = 0;
+	table.buckets.assign(CHEEVOS_HASH_BUCKETS + 1, 0);
+
+	for (auto& record : table.records)
+	{
+		uint32_t gameId = record.gameId & ~OFFICIAL_GAME;
+
+		if (std::binary_search(table.officialIds.cbegin(), table.officialIds.cend(), gameId))
+		{
+			record.gameId = gameId | OFFICIAL_GAME;
+			table.officialCount++;
+		}
+		else
+			record.gameId = gameId;
+
+		table.buckets[((record.md5[0] << 8) | record.md5[1]) + 1]++;
+	}
+
+	for (int i = 0; i < CHEEVOS_HASH_BUCKETS; i++)
+		table.buckets[i + 1] += table.buckets[i];
+}
+
+static void writeUInt(std::ofstream& file, uint32_t value)
+{
+	file.write((const char*)&value, sizeof(value));
+}
+
+static void writeString(std::ofstream& file, const std::string& value)
+{
+	writeUInt(file, (uint32_t)value.size());
+	file.write(value.c_str(), value.size());
+}
+
+static uint32_t readUInt(std::ifstream& file)
+{
+	uint32_t value = 0;
+	file.read((char*)&value, sizeof(value));
+	return value;
+}
+
+static std::string readString(std::ifstream& file)
+{
+	uint32_t size = readUInt(file);
+	if (!file || size > 4096)
+	{
+		file.setstate(std::ios::failbit);
+		return "";
+	}
+
+	std::string value(size, '\0');
+	file.read(&value[0], size);
+	return value;
+}
+
+// Header, validators, then the buckets, records & official ids arrays as they are in memory
+bool CheevosHashDatabase::save(const Table& table)
+{
+	std::string path = getDatabasePath();
+	std::string tmpPath = path + ".tmp";
+
+	Utils::FileSystem::createDirectory(Utils::FileSystem::getParent(path));
+
+	std::ofstream file(WINSTRINGW(tmpPath), std::ios::binary);
+	if (!file.is_open())
+		return false;
+
+	writeUInt(file, CHEEVOS_HASH_DATABASE_MAGIC);
+	writeUInt(file, CHEEVOS_HASH_DATABASE_VERSION);
+	writeUInt(file, (uint32_t)table.records.size());
+	writeUInt(file, (uint32_t)table.officialIds.size());
+
+	writeString(file, table.hashLibrary.etag);
+	writeString(file, table.hashLibrary.lastModified);
+	writeString(file, table.officialGames.etag);
+	writeString(file, table.officialGames.lastModified);
+
+	file.write((const char*)table.buckets.data(), table.buckets.size() * sizeof(uint32_t));
+	file.write((const char*)table.records.data(), table.records.size() * sizeof(Record));
+	file.write((const char*)table.officialIds.data(), table.officialIds.size() * sizeof(uint32_t));
+	file.close();
+
+	if (file.fail())
+	{
+		Utils::FileSystem::removeFile(tmpPath);
+		return false;
+	}
+
+	Utils::FileSystem::removeFile(path);
+	return Utils::FileSystem::renameFile(tmpPath, path);
+}
+
+std::shared_ptr<CheevosHashDatabase::Table> CheevosHashDatabase::load()
+{
+	std::string path = getDatabasePath();
+	if (!Utils::FileSystem::exists(path))
+		return nullptr;
+
+	std::ifstream file(WINSTRINGW(path), std::ios::binary);
+	if (!file.is_open())
+		return nullptr;
+
+	if (readUInt(file) != CHEEVOS_HASH_DATABASE_MAGIC || readUInt(file) != CHEEVOS_HASH_DATABASE_VERSION)
+	{
+		LOG(LogWarning) << "CheevosHashDatabase : ignoring " << path << ", unknown format";
+		return nullptr;
+	}
+
+	auto table = std::make_shared<Table>();
+
+	uint32_t recordCount = readUInt(file);
+	uint32_t officialIdCount = readUInt(file);
+
+	table->hashLibrary.etag = readString(file);
+	table->hashLibrary.lastModified = readString(file);
+	table->officialGames.etag = readString(file);
+	table->officialGames.lastModified = readString(file);
+
+	if (!file || recordCount > (1 << 26) || officialIdCount > (1 << 26))
+	{
+		LOG(LogWarning) << "CheevosHashDatabase : " << path << " is damaged";
+		return nullptr;
+	}
+
+	table->buckets.resize(CHEEVOS_HASH_BUCKETS + 1);
+	table->records.resize(recordCount);
+	table->officialIds.resize(officialIdCount);
+
+	file.read((char*)table->buckets.data(), table->buckets.size() * sizeof(uint32_t));
+	file.read((char*)table->records.data(), table->records.size() * sizeof(Record));
+	file.read((char*)table->officialIds.data(), table->officialIds.size() * sizeof(uint32_t));
+
+	bool valid = file && table->buckets.back() == recordCount;
+	for (int i = 0; valid && i < CHEEVOS_HASH_BUCKETS; i++)
+		valid = table->buckets[i] <= table->buckets[i + 1];
+
+	if (!valid)
+	{
+		LOG(LogWarning) << "CheevosHashDatabase : " << path << " is damaged";
+		return nullptr;
+	}
+
+	table->officialCount = std::count_if(table->records.cbegin(), table->records.cend(), [](const Record& r) { return (r.gameId & OFFICIAL_GAME) != 0; });
+
+	LOG(LogDebug) << "CheevosHashDatabase : loaded " << table->officialCount << " hashes";
+	return table;
+}
+
+static void addConditionalHeaders(HttpReqOptions& options, const std::string& etag, const std::string& lastModified)
+{
+	if (!etag.empty())
+		options.customHeaders.push_back("If-None-Match: " + etag);
+
+	if (!lastModified.empty())
+		options.customHeaders.push_back("If-Modified-Since: " + lastModified);
+}
+
+bool CheevosHashDatabase::refresh()
+{
+	std::unique_lock<std::mutex> refreshLock(mRefreshLock);
+
+	std::shared_ptr<Table> current;
+
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+		ensureLoaded();
+		current = mTable;
+	}
+
+	auto officialOptions = RetroAchievements::getHttpOptions();
+	auto hashOptions = RetroAchievements::getHttpOptions();
+
+	if (current != nullptr)
+	{
+		addConditionalHeaders(officialOptions, current->officialGames.etag, current->officialGames.lastModified);
+		addConditionalHeaders(hashOptions, current->hashLibrary.etag, current->hashLibrary.lastModified);
+	}
+
+	HttpReq officialGamesList(sServerUrl + "/dorequest.php?r=officialgameslist", &officialOptions);
+	HttpReq hashLibrary(sServerUrl + "/dorequest.php?r=hashlibrary", &hashOptions);
+
+	auto table = std::make_shared<Table>();
+	bool officialChanged = false;
+	bool hashesChanged = false;
+
+	// Official games
+	if (officialGamesList.wait())
+	{
+		rapidjson::Document doc;
+		doc.Parse(officialGamesList.getContent().c_str());
+		if (doc.HasParseError() || !doc.HasMember("Response"))
+		{
+			LOG(LogError) << "CheevosHashDatabase : invalid official games list";
+			return false;
+		}
+
+		const rapidjson::Value& response = doc["Response"];
+		for (auto it = response.MemberBegin(); it != response.MemberEnd(); ++it)
+			table->officialIds.push_back((uint32_t)Utils::String::toInteger(it->name.GetString()));
+
+		std::sort(table->officialIds.begin(), table->officialIds.end());
+		table->officialGames.etag = officialGamesList.getResponseHeader("ETag");
+		table->officialGames.lastModified = officialGamesList.getResponseHeader("Last-Modified");
+		officialChanged = true;
+	}
+	else if (officialGamesList.status() != HttpReq::REQ_304_NOTMODIFIED)
+	{
+		std::string error = "Error while accessing retroachievements official games list :\n" + officialGamesList.getErrorMsg();
+		if (current == nullptr)
+			throw std::domain_error(error);
+
+		LOG(LogWarning) << "CheevosHashDatabase : " << error;
+		return false;
+	}
+
+	// Hash library
+	if (hashLibrary.wait())
+	{
+		rapidjson::Document doc;
+		doc.Parse(hashLibrary.getContent().c_str());
+		if (doc.HasParseError() || !doc.HasMember("MD5List"))
+		{
+			LOG(LogError) << "CheevosHashDatabase : invalid hash library";
+			return false;
+		}
+
+		const rapidjson::Value& mdlist = doc["MD5List"];
+		for (auto it = mdlist.MemberBegin(); it != mdlist.MemberEnd(); ++it)
+		{
+			if (!it->value.IsInt() || it->value.GetInt() <= 0)
+				continue;
+
+			Record record;
+			if (!parseMd5(it->name.GetString(), record.md5))
+				continue;
+
+			record.gameId = (uint32_t)it->value.GetInt();
+			table->records.push_back(record);
+		}
+
+		table->hashLibrary.etag = hashLibrary.getResponseHeader("ETag");
+		table->hashLibrary.lastModified = hashLibrary.getResponseHeader("Last-Modified");
+		hashesChanged = true;
+	}
+	else if (hashLibrary.status() != HttpReq::REQ_304_NOTMODIFIED)
+	{
+		std::string error = "Error while accessing retroachievements hashlibrary :\n" + hashLibrary.getErrorMsg();
+		if (current == nullptr)
+			throw std::domain_error(error);
+
+		LOG(LogWarning) << "CheevosHashDatabase : " << error;
+		return false;
+	}
+
+	if (!officialChanged && !hashesChanged)
+	{
+		LOG(LogDebug) << "CheevosHashDatabase : hashes are up to date";
+		return true;
+	}
+
+	// Keep the side the server reported as unchanged
+	if (!officialChanged)
+	{
+		table->officialIds = current->officialIds;
+		table->officialGames = current->officialGames;
+	}
+
+	if (!hashesChanged)
+	{
+		table->records = current->records;
+		table->hashLibrary = current->hashLibrary;
+	}
+
+	index(*table);
+
+	if (!save(*table))
+		LOG(LogWarning) << "CheevosHashDatabase : unable to write " << getDatabasePath();
+
+	LOG(LogInfo) << "CheevosHashDatabase : " << table->officialCount << " hashes" << (officialChanged ? ", official games updated" : "") << (hashesChanged ? ", hash library updated" : "");
+
+	std::unique_lock<std::mutex> lock(mLock);
+	mTable = table;
+	return true;
+}
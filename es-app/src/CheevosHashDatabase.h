@@ -0,0 +1,78 @@
+#pragma once
+#ifndef ES_APP_CHEEVOS_HASH_DATABASE_H
+#define ES_APP_CHEEVOS_HASH_DATABASE_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+
+// RetroAchievements md5 -> game id table, from the hashlibrary & officialgameslist requests.
+// Stored in <es>/cheevos/hashes.db with the ETag / Last-Modified of each request : refresh() sends conditional requests,
+// and only parses what the server reports as changed. Lookups search one bucket of a sorted array ( 65536 buckets on the first two md5 bytes ).
+// The file layout is the in-memory layout, so loading is a few block reads.
+class CheevosHashDatabase
+{
+public:
+	static CheevosHashDatabase* getInstance();
+
+	// Game id of an md5 ( hex, any case ), 0 when the md5 is unknown or the game isn't official. Loads the file on first call
+	int getGameId(const std::string& md5);
+
+	// Number of official hashes
+	size_t size();
+
+	// Downloads the changes. Throws when the server can't be reached and there is no local copy, as getCheevosHashes did
+	bool refresh();
+
+	// Forgets the loaded table, the next access reads the file again
+	void unload();
+
+	// https://retroachievements.org by default, a local server can stand in
+	static void setServerUrl(const std::string& url);
+	static std::string getDatabasePath();
+
+private:
+	struct Record
+	{
+		uint8_t		md5[16];
+		uint32_t	gameId; // OFFICIAL_GAME flag + id
+	};
+
+	struct Source
+	{
+		std::string etag;
+		std::string lastModified;
+	};
+
+	struct Table
+	{
+		Source hashLibrary;
+		Source officialGames;
+
+		std::vector<Record>		records;		// sorted by md5
+		std::vector<uint32_t>	buckets;		// first record of each bucket, + end
+		std::vector<uint32_t>	officialIds;	// sorted
+		size_t					officialCount;
+	};
+
+	CheevosHashDatabase();
+
+	void ensureLoaded();
+	std::shared_ptr<Table> load();
+	bool save(const Table& table);
+
+	static void index(Table& table);
+	static bool parseMd5(const std::string& hex, uint8_t* md5);
+
+	static CheevosHashDatabase* sInstance;
+	static std::string sServerUrl;
+
+	std::mutex mLock;			// table access
+	std::mutex mRefreshLock;	// one refresh at a time
+	bool mLoaded;
+	std::shared_ptr<Table> mTable;
+};
+
+#endif // ES_APP_CHEEVOS_HASH_DATABASE_H
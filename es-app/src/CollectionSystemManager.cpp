@@ -3,6 +3,7 @@
 #include "guis/GuiInfoPopup.h"
 #include "utils/FileSystemUtil.h"
 #include "utils/StringUtil.h"
+#include "Tracing.h"
 #include "views/gamelist/IGameListView.h"
 #include "views/ViewController.h"
 #include "FileData.h"
@@ -975,6 +976,8 @@ SystemData* CollectionSystemManager::createNewCollectionEntry(const std::string&
 // populates an Automatic Collection System
 void CollectionSystemManager::populateAutoCollection(CollectionSystemData* sysData)
 {
+	TRACE_ZONE("CollectionSystemManager::populateAutoCollection");
+
 	SystemData* newSys = sysData->system;
 	CollectionSystemDecl sysDecl = sysData->decl;
 	FolderData* rootFolder = newSys->getRootFolder();
@@ -997,7 +1000,7 @@ void CollectionSystemManager::populateAutoCollection(CollectionSystemData* sysDa
 		bool isArcade = system->hasPlatformId(PlatformIds::ARCADE);
 
 		std::vector<std::string> hiddenExts;
-		for (auto ext : Utils::String::split(Settings::getInstance()->getString(system->getName() + ".HiddenExt"), ';'))
+		for (auto ext : Utils::String::split(system->getHiddenExtensions(), ';'))
 			hiddenExts.push_back("." + Utils::String::toLower(ext));
 
 		std::vector<FileData*> files = system->getRootFolder()->getFilesRecursive(GAME);
@@ -20,6 +20,8 @@
 #include "InputManager.h"
 #include "scrapers/ThreadedScraper.h"
 #include "Gamelist.h" 
+#include "GamelistWriter.h"
+#include "GamelistMaintenance.h"
 #include "ApiSystem.h"
 #include <time.h>
 #include <algorithm>
@@ -35,6 +37,7 @@
 #include "resources/TextureData.h"
 #include "views/gamelist/GameNameFormatter.h"
 #include "watchers/WatchersManager.h"
+#include "Tracing.h"
 
 using namespace Utils::Platform;
 
@@ -67,7 +70,7 @@ static std::map<std::string, std::function<BindableProperty(FileData*)>> propert
 FileData* FileData::mRunningGame = nullptr;
 
 FileData::FileData(FileType type, const std::string& path, SystemData* system)
-	: mPath(path), mType(type), mSystem(system), mParent(nullptr), mDisplayName(nullptr), mMetadata(type == GAME ? GAME_METADATA : FOLDER_METADATA) // metadata is REALLY set in the constructor!
+	: mPath(path), mType(type), mSystem(system), mParent(nullptr), mDisplayName(nullptr), mMetadata(type == GAME ? GAME_METADATA : FOLDER_METADATA), mFlags(0), mFlagsRevision(0) // metadata is REALLY set in the constructor!
 {
 	// metadata needs at least a name field (since that's what getName() will return)
 	if (mMetadata.get(MetaDataId::Name).empty() && !mPath.empty())
@@ -165,9 +168,11 @@ std::string FileData::getCleanName()
 	return Utils::String::removeParenthesis(getDisplayName());
 }
 
+static SettingHandle<bool> sLocalArt("LocalArt");
+
 std::string FileData::findLocalArt(const std::string& type, std::vector<std::string> exts)
 {
-	if (Settings::getInstance()->getBool("LocalArt"))
+	if (sLocalArt.get())
 	{
 		for (auto ext : exts)
 		{
@@ -250,21 +255,48 @@ const bool FileData::getKidGame() const
 	return data != "false" && !data.empty();
 }
 
+void FileData::checkMetadataFlags()
+{
+	unsigned int revision = getMetadata().getRevision();
+	if (mFlagsRevision == revision)
+		return;
+
+	mFlags &= ~(FLAG_CHEEVOS_COMPUTED | FLAG_CHEEVOS | FLAG_MEDIA_COMPUTED | FLAG_MEDIA);
+	mFlagsRevision = revision;
+}
+
 const bool FileData::hasCheevos()
 {
-	if (Utils::String::toInteger(getMetadata(MetaDataId::CheevosId)) > 0)
-		return getSourceFileData()->getSystem()->isCheevosSupported();
+	checkMetadataFlags();
 
-	return false;
+	if ((mFlags & FLAG_CHEEVOS_COMPUTED) == 0)
+	{
+		if (Utils::String::toInteger(getMetadata(MetaDataId::CheevosId)) > 0 && getSourceFileData()->getSystem()->isCheevosSupported())
+			mFlags |= FLAG_CHEEVOS;
+
+		mFlags |= FLAG_CHEEVOS_COMPUTED;
+	}
+
+	return (mFlags & FLAG_CHEEVOS) != 0;
 }
 
 bool FileData::hasAnyMedia()
 {
+	checkMetadataFlags();
+
+	if ((mFlags & FLAG_MEDIA_COMPUTED) != 0)
+		return (mFlags & FLAG_MEDIA) != 0;
+
+	bool hasMedia = false;
+
 	if (Utils::FileSystem::exists(getImagePath()) || Utils::FileSystem::exists(getThumbnailPath(false)) || Utils::FileSystem::exists(getVideoPath()))
-		return true;
+		hasMedia = true;
 
 	for (auto mdd : mMetadata.getMDD())
 	{
+		if (hasMedia)
+			break;
+
 		if (mdd.type != MetaDataType::MD_PATH)
 			continue;
 
@@ -275,7 +307,7 @@ bool FileData::hasAnyMedia()
 		if (mdd.id == MetaDataId::Manual || mdd.id == MetaDataId::Magazine)
 		{
 			if (Utils::FileSystem::exists(path))
-				return true;
+				hasMedia = true;
 		}
 		else if (mdd.id != MetaDataId::Image && mdd.id != MetaDataId::Thumbnail)
 		{
@@ -283,11 +315,12 @@ bool FileData::hasAnyMedia()
 				continue;
 
 			if (Utils::FileSystem::exists(path))
-				return true;
+				hasMedia = true;
 		}
 	}
 
-	return false;
+	mFlags |= FLAG_MEDIA_COMPUTED | (hasMedia ? FLAG_MEDIA : 0);
+	return hasMedia;
 }
 
 std::vector<std::string> FileData::getFileMedias()
@@ -419,46 +452,76 @@ std::string FileData::getKey()
 	return getFileName();
 }
 
-const bool FileData::isArcadeAsset()
+// All the MameNames lookups are done at once, the first time one of them is needed
+unsigned short FileData::getNameFlags()
 {
-	if (mSystem && (mSystem->hasPlatformId(PlatformIds::ARCADE) || mSystem->hasPlatformId(PlatformIds::NEOGEO)))
-	{	
+	if ((mFlags & FLAGS_NAME_COMPUTED) != 0)
+		return mFlags;
+
+	unsigned short flags = FLAGS_NAME_COMPUTED;
+
+	if (mSystem != nullptr)
+	{
 		const std::string stem = Utils::FileSystem::getStem(getPath());
-		return MameNames::getInstance()->isBiosOrDevice(stem);		
+		const std::string& systemName = mSystem->getName();
+		const bool isArcade = mSystem->hasPlatformId(PlatformIds::ARCADE);
+
+		MameNames* mameNames = MameNames::getInstance();
+
+		if ((isArcade || mSystem->hasPlatformId(PlatformIds::NEOGEO)) && mameNames->isBiosOrDevice(stem))
+			flags |= FLAG_ARCADE_ASSET;
+
+		if (isArcade && mameNames->isVertical(stem))
+			flags |= FLAG_VERTICAL;
+
+		if (mameNames->isLightgun(stem, systemName, isArcade))
+			flags |= FLAG_LIGHTGUN;
+
+		if (mameNames->isWheel(stem, systemName, isArcade))
+			flags |= FLAG_WHEEL;
+
+		if (mameNames->isTrackball(stem, systemName, isArcade))
+			flags |= FLAG_TRACKBALL;
+
+		if (mameNames->isSpinner(stem, systemName, isArcade))
+			flags |= FLAG_SPINNER;
 	}
 
-	return false;
+	mFlags |= flags;
+	return mFlags;
 }
 
-const bool FileData::isVerticalArcadeGame()
+const bool FileData::isArcadeAsset()
 {
-	if (mSystem && mSystem->hasPlatformId(PlatformIds::ARCADE))
-		return MameNames::getInstance()->isVertical(Utils::FileSystem::getStem(getPath()));
+	return (getNameFlags() & FLAG_ARCADE_ASSET) != 0;
+}
 
-	return false;
+const bool FileData::isVerticalArcadeGame()
+{
+	return (getNameFlags() & FLAG_VERTICAL) != 0;
 }
 
 const bool FileData::isLightGunGame()
 {
-	return MameNames::getInstance()->isLightgun(Utils::FileSystem::getStem(getPath()), mSystem->getName(), mSystem && mSystem->hasPlatformId(PlatformIds::ARCADE));
+	return (getNameFlags() & FLAG_LIGHTGUN) != 0;
 	//return Genres::genreExists(&getMetadata(), GENRE_LIGHTGUN);
 }
 
 const bool FileData::isWheelGame()
 {
-	return MameNames::getInstance()->isWheel(Utils::FileSystem::getStem(getPath()), mSystem->getName(), mSystem && mSystem->hasPlatformId(PlatformIds::ARCADE));
+	return (getNameFlags() & FLAG_WHEEL) != 0;
 	//return Genres::genreExists(&getMetadata(), GENRE_WHEEL);
 }
 
 const bool FileData::isTrackballGame()
 {
-	return MameNames::getInstance()->isTrackball(Utils::FileSystem::getStem(getPath()), mSystem->getName(), mSystem && mSystem->hasPlatformId(PlatformIds::ARCADE));
+	return (getNameFlags() & FLAG_TRACKBALL) != 0;
 	//return Genres::genreExists(&getMetadata(), GENRE_TRACKBALL);
 }
 
 const bool FileData::isSpinnerGame()
 {
-	return MameNames::getInstance()->isSpinner(Utils::FileSystem::getStem(getPath()), mSystem->getName(), mSystem && mSystem->hasPlatformId(PlatformIds::ARCADE));
+	return (getNameFlags() & FLAG_SPINNER) != 0;
 	//return Genres::genreExists(&getMetadata(), GENRE_SPINNER);
 }
 
@@ -726,6 +789,10 @@ bool FileData::launchGame(Window* window, LaunchGameOptions options)
 	// Pause watchers before game launch
 	WatchersManager::pause();
 
+	// The recovery files still pending are written before the game runs, the maintenance leaves the storage to it
+	GamelistWriter::getInstance()->flush();
+	GamelistMaintenance::pause();
+
 	ProcessStartInfo process(command);
 	process.window = hideWindow ? NULL : window;
 	
@@ -733,6 +800,7 @@ bool FileData::launchGame(Window* window, LaunchGameOptions options)
 	
 	// Resume watchers when returning to ES
 	WatchersManager::resume();
+	GamelistMaintenance::resume();
 	
 	if (exitCode != 0)
 		LOG(LogWarning) << "...launch terminated with nonzero exit code " << exitCode << "!";
@@ -1029,15 +1097,13 @@ const std::string& CollectionFileData::getName()
 
 const std::vector<FileData*> FolderData::getChildrenListToDisplay() 
 {
+	TRACE_ZONE("FolderData::getChildrenListToDisplay");
+
 	std::vector<FileData*> ret;
 
 	std::string showFoldersMode = getSystem()->getFolderViewMode();
 	
-	bool showHiddenFiles = Settings::ShowHiddenFiles();
-
-	auto shv = Settings::getInstance()->getString(getSystem()->getName() + ".ShowHiddenFiles");
-	if (shv == "1") showHiddenFiles = true;
-	else if (shv == "0") showHiddenFiles = false;
+	bool showHiddenFiles = getSystem()->getShowHiddenFiles(Settings::ShowHiddenFiles());
 
 	bool filterKidGame = false;
 
@@ -1054,7 +1120,7 @@ const std::vector<FileData*> FolderData::getChildrenListToDisplay()
 
 	std::vector<std::string> hiddenExts;
 	if (mSystem->isGameSystem() && !mSystem->isCollection())
-		hiddenExts = Utils::String::split(Utils::String::toLower(Settings::getInstance()->getString(mSystem->getName() + ".HiddenExt")), ';');
+		hiddenExts = Utils::String::split(Utils::String::toLower(mSystem->getHiddenExtensions()), ';');
 
 	FileFilterIndex* idx = sys->getIndex(false);
 	if (idx != nullptr && !idx->isFiltered())
@@ -1210,11 +1276,7 @@ FileData* FolderData::findUniqueGameForFolder()
 	{
 		if (game->getHidden())
 		{
-			bool showHiddenFiles = Settings::ShowHiddenFiles() && !UIModeController::getInstance()->isUIModeKiosk();
-
-			auto shv = Settings::getInstance()->getString(getSystem()->getName() + ".ShowHiddenFiles");
-			if (shv == "1") showHiddenFiles = true;
-			else if (shv == "0") showHiddenFiles = false;
+			bool showHiddenFiles = getSystem()->getShowHiddenFiles(Settings::ShowHiddenFiles() && !UIModeController::getInstance()->isUIModeKiosk());
 
 			if (!showHiddenFiles)
 				continue;
@@ -1311,17 +1373,11 @@ std::vector<FileData*> FolderData::getFilesRecursive(unsigned int typeMask, bool
 	SystemData* pSystem = (system != nullptr ? system : mSystem);
 	
 	GetFileContext ctx;
-	ctx.showHiddenFiles = Settings::ShowHiddenFiles() && !UIModeController::getInstance()->isUIModeKiosk();
-
-	auto shv = Settings::getInstance()->getString(getSystem()->getName() + ".ShowHiddenFiles");
-	if (shv == "1")
-		ctx.showHiddenFiles = true;
-	else if (shv == "0")
-		ctx.showHiddenFiles = false;
+	ctx.showHiddenFiles = getSystem()->getShowHiddenFiles(Settings::ShowHiddenFiles() && !UIModeController::getInstance()->isUIModeKiosk());
 
 	if (pSystem->isGameSystem() && !pSystem->isCollection())
 	{
-		for (auto ext : Utils::String::split(Utils::String::toLower(Settings::getInstance()->getString(pSystem->getName() + ".HiddenExt")), ';'))
+		for (auto ext : Utils::String::split(Utils::String::toLower(pSystem->getHiddenExtensions()), ';'))
 			if (ctx.hiddenExtensions.find(ext) == ctx.hiddenExtensions.cend())
 				ctx.hiddenExtensions.insert(ext);
 	}
@@ -1343,6 +1399,8 @@ void FolderData::addChild(FileData* file, bool assignParent)
 
 	if (assignParent)
 		file->setParent(this);	
+
+	resetVisibleGamesCount();
 }
 
 void FolderData::removeChild(FileData* file)
@@ -1358,6 +1416,8 @@ void FolderData::removeChild(FileData* file)
 		file->setParent(nullptr);
 		std::iter_swap(it, mChildren.end() - 1);
 		mChildren.pop_back();
+
+		resetVisibleGamesCount();
 	}
 
 	// File somehow wasn't in our children.
@@ -1368,6 +1428,8 @@ void FolderData::removeChild(FileData* file)
 
 void FolderData::bulkRemoveChildren(std::vector<FileData*>& mChildren, const std::unordered_set<FileData*>& filesToRemove)
 {
+	resetVisibleGamesCount();
+
 	mChildren.erase(
 		std::remove_if(
 			mChildren.begin(),
@@ -1786,6 +1848,8 @@ FolderData::FolderData(const std::string& startpath, SystemData* system, bool ow
 {
 	mIsDisplayableAsVirtualFolder = false;
 	mOwnsChildrens = ownsChildrens;
+	mFilterGeneration = 0;
+	mVisibleGames = 0;
 }
 
 FolderData::~FolderData()
@@ -1801,6 +1865,30 @@ void FolderData::clear() {
 			delete child;
 		}
 	mChildren.clear();
+
+	resetVisibleGamesCount();
+}
+
+bool FolderData::getVisibleGamesCount(unsigned int generation, int& count) const
+{
+	if (mFilterGeneration != generation)
+		return false;
+
+	count = mVisibleGames;
+	return true;
+}
+
+void FolderData::setVisibleGamesCount(unsigned int generation, int count)
+{
+	mFilterGeneration = generation;
+	mVisibleGames = count;
+}
+
+// The count of the parents includes this folder
+void FolderData::resetVisibleGamesCount()
+{
+	for (FolderData* folder = this; folder != nullptr; folder = folder->getParent())
+		folder->mFilterGeneration = 0;
 }
 
 void FolderData::removeFromVirtualFolders(FileData* game)
@@ -1816,6 +1904,7 @@ void FolderData::removeFromVirtualFolders(FileData* game)
 		if ((*it) == game)
 		{
 			mChildren.erase(it);
+			resetVisibleGamesCount();
 			return;
 		}
 	}
@@ -202,6 +202,29 @@ protected:
 	FileType mType;
 	SystemData* mSystem;
 	std::string* mDisplayName;
+
+private:
+	// Classification flags : computed once from the file name ( MameNames lookups ), or from the metadata they depend on
+	enum FileDataFlags : unsigned short
+	{
+		FLAGS_NAME_COMPUTED		= 1 << 0,
+		FLAG_ARCADE_ASSET		= 1 << 1,
+		FLAG_VERTICAL			= 1 << 2,
+		FLAG_LIGHTGUN			= 1 << 3,
+		FLAG_WHEEL				= 1 << 4,
+		FLAG_TRACKBALL			= 1 << 5,
+		FLAG_SPINNER			= 1 << 6,
+		FLAG_CHEEVOS_COMPUTED	= 1 << 7,
+		FLAG_CHEEVOS			= 1 << 8,
+		FLAG_MEDIA_COMPUTED		= 1 << 9,
+		FLAG_MEDIA				= 1 << 10
+	};
+
+	unsigned short	mFlags;
+	unsigned int	mFlagsRevision; // metadata revision FLAG_CHEEVOS & FLAG_MEDIA were computed from
+
+	unsigned short getNameFlags();
+	void checkMetadataFlags();
 };
 
 class CollectionFileData : public FileData
@@ -258,6 +281,11 @@ public:
 
 	FileData* findUniqueGameForFolder();
 
+	// Visible games below this folder, cached by FileFilterIndex::showFile for one filter generation
+	bool getVisibleGamesCount(unsigned int generation, int& count) const;
+	void setVisibleGamesCount(unsigned int generation, int count);
+	void resetVisibleGamesCount();
+
 	void clear();
 	void removeVirtualFolders();
 	void removeFromVirtualFolders(FileData* game);
@@ -269,6 +297,9 @@ private:
 	std::vector<FileData*> mChildren;
 	bool	mOwnsChildrens;
 	bool	mIsDisplayableAsVirtualFolder;
+
+	unsigned int mFilterGeneration;
+	int		mVisibleGames;
 };
 
 #endif // ES_APP_FILE_DATA_H
@@ -8,20 +8,23 @@
 #include "LocaleES.h"
 
 #include <pugixml/src/pugixml.hpp>
+#include <atomic>
 
 #include "SystemData.h"
 #include "FileData.h"
 #include "CollectionSystemManager.h"
 #include "Genres.h"
-#include "SystemConf.h"
 #include "FileTag.h"
 
 #define UNKNOWN_LABEL "UNKNOWN"
 #define INCLUDE_UNKNOWN false;
 
+// Shared by all the indexes, so a folder count cached by an index is never taken for the count of another one
+static std::atomic<unsigned int> sLastGeneration(0);
+
 FileFilterIndex::FileFilterIndex()
 	: filterByFavorites(false), filterByGenre(false), filterByKidGame(false), filterByPlayers(false), filterByPubDev(false), filterByRatings(false), filterByYear(false), filterByTag(false)
-	, filterByLightGun(false), filterByWheel(false), filterByTrackball(false), filterBySpinner(false), filterByVertical(false), filterByCheevos(false), filterByPlayed(false), filterByRegion(false), filterByLang(false), filterByFamily(false), filterByHasMedia(false), filterByMissingMedia(false)
+	, filterByLightGun(false), filterByWheel(false), filterByTrackball(false), filterBySpinner(false), filterByVertical(false), filterByCheevos(false), filterByPlayed(false), filterByRegion(false), filterByLang(false), filterByFamily(false), filterByHasMedia(false), filterByMissingMedia(false), mGeneration(0), mMetadataRevision(0)
 {
 	clearAllFilters();
 	FilterDataDecl filterDecls[] = 
@@ -61,6 +64,11 @@ FileFilterIndex::~FileFilterIndex()
 	resetIndex();
 }
 
+void FileFilterIndex::invalidate()
+{
+	mGeneration = ++sLastGeneration;
+}
+
 std::vector<FilterDataDecl> FileFilterIndex::getFilterDataDecls()
 {
 	std::vector<FilterDataDecl> ret;
@@ -94,6 +102,8 @@ void FileFilterIndex::copyFrom(FileFilterIndex* indexToImport)
 
 		*src->second.filteredByRef = *decl.second.filteredByRef;
 	}
+
+	invalidate();
 }
 
 void FileFilterIndex::importIndex(FileFilterIndex* indexToImport)
@@ -151,6 +161,8 @@ void FileFilterIndex::resetIndex()
 	mTextFilter = "";
 	clearAllFilters();
 
+	mSearchIndex.clear();
+
 	clearIndex(genreIndexAllKeys);
 	clearIndex(familyIndexAllKeys);
 	clearIndex(playersIndexAllKeys);
@@ -463,6 +475,12 @@ void FileFilterIndex::addToIndex(FileData* game)
 	manageYearEntryInIndex(game);
 	manageLangEntryInIndex(game);
 	manageRegionEntryInIndex(game);		
+
+	// The search index is only created by a first search
+	if (mSearchIndex.isPopulated())
+		mSearchIndex.add(game);
+
+	invalidate();
 }
 
 void FileFilterIndex::removeFromIndex(FileData* game)
@@ -474,6 +492,10 @@ void FileFilterIndex::removeFromIndex(FileData* game)
 	manageYearEntryInIndex(game, true);
 	manageLangEntryInIndex(game, true);
 	manageRegionEntryInIndex(game, true);	
+
+	mSearchIndex.remove(game);
+
+	invalidate();
 }
 
 void FileFilterIndex::setFilter(FilterIndexType type, std::vector<std::string>* values)
@@ -489,6 +511,8 @@ void FileFilterIndex::setFilter(FilterIndexType type, std::vector<std::string>*
 	if (it == mFilterDecl.cend())
 		return;
 	
+	invalidate();
+
 	FilterDataDecl& filterData = it->second;
 	*(filterData.filteredByRef) = values != nullptr && values->size() > 0;
 	filterData.currentFilteredKeys->clear();
@@ -526,7 +550,8 @@ void FileFilterIndex::clearAllFilters()
 		*(filterData.filteredByRef) = false;
 		filterData.currentFilteredKeys->clear();
 	}
-	return;
+
+	invalidate();
 }
 
 void FileFilterIndex::resetFilters()
@@ -552,6 +577,8 @@ void FileFilterIndex::setTextFilter(const std::string text, bool useRelevancy)
 { 
 	mTextFilter = text;
 	mUseRelevency = useRelevancy;
+
+	invalidate();
 }
 
 float jw_distance(std::string s1, std::string s2, bool caseSensitive = true) {
@@ -652,14 +679,38 @@ int FileFilterIndex::showFile(FileData* game)
 	// that should be shown
 	if (game->getType() == FOLDER) 
 	{
-		std::vector<FileData*> children = ((FolderData*)game)->getChildren();
-		// iterate through all of the children, until there's a match
+		FolderData* folder = (FolderData*)game;
+
+		// Metadata changed without going through removeFromIndex & addToIndex
+		unsigned int metadataRevision = MetaDataList::getGlobalRevision();
+		if (mMetadataRevision != metadataRevision)
+		{
+			mMetadataRevision = metadataRevision;
+			invalidate();
+		}
 
-		for (std::vector<FileData*>::const_iterator it = children.cbegin(); it != children.cend(); ++it )
-			if (showFile(*it))
-				return 1;
+		// Evaluated once per generation : the subfolders answer from their own cached count
+		int count;
+		if (!folder->getVisibleGamesCount(mGeneration, count))
+		{
+			count = 0;
 
-		return 0;
+			for (auto child : folder->getChildren())
+			{
+				if (!showFile(child))
+					continue;
+
+				int childCount = 1;
+				if (child->getType() == FOLDER)
+					((FolderData*)child)->getVisibleGamesCount(mGeneration, childCount);
+
+				count += childCount;
+			}
+
+			folder->setVisibleGamesCount(mGeneration, count);
+		}
+
+		return count > 0 ? 1 : 0;
 	}
 
 	bool keepGoing = false;
@@ -668,44 +719,15 @@ int FileFilterIndex::showFile(FileData* game)
 
 	if (!mTextFilter.empty())
 	{
-		auto name = game->getSourceFileData()->getName();
-		std::string language = SystemConf::getInstance()->get("system.language");
-		bool isChinese = (language == "zh_CN" || language == "zh_TW");
-
 		if (!mUseRelevency)
 		{
-			if (mTextFilter.find(',') == std::string::npos)
-			{
-				if (Utils::String::containsIgnoreCase(name, mTextFilter))
-				{
-					textScore = 1;
-					keepGoing = true;
-				}
-				else if (isChinese && Utils::String::containsIgnoreCasePinyin(name, mTextFilter)) {
-					textScore = 2;
-					keepGoing = true;
-				}
-			}
-			else
-			{
-				for (auto token : Utils::String::split(mTextFilter, ',', true))
-				{
-					if (Utils::String::containsIgnoreCase(name, Utils::String::trim(token)))
-					{
-						textScore = 1;
-						keepGoing = true;
-						break;  // score=1 need break
-					}
-					else if (isChinese && Utils::String::containsIgnoreCasePinyin(name, Utils::String::trim(token)))
-					{
-						textScore = 2;
-						keepGoing = true;
-					}
-				}
-			}
+			textScore = mSearchIndex.getScore(game, mTextFilter);
+			keepGoing = (textScore != 0);
 		}
 		else
 		{
+			auto name = game->getSourceFileData()->getName();
+
 			if (Utils::String::compareIgnoreCase(name, mTextFilter) == 0)
 			{
 				keepGoing = true;
@@ -1133,6 +1155,8 @@ bool CollectionFilter::createFromSystem(const std::string name, SystemData* syst
 		*(filterData.filteredByRef) = (filterData.currentFilteredKeys->size() > 0);
 	}
 
+	invalidate();
+
 	mName = name;
 	mPath = getCollectionsFolder() + "/" + mName + ".xcc";
 	
@@ -1231,6 +1255,7 @@ bool CollectionFilter::load(const std::string file)
 		*(filterData.filteredByRef) = (filterData.currentFilteredKeys->size() > 0);
 	}
 
+	invalidate();
 	return true;
 }
 
@@ -1357,11 +1382,14 @@ void CollectionFilter::setSystemSelected(const std::string name, bool value)
 	}
 	else if (!value)			
 		mSystemFilter.erase(sys);	
+
+	invalidate();
 }
 
 void CollectionFilter::resetSystemFilter()
 {
 	mSystemFilter.clear();
+	invalidate();
 }
 
 std::string FileFilterIndex::getDisplayLabel(bool includeText)
@@ -7,6 +7,8 @@
 #include <unordered_set>
 #include <string>
 
+#include "SearchIndex.h"
+
 class FileData;
 class SystemData;
 
@@ -88,6 +90,9 @@ public:
 	std::string getDisplayLabel(bool includeText = false);
 
 protected:
+	// New generation : the filters or the indexed games changed, folder visibility cached before is stale
+	void invalidate();
+
 	//std::vector<FilterDataDecl> filterDataDecl;
 	std::map<int, FilterDataDecl> mFilterDecl;
 
@@ -170,6 +175,11 @@ protected:
 
 	std::string mTextFilter;
 	bool		mUseRelevency;
+
+	SearchIndex mSearchIndex;
+
+	unsigned int mGeneration;
+	unsigned int mMetadataRevision;
 };
 
 class CollectionFilter : public FileFilterIndex
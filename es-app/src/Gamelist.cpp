@@ -11,6 +11,12 @@
 #include "Genres.h"
 #include "Paths.h"
 #include "utils/ThreadPool.h"
+#include "GamelistReader.h"
+#include "GamelistWriter.h"
+#include "GamelistMaintenance.h"
+#include <algorithm>
+#include <cstring>
+#include <sstream>
 
 #ifdef WIN32
 #include <Windows.h>
@@ -109,6 +115,175 @@ FileData* findOrCreateFile(SystemData* system, const std::string& path, FileType
 
 #include <fstream>
 
+// FileData of a gamelist entry, nullptr when the entry is ignored
+static FileData* findGamelistFile(SystemData* system, const std::string& path, FileType type, std::unordered_map<std::string, FileData*>& fileMap, bool trustGamelist, bool fromFile)
+{
+	FileData* file = nullptr;
+
+	if (trustGamelist)
+		file = findOrCreateFile(system, path, type, fileMap);
+	else 
+	{
+		auto pGame = fileMap.find(path);
+		if (pGame != fileMap.end())
+			file = pGame->second;
+		else
+		{
+			if (!fromFile && system->getSystemEnvData()->isValidExtension(Utils::String::toLower(Utils::FileSystem::getExtension(path))) && Utils::FileSystem::exists(path))
+				file = findOrCreateFile(system, path, type, fileMap);
+			else
+			{
+				LOG(LogWarning) << "File \"" << path << "\" does not exist or is arcade asset ! Ignoring.";
+				return nullptr;
+			}
+		}
+	}
+
+	if (file == nullptr)
+	{			
+		LOG(LogError) << "Error finding/creating FileData for \"" << path << "\", skipping.";
+		return nullptr;
+	}
+
+	if (trustGamelist && file->isArcadeAsset()) // arcade assets already filtered when !trustGamelist
+		return nullptr;
+
+	return file;
+}
+
+static void endGamelistEntry(FileData* file, const std::string& path, bool trustGamelist, size_t checkSize)
+{
+	MetaDataList& mdl = file->getMetadata();
+
+	// Make sure name gets set if one didn't exist
+	if (mdl.getName().empty())
+		mdl.set(MetaDataId::Name, file->getDisplayName());
+
+	if (!trustGamelist && !file->getHidden() && Utils::FileSystem::isHidden(path))
+		mdl.set(MetaDataId::Hidden, "true");
+
+	Genres::convertGenreToGenreIds(&mdl);
+
+	if (checkSize != SIZE_MAX)
+		mdl.setDirty();
+	else
+		mdl.resetChangedFlag();
+}
+
+// Utils::FileSystem::resolveRelativePath, without temporary strings for the usual "./file" paths that are already generic
+static void resolveGamelistPath(const GamelistReader::Span& text, const std::string& relativeTo, bool relativeToIsGeneric, std::string& path)
+{
+	const char* data = text.data;
+	size_t length = text.length;
+
+	if (relativeToIsGeneric && length > 2 && data[0] == '.' && data[1] == '/' && data[2] != '.' && data[2] != '/' && data[length - 1] != '/' &&
+		memchr(data, '\\', length) == nullptr && std::search(data, data + length, "//", "//" + 2) == data + length)
+	{
+		path.assign(relativeTo);
+		path.append(data + 1, length - 1);
+		return;
+	}
+
+	path = Utils::FileSystem::resolveRelativePath(text.str(), relativeTo, false);
+}
+
+// Entries are loaded while the file is read, no document is built
+static void readGamelistFile(std::vector<char>& buffer, const std::string& xmlpath, SystemData* system, std::unordered_map<std::string, FileData*>& fileMap, size_t checkSize, std::vector<FileData*>& ret)
+{
+	GamelistReader reader(buffer.data(), buffer.size());
+
+	if (!reader.readRoot("gameList"))
+	{
+		if (reader.hasError())
+			LOG(LogError) << "Error parsing XML file \"" << xmlpath << "\"!\n	" << reader.getError();
+		else
+			LOG(LogError) << "Could not find <gameList> node in gamelist \"" << xmlpath << "\"!";
+
+		return;
+	}
+
+	if (checkSize != SIZE_MAX)
+	{
+		auto parentHash = reader.getRootAttribute("parentHash");
+		auto parentSize = parentHash == nullptr ? 0 : (unsigned int)strtoul(parentHash->str().c_str(), nullptr, 10);
+		if (parentSize != checkSize)
+		{
+			LOG(LogWarning) << "gamelist size don't match !";
+			return;
+		}
+	}
+
+	const std::string& relativeTo = system->getStartPath();
+	bool relativeToIsGeneric = (relativeTo == Utils::FileSystem::getGenericPath(relativeTo));
+	bool trustGamelist = Settings::ParseGamelistOnly();
+
+	GamelistReader::Entry entry;
+	std::string path;
+	std::string value;
+
+	while (reader.readEntry(entry))
+	{
+		FileType type = GAME;
+
+		if (entry.name.equals("folder"))
+			type = FOLDER;
+		else if (!entry.name.equals("game"))
+			continue;
+
+		auto pathElement = entry.findElement("path");
+		resolveGamelistPath(pathElement == nullptr ? GamelistReader::Span() : pathElement->text, relativeTo, relativeToIsGeneric, path);
+
+		FileData* file = findGamelistFile(system, path, type, fileMap, trustGamelist, true);
+		if (file == nullptr)
+			continue;
+
+		MetaDataList& mdl = file->getMetadata();
+		mdl.beginLoad(type == FOLDER ? FOLDER_METADATA : GAME_METADATA, system);
+
+		const GamelistReader::Element* hash = nullptr;
+
+		for (auto& element : entry.elements)
+		{
+			if (element.name.equals("scrap"))
+			{
+				auto scraper = entry.findAttribute(element, "name");
+				auto date = entry.findAttribute(element, "date");
+				if (scraper != nullptr && date != nullptr)
+					mdl.loadScrapeDate(scraper->value.str(), date->value.str());
+
+				continue;
+			}
+
+			if (hash == nullptr && element.name.equals("hash"))
+				hash = &element;
+
+			value.assign(element.text.data, element.text.length);
+			mdl.loadElement(element.name.data, element.name.length, value);
+		}
+
+		for (size_t i = 0; i < entry.attributeCount; i++)
+		{
+			auto& attribute = entry.attributes[i];
+
+			value.assign(attribute.value.data, attribute.value.length);
+			mdl.loadAttribute(attribute.name.data, attribute.name.length, value);
+		}
+
+		mdl.endLoad();
+
+		// Same as MetaDataList::migrate
+		if (hash != nullptr && mdl.get(MetaDataId::Crc32).empty())
+			mdl.set(MetaDataId::Crc32, hash->text.str());
+
+		endGamelistEntry(file, path, trustGamelist, checkSize);
+		ret.push_back(file);
+	}
+
+	// The entries read before are kept
+	if (reader.hasError())
+		LOG(LogError) << "Error parsing XML file \"" << xmlpath << "\"!\n	" << reader.getError() << " ( " << ret.size() << " entries loaded )";
+}
+
 std::vector<FileData*> loadGamelistFile(const std::string xmlpath, SystemData* system, std::unordered_map<std::string, FileData*>& fileMap, size_t checkSize, bool fromFile)
 {	
 	std::vector<FileData*> ret;
@@ -132,6 +307,12 @@ std::vector<FileData*> loadGamelistFile(const std::string xmlpath, SystemData* s
 			return ret;
 		}
 		
+		if (GamelistReader::canRead(buffer.data(), buffer.size()))
+		{
+			readGamelistFile(buffer, xmlpath, system, fileMap, checkSize, ret);
+			return ret;
+		}
+
 		result = doc.load_buffer_inplace(buffer.data(), buffer.size(), pugi::parse_default);
 	}
 	else 
@@ -176,55 +357,16 @@ std::vector<FileData*> loadGamelistFile(const std::string xmlpath, SystemData* s
 
 		const std::string path = Utils::FileSystem::resolveRelativePath(fileNode.child("path").text().get(), relativeTo, false);
 		
-		FileData* file = nullptr;
-
-		if (trustGamelist)
-			file = findOrCreateFile(system, path, type, fileMap);
-		else 
-		{
-			auto pGame = fileMap.find(path);
-			if (pGame != fileMap.end())
-				file = pGame->second;
-			else
-			{
-				if (!fromFile && system->getSystemEnvData()->isValidExtension(Utils::String::toLower(Utils::FileSystem::getExtension(path))) && Utils::FileSystem::exists(path))
-					file = findOrCreateFile(system, path, type, fileMap);
-				else
-				{
-					LOG(LogWarning) << "File \"" << path << "\" does not exist or is arcade asset ! Ignoring.";
-					continue;
-				}
-			}
-		}
-
+		FileData* file = findGamelistFile(system, path, type, fileMap, trustGamelist, fromFile);
 		if (file == nullptr)
-		{			
-			LOG(LogError) << "Error finding/creating FileData for \"" << path << "\", skipping.";
 			continue;
-		}
-		
-		if (!trustGamelist || !file->isArcadeAsset()) // arcade assets already filtered when !trustGamelist
-		{
-			MetaDataList& mdl = file->getMetadata();
-			mdl.loadFromXML(type == FOLDER ? FOLDER_METADATA : GAME_METADATA, fileNode, system);
-			mdl.migrate(file, fileNode);
-
-			// Make sure name gets set if one didn't exist
-			if (mdl.getName().empty())
-				mdl.set(MetaDataId::Name, file->getDisplayName());
 
-			if (!trustGamelist && !file->getHidden() && Utils::FileSystem::isHidden(path))
-				mdl.set(MetaDataId::Hidden, "true");
+		MetaDataList& mdl = file->getMetadata();
+		mdl.loadFromXML(type == FOLDER ? FOLDER_METADATA : GAME_METADATA, fileNode, system);
+		mdl.migrate(file, fileNode);
 
-			Genres::convertGenreToGenreIds(&mdl);
-
-			if (checkSize != SIZE_MAX)
-				mdl.setDirty();
-			else
-				mdl.resetChangedFlag();
-
-			ret.push_back(file);
-		}
+		endGamelistEntry(file, path, trustGamelist, checkSize);
+		ret.push_back(file);
 	}
 
 	return ret;
@@ -252,7 +394,7 @@ void parseGamelist(SystemData* system, std::unordered_map<std::string, FileData*
 		system->setGamelistHash(size);	
 }
 
-bool addFileDataNode(pugi::xml_node& parent, FileData* file, const char* tag, SystemData* system, bool fullPaths = false)
+bool addFileDataNode(pugi::xml_node& parent, FileData* file, const char* tag, SystemData* system, bool fullPaths)
 {
 	//create game and add to parent node
 	pugi::xml_node newNode = parent.append_child(tag);
@@ -285,6 +427,18 @@ bool addFileDataNode(pugi::xml_node& parent, FileData* file, const char* tag, Sy
 	return true;	
 }
 
+// Gamelist of a single entry, false when there's nothing to save
+static bool createEntryXml(pugi::xml_document& doc, FileData* file, SystemData* system, bool fullPaths)
+{
+	pugi::xml_node root = doc.append_child("gameList");
+
+	const char* tag = file->getType() == GAME ? "game" : "folder";
+
+	root.append_attribute("parentHash").set_value(system->getGamelistHash());
+
+	return addFileDataNode(root, file, tag, system, fullPaths);
+}
+
 bool saveToXml(FileData* file, const std::string& fileName, bool fullPaths)
 {
 	SystemData* system = file->getSourceFileData()->getSystem();
@@ -292,13 +446,8 @@ bool saveToXml(FileData* file, const std::string& fileName, bool fullPaths)
 		return false;	
 
 	pugi::xml_document doc;
-	pugi::xml_node root = doc.append_child("gameList");
-
-	const char* tag = file->getType() == GAME ? "game" : "folder";
-
-	root.append_attribute("parentHash").set_value(system->getGamelistHash());
 
-	if (addFileDataNode(root, file, tag, system, fullPaths))
+	if (createEntryXml(doc, file, system, fullPaths))
 	{
 		std::string folder = Utils::FileSystem::getParent(fileName);
 		if (!Utils::FileSystem::exists(folder))
@@ -331,9 +480,17 @@ bool saveToGamelistRecovery(FileData* file)
 	fp = Utils::FileSystem::getParent(fp) + "/" + Utils::FileSystem::getStem(fp) + ".xml";
 
 	std::string path = Utils::FileSystem::getAbsolutePath(fp, getGamelistRecoveryPath(system));
-	path = Utils::FileSystem::getCanonicalPath(path);
 
-	return saveToXml(file, path);
+	pugi::xml_document doc;
+	if (!createEntryXml(doc, file, system, false))
+		return false;
+
+	std::stringstream xml;
+	doc.save(xml);
+
+	// Written in the background, with the other changes of the system
+	GamelistWriter::getInstance()->save(system, path, xml.str());
+	return true;
 }
 
 bool removeFromGamelistRecovery(FileData* file)
@@ -347,12 +504,10 @@ bool removeFromGamelistRecovery(FileData* file)
 	fp = Utils::FileSystem::getParent(fp) + "/" + Utils::FileSystem::getStem(fp) + ".xml";
 
 	std::string path = Utils::FileSystem::getAbsolutePath(fp, getGamelistRecoveryPath(system));
-	path = Utils::FileSystem::getCanonicalPath(path);
-
-	if (Utils::FileSystem::exists(path))
-		return Utils::FileSystem::removeFile(path);
 
-	return false;
+	// After the pending write of the file, if any
+	GamelistWriter::getInstance()->remove(system, path);
+	return true;
 }
 
 bool hasDirtyFile(SystemData* system)
@@ -391,6 +546,10 @@ void updateGamelist(SystemData* system)
 		return;
 	}
 
+	// The whole gamelist is written : the pending recovery files are no longer needed, and the maintenance would write a former one
+	GamelistWriter::discard(system);
+	GamelistMaintenance::cancel(system);
+
 	std::vector<FileData*> dirtyFiles;
 	
 	auto files = rootFolder->getFilesRecursive(GAME | FOLDER, false, nullptr, false);
@@ -471,7 +630,7 @@ void updateGamelist(SystemData* system)
 
 		LOG(LogInfo) << "Added/Updated " << numUpdated << " entities in '" << xmlReadPath << "'";
 
-		if (!doc.save_file(WINSTRINGW(xmlWritePath).c_str()))
+		if (!GamelistWriter::saveDocument(doc, xmlWritePath))
 			LOG(LogError) << "Error saving gamelist.xml to \"" << xmlWritePath << "\" (for system " << system->getName() << ")!";
 		else
 			clearTemporaryGamelistRecovery(system);
@@ -514,335 +673,3 @@ void resetGamelistUsageData(SystemData* system)
 		}
 	}
 }
-
-void packGamelist(SystemData* system)
-{
-	if (!system->isGameSystem() || system->isCollection())
-		return;
-
-	FolderData* rootFolder = system->getRootFolder();
-	if (rootFolder == nullptr)
-	{
-		LOG(LogError) << "CleanupGamelist : Found no root folder for system \"" << system->getName() << "\"!";
-		return;
-	}
-
-	std::string xmlReadPath = system->getGamelistPath(false);
-	if (!Utils::FileSystem::exists(xmlReadPath))
-		return;
-
-	pugi::xml_document doc;
-	pugi::xml_parse_result result = doc.load_file(WINSTRINGW(xmlReadPath).c_str());
-	if (!result)
-	{
-		LOG(LogError) << "CleanupGamelist : Error parsing XML file \"" << xmlReadPath << "\"!\n	" << result.description();
-		return;
-	}
-
-	pugi::xml_node root = doc.child("gameList");
-	if (!root)
-	{
-		LOG(LogError) << "CleanupGamelist : Could not find <gameList> node in gamelist \"" << xmlReadPath << "\"!";
-		return;
-	}
-
-	std::set<std::string> files;
-
-	for (auto file : Utils::FileSystem::getDirContent(system->getStartPath(), true))
-		files.insert(Utils::FileSystem::getCanonicalPath(file));
-
-	std::set<std::string> pathMdds;
-	for (auto mdd : MetaDataList::getMDD())
-		if (mdd.type == MetaDataType::MD_PATH)
-			pathMdds.insert(mdd.key);
-
-	bool dirty = false;
-
-	for (pugi::xml_node fileNode = root.first_child(); fileNode; )
-	{
-		pugi::xml_node next = fileNode.next_sibling();
-
-		pugi::xml_node path = fileNode.child("path");
-		if (!path)
-		{
-			dirty = true;
-			root.remove_child(fileNode);
-			fileNode = next;
-			continue;
-		}
-
-		std::string gamePath = Utils::FileSystem::getCanonicalPath(Utils::FileSystem::resolveRelativePath(path.text().get(), system->getStartPath(), true));
-
-		auto file = files.find(gamePath);
-		if (file == files.cend())
-		{
-			dirty = true;
-			root.remove_child(fileNode);
-			fileNode = next;
-			continue;
-		}
-
-		auto it = fileNode.children().begin();
-		while (it != fileNode.children().end())
-		{
-			pugi::xml_node xelement = *it;
-			++it;
-
-			std::string tag = xelement.name();
-			if (pathMdds.find(tag) == pathMdds.cend())
-				continue;
-
-			std::string path = xelement.text().get();		
-			std::string mddFullPath = Utils::FileSystem::getCanonicalPath(Utils::FileSystem::resolveRelativePath(path, system->getStartPath(), true));
-
-			if (mddFullPath.size() && files.find(mddFullPath) != files.cend())
-				continue;
-
-			if (mddFullPath.empty() || !Utils::FileSystem::exists(mddFullPath))
-			{
-				dirty = true;
-				fileNode.remove_child(xelement);
-			}
-		}
-
-		fileNode = next;
-	}
-
-	// Now write the file
-	if (dirty)
-	{
-		// Make sure the folders leading up to this path exist (or the write will fail)
-		std::string xmlWritePath(system->getGamelistPath(true));
-		Utils::FileSystem::createDirectory(Utils::FileSystem::getParent(xmlWritePath));
-
-		std::string oldXml = xmlWritePath + ".old";
-		Utils::FileSystem::removeFile(oldXml);
-		Utils::FileSystem::copyFile(xmlWritePath, oldXml);
-
-		if (!doc.save_file(WINSTRINGW(xmlWritePath).c_str()))
-			LOG(LogError) << "Error saving gamelist.xml to \"" << xmlWritePath << "\" (for system " << system->getName() << ")!";
-		else
-			clearTemporaryGamelistRecovery(system);
-	}
-	else
-		clearTemporaryGamelistRecovery(system);
-}
-
-void cleanupGamelist(SystemData* system)
-{
-	if (!system->isGameSystem() || system->isCollection() || (!Settings::HiddenSystemsShowGames() && !system->isVisible())) //  || system->hasPlatformId(PlatformIds::IMAGEVIEWER)
-		return;
-
-	FolderData* rootFolder = system->getRootFolder();
-	if (rootFolder == nullptr)
-	{
-		LOG(LogError) << "CleanupGamelist : Found no root folder for system \"" << system->getName() << "\"!";
-		return;
-	}
-
-	std::string xmlReadPath = system->getGamelistPath(false);
-	if (!Utils::FileSystem::exists(xmlReadPath))
-		return;
-
-	pugi::xml_document doc;
-	pugi::xml_parse_result result = doc.load_file(WINSTRINGW(xmlReadPath).c_str());
-	if (!result)
-	{
-		LOG(LogError) << "CleanupGamelist : Error parsing XML file \"" << xmlReadPath << "\"!\n	" << result.description();
-		return;
-	}
-
-	pugi::xml_node root = doc.child("gameList");
-	if (!root)
-	{
-		LOG(LogError) << "CleanupGamelist : Could not find <gameList> node in gamelist \"" << xmlReadPath << "\"!";
-		return;
-	}
-
-	std::map<std::string, FileData*> fileMap;
-	for (auto file : rootFolder->getFilesRecursive(GAME | FOLDER, false, nullptr, false))
-		fileMap[Utils::FileSystem::getCanonicalPath(file->getPath())] = file;
-
-	bool dirty = false;
-
-	std::set<std::string> knownXmlPaths;
-	std::set<std::string> knownMedias;
-
-	for (pugi::xml_node fileNode = root.first_child(); fileNode; )
-	{
-		pugi::xml_node next = fileNode.next_sibling();
-
-		pugi::xml_node path = fileNode.child("path");
-		if (!path)
-		{
-			dirty = true;
-			root.remove_child(fileNode);
-			fileNode = next;
-			continue;
-		}
-		
-		std::string gamePath = Utils::FileSystem::getCanonicalPath(Utils::FileSystem::resolveRelativePath(path.text().get(), system->getStartPath(), true));
-
-		auto file = fileMap.find(gamePath);
-		if (file == fileMap.cend())
-		{
-			dirty = true;
-			root.remove_child(fileNode);
-			fileNode = next;
-			continue;
-		}
-
-		knownXmlPaths.insert(gamePath);
-		
-		for (auto mdd : MetaDataList::getMDD())
-		{
-			if (mdd.type != MetaDataType::MD_PATH)
-				continue;
-
-			pugi::xml_node mddPath = fileNode.child(mdd.key.c_str());
-
-			std::string mddFullPath = (mddPath ? Utils::FileSystem::getCanonicalPath(Utils::FileSystem::resolveRelativePath(mddPath.text().get(), system->getStartPath(), true)) : "");
-			if (!Utils::FileSystem::exists(mddFullPath))
-			{
-				std::string ext = ".jpg";
-				std::string folder = "/images/";
-				std::string suffix;
-
-				switch (mdd.id)
-				{
-				case MetaDataId::Image: suffix = "image"; break;
-				case MetaDataId::Thumbnail: suffix = "thumb"; break;
-				case MetaDataId::Marquee: suffix = "marquee"; break;
-				case MetaDataId::Video: suffix = "video"; folder = "/videos/"; ext = ".mp4"; break;
-				case MetaDataId::FanArt: suffix = "fanart"; break;
-				case MetaDataId::BoxBack: suffix = "boxback"; break;
-				case MetaDataId::BoxArt: suffix = "box"; break;
-				case MetaDataId::Wheel: suffix = "wheel"; break;
-				case MetaDataId::TitleShot: suffix = "titleshot"; break;
-				case MetaDataId::Manual: suffix = "manual"; folder = "/manuals/"; ext = ".pdf"; break;
-				case MetaDataId::Magazine: suffix = "magazine"; folder = "/magazines/"; ext = ".pdf"; break;
-				case MetaDataId::Map: suffix = "map"; break;
-				case MetaDataId::Cartridge: suffix = "cartridge"; break;
-				}
-
-				if (!suffix.empty())
-				{					
-					std::string mediaPath = system->getStartPath() + folder + file->second->getDisplayName() + "-"+ suffix + ext;
-
-					if (ext == ".pdf" && !Utils::FileSystem::exists(mediaPath))
-					{
-						mediaPath = system->getStartPath() + folder + file->second->getDisplayName() + ".pdf";
-						if (!Utils::FileSystem::exists(mediaPath))
-							mediaPath = system->getStartPath() + folder + file->second->getDisplayName() + ".cbz";
-					}
-					else if (ext != ".jpg" && !Utils::FileSystem::exists(mediaPath))
-						mediaPath = system->getStartPath() + folder + file->second->getDisplayName() + ext;
-					else if (ext == ".jpg" && !Utils::FileSystem::exists(mediaPath))
-						mediaPath = system->getStartPath() + folder + file->second->getDisplayName() + "-" + suffix + ".png";
-
-					if (mdd.id == MetaDataId::Image && !Utils::FileSystem::exists(mediaPath))
-						mediaPath = system->getStartPath() + folder + file->second->getDisplayName() + ".jpg";
-					if (mdd.id == MetaDataId::Image && !Utils::FileSystem::exists(mediaPath))
-						mediaPath = system->getStartPath() + folder + file->second->getDisplayName() + ".png";
-
-					if (Utils::FileSystem::exists(mediaPath))
-					{
-						auto relativePath = Utils::FileSystem::createRelativePath(mediaPath, system->getStartPath(), true);
-
-						fileNode.append_child(mdd.key.c_str()).text().set(relativePath.c_str());
-
-						LOG(LogInfo) << "CleanupGamelist : Add resolved " << mdd.key << " path " << mediaPath << " to game " << gamePath << " in system " << system->getName();
-						dirty = true;
-
-						knownMedias.insert(mediaPath);
-						continue;
-					}
-				}
-
-				if (mddPath)
-				{
-					LOG(LogInfo) << "CleanupGamelist : Remove " << mdd.key << " path to game " << gamePath << " in system " << system->getName();
-
-					dirty = true;
-					fileNode.remove_child(mdd.key.c_str());
-				}
-
-				continue;
-			}
-
-			knownMedias.insert(mddFullPath);
-		}
-
-		fileNode = next;
-	}
-	
-	// iterate through all files, checking if they're already in the XML
-	for (auto file : fileMap)
-	{
-		auto fileName = file.first;
-		auto fileData = file.second;
-
-		if (knownXmlPaths.find(fileName) != knownXmlPaths.cend())
-			continue;
-
-		const char* tag = (fileData->getType() == GAME) ? "game" : "folder";
-
-		if (addFileDataNode(root, fileData, tag, system))
-		{
-			LOG(LogInfo) << "CleanupGamelist : Add " << fileName << " to system " << system->getName();
-			dirty = true;
-		}
-	}
-
-	// Cleanup unknown files in system rom path
-	auto allFiles = Utils::FileSystem::getDirContent(system->getStartPath(), true);
-	for (auto dirFile : allFiles)
-	{
-		if (knownXmlPaths.find(dirFile) != knownXmlPaths.cend())
-			continue;
-
-		if (knownMedias.find(dirFile) != knownMedias.cend())
-			continue;
-
-		if (dirFile.empty())
-			continue;
-
-		if (Utils::FileSystem::isDirectory(dirFile))
-			continue;
-
-		std::string parent = Utils::String::toLower(Utils::FileSystem::getFileName(Utils::FileSystem::getParent(dirFile)));
-		if (parent != "images" && parent != "videos" && parent != "manuals" && parent != "downloaded_images" && parent != "downloaded_videos")
-			continue;
-
-		if (Utils::FileSystem::getParent(Utils::FileSystem::getParent(dirFile)) != system->getStartPath())
-			if (Utils::FileSystem::getFileName(Utils::FileSystem::getParent(Utils::FileSystem::getParent(dirFile))) != "media")
-				continue;
-
-		std::string ext = Utils::String::toLower(Utils::FileSystem::getExtension(dirFile));
-		if (ext == ".txt" || ext == ".xml" || ext == ".old")
-			continue;
-		
-		LOG(LogInfo) << "CleanupGamelist : Remove unknown file " << dirFile << " to system " << system->getName();
-
-		Utils::FileSystem::removeFile(dirFile);
-	}
-
-	// Now write the file
-	if (dirty)
-	{
-		// Make sure the folders leading up to this path exist (or the write will fail)
-		std::string xmlWritePath(system->getGamelistPath(true));
-		Utils::FileSystem::createDirectory(Utils::FileSystem::getParent(xmlWritePath));		
-
-		std::string oldXml = xmlWritePath + ".old";
-		Utils::FileSystem::removeFile(oldXml);
-		Utils::FileSystem::copyFile(xmlWritePath, oldXml);
-
-		if (!doc.save_file(WINSTRINGW(xmlWritePath).c_str()))
-			LOG(LogError) << "Error saving gamelist.xml to \"" << xmlWritePath << "\" (for system " << system->getName() << ")!";
-		else
-			clearTemporaryGamelistRecovery(system);
-	}
-	else
-		clearTemporaryGamelistRecovery(system);
-}
@@ -10,18 +10,24 @@
 class SystemData;
 class FileData;
 
+namespace pugi
+{
+	class xml_node;
+}
+
 // Loads gamelist.xml data into a SystemData.
 void parseGamelist(SystemData* system, std::unordered_map<std::string, FileData*>& fileMap);
 
 // Writes currently loaded metadata for a SystemData to gamelist.xml.
 void updateGamelist(SystemData* system);
-void cleanupGamelist(SystemData* system);
-void packGamelist(SystemData* system);
 void resetGamelistUsageData(SystemData* system);
 
 bool saveToGamelistRecovery(FileData* file);
 bool removeFromGamelistRecovery(FileData* file);
 
+// Appends the entry of a file, false when it has nothing but its default name
+bool addFileDataNode(pugi::xml_node& parent, FileData* file, const char* tag, SystemData* system, bool fullPaths = false);
+
 bool saveToXml(FileData* file, const std::string& fileName, bool fullPaths = false);
 
 bool hasDirtyFile(SystemData* system);
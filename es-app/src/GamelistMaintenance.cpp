@@ -0,0 +1,1096 @@
+#include "GamelistMaintenance.h"
+#include "Gamelist.h"
+#include "SystemData.h"
+#include "FileData.h"
+#include "MetaData.h"
+#include "Settings.h"
+#include "Window.h"
+#include "Paths.h"
+#include "components/AsyncNotificationComponent.h"
+#include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+#include "Log.h"
+#include "Tracing.h"
+#include "LocaleES.h"
+
+#include <pugixml/src/pugixml.hpp>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <unordered_set>
+#include <unordered_map>
+#include <cstdlib>
+
+#define GAMELIST_MAINTENANCE_THREADS		2		// at most : the storage is what limits them
+#define GAMELIST_MAINTENANCE_IO_RATE		1000	// file operations per second, shared by the threads
+#define GAMELIST_MAINTENANCE_CHECKPOINT		500		// entries between two saves of the progress
+#define GAMELIST_MAINTENANCE_STATE_VERSION	1
+
+GamelistMaintenance* GamelistMaintenance::sInstance = nullptr;
+std::atomic<bool> GamelistMaintenance::sPaused(false);
+
+static std::mutex sInstanceLock;
+static std::atomic<int> sLastUiCall(0);
+
+struct MaintenanceState
+{
+	MaintenanceState() : size(0), date(0), complete(false) { }
+
+	size_t	size;		// generation stamp of the gamelist
+	time_t	date;
+	bool	complete;
+
+	std::map<std::string, time_t>	folders;	// rom folders, by date
+	std::unordered_set<uint64_t>	entries;	// entries found valid
+};
+
+struct MaintenanceFile
+{
+	std::string	path;
+	bool		directory;
+};
+
+static std::string getStatePath(SystemData* system, GamelistMaintenance::Task task)
+{
+	return Paths::getUserEmulationStationPath() + "/maintenance/" + system->getName() + (task == GamelistMaintenance::PACK ? ".pack" : ".cleanup");
+}
+
+// Header line, then a line per folder & per entry
+static void loadState(const std::string& path, MaintenanceState& state)
+{
+	std::ifstream file(WINSTRINGW(path));
+	if (!file.is_open())
+		return;
+
+	std::string line;
+	if (!std::getline(file, line))
+		return;
+
+	int version = 0;
+	int complete = 0;
+
+	std::istringstream header(line);
+	if (!(header >> version >> state.size >> state.date >> complete) || version != GAMELIST_MAINTENANCE_STATE_VERSION)
+	{
+		state = MaintenanceState();
+		return;
+	}
+
+	state.complete = (complete != 0);
+
+	while (std::getline(file, line))
+	{
+		if (line.size() < 3 || line[1] != ' ')
+			continue;
+
+		if (line[0] == 'E')
+			state.entries.insert(strtoull(line.c_str() + 2, nullptr, 16));
+		else if (line[0] == 'F')
+		{
+			char* end = nullptr;
+			time_t date = (time_t)strtoll(line.c_str() + 2, &end, 10);
+			if (end != nullptr && *end == ' ')
+				state.folders[end + 1] = date;
+		}
+	}
+}
+
+static bool saveState(const std::string& path, const MaintenanceState& state)
+{
+	std::stringstream ss;
+	ss << GAMELIST_MAINTENANCE_STATE_VERSION << " " << state.size << " " << state.date << " " << (state.complete ? 1 : 0) << "\n";
+
+	for (auto& folder : state.folders)
+		ss << "F " << folder.second << " " << folder.first << "\n";
+
+	ss << std::hex;
+	for (auto entry : state.entries)
+		ss << "E " << entry << "\n";
+
+	Utils::FileSystem::createDirectory(Utils::FileSystem::getParent(path));
+
+	std::string temporary = path + ".tmp";
+	Utils::FileSystem::writeAllText(temporary, ss.str());
+	return Utils::FileSystem::replaceFile(temporary, path);
+}
+
+static void hashString(uint64_t& hash, const char* str)
+{
+	for (; *str; str++)
+	{
+		hash ^= (unsigned char)*str;
+		hash *= 0x100000001B3ULL;
+	}
+
+	hash ^= 0xFF;
+	hash *= 0x100000001B3ULL;
+}
+
+// FNV-1a of the tag, attributes & elements of an entry
+static uint64_t hashEntry(const pugi::xml_node& node)
+{
+	uint64_t hash = 0xCBF29CE484222325ULL;
+	hashString(hash, node.name());
+
+	for (auto attribute : node.attributes())
+	{
+		hashString(hash, attribute.name());
+		hashString(hash, attribute.value());
+	}
+
+	for (auto child : node.children())
+	{
+		hashString(hash, child.name());
+		hashString(hash, child.text().get());
+
+		for (auto attribute : child.attributes())
+		{
+			hashString(hash, attribute.name());
+			hashString(hash, attribute.value());
+		}
+	}
+
+	return hash;
+}
+
+// Maintenance of a system, on a worker thread
+class GamelistMaintenance::Run
+{
+public:
+	Run(GamelistMaintenance* owner, Job& job) : mOwner(owner), mJob(job), mSystem(job.system), mListed(false), mFull(true), mCount(0)
+	{
+		mStartPath = Utils::FileSystem::getGenericPath(mSystem->getStartPath());
+		while (mStartPath.size() > 1 && mStartPath.back() == '/')
+			mStartPath.pop_back();
+
+		mCanonicalStart = Utils::FileSystem::getCanonicalPath(mStartPath);
+		mStatePath = getStatePath(mSystem, mJob.task);
+	}
+
+	void execute();
+
+private:
+	std::string canonical(const std::string& path);
+	std::string resolve(const char* text);
+	bool exists(const std::string& path);
+
+	void list();
+	bool foldersChanged();
+	bool checkpoint();
+	void save(bool complete);
+
+	bool pack(pugi::xml_node& root);
+	bool cleanup(pugi::xml_node& root);
+	std::string findMedia(const MetaDataDecl& mdd, const Game& game);
+	void removeUnknownMedias(const std::set<std::string>& knownXmlPaths, const std::set<std::string>& knownMedias);
+
+	GamelistMaintenance*	mOwner;
+	Job&					mJob;
+	SystemData*				mSystem;
+
+	std::string		mStartPath;
+	std::string		mCanonicalStart;
+	std::string		mStatePath;
+
+	bool							mListed;
+	std::unordered_set<std::string>	mFiles;		// canonical paths of the rom folder's content
+	std::vector<MaintenanceFile>	mListing;
+	std::map<std::string, time_t>	mFolders;
+
+	MaintenanceState	mPrevious;
+	MaintenanceState	mNext;
+	bool				mFull;		// every entry is checked
+	int					mCount;
+};
+
+// Paths in the rom folder are mapped on its canonical path, instead of resolving each of them
+std::string GamelistMaintenance::Run::canonical(const std::string& path)
+{
+	if (path.size() > mStartPath.size() && path[mStartPath.size()] == '/' && Utils::String::startsWith(path, mStartPath) &&
+		path.find("/./") == std::string::npos && path.find("/..") == std::string::npos)
+		return mCanonicalStart + path.substr(mStartPath.size());
+
+	mOwner->throttle(mJob, 1);
+	return Utils::FileSystem::getCanonicalPath(path);
+}
+
+std::string GamelistMaintenance::Run::resolve(const char* text)
+{
+	if (text == nullptr || *text == 0)
+		return "";
+
+	return canonical(Utils::FileSystem::resolveRelativePath(text, mStartPath, true));
+}
+
+// The listing answers for the rom folder when it was made, the others are stated
+bool GamelistMaintenance::Run::exists(const std::string& path)
+{
+	if (path.empty())
+		return false;
+
+	if (mListed && path.size() > mCanonicalStart.size() && path[mCanonicalStart.size()] == '/' && Utils::String::startsWith(path, mCanonicalStart))
+		return mFiles.find(path) != mFiles.cend();
+
+	mOwner->throttle(mJob, 1);
+	return Utils::FileSystem::exists(path);
+}
+
+// Content of the rom folder, hidden files excepted, and dates of its folders
+void GamelistMaintenance::Run::list()
+{
+	std::vector<std::string> stack;
+	stack.push_back(mStartPath);
+
+	while (!stack.empty() && !mJob.cancelled)
+	{
+		std::string folder = stack.back();
+		stack.pop_back();
+
+		mOwner->throttle(mJob, 2);
+
+		mFolders[folder] = Utils::FileSystem::getFileModificationDate(folder).getTime();
+
+		auto content = Utils::FileSystem::getDirectoryFiles(folder);
+		mOwner->throttle(mJob, (int)(content.size() / 64));
+
+		for (auto& file : content)
+		{
+			if (file.hidden)
+				continue;
+
+			if (file.directory)
+				stack.push_back(file.path);
+
+			MaintenanceFile item;
+			item.path = canonical(file.path);
+			item.directory = file.directory;
+
+			mFiles.insert(item.path);
+			mListing.push_back(item);
+		}
+	}
+
+	mListed = !mJob.cancelled;
+}
+
+// The date of a folder changes when a file is added, removed or renamed in it
+bool GamelistMaintenance::Run::foldersChanged()
+{
+	if (mPrevious.folders.empty())
+		return true;
+
+	for (auto& folder : mPrevious.folders)
+	{
+		if (!mOwner->throttle(mJob, 1))
+			return true;
+
+		if (Utils::FileSystem::getFileModificationDate(folder.first).getTime() != folder.second)
+			return true;
+	}
+
+	return false;
+}
+
+void GamelistMaintenance::Run::save(bool complete)
+{
+	mNext.complete = complete;
+
+	// Entries not reached yet stay valid, unless the rom folder changed
+	if (!complete && !mFull)
+		mNext.entries.insert(mPrevious.entries.cbegin(), mPrevious.entries.cend());
+
+	mOwner->throttle(mJob, 1 + (int)(mNext.entries.size() / 4096));
+
+	if (!saveState(mStatePath, mNext))
+		LOG(LogWarning) << "GamelistMaintenance : unable to save " << mStatePath;
+}
+
+// False when cancelled
+bool GamelistMaintenance::Run::checkpoint()
+{
+	if (mJob.cancelled)
+		return false;
+
+	if (++mCount % GAMELIST_MAINTENANCE_CHECKPOINT == 0)
+	{
+		MaintenanceState next = mNext;
+		save(false);
+		mNext = next;
+	}
+
+	return true;
+}
+
+void GamelistMaintenance::Run::execute()
+{
+	std::string xmlReadPath = mSystem->getGamelistPath(false);
+
+	mOwner->throttle(mJob, 2);
+	if (!Utils::FileSystem::exists(xmlReadPath))
+		return;
+
+	size_t size = Utils::FileSystem::getFileSize(xmlReadPath);
+	time_t date = Utils::FileSystem::getFileModificationDate(xmlReadPath).getTime();
+
+	loadState(mStatePath, mPrevious);
+
+	bool changed = true;
+
+	if (mJob.task == CLEANUP)
+	{
+		// Unknown medias are searched in the listing
+		list();
+		changed = (mFolders != mPrevious.folders);
+	}
+	else if (foldersChanged())
+		list();
+	else
+		changed = false;
+
+	if (mJob.cancelled)
+		return;
+
+	if (!changed && mPrevious.complete && mPrevious.size == size && mPrevious.date == date)
+	{
+		LOG(LogDebug) << "GamelistMaintenance : " << mSystem->getName() << " is up to date";
+		return;
+	}
+
+	mFull = changed;
+	mNext.folders = mListed ? mFolders : mPrevious.folders;
+	mNext.size = size;
+	mNext.date = date;
+
+	mOwner->throttle(mJob, 1 + (int)(size / 65536));
+
+	pugi::xml_document doc;
+	pugi::xml_parse_result result = doc.load_file(WINSTRINGW(xmlReadPath).c_str());
+	if (!result)
+	{
+		LOG(LogError) << "GamelistMaintenance : Error parsing XML file \"" << xmlReadPath << "\"!\n	" << result.description();
+		return;
+	}
+
+	pugi::xml_node root = doc.child("gameList");
+	if (!root)
+	{
+		LOG(LogError) << "GamelistMaintenance : Could not find <gameList> node in gamelist \"" << xmlReadPath << "\"!";
+		return;
+	}
+
+	bool dirty = (mJob.task == PACK ? pack(root) : cleanup(root));
+	if (mJob.cancelled)
+	{
+		save(false);
+		return;
+	}
+
+	if (dirty)
+	{
+		// Make sure the folders leading up to this path exist (or the write will fail)
+		std::string xmlWritePath(mSystem->getGamelistPath(true));
+		Utils::FileSystem::createDirectory(Utils::FileSystem::getParent(xmlWritePath));
+
+		std::string temporary = xmlWritePath + ".tmp";
+		if (!doc.save_file(WINSTRINGW(temporary).c_str()) || !Utils::FileSystem::syncFile(temporary))
+		{
+			LOG(LogError) << "Error saving gamelist.xml to \"" << temporary << "\" (for system " << mSystem->getName() << ")!";
+			Utils::FileSystem::removeFile(temporary);
+			save(false);
+			return;
+		}
+
+		mOwner->throttle(mJob, 1 + (int)(Utils::FileSystem::getFileSize(temporary) / 65536));
+
+		std::string oldXml = xmlWritePath + ".old";
+		Utils::FileSystem::removeFile(oldXml);
+		Utils::FileSystem::copyFile(xmlWritePath, oldXml);
+
+		mOwner->throttle(mJob, 1 + (int)(size / 65536));
+
+		Commit commit;
+		commit.system = mSystem;
+		commit.temporary = temporary;
+		commit.path = xmlWritePath;
+		commit.readPath = xmlReadPath;
+		commit.size = size;
+		commit.date = date;
+
+		if (!mOwner->commit(mJob, commit))
+		{
+			Utils::FileSystem::removeFile(temporary);
+			save(false);
+			return;
+		}
+
+		mNext.size = commit.size;
+		mNext.date = commit.date;
+	}
+
+	save(true);
+}
+
+// Removes the entries of missing games, and the paths to missing medias
+bool GamelistMaintenance::Run::pack(pugi::xml_node& root)
+{
+	std::set<std::string> pathMdds;
+	for (auto mdd : MetaDataList::getMDD())
+		if (mdd.type == MetaDataType::MD_PATH)
+			pathMdds.insert(mdd.key);
+
+	bool dirty = false;
+
+	for (pugi::xml_node fileNode = root.first_child(); fileNode; )
+	{
+		if (!checkpoint())
+			break;
+
+		pugi::xml_node next = fileNode.next_sibling();
+
+		uint64_t hash = hashEntry(fileNode);
+		if (!mFull && mPrevious.entries.find(hash) != mPrevious.entries.cend())
+		{
+			mNext.entries.insert(hash);
+			fileNode = next;
+			continue;
+		}
+
+		pugi::xml_node path = fileNode.child("path");
+		if (!path || !exists(resolve(path.text().get())))
+		{
+			dirty = true;
+			root.remove_child(fileNode);
+			fileNode = next;
+			continue;
+		}
+
+		auto it = fileNode.children().begin();
+		while (it != fileNode.children().end())
+		{
+			pugi::xml_node xelement = *it;
+			++it;
+
+			if (pathMdds.find(xelement.name()) == pathMdds.cend())
+				continue;
+
+			if (!exists(resolve(xelement.text().get())))
+			{
+				dirty = true;
+				fileNode.remove_child(xelement);
+			}
+		}
+
+		mNext.entries.insert(hashEntry(fileNode));
+		fileNode = next;
+	}
+
+	return dirty;
+}
+
+// Removes the entries of unknown games, resolves missing medias, adds the games missing from the gamelist & removes the unknown medias
+bool GamelistMaintenance::Run::cleanup(pugi::xml_node& root)
+{
+	std::map<std::string, const Game*> fileMap;
+	if (mJob.games != nullptr)
+		for (auto& game : *mJob.games)
+			fileMap[canonical(game.path)] = &game;
+
+	bool dirty = false;
+
+	std::set<std::string> knownXmlPaths;
+	std::set<std::string> knownMedias;
+
+	for (pugi::xml_node fileNode = root.first_child(); fileNode; )
+	{
+		if (!checkpoint())
+			return dirty;
+
+		pugi::xml_node next = fileNode.next_sibling();
+
+		pugi::xml_node path = fileNode.child("path");
+		if (!path)
+		{
+			dirty = true;
+			root.remove_child(fileNode);
+			fileNode = next;
+			continue;
+		}
+
+		std::string gamePath = resolve(path.text().get());
+
+		auto file = fileMap.find(gamePath);
+		if (file == fileMap.cend())
+		{
+			dirty = true;
+			root.remove_child(fileNode);
+			fileNode = next;
+			continue;
+		}
+
+		knownXmlPaths.insert(gamePath);
+
+		uint64_t hash = hashEntry(fileNode);
+		if (!mFull && mPrevious.entries.find(hash) != mPrevious.entries.cend())
+		{
+			// Valid since the last run : only its medias are needed
+			for (auto& mdd : MetaDataList::getMDD())
+			{
+				pugi::xml_node mddPath;
+				if (mdd.type == MetaDataType::MD_PATH && (mddPath = fileNode.child(mdd.key.c_str())))
+					knownMedias.insert(resolve(mddPath.text().get()));
+			}
+
+			mNext.entries.insert(hash);
+			fileNode = next;
+			continue;
+		}
+
+		for (auto& mdd : MetaDataList::getMDD())
+		{
+			if (mdd.type != MetaDataType::MD_PATH)
+				continue;
+
+			pugi::xml_node mddPath = fileNode.child(mdd.key.c_str());
+
+			std::string mddFullPath = (mddPath ? resolve(mddPath.text().get()) : "");
+			if (exists(mddFullPath))
+			{
+				knownMedias.insert(mddFullPath);
+				continue;
+			}
+
+			std::string mediaPath = findMedia(mdd, *file->second);
+			if (!mediaPath.empty())
+			{
+				if (mddPath)
+					fileNode.remove_child(mddPath);
+
+				auto relativePath = Utils::FileSystem::createRelativePath(mediaPath, mStartPath, true);
+				fileNode.append_child(mdd.key.c_str()).text().set(relativePath.c_str());
+
+				LOG(LogInfo) << "CleanupGamelist : Add resolved " << mdd.key << " path " << mediaPath << " to game " << gamePath << " in system " << mSystem->getName();
+				dirty = true;
+
+				knownMedias.insert(canonical(mediaPath));
+				continue;
+			}
+
+			if (mddPath)
+			{
+				LOG(LogInfo) << "CleanupGamelist : Remove " << mdd.key << " path to game " << gamePath << " in system " << mSystem->getName();
+
+				dirty = true;
+				fileNode.remove_child(mddPath);
+			}
+		}
+
+		mNext.entries.insert(hashEntry(fileNode));
+		fileNode = next;
+	}
+
+	// iterate through all files, checking if they're already in the XML
+	std::vector<Game> missing;
+	for (auto file : fileMap)
+		if (knownXmlPaths.find(file.first) == knownXmlPaths.cend())
+			missing.push_back(*file.second);
+
+	if (!missing.empty())
+	{
+		// Their entries are written from the FileData, on the UI thread
+		SystemData* system = mSystem;
+		std::string xml;
+
+		if (!mOwner->runOnUiThread(mJob, [system, &missing, &xml]() { xml = writeEntries(system, missing); return true; }))
+			return dirty;
+
+		pugi::xml_document entries;
+		if (entries.load_string(xml.c_str()))
+		{
+			for (auto node : entries.child("gameList").children())
+			{
+				root.append_copy(node);
+
+				LOG(LogInfo) << "CleanupGamelist : Add " << node.child("path").text().get() << " to system " << mSystem->getName();
+				dirty = true;
+			}
+		}
+	}
+
+	removeUnknownMedias(knownXmlPaths, knownMedias);
+	return dirty;
+}
+
+// Media named after the game in the media folders, as the scrapers save them
+std::string GamelistMaintenance::Run::findMedia(const MetaDataDecl& mdd, const Game& game)
+{
+	std::string ext = ".jpg";
+	std::string folder = "/images/";
+	std::string suffix;
+
+	switch (mdd.id)
+	{
+	case MetaDataId::Image: suffix = "image"; break;
+	case MetaDataId::Thumbnail: suffix = "thumb"; break;
+	case MetaDataId::Marquee: suffix = "marquee"; break;
+	case MetaDataId::Video: suffix = "video"; folder = "/videos/"; ext = ".mp4"; break;
+	case MetaDataId::FanArt: suffix = "fanart"; break;
+	case MetaDataId::BoxBack: suffix = "boxback"; break;
+	case MetaDataId::BoxArt: suffix = "box"; break;
+	case MetaDataId::Wheel: suffix = "wheel"; break;
+	case MetaDataId::TitleShot: suffix = "titleshot"; break;
+	case MetaDataId::Manual: suffix = "manual"; folder = "/manuals/"; ext = ".pdf"; break;
+	case MetaDataId::Magazine: suffix = "magazine"; folder = "/magazines/"; ext = ".pdf"; break;
+	case MetaDataId::Map: suffix = "map"; break;
+	case MetaDataId::Cartridge: suffix = "cartridge"; break;
+	}
+
+	if (suffix.empty())
+		return "";
+
+	std::string prefix = mStartPath + folder + game.name;
+	std::string mediaPath = prefix + "-" + suffix + ext;
+
+	if (ext == ".pdf" && !exists(canonical(mediaPath)))
+	{
+		mediaPath = prefix + ".pdf";
+		if (!exists(canonical(mediaPath)))
+			mediaPath = prefix + ".cbz";
+	}
+	else if (ext != ".jpg" && !exists(canonical(mediaPath)))
+		mediaPath = prefix + ext;
+	else if (ext == ".jpg" && !exists(canonical(mediaPath)))
+		mediaPath = prefix + "-" + suffix + ".png";
+
+	if (mdd.id == MetaDataId::Image && !exists(canonical(mediaPath)))
+		mediaPath = prefix + ".jpg";
+	if (mdd.id == MetaDataId::Image && !exists(canonical(mediaPath)))
+		mediaPath = prefix + ".png";
+
+	return exists(canonical(mediaPath)) ? mediaPath : "";
+}
+
+// Cleanup unknown files in system rom path
+void GamelistMaintenance::Run::removeUnknownMedias(const std::set<std::string>& knownXmlPaths, const std::set<std::string>& knownMedias)
+{
+	if (!mListed || mJob.cancelled)
+		return;
+
+	for (auto& item : mListing)
+	{
+		const std::string& dirFile = item.path;
+
+		if (item.directory || dirFile.empty())
+			continue;
+
+		if (knownXmlPaths.find(dirFile) != knownXmlPaths.cend())
+			continue;
+
+		if (knownMedias.find(dirFile) != knownMedias.cend())
+			continue;
+
+		std::string parent = Utils::String::toLower(Utils::FileSystem::getFileName(Utils::FileSystem::getParent(dirFile)));
+		if (parent != "images" && parent != "videos" && parent != "manuals" && parent != "downloaded_images" && parent != "downloaded_videos")
+			continue;
+
+		if (Utils::FileSystem::getParent(Utils::FileSystem::getParent(dirFile)) != mCanonicalStart)
+			if (Utils::FileSystem::getFileName(Utils::FileSystem::getParent(Utils::FileSystem::getParent(dirFile))) != "media")
+				continue;
+
+		std::string ext = Utils::String::toLower(Utils::FileSystem::getExtension(dirFile));
+		if (ext == ".txt" || ext == ".xml" || ext == ".old")
+			continue;
+
+		if (!mOwner->throttle(mJob, 1))
+			return;
+
+		LOG(LogInfo) << "CleanupGamelist : Remove unknown file " << dirFile << " to system " << mSystem->getName();
+
+		Utils::FileSystem::removeFile(dirFile);
+	}
+}
+
+GamelistMaintenance* GamelistMaintenance::getInstance()
+{
+	std::unique_lock<std::mutex> lock(sInstanceLock);
+
+	if (sInstance == nullptr)
+		sInstance = new GamelistMaintenance();
+
+	return sInstance;
+}
+
+void GamelistMaintenance::deinit()
+{
+	std::unique_lock<std::mutex> lock(sInstanceLock);
+
+	if (sInstance != nullptr)
+	{
+		sInstance->stop();
+
+		delete sInstance;
+		sInstance = nullptr;
+	}
+}
+
+void GamelistMaintenance::cancel(SystemData* system)
+{
+	std::unique_lock<std::mutex> instanceLock(sInstanceLock);
+
+	if (sInstance == nullptr)
+		return;
+
+	std::unique_lock<std::mutex> lock(sInstance->mLock);
+
+	auto& queue = sInstance->mQueue;
+	auto size = queue.size();
+	queue.erase(std::remove_if(queue.begin(), queue.end(), [system](const Job& job) { return job.system == system; }), queue.end());
+	sInstance->mDone += (int)(size - queue.size());
+
+	auto isRunning = [system]()
+	{
+		for (auto job : sInstance->mRunning)
+			if (job->system == system)
+				return true;
+
+		return false;
+	};
+
+	if (!isRunning())
+		return;
+
+	for (auto job : sInstance->mRunning)
+		if (job->system == system)
+			job->cancelled = true;
+
+	sInstance->mEvent.notify_all();
+	sInstance->mEvent.wait(lock, [&isRunning]() { return !isRunning(); });
+}
+
+void GamelistMaintenance::packNow(SystemData* system)
+{
+	Job job;
+	job.system = system;
+	job.task = PACK;
+	job.synchronous = true;
+
+	Run run(getInstance(), job);
+	run.execute();
+}
+
+GamelistMaintenance::GamelistMaintenance() : mExit(false), mWindow(nullptr), mNotification(nullptr), mTotal(0), mDone(0), mBudget(GAMELIST_MAINTENANCE_IO_RATE)
+{
+	mBudgetTime = std::chrono::steady_clock::now();
+}
+
+GamelistMaintenance::~GamelistMaintenance()
+{
+	stop();
+}
+
+void GamelistMaintenance::stop()
+{
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+		if (mExit)
+			return;
+
+		mExit = true;
+		mQueue.clear();
+
+		for (auto job : mRunning)
+			job->cancelled = true;
+	}
+
+	mEvent.notify_all();
+
+	for (auto& thread : mThreads)
+		if (thread.joinable())
+			thread.join();
+
+	mThreads.clear();
+
+	if (mNotification != nullptr)
+	{
+		mNotification->close();
+		mNotification = nullptr;
+	}
+}
+
+void GamelistMaintenance::start(Window* window, const std::vector<SystemData*>& systems, Task task, bool notify)
+{
+	std::unique_lock<std::mutex> lock(mLock);
+	if (mExit)
+		return;
+
+	if (mQueue.empty() && mRunning.empty())
+	{
+		mTotal = 0;
+		mDone = 0;
+	}
+
+	mWindow = window;
+
+	for (auto system : systems)
+	{
+		if (!system->isGameSystem() || system->isCollection() || system->getRootFolder() == nullptr)
+			continue;
+
+		if (task == CLEANUP && !Settings::HiddenSystemsShowGames() && !system->isVisible())
+			continue;
+
+		if (std::find_if(mQueue.cbegin(), mQueue.cend(), [system, task](const Job& job) { return job.system == system && job.task == task; }) != mQueue.cend())
+			continue;
+
+		Job job;
+		job.system = system;
+		job.task = task;
+
+		if (task == CLEANUP)
+		{
+			job.games = std::make_shared<std::vector<Game>>();
+
+			for (auto file : system->getRootFolder()->getFilesRecursive(GAME | FOLDER, false, nullptr, false))
+			{
+				Game game;
+				game.path = file->getPath();
+				game.name = file->getDisplayName();
+				game.folder = (file->getType() == FOLDER);
+				job.games->push_back(game);
+			}
+		}
+
+		mQueue.push_back(job);
+		mTotal++;
+	}
+
+	if (mQueue.empty())
+		return;
+
+	if (notify && mNotification == nullptr && mWindow != nullptr)
+	{
+		mNotification = mWindow->createAsyncNotificationComponent();
+		mNotification->updateTitle(_("CLEANING GAMELISTS"));
+	}
+
+	if (mThreads.empty())
+	{
+		int threadCount = std::max(1, std::min(GAMELIST_MAINTENANCE_THREADS, (int)std::thread::hardware_concurrency() / 2));
+		for (int i = 0; i < threadCount; i++)
+			mThreads.push_back(std::thread(&GamelistMaintenance::threadProc, this));
+	}
+
+	mEvent.notify_all();
+}
+
+bool GamelistMaintenance::isRunning()
+{
+	std::unique_lock<std::mutex> lock(mLock);
+	return !mQueue.empty() || !mRunning.empty();
+}
+
+void GamelistMaintenance::threadProc()
+{
+	Tracing::setThreadName("GamelistMaintenance");
+
+	std::unique_lock<std::mutex> lock(mLock);
+
+	while (!mExit)
+	{
+		if (mQueue.empty())
+		{
+			mEvent.wait(lock);
+			continue;
+		}
+
+		Job job = mQueue.front();
+		mQueue.pop_front();
+		mRunning.push_back(&job);
+
+		if (mNotification != nullptr)
+			mNotification->updateText(job.system->getFullName());
+
+		lock.unlock();
+
+		{
+			TRACE_ZONE("GamelistMaintenance::process");
+			process(job);
+		}
+
+		lock.lock();
+
+		mRunning.erase(std::find(mRunning.begin(), mRunning.end(), &job));
+		mDone++;
+
+		if (mNotification != nullptr && mTotal > 0)
+			mNotification->updatePercent(mDone * 100 / mTotal);
+
+		if (mQueue.empty() && mRunning.empty())
+			finished();
+
+		mEvent.notify_all();
+	}
+}
+
+// Called with the lock held, once the queue is done
+void GamelistMaintenance::finished()
+{
+	if (mNotification == nullptr)
+		return;
+
+	mNotification->close();
+	mNotification = nullptr;
+
+	if (!mExit && mWindow != nullptr)
+		mWindow->displayNotificationMessage(_("GAMELISTS CLEANED"));
+}
+
+void GamelistMaintenance::process(Job& job)
+{
+	LOG(LogDebug) << "GamelistMaintenance : " << (job.task == PACK ? "packing " : "cleaning ") << job.system->getName();
+
+	Run run(this, job);
+	run.execute();
+}
+
+// Takes operations from the budget shared by the workers, waits while it's spent or while paused. False when the job is cancelled
+bool GamelistMaintenance::throttle(Job& job, int operations)
+{
+	if (job.synchronous)
+		return !job.cancelled;
+
+	std::unique_lock<std::mutex> lock(mLock);
+
+	while (!job.cancelled && !mExit)
+	{
+		auto now = std::chrono::steady_clock::now();
+
+		mBudget = std::min<double>(GAMELIST_MAINTENANCE_IO_RATE, mBudget + std::chrono::duration<double>(now - mBudgetTime).count() * GAMELIST_MAINTENANCE_IO_RATE);
+		mBudgetTime = now;
+
+		// The budget goes below zero for a large operation : the next ones wait for it
+		if (!sPaused && mBudget > 0)
+		{
+			mBudget -= operations;
+			return true;
+		}
+
+		mEvent.wait_for(lock, std::chrono::milliseconds(50));
+	}
+
+	return false;
+}
+
+// The gamelist is swapped on the UI thread, where the recovery files are saved. False when cancelled or when the gamelist changed
+bool GamelistMaintenance::commit(Job& job, Commit& commit)
+{
+	// packNow runs where the system is loaded, nothing else uses it yet
+	if (job.synchronous)
+		return apply(commit);
+
+	return runOnUiThread(job, [&commit]() { return apply(commit); });
+}
+
+// Waits for func to run on the UI thread. False when cancelled, or when func fails
+bool GamelistMaintenance::runOnUiThread(Job& job, const std::function<bool()>& func)
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	// Without a window, there is no UI thread to wait for
+	Window* window = mWindow;
+	if (window == nullptr)
+	{
+		lock.unlock();
+		return func();
+	}
+
+	UiCall call;
+	call.func = func;
+
+	int id = ++sLastUiCall;
+	mUiCalls[id] = &call;
+	lock.unlock();
+
+	window->postToUiThread([id]() { GamelistMaintenance::runUiCall(id); });
+
+	lock.lock();
+	mEvent.wait(lock, [this, &job, &call]() { return call.done || job.cancelled || mExit; });
+	mUiCalls.erase(id);
+
+	return call.done && call.result;
+}
+
+void GamelistMaintenance::runUiCall(int id)
+{
+	std::unique_lock<std::mutex> instanceLock(sInstanceLock);
+	if (sInstance == nullptr)
+		return;
+
+	std::unique_lock<std::mutex> lock(sInstance->mLock);
+
+	auto it = sInstance->mUiCalls.find(id);
+	if (it == sInstance->mUiCalls.cend())
+		return;
+
+	UiCall* call = it->second;
+	sInstance->mUiCalls.erase(it);
+
+	call->result = call->func();
+	call->done = true;
+
+	sInstance->mEvent.notify_all();
+}
+
+// UI thread : entries of the games missing from the gamelist, in a <gameList> document
+std::string GamelistMaintenance::writeEntries(SystemData* system, const std::vector<Game>& games)
+{
+	std::unordered_map<std::string, FileData*> files;
+	for (auto file : system->getRootFolder()->getFilesRecursive(GAME | FOLDER, false, nullptr, false))
+		files[file->getPath()] = file;
+
+	pugi::xml_document doc;
+	pugi::xml_node root = doc.append_child("gameList");
+
+	for (auto& game : games)
+	{
+		// Removed since the cleanup was queued
+		auto it = files.find(game.path);
+		if (it == files.cend())
+			continue;
+
+		addFileDataNode(root, it->second, game.folder ? "folder" : "game", system);
+	}
+
+	std::stringstream ss;
+	doc.save(ss);
+	return ss.str();
+}
+
+bool GamelistMaintenance::apply(Commit& commit)
+{
+	if (Utils::FileSystem::getFileSize(commit.readPath) != commit.size || Utils::FileSystem::getFileModificationDate(commit.readPath).getTime() != commit.date)
+	{
+		LOG(LogDebug) << "GamelistMaintenance : " << commit.readPath << " changed, the maintenance of " << commit.system->getName() << " is dropped";
+		return false;
+	}
+
+	if (!Utils::FileSystem::replaceFile(commit.temporary, commit.path))
+	{
+		LOG(LogError) << "Error saving gamelist.xml to \"" << commit.path << "\" (for system " << commit.system->getName() << ")!";
+		return false;
+	}
+
+	Utils::FileSystem::syncDirectory(Utils::FileSystem::getParent(commit.path));
+
+	commit.size = Utils::FileSystem::getFileSize(commit.path);
+	commit.date = Utils::FileSystem::getFileModificationDate(commit.path).getTime();
+
+	// The recovery files refer to the size of the gamelist : the changes not in the gamelist yet are saved again
+	commit.system->setGamelistHash(commit.size);
+
+	for (auto file : commit.system->getRootFolder()->getFilesRecursive(GAME | FOLDER, false, nullptr, false))
+		if (file->getSystem() == commit.system && file->getMetadata().wasChanged())
+			saveToGamelistRecovery(file);
+
+	LOG(LogInfo) << "GamelistMaintenance : " << commit.path << " saved";
+	return true;
+}
@@ -0,0 +1,153 @@
+#pragma once
+#ifndef ES_APP_GAMELIST_MAINTENANCE_H
+#define ES_APP_GAMELIST_MAINTENANCE_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <atomic>
+#include <memory>
+#include <functional>
+
+class SystemData;
+class Window;
+class AsyncNotificationComponent;
+
+// Packs & cleans gamelists in the background : entries of missing games and paths to missing medias are removed, cleaning also resolves
+// the missing medias, adds the games missing from the gamelist & removes the unknown medias. Systems are processed in parallel, and every
+// file operation is taken from a shared budget ( GAMELIST_MAINTENANCE_IO_RATE per second ) so the UI & a running game keep the storage.
+// The progress of each system is kept in a state file : the generation stamp ( size & date ) of the gamelist, the dates of the rom folders
+// and the hashes of the entries found valid. A system whose stamps are unchanged is skipped, otherwise only the entries whose hash is
+// unknown are checked, unless a rom folder changed. Interrupted systems resume from their last checkpoint.
+// The packed gamelist is swapped on the UI thread, which also rewrites the recovery files against it. The workers never read FileData : the games
+// to clean are listed when the cleanup is queued, and the entries of the games missing from the gamelist are written on the UI thread.
+class GamelistMaintenance
+{
+public:
+	enum Task : unsigned int
+	{
+		PACK = 1,
+		CLEANUP = 2
+	};
+
+	static GamelistMaintenance* getInstance();
+
+	// Stops the workers, the systems being processed save their progress
+	static void deinit();
+
+	// Drops the maintenance of a system, and waits if it's running : updateGamelist is about to write the gamelist
+	static void cancel(SystemData* system);
+
+	// Packs a system on the calling thread, before its gamelist is parsed : when the gamelist is trusted, the entries of missing games would be loaded
+	static void packNow(SystemData* system);
+
+	// While a game runs
+	static void pause() { sPaused = true; }
+	static void resume() { sPaused = false; }
+
+	// Queues the systems. With notify, the progress is displayed & a message tells when it's done. UI thread
+	void start(Window* window, const std::vector<SystemData*>& systems, Task task, bool notify = false);
+
+	bool isRunning();
+
+private:
+	GamelistMaintenance();
+	~GamelistMaintenance();
+
+	// Game or folder of a system, read on the UI thread when a cleanup is queued
+	struct Game
+	{
+		std::string	path;
+		std::string	name;	// display name, the medias are named after it
+		bool		folder;
+	};
+
+	struct Job
+	{
+		Job() : system(nullptr), task(PACK), synchronous(false), cancelled(false) { }
+		Job(const Job& job) : system(job.system), task(job.task), games(job.games), synchronous(job.synchronous), cancelled(job.cancelled.load()) { }
+
+		Job& operator=(const Job& job)
+		{
+			system = job.system;
+			task = job.task;
+			games = job.games;
+			synchronous = job.synchronous;
+			cancelled = job.cancelled.load();
+			return *this;
+		}
+
+		SystemData*			system;
+		Task				task;
+		std::shared_ptr<std::vector<Game>>	games;	// CLEANUP
+		bool				synchronous;	// packNow : not throttled, committed on the calling thread
+		std::atomic<bool>	cancelled;
+	};
+
+	struct Commit
+	{
+		Commit() : system(nullptr), size(0), date(0), done(false), result(false) { }
+
+		SystemData*	system;
+		std::string	temporary;
+		std::string	path;
+		std::string	readPath;
+		size_t		size;		// stamp of the gamelist that was read
+		time_t		date;
+		bool		done;
+		bool		result;
+	};
+
+	// Function run on the UI thread for a worker
+	struct UiCall
+	{
+		UiCall() : done(false), result(false) { }
+
+		std::function<bool()>	func;
+		bool					done;
+		bool					result;
+	};
+
+	class Run;
+
+	void threadProc();
+	void process(Job& job);
+	void finished();
+	void stop();
+
+	bool throttle(Job& job, int operations);
+	bool commit(Job& job, Commit& commit);
+	bool runOnUiThread(Job& job, const std::function<bool()>& func);
+
+	static void runUiCall(int id);
+	static bool apply(Commit& commit);
+	static std::string writeEntries(SystemData* system, const std::vector<Game>& games);
+
+	static GamelistMaintenance* sInstance;
+	static std::atomic<bool> sPaused;
+
+	std::deque<Job>				mQueue;
+	std::vector<Job*>			mRunning;
+	std::map<int, UiCall*>		mUiCalls;	// waiting for the UI thread
+
+	std::vector<std::thread>	mThreads;
+	std::mutex					mLock;
+	std::condition_variable		mEvent;
+	bool						mExit;
+
+	Window*							mWindow;
+	AsyncNotificationComponent*		mNotification;
+	int								mTotal;
+	int								mDone;
+
+	double									mBudget;	// I/O operations
+	std::chrono::steady_clock::time_point	mBudgetTime;
+};
+
+#endif // ES_APP_GAMELIST_MAINTENANCE_H
@@ -0,0 +1,548 @@
+#include "GamelistReader.h"
+
+#include <algorithm>
+#include <cstring>
+
+#define IS_WHITESPACE(c) (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+#define MAX_DEPTH 64
+
+static inline bool startsWith(const char* pos, const char* end, const char* str)
+{
+	size_t length = strlen(str);
+	return (size_t)(end - pos) >= length && memcmp(pos, str, length) == 0;
+}
+
+static inline char* find(char* pos, char* end, const char* str)
+{
+	return std::search(pos, end, str, str + strlen(str));
+}
+
+static char* encodeUtf8(unsigned long code, char* out)
+{
+	if (code < 0x80)
+		*out++ = (char)code;
+	else if (code < 0x800)
+	{
+		*out++ = (char)(0xC0 | (code >> 6));
+		*out++ = (char)(0x80 | (code & 0x3F));
+	}
+	else if (code < 0x10000)
+	{
+		*out++ = (char)(0xE0 | (code >> 12));
+		*out++ = (char)(0x80 | ((code >> 6) & 0x3F));
+		*out++ = (char)(0x80 | (code & 0x3F));
+	}
+	else
+	{
+		*out++ = (char)(0xF0 | (code >> 18));
+		*out++ = (char)(0x80 | ((code >> 12) & 0x3F));
+		*out++ = (char)(0x80 | ((code >> 6) & 0x3F));
+		*out++ = (char)(0x80 | (code & 0x3F));
+	}
+
+	return out;
+}
+
+// Character of the entity at in ( on '&' ), unknown entities are left as they are. The decoded text is never longer than the entity
+static char* decodeEntity(char*& in, char* end, char* out)
+{
+	char* semicolon = in + 1;
+	while (semicolon < end && semicolon - in < 12 && *semicolon != ';')
+		semicolon++;
+
+	if (semicolon >= end || *semicolon != ';')
+	{
+		*out++ = *in++;
+		return out;
+	}
+
+	const char* name = in + 1;
+	size_t length = semicolon - name;
+
+	char c = 0;
+
+	if (length == 2 && name[0] == 'l' && name[1] == 't')
+		c = '<';
+	else if (length == 2 && name[0] == 'g' && name[1] == 't')
+		c = '>';
+	else if (length == 3 && memcmp(name, "amp", 3) == 0)
+		c = '&';
+	else if (length == 4 && memcmp(name, "quot", 4) == 0)
+		c = '"';
+	else if (length == 4 && memcmp(name, "apos", 4) == 0)
+		c = '\'';
+	else if (length >= 2 && name[0] == '#')
+	{
+		bool hex = (name[1] == 'x');
+
+		unsigned long code = 0;
+		bool valid = length > (hex ? 2 : 1);
+
+		for (const char* digit = name + (hex ? 2 : 1); digit < semicolon && valid; digit++)
+		{
+			if (*digit >= '0' && *digit <= '9')
+				code = code * (hex ? 16 : 10) + (*digit - '0');
+			else if (hex && *digit >= 'a' && *digit <= 'f')
+				code = code * 16 + (*digit - 'a' + 10);
+			else if (hex && *digit >= 'A' && *digit <= 'F')
+				code = code * 16 + (*digit - 'A' + 10);
+			else
+				valid = false;
+
+			if (code > 0x10FFFF)
+				valid = false;
+		}
+
+		if (valid && code != 0)
+		{
+			in = semicolon + 1;
+			return encodeUtf8(code, out);
+		}
+	}
+
+	if (c == 0)
+	{
+		*out++ = *in++;
+		return out;
+	}
+
+	in = semicolon + 1;
+	*out++ = c;
+	return out;
+}
+
+// Decodes [in, end) to out, which may be in : entities, line endings, and whitespaces of attributes like pugixml does
+static char* decode(char* in, char* end, char* out, bool entities, bool attribute)
+{
+	while (in < end)
+	{
+		char c = *in;
+
+		if (c == '\r')
+		{
+			in++;
+			if (in < end && *in == '\n')
+				in++;
+
+			*out++ = attribute ? ' ' : '\n';
+		}
+		else if (attribute && (c == '\n' || c == '\t'))
+		{
+			in++;
+			*out++ = ' ';
+		}
+		else if (c == '&' && entities)
+			out = decodeEntity(in, end, out);
+		else
+		{
+			in++;
+			*out++ = c;
+		}
+	}
+
+	return out;
+}
+
+bool GamelistReader::Span::equals(const char* str) const
+{
+	size_t len = strlen(str);
+	return len == length && memcmp(data, str, len) == 0;
+}
+
+const GamelistReader::Element* GamelistReader::Entry::findElement(const char* name) const
+{
+	for (auto& element : elements)
+		if (element.name.equals(name))
+			return &element;
+
+	return nullptr;
+}
+
+const GamelistReader::Attribute* GamelistReader::Entry::findAttribute(const Element& element, const char* name) const
+{
+	for (size_t i = element.firstAttribute; i < element.firstAttribute + element.attributeCount; i++)
+		if (attributes[i].name.equals(name))
+			return &attributes[i];
+
+	return nullptr;
+}
+
+GamelistReader::GamelistReader(char* data, size_t size) : mData(data), mPos(data), mEnd(data + size), mRootDone(false), mDepth(0)
+{
+	// UTF-8 BOM
+	if (size >= 3 && (unsigned char)data[0] == 0xEF && (unsigned char)data[1] == 0xBB && (unsigned char)data[2] == 0xBF)
+		mPos += 3;
+}
+
+bool GamelistReader::canRead(const char* data, size_t size)
+{
+	// UTF-16 & 32 : a BOM, or zeroes next to the first '<'
+	if (size >= 2 && (((unsigned char)data[0] == 0xFF && (unsigned char)data[1] == 0xFE) || ((unsigned char)data[0] == 0xFE && (unsigned char)data[1] == 0xFF)))
+		return false;
+
+	for (size_t i = 0; i < size && i < 4; i++)
+		if (data[i] == 0)
+			return false;
+
+	const char* pos = data;
+	const char* end = data + size;
+
+	if (size >= 3 && (unsigned char)data[0] == 0xEF && (unsigned char)data[1] == 0xBB && (unsigned char)data[2] == 0xBF)
+		pos += 3;
+
+	if (!startsWith(pos, end, "<?xml"))
+		return true;
+
+	// Values are not converted : only UTF-8 ( or ASCII ) declarations can be read
+	const char* close = std::search(pos, end, "?>", "?>" + 2);
+	const char* encoding = std::search(pos, close, "encoding", "encoding" + 8);
+	if (encoding == close)
+		return true;
+
+	const char* quote = std::find_if(encoding, close, [](char c) { return c == '"' || c == '\''; });
+	if (quote == close)
+		return true;
+
+	const char* value = quote + 1;
+	const char* valueEnd = std::find(value, close, *quote);
+
+	std::string name(value, valueEnd);
+	std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+
+	return name == "utf-8" || name == "utf8" || name == "us-ascii" || name == "ascii";
+}
+
+bool GamelistReader::setError(const char* error)
+{
+	if (mError.empty())
+		mError = std::string(error) + " at offset " + std::to_string(std::min(mPos, mEnd) - mData);
+
+	mPos = mEnd;
+	return false;
+}
+
+void GamelistReader::skipWhitespaces()
+{
+	while (mPos < mEnd && IS_WHITESPACE(*mPos))
+		mPos++;
+}
+
+// Comment, CDATA, processing instruction or doctype at mPos
+bool GamelistReader::isMarkup() const
+{
+	return mPos + 1 < mEnd && (mPos[1] == '!' || mPos[1] == '?');
+}
+
+bool GamelistReader::skipMarkup()
+{
+	const char* close = nullptr;
+
+	if (startsWith(mPos, mEnd, "<!--"))
+		close = "-->";
+	else if (startsWith(mPos, mEnd, "<![CDATA["))
+		close = "]]>";
+	else if (startsWith(mPos, mEnd, "<?"))
+		close = "?>";
+	else if (startsWith(mPos, mEnd, "<!DOCTYPE"))
+	{
+		// The internal subset may contain '>'
+		int depth = 0;
+		char* pos = mPos + 9;
+		while (pos < mEnd && (*pos != '>' || depth > 0))
+		{
+			if (*pos == '[')
+				depth++;
+			else if (*pos == ']')
+				depth--;
+
+			pos++;
+		}
+
+		if (pos >= mEnd)
+			return setError("unexpected end of file");
+
+		mPos = pos + 1;
+		return true;
+	}
+	else
+		return setError("invalid markup");
+
+	char* pos = find(mPos, mEnd, close);
+	if (pos == mEnd)
+		return setError("unexpected end of file");
+
+	mPos = pos + strlen(close);
+	return true;
+}
+
+bool GamelistReader::readName(Span& name)
+{
+	char* start = mPos;
+	while (mPos < mEnd && !IS_WHITESPACE(*mPos) && *mPos != '>' && *mPos != '/' && *mPos != '=' && *mPos != '<')
+		mPos++;
+
+	if (mPos >= mEnd)
+		return setError("unexpected end of file");
+
+	if (mPos == start)
+		return setError("invalid name");
+
+	name.data = start;
+	name.length = mPos - start;
+	return true;
+}
+
+// At '<'
+bool GamelistReader::readStartTag(Span& name, std::vector<Attribute>& attributes, bool& empty)
+{
+	mPos++;
+
+	if (!readName(name))
+		return false;
+
+	while (true)
+	{
+		skipWhitespaces();
+
+		if (mPos >= mEnd)
+			return setError("unexpected end of file");
+
+		if (*mPos == '>')
+		{
+			mPos++;
+			empty = false;
+			return true;
+		}
+
+		if (*mPos == '/')
+		{
+			if (mPos + 1 >= mEnd || mPos[1] != '>')
+				return setError("invalid start tag");
+
+			mPos += 2;
+			empty = true;
+			return true;
+		}
+
+		Attribute attribute;
+		if (!readName(attribute.name))
+			return false;
+
+		skipWhitespaces();
+		if (mPos >= mEnd || *mPos != '=')
+			return setError("invalid attribute");
+
+		mPos++;
+
+		skipWhitespaces();
+		if (mPos >= mEnd || (*mPos != '"' && *mPos != '\''))
+			return setError("invalid attribute");
+
+		char* value = mPos + 1;
+		char* close = (char*)memchr(value, *mPos, mEnd - value);
+		if (close == nullptr)
+			return setError("unexpected end of file");
+
+		attribute.value.data = value;
+		attribute.value.length = decode(value, close, value, true, true) - value;
+		attributes.push_back(attribute);
+
+		mPos = close + 1;
+	}
+}
+
+// At "</"
+bool GamelistReader::readEndTag(const Span& name)
+{
+	mPos += 2;
+
+	Span endName;
+	if (!readName(endName))
+		return false;
+
+	if (endName.length != name.length || memcmp(endName.data, name.data, name.length) != 0)
+		return setError("mismatched end tag");
+
+	skipWhitespaces();
+	if (mPos >= mEnd || *mPos != '>')
+		return setError("invalid end tag");
+
+	mPos++;
+	return true;
+}
+
+// Content of an element up to its end tag : pieces of text & CDATA are joined, deeper elements are skipped
+bool GamelistReader::readText(const Span& name, Span& text)
+{
+	if (++mDepth > MAX_DEPTH)
+		return setError("elements nested too deeply");
+
+	char* out = mPos;
+	text.data = out;
+	text.length = 0;
+
+	while (true)
+	{
+		char* lt = (char*)memchr(mPos, '<', mEnd - mPos);
+		if (lt == nullptr)
+			return setError("unexpected end of file");
+
+		out = decode(mPos, lt, out, true, false);
+		mPos = lt;
+
+		if (startsWith(mPos, mEnd, "<![CDATA["))
+		{
+			char* cdata = mPos + 9;
+			char* close = find(cdata, mEnd, "]]>");
+			if (close == mEnd)
+				return setError("unexpected end of file");
+
+			out = decode(cdata, close, out, false, false);
+			mPos = close + 3;
+		}
+		else if (startsWith(mPos, mEnd, "</"))
+		{
+			// Whitespaces only is no text, like pugixml
+			for (const char* c = text.data; c < out; c++)
+			{
+				if (!IS_WHITESPACE(*c))
+				{
+					text.length = out - text.data;
+					break;
+				}
+			}
+
+			mDepth--;
+			return readEndTag(name);
+		}
+		else if (isMarkup())
+		{
+			if (!skipMarkup())
+				return false;
+		}
+		else
+		{
+			Span childName;
+			Span childText;
+			bool empty;
+
+			if (!readStartTag(childName, mSkipped, empty))
+				return false;
+
+			mSkipped.clear();
+
+			if (!empty && !readText(childName, childText))
+				return false;
+		}
+	}
+}
+
+bool GamelistReader::readRoot(const char* name)
+{
+	while (true)
+	{
+		skipWhitespaces();
+
+		if (mPos >= mEnd)
+			return setError("no root element");
+
+		if (*mPos != '<')
+			return setError("text outside of the root element");
+
+		if (!isMarkup())
+			break;
+
+		if (!skipMarkup())
+			return false;
+	}
+
+	bool empty;
+	if (!readStartTag(mRootName, mRootAttributes, empty))
+		return false;
+
+	mRootDone = empty;
+	return mRootName.equals(name);
+}
+
+const GamelistReader::Span* GamelistReader::getRootAttribute(const char* name) const
+{
+	for (auto& attribute : mRootAttributes)
+		if (attribute.name.equals(name))
+			return &attribute.value;
+
+	return nullptr;
+}
+
+bool GamelistReader::readEntry(Entry& entry)
+{
+	entry.name = Span();
+	entry.attributes.clear();
+	entry.attributeCount = 0;
+	entry.elements.clear();
+
+	while (!mRootDone && !hasError())
+	{
+		// Text of the root is ignored
+		char* lt = (char*)memchr(mPos, '<', mEnd - mPos);
+		if (lt == nullptr)
+			return setError("unexpected end of file");
+
+		mPos = lt;
+
+		if (startsWith(mPos, mEnd, "</"))
+		{
+			mRootDone = true;
+			readEndTag(mRootName);
+			return false;
+		}
+
+		if (isMarkup())
+		{
+			skipMarkup();
+			continue;
+		}
+
+		bool empty;
+		if (!readStartTag(entry.name, entry.attributes, empty))
+			return false;
+
+		entry.attributeCount = entry.attributes.size();
+		if (empty)
+			return true;
+
+		while (true)
+		{
+			lt = (char*)memchr(mPos, '<', mEnd - mPos);
+			if (lt == nullptr)
+				return setError("unexpected end of file");
+
+			mPos = lt;
+
+			if (startsWith(mPos, mEnd, "</"))
+				return readEndTag(entry.name);
+
+			if (isMarkup())
+			{
+				if (!skipMarkup())
+					return false;
+
+				continue;
+			}
+
+			Element element;
+			element.firstAttribute = entry.attributes.size();
+
+			if (!readStartTag(element.name, entry.attributes, empty))
+				return false;
+
+			element.attributeCount = entry.attributes.size() - element.firstAttribute;
+
+			if (!empty && !readText(element.name, element.text))
+				return false;
+
+			entry.elements.push_back(element);
+		}
+	}
+
+	return false;
+}
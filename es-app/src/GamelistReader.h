@@ -0,0 +1,96 @@
+#pragma once
+#ifndef ES_APP_GAMELIST_READER_H
+#define ES_APP_GAMELIST_READER_H
+
+#include <string>
+#include <vector>
+
+// Forward-only reader of gamelist files, used instead of a pugixml document to load them : no tree is built, the text is decoded in place
+// in the caller's buffer, and a single entry ( child of the root element ) is held at once, its elements being kept one level deep.
+// Reads what gamelists are made of : attributes, the predefined & numeric entities, CDATA sections, comments, processing instructions
+// & doctype ( skipped ). Only UTF-8 is read, see canRead.
+class GamelistReader
+{
+public:
+	struct Span
+	{
+		Span() : data(nullptr), length(0) { }
+
+		const char*	data;
+		size_t		length;
+
+		bool equals(const char* str) const;
+		std::string str() const { return std::string(data, length); }
+	};
+
+	struct Attribute
+	{
+		Span name;
+		Span value;
+	};
+
+	struct Element
+	{
+		Element() : firstAttribute(0), attributeCount(0) { }
+
+		Span	name;
+		Span	text;
+		size_t	firstAttribute;
+		size_t	attributeCount;
+	};
+
+	struct Entry
+	{
+		Entry() : attributeCount(0) { }
+
+		Span					name;
+		std::vector<Attribute>	attributes;		// the entry's own first, then the ones of its elements
+		size_t					attributeCount;	// the entry's own
+		std::vector<Element>	elements;
+
+		const Element* findElement(const char* name) const;
+		const Attribute* findAttribute(const Element& element, const char* name) const;
+	};
+
+	GamelistReader(char* data, size_t size);
+
+	// False when the data is not UTF-8 ( UTF-16 or 32, or another encoding in the XML declaration ), pugixml has to be used
+	static bool canRead(const char* data, size_t size);
+
+	// Moves into the root element. False when it's missing, or named otherwise
+	bool readRoot(const char* name);
+	const Span* getRootAttribute(const char* name) const;
+
+	// Reads the next child of the root element. False at the end of the root element, or on error
+	bool readEntry(Entry& entry);
+
+	bool hasError() const { return !mError.empty(); }
+	const std::string& getError() const { return mError; }
+
+private:
+	bool setError(const char* error);
+
+	void skipWhitespaces();
+	bool skipMarkup();
+	bool isMarkup() const;
+
+	bool readName(Span& name);
+	bool readStartTag(Span& name, std::vector<Attribute>& attributes, bool& empty);
+	bool readEndTag(const Span& name);
+	bool readText(const Span& name, Span& text);
+
+	char*	mData;
+	char*	mPos;
+	char*	mEnd;
+
+	Span					mRootName;
+	std::vector<Attribute>	mRootAttributes;
+	bool					mRootDone;
+
+	std::vector<Attribute>	mSkipped;	// attributes of the elements deeper than the entries
+	int						mDepth;
+
+	std::string				mError;
+};
+
+#endif // ES_APP_GAMELIST_READER_H
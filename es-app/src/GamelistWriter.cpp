@@ -0,0 +1,308 @@
+#include "GamelistWriter.h"
+#include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+#include "Log.h"
+#include "Tracing.h"
+
+#include <pugixml/src/pugixml.hpp>
+#include <set>
+#include <vector>
+
+#define GAMELIST_WRITE_DELAY		2000 // ms after the last change of a system
+#define GAMELIST_WRITE_MAX_DELAY	10000 // ms after its first pending change
+
+GamelistWriter* GamelistWriter::sInstance = nullptr;
+
+static std::mutex sInstanceLock;
+
+GamelistWriter* GamelistWriter::getInstance()
+{
+	std::unique_lock<std::mutex> lock(sInstanceLock);
+
+	if (sInstance == nullptr)
+		sInstance = new GamelistWriter();
+
+	return sInstance;
+}
+
+void GamelistWriter::deinit()
+{
+	std::unique_lock<std::mutex> lock(sInstanceLock);
+
+	if (sInstance != nullptr)
+		sInstance->stop();
+}
+
+void GamelistWriter::discard(SystemData* system)
+{
+	std::unique_lock<std::mutex> instanceLock(sInstanceLock);
+
+	if (sInstance == nullptr)
+		return;
+
+	std::unique_lock<std::mutex> lock(sInstance->mLock);
+
+	auto it = sInstance->mPending.find(system);
+	if (it != sInstance->mPending.end())
+	{
+		sInstance->mStats.discarded += it->second.files.size();
+		sInstance->mPending.erase(it);
+	}
+
+	sInstance->mDone.wait(lock, []() { return !sInstance->mWriting; });
+}
+
+GamelistWriter::GamelistWriter() : mWriting(false), mFlushRequests(0), mExit(false), mDelay(GAMELIST_WRITE_DELAY), mMaxDelay(GAMELIST_WRITE_MAX_DELAY)
+{
+}
+
+void GamelistWriter::stop()
+{
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+		if (mExit)
+			return;
+
+		mExit = true;
+
+		if (mPending.size())
+			LOG(LogDebug) << "GamelistWriter : dropping the pending files of " << mPending.size() << " systems";
+
+		mPending.clear();
+	}
+
+	mEvent.notify_all();
+	mDone.notify_all();
+
+	if (mThread.joinable())
+		mThread.join();
+}
+
+void GamelistWriter::setDelays(int delay, int maxDelay)
+{
+	std::unique_lock<std::mutex> lock(mLock);
+	mDelay = delay;
+	mMaxDelay = maxDelay;
+}
+
+void GamelistWriter::save(SystemData* system, const std::string& path, const std::string& xml)
+{
+	Pending pending;
+	pending.xml = xml;
+	queue(system, path, pending);
+}
+
+void GamelistWriter::remove(SystemData* system, const std::string& path)
+{
+	Pending pending;
+	pending.remove = true;
+	queue(system, path, pending);
+}
+
+void GamelistWriter::queue(SystemData* system, const std::string& path, Pending& pending)
+{
+	auto now = std::chrono::steady_clock::now();
+
+	std::unique_lock<std::mutex> lock(mLock);
+	if (mExit)
+		return;
+
+	mStats.queued++;
+
+	auto it = mPending.find(system);
+	if (it == mPending.end())
+	{
+		it = mPending.insert(std::make_pair(system, PendingSystem())).first;
+		it->second.first = now;
+	}
+
+	it->second.last = now;
+
+	auto file = it->second.files.find(path);
+	if (file != it->second.files.end())
+	{
+		mStats.coalesced++;
+		file->second = std::move(pending);
+	}
+	else
+		it->second.files[path] = std::move(pending);
+
+	if (!mThread.joinable())
+		mThread = std::thread(&GamelistWriter::threadProc, this);
+
+	mEvent.notify_one();
+}
+
+void GamelistWriter::flush()
+{
+	std::unique_lock<std::mutex> lock(mLock);
+	if (mExit || (mPending.empty() && !mWriting))
+		return;
+
+	mFlushRequests++;
+	mEvent.notify_one();
+
+	mDone.wait(lock, [this]() { return mExit || (mPending.empty() && !mWriting); });
+	mFlushRequests--;
+}
+
+void GamelistWriter::threadProc()
+{
+	Tracing::setThreadName("GamelistWriter");
+
+	std::unique_lock<std::mutex> lock(mLock);
+
+	while (!mExit)
+	{
+		auto now = std::chrono::steady_clock::now();
+		auto next = std::chrono::steady_clock::time_point::max();
+
+		// Recovery files of different systems never collide
+		std::map<std::string, Pending> batch;
+
+		for (auto it = mPending.begin(); it != mPending.end(); )
+		{
+			auto due = std::min(it->second.last + std::chrono::milliseconds(mDelay), it->second.first + std::chrono::milliseconds(mMaxDelay));
+			if (mFlushRequests == 0 && due > now)
+			{
+				next = std::min(next, due);
+				it++;
+				continue;
+			}
+
+			for (auto& file : it->second.files)
+				batch[file.first] = std::move(file.second);
+
+			it = mPending.erase(it);
+		}
+
+		if (batch.empty())
+		{
+			if (next == std::chrono::steady_clock::time_point::max())
+				mEvent.wait(lock);
+			else
+				mEvent.wait_until(lock, next);
+
+			continue;
+		}
+
+		mWriting = true;
+		lock.unlock();
+
+		Stats stats;
+
+		{
+			TRACE_ZONE("GamelistWriter::writeBatch");
+			writeBatch(batch, stats);
+		}
+
+		lock.lock();
+		mWriting = false;
+
+		mStats.written += stats.written;
+		mStats.removed += stats.removed;
+		mStats.failed += stats.failed;
+		mStats.syncs += stats.syncs;
+		mStats.bytes += stats.bytes;
+		mStats.batches++;
+
+		mDone.notify_all();
+	}
+}
+
+void GamelistWriter::writeBatch(std::map<std::string, Pending>& batch, Stats& stats)
+{
+	std::vector<std::pair<std::string, std::string>> renames; // temporary file -> recovery file
+	std::set<std::string> folders;
+
+	for (auto& file : batch)
+	{
+		std::string path = Utils::FileSystem::getCanonicalPath(file.first);
+
+		if (file.second.remove)
+		{
+			if (Utils::FileSystem::exists(path) && Utils::FileSystem::removeFile(path))
+				stats.removed++;
+
+			continue;
+		}
+
+		std::string folder = Utils::FileSystem::getParent(path);
+		if (folders.find(folder) == folders.cend() && !Utils::FileSystem::exists(folder))
+			Utils::FileSystem::createDirectory(folder);
+
+		std::string temporary = path + ".tmp";
+		if (!Utils::FileSystem::writeAllTextSynced(temporary, file.second.xml))
+		{
+			LOG(LogError) << "GamelistWriter : unable to write " << temporary;
+			Utils::FileSystem::removeFile(temporary);
+			stats.failed++;
+			continue;
+		}
+
+		stats.syncs++;
+		stats.bytes += file.second.xml.size();
+
+		renames.push_back(std::make_pair(temporary, path));
+		folders.insert(folder);
+	}
+
+	// Every file is synced before the first rename : a crash leaves recovery files of the same batch, or of the former one
+	for (auto& rename : renames)
+	{
+		if (Utils::FileSystem::replaceFile(rename.first, rename.second))
+			stats.written++;
+		else
+		{
+			LOG(LogError) << "GamelistWriter : unable to replace " << rename.second;
+			Utils::FileSystem::removeFile(rename.first);
+			stats.failed++;
+		}
+	}
+
+	for (auto& folder : folders)
+	{
+		Utils::FileSystem::syncDirectory(folder);
+		stats.syncs++;
+	}
+}
+
+bool GamelistWriter::saveDocument(pugi::xml_document& doc, const std::string& path)
+{
+	// A linked gamelist is replaced where it lives, the link is kept
+	std::string target = path;
+	for (int i = 0; i < 8 && Utils::FileSystem::isSymlink(target); i++)
+	{
+		std::string resolved = Utils::FileSystem::resolveSymlink(target);
+		if (resolved.empty() || resolved == target)
+			break;
+
+		target = resolved;
+	}
+
+	std::string temporary = target + ".tmp";
+
+	if (!doc.save_file(WINSTRINGW(temporary).c_str()) || !Utils::FileSystem::syncFile(temporary))
+	{
+		Utils::FileSystem::removeFile(temporary);
+		return false;
+	}
+
+	if (Utils::FileSystem::replaceFile(temporary, target))
+	{
+		Utils::FileSystem::syncDirectory(Utils::FileSystem::getParent(target));
+		return true;
+	}
+
+	// Some shares ( CIFS/SMB ) refuse to rename over an existing file : write in place, as before atomic saves
+	LOG(LogWarning) << "GamelistWriter : unable to replace " << target << ", writing it in place";
+	Utils::FileSystem::removeFile(temporary);
+
+	return doc.save_file(WINSTRINGW(target).c_str()) && Utils::FileSystem::syncFile(target);
+}
+
+GamelistWriter::Stats GamelistWriter::getStats()
+{
+	std::unique_lock<std::mutex> lock(mLock);
+	return mStats;
+}
@@ -0,0 +1,108 @@
+#pragma once
+#ifndef ES_APP_GAMELIST_WRITER_H
+#define ES_APP_GAMELIST_WRITER_H
+
+#include <string>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+class SystemData;
+
+namespace pugi
+{
+	class xml_document;
+}
+
+// Recovery files of the games whose metadata changed ( play count & time, scraping, hashes... ), written on a background thread instead of
+// the thread that made the change. Changes are coalesced per system & per game : a system is written GAMELIST_WRITE_DELAY after its last
+// change, and no later than GAMELIST_WRITE_MAX_DELAY after its first pending one. A batch writes & syncs temporary files, renames them over
+// the recovery files, and syncs each folder once : a crash leaves either the former or the new file, never a truncated one.
+class GamelistWriter
+{
+public:
+	static GamelistWriter* getInstance();
+
+	// Stops the worker once the batch being written is done. Pending files are dropped, updateGamelist writes the gamelists on exit
+	static void deinit();
+
+	// Drops the pending files of a system, and waits for the batch being written : updateGamelist is about to write the whole gamelist
+	static void discard(SystemData* system);
+
+	// Queues the recovery file of a game, serialized by the caller. The latest content wins
+	void save(SystemData* system, const std::string& path, const std::string& xml);
+
+	// Queues the removal of a recovery file
+	void remove(SystemData* system, const std::string& path);
+
+	// Writes the pending files now, returns once they're written
+	void flush();
+
+	// Debounce delays in ms, GAMELIST_WRITE_DELAY & GAMELIST_WRITE_MAX_DELAY by default
+	void setDelays(int delay, int maxDelay);
+
+	// Saves a document through a synced temporary file renamed over the file
+	static bool saveDocument(pugi::xml_document& doc, const std::string& path);
+
+	struct Stats
+	{
+		Stats() : queued(0), coalesced(0), discarded(0), written(0), removed(0), failed(0), batches(0), syncs(0), bytes(0) { }
+
+		int queued;		// calls to save & remove
+		int coalesced;	// changes replaced by a later one before being written
+		int discarded;
+		int written;
+		int removed;
+		int failed;
+		int batches;
+		int syncs;		// files & folders synced
+		unsigned long long bytes;
+	};
+
+	Stats getStats();
+
+private:
+	GamelistWriter();
+
+	struct Pending
+	{
+		Pending() : remove(false) { }
+
+		bool		remove;
+		std::string	xml;
+	};
+
+	struct PendingSystem
+	{
+		std::map<std::string, Pending>			files; // by recovery file
+		std::chrono::steady_clock::time_point	first;
+		std::chrono::steady_clock::time_point	last;
+	};
+
+	void queue(SystemData* system, const std::string& path, Pending& pending);
+	void threadProc();
+	void stop();
+
+	static void writeBatch(std::map<std::string, Pending>& batch, Stats& stats);
+
+	static GamelistWriter* sInstance;
+
+	std::map<SystemData*, PendingSystem>	mPending;
+
+	std::thread					mThread;
+	std::mutex					mLock;
+	std::condition_variable		mEvent;		// changes queued
+	std::condition_variable		mDone;		// batch written
+	bool						mWriting;
+	int							mFlushRequests;
+	bool						mExit;
+
+	int							mDelay;
+	int							mMaxDelay;
+
+	Stats						mStats;
+};
+
+#endif // ES_APP_GAMELIST_WRITER_H
@@ -9,14 +9,72 @@
 #include "Settings.h"
 #include "FileData.h"
 #include "ImageIO.h"
+#include <cstring>
+#include <bitset>
+
+// Bit of MetaDataList::mPresent telling the value offsets take 4 bytes, for entries over 64 KB
+#define VALUES_WIDE_OFFSETS 63
+static_assert(MetaDataIdCount <= VALUES_WIDE_OFFSETS, "MetaDataList::mPresent needs a bit per id");
 
 std::vector<MetaDataDecl> MetaDataList::mMetaDataDecls;
+std::atomic<unsigned int> MetaDataList::sGlobalRevision(0);
 
 static std::map<MetaDataId, int> mMetaDataIndexes;
 static std::string* mDefaultGameMap = nullptr;
 static MetaDataType* mGameTypeMap = nullptr;
 static std::map<std::string, MetaDataId> mGameIdMap;
 
+// Perfect hash of the keys : a gamelist tag is mapped to its declaration with a single probe, no string is built
+static std::vector<int> mKeySlots;
+static unsigned int mKeySeed = 0;
+static unsigned int mKeyMask = 0;
+
+static inline unsigned int hashKey(const char* key, size_t length, unsigned int seed)
+{
+	unsigned int hash = 2166136261u ^ (seed * 0x9E3779B9u);
+	for (size_t i = 0; i < length; i++)
+		hash = (hash ^ (unsigned char)key[i]) * 16777619u;
+
+	return hash ^ (hash >> 16);
+}
+
+static void buildKeySlots(const std::vector<MetaDataDecl>& decls)
+{
+	unsigned int size = 16;
+	while (size < decls.size() * 4)
+		size <<= 1;
+
+	std::vector<int> slots;
+
+	while (true)
+	{
+		for (unsigned int seed = 0; seed < 4096; seed++)
+		{
+			slots.assign(size, -1);
+
+			bool collision = false;
+			for (int i = 0; i < decls.size() && !collision; i++)
+			{
+				int& slot = slots[hashKey(decls[i].key.c_str(), decls[i].key.size(), seed) & (size - 1)];
+				if (slot >= 0 && decls[slot].key != decls[i].key)
+					collision = true;
+				else
+					slot = i; // Same as mGameIdMap, the last declaration of a key wins
+			}
+
+			if (!collision)
+			{
+				mKeySlots = slots;
+				mKeySeed = seed;
+				mKeyMask = size - 1;
+				return;
+			}
+		}
+
+		size <<= 1;
+	}
+}
+
 static std::map<std::string, int> KnowScrapersIds =
 {
 	{ "ScreenScraper", 0 },
@@ -127,6 +185,24 @@ void MetaDataList::initMetadata()
 		mGameTypeMap[iter->id] = iter->type;
 		mGameIdMap[iter->key] = iter->id;
 	}
+
+	buildKeySlots(mMetaDataDecls);
+}
+
+const MetaDataDecl* MetaDataList::findDecl(const char* key, size_t length)
+{
+	if (mKeySlots.empty())
+		return nullptr;
+
+	int index = mKeySlots[hashKey(key, length, mKeySeed) & mKeyMask];
+	if (index < 0)
+		return nullptr;
+
+	const MetaDataDecl& mdd = mMetaDataDecls[index];
+	if (mdd.key.size() != length || memcmp(mdd.key.c_str(), key, length) != 0)
+		return nullptr;
+
+	return &mdd;
 }
 
 MetaDataType MetaDataList::getType(MetaDataId id) const
@@ -144,127 +220,238 @@ MetaDataId MetaDataList::getId(const std::string& key) const
 	return mGameIdMap[key];
 }
 
-MetaDataList::MetaDataList(MetaDataListType type) : mType(type), mWasChanged(false), mRelativeTo(nullptr)
+MetaDataList::MetaDataList(MetaDataListType type) : mType(type), mWasChanged(false), mRevision(1), mRelativeTo(nullptr), mPresent(0)
 {
-	memset(mIndices, -1, sizeof(mIndices));
+
 }
 
-void MetaDataList::loadFromXML(MetaDataListType type, pugi::xml_node& node, SystemData* system)
+static inline size_t rankOf(uint64_t present, int id)
 {
-	mType = type;
-	mRelativeTo = system;	
+	return std::bitset<64>(present & ((1ULL << id) - 1)).count();
+}
 
-	mUnKnownElements.clear();
-	mScrapeDates.clear();
+static inline size_t readOffset(const std::string& values, size_t index, bool wide)
+{
+	const unsigned char* data = (const unsigned char*)values.data();
 
-	std::string value;
-	std::string relativeTo = mRelativeTo->getStartPath();
+	if (wide)
+	{
+		data += index * 4;
+		return (size_t)data[0] | ((size_t)data[1] << 8) | ((size_t)data[2] << 16) | ((size_t)data[3] << 24);
+	}
 
-	bool preloadMedias = Settings::PreloadMedias();
-	if (preloadMedias && Settings::ParseGamelistOnly())
-		preloadMedias = false;
+	data += index * 2;
+	return (size_t)data[0] | ((size_t)data[1] << 8);
+}
 
-	for (pugi::xml_node xelement : node.children())
-	{
-		std::string name = xelement.name();
+bool MetaDataList::findValue(MetaDataId id, size_t& start, size_t& length) const
+{
+	if ((mPresent & (1ULL << id)) == 0)
+		return false;
 
-		if (name == "scrap")
-		{
-			if (xelement.attribute("name") && xelement.attribute("date"))
-			{
-				auto scraperId = KnowScrapersIds.find(xelement.attribute("name").value());
-				if (scraperId == KnowScrapersIds.cend())
-					continue;
-				
-				Utils::Time::DateTime dateTime(xelement.attribute("date").value());
-				if (!dateTime.isValid())
-					continue;
-								
-				mScrapeDates[scraperId->second] = dateTime;
-			}		
-								
-			continue;
-		}
+	bool wide = (mPresent & (1ULL << VALUES_WIDE_OFFSETS)) != 0;
+	size_t count = rankOf(mPresent, VALUES_WIDE_OFFSETS);
+	size_t index = rankOf(mPresent, id);
+	size_t base = count * (wide ? 4 : 2);
 
-		auto it = mGameIdMap.find(name);
-		if (it == mGameIdMap.cend())
-		{
-			if (name == "hash" || name == "path")
-				continue;
+	size_t offset = readOffset(mValues, index, wide);
+	size_t end = index + 1 < count ? readOffset(mValues, index + 1, wide) : mValues.size() - base;
 
-			value = xelement.text().get();
-			if (!value.empty())
-				mUnKnownElements.emplace_back(name, value, true);
+	start = base + offset;
+	length = end - offset;
+	return true;
+}
 
-			continue;
-		}
+void MetaDataList::storeValue(MetaDataId id, const std::string& value)
+{
+	// Values rarely change once loaded : the buffer is simply rebuilt
+	uint64_t present = (mPresent & ~(1ULL << VALUES_WIDE_OFFSETS)) | (1ULL << id);
 
-		MetaDataDecl& mdd = mMetaDataDecls[mMetaDataIndexes[it->second]];
-		if (mdd.isAttribute)
-			continue;
+	size_t starts[MetaDataIdCount];
+	size_t lengths[MetaDataIdCount];
+	size_t dataSize = 0;
 
-		value = xelement.text().get();
+	for (int i = 0; i < MetaDataIdCount; i++)
+	{
+		if ((present & (1ULL << i)) == 0)
+			continue;
 
-		if (mdd.id == MetaDataId::Name)
+		if (i == id)
 		{
-			mName = value;
-			continue;
+			starts[i] = 0;
+			lengths[i] = value.size();
 		}
+		else
+			findValue((MetaDataId)i, starts[i], lengths[i]);
 
-		if (mdd.id == MetaDataId::GenreIds)
-			continue;
+		dataSize += lengths[i];
+	}
+
+	bool wide = dataSize > 0xFFFF;
+	if (wide)
+		present |= 1ULL << VALUES_WIDE_OFFSETS;
+
+	int offsetSize = wide ? 4 : 2;
+	size_t count = rankOf(present, VALUES_WIDE_OFFSETS);
 
-		if (value == mdd.defaultValue)
+	std::string buffer;
+	buffer.reserve(count * offsetSize + dataSize);
+
+	size_t offset = 0;
+	for (int i = 0; i < MetaDataIdCount; i++)
+	{
+		if ((present & (1ULL << i)) == 0)
 			continue;
 
-		if (mdd.type == MD_BOOL)
-			value = Utils::String::toLower(value);
-		
-		if (preloadMedias && mdd.type == MD_PATH && (mdd.id == MetaDataId::Image || mdd.id == MetaDataId::Thumbnail || mdd.id == MetaDataId::Marquee || mdd.id == MetaDataId::Video) &&
-			!Utils::FileSystem::exists(Utils::FileSystem::resolveRelativePath(value, relativeTo, true)))
+		for (int b = 0; b < offsetSize; b++)
+			buffer += (char)((offset >> (b * 8)) & 0xFF);
+
+		offset += lengths[i];
+	}
+
+	for (int i = 0; i < MetaDataIdCount; i++)
+	{
+		if ((present & (1ULL << i)) == 0)
 			continue;
-		
-		// Players -> remove "1-"
-		// if (type == GAME_METADATA && mdd.id == MetaDataId::Players && Utils::String::startsWith(value, "1-"))
-		// 	value = Utils::String::replace(value, "1-", "");
 
-		set(mdd.id, value);
+		if (i == id)
+			buffer += value;
+		else
+			buffer.append(mValues, starts[i], lengths[i]);
 	}
 
-	for (pugi::xml_attribute xattr : node.attributes())
+	mValues = std::move(buffer);
+	mPresent = present;
+}
+
+void MetaDataList::loadFromXML(MetaDataListType type, pugi::xml_node& node, SystemData* system)
+{
+	beginLoad(type, system);
+
+	std::string value;
+
+	for (pugi::xml_node xelement : node.children())
 	{
-		std::string name = xattr.name();
-		auto it = mGameIdMap.find(name);
-		if (it == mGameIdMap.cend())
+		const char* name = xelement.name();
+
+		if (strcmp(name, "scrap") == 0)
 		{
-			value = xattr.value();
-			if (!value.empty())
-				mUnKnownElements.emplace_back(name, value, false);
+			if (xelement.attribute("name") && xelement.attribute("date"))
+				loadScrapeDate(xelement.attribute("name").value(), xelement.attribute("date").value());
 
 			continue;
 		}
 
-		MetaDataDecl& mdd = mMetaDataDecls[mMetaDataIndexes[it->second]];
-		if (!mdd.isAttribute)
-			continue;
+		value = xelement.text().get();
+		loadElement(name, strlen(name), value);
+	}
+
+	for (pugi::xml_attribute xattr : node.attributes())
+	{
+		const char* name = xattr.name();
 
 		value = xattr.value();
+		loadAttribute(name, strlen(name), value);
+	}
 
-		if (value == mdd.defaultValue)
-			continue;
+	endLoad();
+}
 
-		if (mdd.type == MD_BOOL)
-			value = Utils::String::toLower(value);
+void MetaDataList::beginLoad(MetaDataListType type, SystemData* system)
+{
+	mType = type;
+	mRelativeTo = system;
 
-		// Players -> remove "1-"
-		// if (type == GAME_METADATA && mdd.id == MetaDataId::Players && Utils::String::startsWith(value, "1-"))
-		// 	value = Utils::String::replace(value, "1-", "");
+	mUnKnownElements.clear();
+	mScrapeDates.clear();
+}
 
-		if (mdd.id == MetaDataId::Name)
-			mName = value;
-		else
-			set(mdd.id, value);
+void MetaDataList::loadScrapeDate(const std::string& scraper, const std::string& date)
+{
+	auto scraperId = KnowScrapersIds.find(scraper);
+	if (scraperId == KnowScrapersIds.cend())
+		return;
+
+	Utils::Time::DateTime dateTime(date);
+	if (!dateTime.isValid())
+		return;
+
+	mScrapeDates[scraperId->second] = dateTime;
+}
+
+void MetaDataList::loadElement(const char* name, size_t length, std::string& value)
+{
+	const MetaDataDecl* mdd = findDecl(name, length);
+	if (mdd == nullptr)
+	{
+		if (length == 4 && (memcmp(name, "hash", 4) == 0 || memcmp(name, "path", 4) == 0))
+			return;
+
+		if (!value.empty())
+			mUnKnownElements.emplace_back(std::string(name, length), value, true);
+
+		return;
+	}
+
+	if (mdd->isAttribute)
+		return;
+
+	if (mdd->id == MetaDataId::Name)
+	{
+		mName = value;
+		return;
 	}
+
+	if (mdd->id == MetaDataId::GenreIds)
+		return;
+
+	if (value == mdd->defaultValue)
+		return;
+
+	if (mdd->type == MD_BOOL)
+		value = Utils::String::toLower(value);
+
+	if (mdd->type == MD_PATH && (mdd->id == MetaDataId::Image || mdd->id == MetaDataId::Thumbnail || mdd->id == MetaDataId::Marquee || mdd->id == MetaDataId::Video) &&
+		Settings::PreloadMedias() && !Settings::ParseGamelistOnly() &&
+		!Utils::FileSystem::exists(Utils::FileSystem::resolveRelativePath(value, mRelativeTo->getStartPath(), true)))
+		return;
+
+	// Players -> remove "1-"
+	// if (type == GAME_METADATA && mdd.id == MetaDataId::Players && Utils::String::startsWith(value, "1-"))
+	// 	value = Utils::String::replace(value, "1-", "");
+
+	set(mdd->id, value);
+}
+
+void MetaDataList::loadAttribute(const char* name, size_t length, std::string& value)
+{
+	const MetaDataDecl* mdd = findDecl(name, length);
+	if (mdd == nullptr)
+	{
+		if (!value.empty())
+			mUnKnownElements.emplace_back(std::string(name, length), value, false);
+
+		return;
+	}
+
+	if (!mdd->isAttribute)
+		return;
+
+	if (value == mdd->defaultValue)
+		return;
+
+	if (mdd->type == MD_BOOL)
+		value = Utils::String::toLower(value);
+
+	if (mdd->id == MetaDataId::Name)
+		mName = value;
+	else
+		set(mdd->id, value);
+}
+
+void MetaDataList::endLoad()
+{
+	// storeValue rebuilds the buffer at its exact size : nothing left to trim
 }
 
 // Add migration for alternative formats & old tags
@@ -294,18 +481,16 @@ void MetaDataList::appendToXML(pugi::xml_node& parent, bool ignoreDefaults, cons
 		if (mddIter->id == MetaDataId::GenreIds)
 			continue;
 
-		auto idx = mIndices[mddIter->id];
-		//auto mapIter = mMap.find(mddIter->id);
-		//if(mapIter != mMap.cend())
-		if (idx >= 0)
+		size_t start, length;
+		if (findValue(mddIter->id, start, length))
 		{
 			// we have this value!
 			// if it's just the default (and we ignore defaults), don't write it
-			if (ignoreDefaults && mValues[idx] == mddIter->defaultValue) // mapIter->second 
+			if (ignoreDefaults && mValues.compare(start, length, mddIter->defaultValue) == 0)
 				continue;
 
 			// try and make paths relative if we can
-			std::string value = mValues[idx]; // mapIter->second;
+			std::string value = mValues.substr(start, length);
 			if (mddIter->type == MD_PATH)
 			{
 				if (fullPaths && mRelativeTo != nullptr)
@@ -364,45 +549,29 @@ void MetaDataList::set(MetaDataId id, const std::string& value)
 
 		mName = value;
 		mWasChanged = true;
+		mRevision++;
+		sGlobalRevision.fetch_add(1, std::memory_order_relaxed);
 		return;
 	}
 
-	auto idx = mIndices[id];
-	if (idx >= 0 && mValues[idx] == value)
-//	auto prev = mMap.find(id);
-	// if (prev != mMap.cend() && prev->second == value)
+	size_t start, length;
+	bool exists = findValue(id, start, length);
+	if (exists && mValues.compare(start, length, value) == 0)
 		return;
 
 	#define IS_TRIMCHAR(c) (c == ' ' || c == '\t' || c == '\r' || c == '\n')
 
-	if (mGameTypeMap[id] == MD_PATH && mRelativeTo != nullptr) // if it's a path, resolve relative paths	
-	{
-		if (idx < 0)
-		{
-			if (value.size())
-			{
-				mIndices[id] = (int8_t)mValues.size();
-				mValues.push_back(value[0] == '.' && value[1] == '/' ? value : Utils::FileSystem::createRelativePath(value, mRelativeTo->getStartPath(), true));
-			}
-		}
-		else
-			mValues[idx] = value[0] == '.' && value[1] == '/' ? value : Utils::FileSystem::createRelativePath(value, mRelativeTo->getStartPath(), true);
-	}
-	else
+	if (exists || value.size())
 	{
-		if (idx < 0)
-		{
-			if (value.size())
-			{
-				mIndices[id] = (int8_t)mValues.size();
-				mValues.push_back(value.size() && IS_TRIMCHAR(value[0]) && IS_TRIMCHAR(value.back()) ? Utils::String::trim(value) : value);
-			}
-		}
+		if (mGameTypeMap[id] == MD_PATH && mRelativeTo != nullptr) // if it's a path, resolve relative paths	
+			storeValue(id, value[0] == '.' && value[1] == '/' ? value : Utils::FileSystem::createRelativePath(value, mRelativeTo->getStartPath(), true));
 		else
-			mValues[idx] = value.size() && IS_TRIMCHAR(value[0]) && IS_TRIMCHAR(value.back()) ? Utils::String::trim(value) : value;
+			storeValue(id, value.size() && IS_TRIMCHAR(value[0]) && IS_TRIMCHAR(value.back()) ? Utils::String::trim(value) : value);
 	}
 
 	mWasChanged = true;
+	mRevision++;
+	sGlobalRevision.fetch_add(1, std::memory_order_relaxed);
 }
 
 const std::string MetaDataList::get(MetaDataId id, bool resolveRelativePaths) const
@@ -410,16 +579,13 @@ const std::string MetaDataList::get(MetaDataId id, bool resolveRelativePaths) co
 	if (id == MetaDataId::Name)
 		return mName;
 
-	auto idx = mIndices[id];
-	if (idx >= 0)
-//	auto it = mMap.find(id);
-//	if (it != mMap.end())
+	size_t start, length;
+	if (findValue(id, start, length))
 	{
-		
 		if (resolveRelativePaths && mGameTypeMap[id] == MD_PATH && mRelativeTo != nullptr) // if it's a path, resolve relative paths				
-			return Utils::FileSystem::resolveRelativePath(mValues[idx]/*it->second*/, mRelativeTo->getStartPath(), true);
+			return Utils::FileSystem::resolveRelativePath(mValues.substr(start, length), mRelativeTo->getStartPath(), true);
 
-		return mValues[idx]; // it->second;
+		return mValues.substr(start, length);
 	}
 
 	return mDefaultGameMap[id];
@@ -6,6 +6,8 @@
 #include <vector>
 #include <functional>
 #include <string>
+#include <atomic>
+#include <cstdint>
 
 #include "utils/TimeUtil.h"
 
@@ -144,6 +146,13 @@ public:
 
 	void migrate(FileData* file, pugi::xml_node& node);
 
+	// Loading element by element, for the streaming gamelist reader. loadFromXML applies the same rules
+	void beginLoad(MetaDataListType type, SystemData* system);
+	void loadElement(const char* name, size_t length, std::string& value);
+	void loadAttribute(const char* name, size_t length, std::string& value);
+	void loadScrapeDate(const std::string& scraper, const std::string& date);
+	void endLoad();
+
 	MetaDataList(MetaDataListType type);
 	
 	void set(MetaDataId id, const std::string& value);
@@ -163,6 +172,12 @@ public:
 
 	bool wasChanged() const;
 	void resetChangedFlag();
+
+	// Incremented by every change : lets FileData know when values derived from metadata are outdated
+	inline unsigned int getRevision() const { return mRevision; }
+
+	// Incremented by every change of any list : lets caches spanning several games know when they are outdated
+	static unsigned int getGlobalRevision() { return sGlobalRevision.load(std::memory_order_relaxed); }
 	const void setDirty() 
 	{ 
 		mWasChanged = true; 
@@ -188,12 +203,22 @@ private:
 	MetaDataListType mType;
 //	std::map<MetaDataId, std::string> mMap;
 	bool mWasChanged;
+	unsigned int	mRevision;
+
+	static std::atomic<unsigned int> sGlobalRevision;
 	SystemData*		mRelativeTo;
 	
-	int8_t mIndices[MetaDataIdCount];
-	std::vector<std::string> mValues;
+	// Values packed in a single buffer per entry instead of one std::string per value, large libraries hold hundreds of thousands of entries.
+	// mPresent has a bit per stored id. The buffer starts with the offsets of the stored values in id order ( 2 bytes, 4 if VALUES_WIDE_OFFSETS ), then their bytes.
+	// A lookup is O(1) : the rank of the id in mPresent gives its offset, the next offset its end
+	std::string mValues;
+	uint64_t	mPresent;
+
+	bool findValue(MetaDataId id, size_t& start, size_t& length) const;
+	void storeValue(MetaDataId id, const std::string& value);
 
 	static std::vector<MetaDataDecl> mMetaDataDecls;
+	static const MetaDataDecl* findDecl(const char* key, size_t length);
 
 	std::vector<std::tuple<std::string, std::string, bool>> mUnKnownElements;
 };
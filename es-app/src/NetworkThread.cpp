@@ -4,18 +4,22 @@
 #include "guis/GuiMsgBox.h"
 #include "LocaleES.h"
 #include "Log.h"
+#include "utils/FileSystemUtil.h"
+#include "utils/TimeUtil.h"
 #include <chrono>
 #include <SDL.h>
 
 #include "watchers/BatteryLevelWatcher.h"
 #include "watchers/NetworkStateWatcher.h"
 #include "RetroAchievements.h"
+#include "CheevosHashDatabase.h"
 
 NetworkThread::NetworkThread(Window* window) : mWindow(window)
 {
 	WatchersManager* mgr = WatchersManager::getInstance();
 
 	mgr->RegisterComponent(&mCheckCheevosTokenComponent);
+	mgr->RegisterComponent(&mCheckCheevosHashesComponent);
 	mgr->RegisterComponent(new BatteryLevelWatcher());
 	mgr->RegisterComponent(new NetworkStateWatcher());
 
@@ -135,6 +139,46 @@ bool CheckCheevosTokenComponent::check()
 	return false;
 }
 
+bool CheckCheevosHashesComponent::enabled()
+{
+	return SystemConf::getInstance()->getBool("global.retroachievements");
+}
+
+bool CheckCheevosHashesComponent::check()
+{
+	if (mRunning)
+		return false;
+
+	// Written by the last refresh that found changes : a younger database is not worth a request
+	std::string path = CheevosHashDatabase::getDatabasePath();
+	if (Utils::FileSystem::exists(path))
+	{
+		time_t age = Utils::Time::DateTime::now().getTime() - Utils::FileSystem::getFileModificationDate(path).getTime();
+		if (age >= 0 && age < updateTime() / 1000)
+			return false;
+	}
+
+	// The requests can take minutes on a slow connection. refresh() swaps the table under the database lock,
+	// so lookups ( ThreadedHasher ) get the new hashes as soon as it's done
+	mRunning = true;
+
+	std::thread([this]
+	{
+		try
+		{
+			CheevosHashDatabase::getInstance()->refresh();
+		}
+		catch (const std::exception& e)
+		{
+			LOG(LogError) << "[CheckCheevosHashesComponent] " << e.what();
+		}
+
+		mRunning = false;
+	}).detach();
+
+	// Nothing to notify
+	return false;
+}
 
 void NetworkThread::onJoystickChanged()
 {
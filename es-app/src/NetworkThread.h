@@ -5,10 +5,12 @@
 #include <condition_variable>
 #include <mutex>
 #include <list>
+#include <atomic>
 
 #include "InputManager.h"
 #include "ApiSystem.h"
 #include "watchers/WatchersManager.h"
+#include "watchers/PowerSupplyMonitor.h"
 
 class CheckPadsBatteryLevelComponent : public IWatcher
 {
@@ -23,9 +25,14 @@ protected:
 
 	bool check() override;
 
+	// Pads batteries are power_supply devices too
+	int  eventFd() override { return mMonitor.getFd(); }
+	void readEvents() override { mMonitor.drain(); }
+
 private:
 	std::vector<PadInfo> mPadsInfo;
 	bool mEnabled;
+	PowerSupplyMonitor mMonitor;
 };
 
 class CheckUpdatesComponent : public IWatcher
@@ -60,6 +67,23 @@ private:
 	std::string mLastToken;
 };
 
+// Keeps the local RetroAchievements hash database fresh, so hashing runs only download what changed.
+// The download runs on its own thread : the other watchers share the watchers thread
+class CheckCheevosHashesComponent : public IWatcher
+{
+public:
+	CheckCheevosHashesComponent() : mRunning(false) { }
+
+protected:
+	bool enabled() override;
+	int  updateTime() override { return 24 * 60 * 60 * 1000; } // 24 * 60 minutes
+	int  initialUpdateTime() override { return 60 * 1000; } // 1 minute
+	bool check() override;
+
+private:
+	std::atomic<bool> mRunning;
+};
+
 class NetworkThread : public IJoystickChangedEvent, public IWatcherNotify
 {
 public:
@@ -74,6 +98,7 @@ private:
 	CheckPadsBatteryLevelComponent					mCheckPadsBatteryLevelComponent;
 	CheckUpdatesComponent							mCheckUpdatesComponent;
 	CheckCheevosTokenComponent						mCheckCheevosTokenComponent;
+	CheckCheevosHashesComponent						mCheckCheevosHashesComponent;
 	Window* mWindow;
 };
 
@@ -8,6 +8,7 @@
 #include "ApiSystem.h"
 
 class SystemData;
+class HttpReqOptions;
 
 // API_GetGameInfoAndUserProgress
 
@@ -211,14 +212,13 @@ class RetroAchievements
 {
 public:
 	static std::string				getApiUrl(const std::string& method, const std::string& parameters);
+	static HttpReqOptions			getHttpOptions();
 	static UserSummary				getUserSummary(const std::string& userName = "", int gameCount = 100);
 	static GameInfoAndUserProgress	getGameInfoAndUserProgress(int gameId, const std::string& userName = "");
 	static UserRankAndScore         getUserRankAndScore(const std::string& userName);
 
 	static RetroAchievementInfo		toRetroAchivementInfo(UserSummary& ret);
 
-	static std::map<std::string, std::string>	getCheevosHashes();
-
 	static std::string				getCheevosHash(SystemData* pSystem, const std::string& fileName);
 	static bool						testAccount(const std::string& username, const std::string& password, std::string& tokenOrError);
 
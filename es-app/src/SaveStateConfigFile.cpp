@@ -6,6 +6,7 @@
 #include "Paths.h"
 #include "Log.h"
 #include <mutex>
+#include <cstring>
 
 static std::mutex mLock;
 static SaveStateConfigFile* mInstance;
@@ -42,7 +43,7 @@ std::shared_ptr<SaveStateConfig> SaveStateConfig::Default()
 		_default->autosave_image = "{{romfilename}}.state.auto.png";
 		_default->racommands = true;
 
-		_default->SetupRegEx();
+		_default->compilePatterns();
 	}
 
 	return _default;
@@ -60,32 +61,124 @@ std::string SaveStateConfig::getDirectory(SystemData* system)
 	return path;
 }
 
-void SaveStateConfig::SetupRegEx()
+void SaveStateFilePattern::compile(const std::string& pattern, bool withSlots)
 {
-	if (!this->file.empty())
+	static const std::pair<const char*, SegmentType> placeholders[] =
 	{
-		std::string restr = this->file;
-		restr = Utils::String::replace(restr, "\\", "\\\\");
-		restr = Utils::String::replace(restr, ".", "\\.");
-		restr = Utils::String::replace(restr, "{{romfilename}}", "(.*)");
-		restr = Utils::String::replace(restr, "{{slot}}", "($|[0-9]+)");
-		restr = Utils::String::replace(restr, "{{slot0}}", "([0-9]+)");
-		restr = Utils::String::replace(restr, "{{slot00}}", "([0-9]+)");
-		restr = Utils::String::replace(restr, "{{slot2d}}", "([0-9]+)");
-		restr = "^" + restr + "$";
-
-		this->slotFileRegEx = std::regex(restr);
+		{ "{{romfilename}}", ANY },
+		{ "{{slot}}", DIGITS_OR_END },
+		{ "{{slot0}}", DIGITS },
+		{ "{{slot00}}", DIGITS },
+		{ "{{slot2d}}", DIGITS }
+	};
+
+	mSegments.clear();
+	mGroupCount = 0;
+
+	std::string literal;
+
+	for (size_t pos = 0; pos < pattern.size(); )
+	{
+		bool found = false;
+
+		for (auto& placeholder : placeholders)
+		{
+			if (!withSlots && placeholder.second != ANY)
+				continue;
+
+			size_t length = strlen(placeholder.first);
+			if (pattern.compare(pos, length, placeholder.first) != 0)
+				continue;
+
+			if (!literal.empty())
+			{
+				mSegments.push_back({ LITERAL, literal, -1 });
+				literal.clear();
+			}
+
+			mSegments.push_back({ placeholder.second, "", ++mGroupCount });
+			pos += length;
+			found = true;
+			break;
+		}
+
+		if (!found)
+			literal += pattern[pos++];
 	}
 
-	if (autosave && !autosave_file.empty())
+	if (!literal.empty())
+		mSegments.push_back({ LITERAL, literal, -1 });
+}
+
+// Backtracking in the order of the regular expression : the longest runs first, and the end of the name before digits for {{slot}}
+bool SaveStateFilePattern::matchFrom(const std::string& fileName, size_t segment, size_t pos, std::vector<std::pair<size_t, size_t>>& groups) const
+{
+	if (segment == mSegments.size())
+		return pos == fileName.size();
+
+	const Segment& seg = mSegments[segment];
+
+	if (seg.type == LITERAL)
+		return fileName.compare(pos, seg.text.size(), seg.text) == 0 && matchFrom(fileName, segment + 1, pos + seg.text.size(), groups);
+
+	if (seg.type == ANY)
 	{
-		std::string autorestr = this->autosave_file;
-		autorestr = Utils::String::replace(autorestr, "\\", "\\\\");
-		autorestr = Utils::String::replace(autorestr, ".", "\\.");
-		autorestr = Utils::String::replace(autorestr, "{{romfilename}}", "(.*)");
-		autorestr = "^" + autorestr + "$";
-		this->autoFileRegEx = std::regex(autorestr);
+		for (size_t end = fileName.size() + 1; end-- > pos; )
+		{
+			groups[seg.group] = std::make_pair(pos, end - pos);
+			if (matchFrom(fileName, segment + 1, end, groups))
+				return true;
+		}
+
+		return false;
+	}
+
+	if (seg.type == DIGITS_OR_END && pos == fileName.size())
+	{
+		groups[seg.group] = std::make_pair(pos, 0);
+		if (matchFrom(fileName, segment + 1, pos, groups))
+			return true;
 	}
+
+	size_t digits = 0;
+	while (pos + digits < fileName.size() && fileName[pos + digits] >= '0' && fileName[pos + digits] <= '9')
+		digits++;
+
+	for (; digits > 0; digits--)
+	{
+		groups[seg.group] = std::make_pair(pos, digits);
+		if (matchFrom(fileName, segment + 1, pos + digits, groups))
+			return true;
+	}
+
+	return false;
+}
+
+bool SaveStateFilePattern::match(const std::string& fileName, std::vector<std::string>& groups) const
+{
+	if (mSegments.empty())
+		return false;
+
+	std::vector<std::pair<size_t, size_t>> ranges(mGroupCount + 1);
+	ranges[0] = std::make_pair(0, fileName.size());
+
+	if (!matchFrom(fileName, 0, 0, ranges))
+		return false;
+
+	groups.clear();
+	for (auto& range : ranges)
+		groups.push_back(fileName.substr(range.first, range.second));
+
+	return true;
+}
+
+void SaveStateConfig::compilePatterns()
+{
+	if (!this->file.empty())
+		slotFilePattern.compile(this->file, true);
+
+	if (autosave && !autosave_file.empty())
+		autoFilePattern.compile(this->autosave_file, false);
 }
 
 bool SaveStateConfig::matchSlotFile(const std::string& filename, std::string& romName, int& slot)
@@ -93,8 +186,8 @@ bool SaveStateConfig::matchSlotFile(const std::string& filename, std::string& ro
 	if (file.empty())
 		return false;
 
-	std::cmatch matches;
-	if (!std::regex_match(filename.c_str(), matches, slotFileRegEx))
+	std::vector<std::string> matches;
+	if (!slotFilePattern.match(filename, matches))
 		return false;
 
 	if (matches.size() - 1 < (size_t) romGroup)
@@ -115,8 +208,8 @@ bool SaveStateConfig::matchAutoFile(const std::string& filename, std::string& ro
 	if (!autosave || autosave_file.empty())
 		return false;
 
-	std::cmatch matches;
-	if (std::regex_match(filename.c_str(), matches, autoFileRegEx))
+	std::vector<std::string> matches;
+	if (autoFilePattern.match(filename, matches))
 	{
 		if (matches.size() - 1 < 1)
 			return false;
@@ -256,7 +349,7 @@ SaveStateConfigFile::SaveStateConfigFile()
 	}
 
 	for (const auto& kv : mSaveStateConfigs)
-		kv.second->SetupRegEx();
+		kv.second->compilePatterns();
 }
 
 std::shared_ptr<SaveStateConfig> SaveStateConfigFile::getSaveStateConfig(const std::string& emulator)
@@ -3,11 +3,47 @@
 #include <string>
 #include <vector>
 #include <map>
-#include <regex>
+#include <memory>
 
 class SystemData;
 class FileData;
 
+// File name template compiled to literals & placeholders : {{romfilename}} matches anything, {{slot}} digits or nothing at the end
+// of the name, {{slot0}}, {{slot00}} & {{slot2d}} digits. Matches and captures like the regular expression the template used to be
+// converted to ( "^(.*)\.state($|[0-9]+)$" ), without std::regex.
+class SaveStateFilePattern
+{
+public:
+	SaveStateFilePattern() : mGroupCount(0) { }
+
+	void compile(const std::string& pattern, bool withSlots);
+	bool empty() const { return mSegments.empty(); }
+
+	// groups[0] is the whole name, then one group per placeholder
+	bool match(const std::string& fileName, std::vector<std::string>& groups) const;
+
+private:
+	enum SegmentType
+	{
+		LITERAL,
+		ANY,
+		DIGITS,
+		DIGITS_OR_END
+	};
+
+	struct Segment
+	{
+		SegmentType type;
+		std::string text;
+		int group;
+	};
+
+	bool matchFrom(const std::string& fileName, size_t segment, size_t pos, std::vector<std::pair<size_t, size_t>>& groups) const;
+
+	std::vector<Segment> mSegments;
+	int mGroupCount;
+};
+
 struct SaveStateCoreConfig
 {
 	SaveStateCoreConfig() { enabled = true; }
@@ -62,10 +98,10 @@ private:
 	std::string directory;
 	std::string defaultCoreDirectory;
 
-	std::regex slotFileRegEx;
-	std::regex autoFileRegEx;
+	SaveStateFilePattern slotFilePattern;
+	SaveStateFilePattern autoFilePattern;
 
-	void SetupRegEx();
+	void compilePatterns();
 };
 
 class SaveStateConfigFile
@@ -2,7 +2,6 @@
 #include "SystemData.h"
 #include "FileData.h"
 #include "utils/StringUtil.h"
-#include <regex>
 #include "Log.h"
 
 #include <time.h>
@@ -22,7 +21,9 @@ SaveStateRepository::SaveStateRepository(SystemData* system)
 	_autosave = nullptr;
 
 	mSystem = system;
-	refresh();
+	mIndexed = false;
+	mLastCheck = 0;
+	mHolders = 0;
 }
 
 SaveStateRepository::~SaveStateRepository()
@@ -36,7 +37,15 @@ void SaveStateRepository::clear()
 		for (auto state : item.second)
 			delete state;
 
+	for (auto state : mRetiredStates)
+		delete state;
+
 	mStates.clear();
+	mRetiredStates.clear();
+
+	mIndex.clear();
+	mDirectories.clear();
+	mIndexed = false;
 }
 
 bool SaveStateRepository::supportsAutoSave()
@@ -60,83 +69,178 @@ bool SaveStateRepository::supportsIncrementalSaveStates()
 void SaveStateRepository::refresh()
 {
 	clear();
+}
 
-	auto list = SaveStateConfigFile::getSaveStateConfigs(mSystem);
-	for (auto rs : list)
+void SaveStateRepository::ensureIndex()
+{
+	if (mIndexed)
 	{
-		std::string path = rs->getDirectory(mSystem);
+		// Directories are checked at most once per second
+		time_t now = time(NULL);
+		if (now == mLastCheck)
+			return;
 
-		if (!Utils::FileSystem::exists(path))
-			continue;
+		mLastCheck = now;
 
-		auto files = Utils::FileSystem::getDirectoryFiles(path);
-		for (auto file : files)
+		if (!isIndexOutdated())
+			return;
+
+		if (mHolders == 0)
 		{
-			if (file.hidden || file.directory)
-				continue;
+			for (auto state : mRetiredStates)
+				delete state;
 
-			std::string ext = Utils::String::toLower(Utils::FileSystem::getExtension(file.path));
+			mRetiredStates.clear();
+		}
 
-			std::string rom;
-			int slot = -1;
+		for (auto item : mStates)
+			for (auto state : item.second)
+				mRetiredStates.push_back(state);
 
-			std::string fileName = Utils::FileSystem::getFileName(file.path);
-			if (!rs->matchSlotFile(fileName, rom, slot) && !rs->matchAutoFile(fileName, rom))
-				continue;
+		mStates.clear();
+	}
 
-			SaveState* state = new SaveState();
-			state->config = rs;
-			state->fileName = file.path;
-			state->rom = rom;
-			state->slot = slot;
+	buildIndex();
+}
 
-			// generators are the same for autosave and slots
-			state->fileGenerator = Utils::String::replace(rs->file, "{{romfilename}}", rom);
-			state->imageGenerator = Utils::String::replace(rs->image, "{{romfilename}}", rom);
+bool SaveStateRepository::isIndexOutdated()
+{
+	for (auto& directory : mDirectories)
+		if (Utils::FileSystem::getFileModificationDate(directory.path).getTime() != directory.modificationTime)
+			return true;
+
+	return false;
+}
+
+void SaveStateRepository::buildIndex()
+{
+	mIndex.clear();
+	mDirectories.clear();
+
+	mIndexed = true;
+	mLastCheck = time(NULL);
 
-			// screenshot
-			if (Utils::FileSystem::exists(state->fileName + ".png"))
-				state->screenshot = state->fileName + ".png";
-			else
+	auto list = SaveStateConfigFile::getSaveStateConfigs(mSystem);
+	for (auto rs : list)
+	{
+		SaveDirectory directory;
+		directory.config = rs;
+		directory.path = rs->getDirectory(mSystem);
+		directory.modificationTime = Utils::FileSystem::getFileModificationDate(directory.path).getTime();
+
+		int directoryIndex = (int)mDirectories.size();
+
+		if (Utils::FileSystem::exists(directory.path))
+		{
+			auto files = Utils::FileSystem::getDirectoryFiles(directory.path);
+			for (auto file : files)
 			{
-				std::string screenshot = Utils::FileSystem::combine(path, slot < 0 ? rs->autosave_image : rs->image);
-				std::string basename = Utils::FileSystem::getFileName(file.path);
+				if (file.hidden || file.directory)
+					continue;
 
-				screenshot = Utils::String::replace(screenshot, "{{romfilename}}", rom);
-				screenshot = Utils::String::replace(screenshot, "{{slot}}", state->slot == 0 ? "" : std::to_string(state->slot));
-				screenshot = Utils::String::replace(screenshot, "{{slot0}}", std::to_string(state->slot));
-				screenshot = Utils::String::replace(screenshot, "{{slot00}}", Utils::String::padLeft(std::to_string(state->slot), 2, '0'));
-				screenshot = Utils::String::replace(screenshot, "{{slot2d}}", Utils::String::padLeft(std::to_string(state->slot), 2, '0'));
+				std::string fileName = Utils::FileSystem::getFileName(file.path);
+				directory.files.insert(fileName);
 
-				if (Utils::FileSystem::exists(screenshot))
-					state->screenshot = screenshot;
-			}
+				std::string rom;
+				int slot = -1;
 
-			// retroarch specific commands
-			state->racommands = rs->racommands;
-			state->hasAutosave = rs->autosave;
+				if (!rs->matchSlotFile(fileName, rom, slot) && !rs->matchAutoFile(fileName, rom))
+					continue;
 
+				IndexedFile indexed;
+				indexed.directory = directoryIndex;
+				indexed.path = file.path;
+				indexed.slot = slot;
 #if WIN32
-			state->creationDate.setTime(file.lastWriteTime);
-#else
-			state->creationDate = Utils::FileSystem::getFileModificationDate(state->fileName);
+				indexed.lastWriteTime = file.lastWriteTime;
 #endif
-			mStates[state->rom].push_back(state);
+				mIndex[rom].push_back(indexed);
+			}
 		}
+
+		mDirectories.push_back(directory);
 	}
 }
 
+SaveState* SaveStateRepository::createState(const std::string& rom, const IndexedFile& file)
+{
+	const SaveDirectory& directory = mDirectories[file.directory];
+	auto rs = directory.config;
+
+	SaveState* state = new SaveState();
+	state->config = rs;
+	state->fileName = file.path;
+	state->rom = rom;
+	state->slot = file.slot;
+
+	// generators are the same for autosave and slots
+	state->fileGenerator = Utils::String::replace(rs->file, "{{romfilename}}", rom);
+	state->imageGenerator = Utils::String::replace(rs->image, "{{romfilename}}", rom);
+
+	// screenshot
+	if (directory.files.find(Utils::FileSystem::getFileName(file.path) + ".png") != directory.files.cend())
+		state->screenshot = state->fileName + ".png";
+	else
+	{
+		std::string screenshot = Utils::FileSystem::combine(directory.path, state->slot < 0 ? rs->autosave_image : rs->image);
+
+		screenshot = Utils::String::replace(screenshot, "{{romfilename}}", rom);
+		screenshot = Utils::String::replace(screenshot, "{{slot}}", state->slot == 0 ? "" : std::to_string(state->slot));
+		screenshot = Utils::String::replace(screenshot, "{{slot0}}", std::to_string(state->slot));
+		screenshot = Utils::String::replace(screenshot, "{{slot00}}", Utils::String::padLeft(std::to_string(state->slot), 2, '0'));
+		screenshot = Utils::String::replace(screenshot, "{{slot2d}}", Utils::String::padLeft(std::to_string(state->slot), 2, '0'));
+
+		// Images stored next to the states are in the listing, the others are probed
+		bool inDirectory = Utils::String::startsWith(screenshot, directory.path + "/") && screenshot.find('/', directory.path.size() + 1) == std::string::npos;
+		if (inDirectory ? directory.files.find(screenshot.substr(directory.path.size() + 1)) != directory.files.cend() : Utils::FileSystem::exists(screenshot))
+			state->screenshot = screenshot;
+	}
+
+	// retroarch specific commands
+	state->racommands = rs->racommands;
+	state->hasAutosave = rs->autosave;
+
+#if WIN32
+	state->creationDate.setTime(file.lastWriteTime);
+#else
+	state->creationDate = Utils::FileSystem::getFileModificationDate(state->fileName);
+#endif
+
+	return state;
+}
+
+const std::vector<SaveState*>& SaveStateRepository::getStates(const std::string& rom)
+{
+	static std::vector<SaveState*> empty;
+
+	auto it = mStates.find(rom);
+	if (it != mStates.cend())
+		return it->second;
+
+	auto files = mIndex.find(rom);
+	if (files == mIndex.cend())
+		return empty;
+
+	std::vector<SaveState*>& states = mStates[rom];
+	for (auto& file : files->second)
+		states.push_back(createState(rom, file));
+
+	return states;
+}
+
 bool SaveStateRepository::hasSaveStates(FileData* game)
 {
-	if (mStates.size())
+	ensureIndex();
+
+	if (mIndex.size())
 	{
 		if (game->getSourceFileData()->getSystem() != mSystem)
 			return false;
 
 		auto name = Utils::FileSystem::getFileName(game->getPath());
 
-		auto it = mStates.find(name);
-		if (it != mStates.cend())
+		auto it = mIndex.find(name);
+		if (it != mIndex.cend())
 			return true;
 
 		for (auto rs : SaveStateConfigFile::getSaveStateConfigs(mSystem))
@@ -146,8 +250,8 @@ bool SaveStateRepository::hasSaveStates(FileData* game)
 
 			std::string name = Utils::FileSystem::getStem(game->getPath());
 
-			auto it = mStates.find(name);
-			if (it != mStates.cend())
+			auto it = mIndex.find(name);
+			if (it != mIndex.cend())
 				return true;
 
 			// Don't need to test again
@@ -161,6 +265,8 @@ std::vector<SaveState*> SaveStateRepository::getSaveStates(FileData* game, std::
 {
 	if (isEnabled(game) && game->getSourceFileData()->getSystem() == mSystem)
 	{
+		ensureIndex();
+
 		std::vector<SaveState*> ret;
 
 		for (auto rs : SaveStateConfigFile::getSaveStateConfigs(mSystem))
@@ -170,13 +276,9 @@ std::vector<SaveState*> SaveStateRepository::getSaveStates(FileData* game, std::
 
 			std::string name = rs->nofileextension ? Utils::FileSystem::getStem(game->getPath()) : Utils::FileSystem::getFileName(game->getPath());
 
-			auto it = mStates.find(name);
-			if (it != mStates.cend())
-			{
-				for (auto item : it->second)
-					if (rs->equals(item->config))
-						ret.push_back(item);
-			}
+			for (auto item : getStates(name))
+				if (rs->equals(item->config))
+					ret.push_back(item);
 		}
 
 		return ret;
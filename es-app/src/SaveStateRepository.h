@@ -3,6 +3,9 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <time.h>
 
 #include "SaveState.h"
 
@@ -10,6 +13,8 @@ class SystemData;
 class FileData;
 class SaveStateConfig;
 
+// Save states of a system, indexed by rom from a listing of the save directories. The listing is done on first access, and again when
+// the modification time of a directory changes. SaveState objects are only created for the roms that are asked for.
 class SaveStateRepository
 {
 public:
@@ -27,8 +32,14 @@ public:
 	std::vector<SaveState*> getSaveStates(FileData* game, std::shared_ptr<SaveStateConfig> config = nullptr);
 
 	void clear();
+
+	// Forgets the index : the directories are listed again on next access
 	void refresh();
 
+	// Keeps the states of outdated indexes alive while a caller (the save state manager) holds pointers to them
+	void hold() { mHolders++; }
+	void release() { if (mHolders > 0) mHolders--; }
+
 	SaveState* getGameAutoSave(FileData* game);
 	SaveState* getDefaultAutoSaveSaveState();
 	SaveState* getDefaultNewGameSaveState();	
@@ -38,9 +49,44 @@ public:
 private:
 	// std::string getDefaultSavesPath();
 
+	struct SaveDirectory
+	{
+		std::shared_ptr<SaveStateConfig> config;
+		std::string path;
+		time_t modificationTime;
+		std::unordered_set<std::string> files; // screenshots are looked up here instead of probing the disk
+	};
+
+	struct IndexedFile
+	{
+		int directory;
+		std::string path;
+		int slot;
+#if WIN32
+		time_t lastWriteTime;
+#endif
+	};
+
+	void ensureIndex();
+	bool isIndexOutdated();
+	void buildIndex();
+
+	const std::vector<SaveState*>& getStates(const std::string& rom);
+	SaveState* createState(const std::string& rom, const IndexedFile& file);
+
 	SystemData* mSystem;
+
+	bool mIndexed;
+	time_t mLastCheck;
+	std::vector<SaveDirectory> mDirectories;
+	std::unordered_map<std::string, std::vector<IndexedFile>> mIndex;
+
 	std::map<std::string, std::vector<SaveState*>> mStates;
 
+	// States of the previous index : callers may still hold them for a frame or a launch, they're deleted when the index is rebuilt again without holders
+	std::vector<SaveState*> mRetiredStates;
+	int mHolders;
+
 	static SaveState* _empty;
 	SaveState* _autosave;
 	SaveState* _newGame;
@@ -0,0 +1,250 @@
+#include "SearchIndex.h"
+
+#include "utils/StringUtil.h"
+#include "FileData.h"
+#include "SystemConf.h"
+
+#define TRIGRAM(s, i) (((unsigned int)(unsigned char)s[i] << 16) | ((unsigned int)(unsigned char)s[i + 1] << 8) | (unsigned int)(unsigned char)s[i + 2])
+
+static bool isPinyinLanguage()
+{
+	std::string language = SystemConf::getInstance()->get("system.language");
+	return language == "zh_CN" || language == "zh_TW";
+}
+
+// An empty token matches any non empty name, like Utils::String::containsIgnoreCase
+static bool containsFolded(const std::string& folded, const std::string& token)
+{
+	if (token.empty())
+		return !folded.empty();
+
+	return folded.find(token) != std::string::npos;
+}
+
+SearchIndex::SearchIndex() : mStalePostings(0), mPinyin(false)
+{
+
+}
+
+// Same folding as Utils::String::containsIgnoreCase : ascii letters only
+std::string SearchIndex::fold(const std::string& text)
+{
+	std::string ret = text;
+
+	for (auto& c : ret)
+		if (c >= 'a' && c <= 'z')
+			c -= 0x20;
+
+	return ret;
+}
+
+std::vector<std::string> SearchIndex::getTokens(const std::string& filter)
+{
+	std::vector<std::string> ret;
+
+	if (filter.find(',') == std::string::npos)
+		ret.push_back(fold(filter));
+	else
+	{
+		for (auto token : Utils::String::split(filter, ',', true))
+			ret.push_back(fold(Utils::String::trim(token)));
+	}
+
+	return ret;
+}
+
+int SearchIndex::computeScore(const Entry& entry)
+{
+	int score = 0;
+
+	for (auto& token : mTokens)
+	{
+		if (containsFolded(entry.folded, token))
+			return 1;
+
+		if (mPinyin && Utils::String::containsPinyin(entry.pinyin, token))
+			score = 2;
+	}
+
+	return score;
+}
+
+int SearchIndex::addEntry(FileData* game, const std::string& name)
+{
+	int id;
+
+	auto it = mGames.find(game);
+	if (it != mGames.cend())
+	{
+		// Postings of the previous name are left, the candidates are always verified
+		id = it->second;
+		mStalePostings++;
+	}
+	else if (!mFreeEntries.empty())
+	{
+		id = mFreeEntries.back();
+		mFreeEntries.pop_back();
+	}
+	else
+	{
+		id = (int)mEntries.size();
+		mEntries.push_back(Entry());
+	}
+
+	mGames[game] = id;
+
+	Entry& entry = mEntries[id];
+	entry.game = game;
+	entry.nameHash = std::hash<std::string>()(name);
+	entry.folded = fold(name);
+	entry.pinyin = Utils::String::getPinyinInitials(name);
+
+	for (size_t i = 0; i + 2 < entry.folded.size(); i++)
+	{
+		auto& posting = mPostings[TRIGRAM(entry.folded, i)];
+		if (posting.empty() || posting.back() != id)
+			posting.push_back(id);
+	}
+
+	if (mScores.size() < mEntries.size())
+		mScores.resize(mEntries.size(), 0);
+
+	mScores[id] = mQuery.empty() ? 0 : computeScore(entry);
+	return id;
+}
+
+void SearchIndex::add(FileData* game)
+{
+	addEntry(game, game->getSourceFileData()->getName());
+}
+
+void SearchIndex::remove(FileData* game)
+{
+	auto it = mGames.find(game);
+	if (it == mGames.cend())
+		return;
+
+	Entry& entry = mEntries[it->second];
+	entry.game = nullptr;
+	entry.nameHash = 0;
+	entry.folded = std::string();
+	entry.pinyin = std::vector<const char*>();
+
+	mFreeEntries.push_back(it->second);
+	mGames.erase(it);
+
+	if (++mStalePostings > 256 && mStalePostings > mGames.size())
+		rebuildPostings();
+}
+
+void SearchIndex::clear()
+{
+	mEntries.clear();
+	mFreeEntries.clear();
+	mGames.clear();
+	mPostings.clear();
+	mStalePostings = 0;
+
+	mQuery.clear();
+	mTokens.clear();
+	mScores.clear();
+}
+
+void SearchIndex::rebuildPostings()
+{
+	mPostings.clear();
+	mStalePostings = 0;
+
+	for (int id = 0; id < (int)mEntries.size(); id++)
+	{
+		const std::string& folded = mEntries[id].folded;
+
+		for (size_t i = 0; i + 2 < folded.size(); i++)
+		{
+			auto& posting = mPostings[TRIGRAM(folded, i)];
+			if (posting.empty() || posting.back() != id)
+				posting.push_back(id);
+		}
+	}
+}
+
+void SearchIndex::setQuery(const std::string& filter)
+{
+	mQuery = filter;
+	mTokens = getTokens(filter);
+	mPinyin = isPinyinLanguage();
+	mScores.assign(mEntries.size(), 0);
+
+	for (auto& token : mTokens)
+	{
+		// Too short for a trigram : verify every name
+		if (token.size() < 3)
+		{
+			for (int id = 0; id < (int)mEntries.size(); id++)
+				if (mEntries[id].game != nullptr && containsFolded(mEntries[id].folded, token))
+					mScores[id] = 1;
+
+			continue;
+		}
+
+		// The names containing the token are in the posting list of each of its trigrams : verify the shortest one
+		const std::vector<int>* candidates = nullptr;
+
+		for (size_t i = 0; i + 2 < token.size(); i++)
+		{
+			auto it = mPostings.find(TRIGRAM(token, i));
+			if (it == mPostings.cend())
+			{
+				candidates = nullptr;
+				break;
+			}
+
+			if (candidates == nullptr || it->second.size() < candidates->size())
+				candidates = &it->second;
+		}
+
+		if (candidates == nullptr)
+			continue;
+
+		for (int id : *candidates)
+		{
+			const Entry& entry = mEntries[id];
+			if (entry.game != nullptr && mScores[id] != 1 && entry.folded.find(token) != std::string::npos)
+				mScores[id] = 1;
+		}
+	}
+
+	if (!mPinyin)
+		return;
+
+	for (int id = 0; id < (int)mEntries.size(); id++)
+	{
+		const Entry& entry = mEntries[id];
+		if (entry.game == nullptr || entry.pinyin.empty() || mScores[id] == 1)
+			continue;
+
+		for (auto& token : mTokens)
+		{
+			if (Utils::String::containsPinyin(entry.pinyin, token))
+			{
+				mScores[id] = 2;
+				break;
+			}
+		}
+	}
+}
+
+int SearchIndex::getScore(FileData* game, const std::string& filter)
+{
+	if (filter != mQuery)
+		setQuery(filter);
+
+	const std::string& name = game->getSourceFileData()->getName();
+
+	auto it = mGames.find(game);
+	if (it != mGames.cend() && mEntries[it->second].nameHash == std::hash<std::string>()(name))
+		return mScores[it->second];
+
+	// Not indexed yet, or renamed since
+	return mScores[addEntry(game, name)];
+}
@@ -0,0 +1,60 @@
+#pragma once
+#ifndef ES_APP_SEARCH_INDEX_H
+#define ES_APP_SEARCH_INDEX_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+class FileData;
+
+// Text filter index of a FileFilterIndex : game names folded once, with their pinyin initials & trigram posting lists.
+// A search only verifies the names having the least common trigram of each searched token, instead of folding every name.
+// Entries are created by the first search, then kept up to date by FileFilterIndex::addToIndex & removeFromIndex.
+class SearchIndex
+{
+public:
+	SearchIndex();
+
+	void add(FileData* game);
+	void remove(FileData* game);
+	void clear();
+
+	bool isPopulated() { return !mGames.empty(); }
+
+	// Same scores as the text filter : 0 no match, 1 the name contains one of the ',' separated tokens, 2 pinyin match
+	int getScore(FileData* game, const std::string& filter);
+
+private:
+	struct Entry
+	{
+		Entry() : game(nullptr), nameHash(0) { }
+
+		FileData* game;
+		size_t nameHash;
+		std::string folded;
+		std::vector<const char*> pinyin;
+	};
+
+	int addEntry(FileData* game, const std::string& name);
+	void setQuery(const std::string& filter);
+	int computeScore(const Entry& entry);
+	void rebuildPostings();
+
+	static std::vector<std::string> getTokens(const std::string& filter);
+	static std::string fold(const std::string& text);
+
+	std::vector<Entry> mEntries;
+	std::vector<int> mFreeEntries;
+	std::unordered_map<FileData*, int> mGames;
+	std::unordered_map<unsigned int, std::vector<int>> mPostings;
+	size_t mStalePostings;
+
+	// Current query
+	std::string mQuery;
+	std::vector<std::string> mTokens;
+	bool mPinyin;
+	std::vector<unsigned char> mScores;
+};
+
+#endif // ES_APP_SEARCH_INDEX_H
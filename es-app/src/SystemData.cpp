@@ -19,12 +19,15 @@
 #include "utils/Randomizer.h"
 #include "views/ViewController.h"
 #include "ThreadedHasher.h"
+#include "GamelistMaintenance.h"
 #include <unordered_set>
 #include <algorithm>
 #include <functional>
 #include "SaveStateRepository.h"
 #include "Paths.h"
 #include "SystemRandomPlaylist.h"
+#include "SystemMediaPool.h"
+#include "Tracing.h"
 #include "ThemeData.h"
 
 #if WIN32
@@ -70,7 +73,8 @@ VectorEx<SystemData*> SystemData::sSystemVector;
 bool SystemData::IsManufacturerSupported = false;
 
 SystemData::SystemData(const SystemMetadata& meta, SystemEnvironmentData* envData, std::vector<EmulatorData>* pEmulators, bool CollectionSystem, bool groupedSystem, bool withTheme, bool loadThemeOnlyIfElements) :
-	mMetadata(meta), mEnvData(envData), mIsCollectionSystem(CollectionSystem), mIsGameSystem(true)
+	mMetadata(meta), mEnvData(envData), mIsCollectionSystem(CollectionSystem), mIsGameSystem(true),
+	mSortSetting(meta.name + ".sort"), mShowHiddenFilesSetting(meta.name + ".ShowHiddenFiles"), mHiddenExtSetting(meta.name + ".HiddenExt")
 {
 	mBindableRandom = nullptr;
 	mSaveRepository = nullptr;
@@ -78,7 +82,8 @@ SystemData::SystemData(const SystemMetadata& meta, SystemEnvironmentData* envDat
 	mIsGroupSystem = groupedSystem;
 	mGameListHash = 0;
 	mGameCountInfo = nullptr;
-	mSortId = Settings::getInstance()->getInt(getName() + ".sort");
+	mGamesGeneration = 0;
+	mSortId = mSortSetting.get();
 	mGridSizeOverride = Vector2f(0, 0);
 
 	mFilterIndex = nullptr;
@@ -116,8 +121,9 @@ SystemData::SystemData(const SystemMetadata& meta, SystemEnvironmentData* envDat
 
 		if (!Settings::IgnoreGamelist())
 		{
-			if (!mHidden && Settings::PackGamelists())
-				packGamelist(this);
+			// The trusted gamelist is the game list : it's packed before it's read
+			if (!mHidden && Settings::PackGamelists() && Settings::ParseGamelistOnly())
+				GamelistMaintenance::packNow(this);
 
 			parseGamelist(this, fileMap);
 		}
@@ -317,13 +323,9 @@ void SystemData::populateFolder(FolderData* folder, std::unordered_map<std::stri
 	std::string filePath;
 	std::string extension;
 	bool isGame;
-	bool showHidden = Settings::ShowHiddenFiles();
+	bool showHidden = getShowHiddenFiles(Settings::ShowHiddenFiles());
 	bool preloadMedias = Settings::PreloadMedias();
 
-	auto shv = Settings::getInstance()->getString(getName() + ".ShowHiddenFiles");
-	if (shv == "1") showHidden = true;
-	else if (shv == "0") showHidden = false;
-
 	Utils::FileSystem::fileList dirContent = Utils::FileSystem::getDirectoryFiles(folderPath);
 	for (auto fileInfo : dirContent)
 	{
@@ -860,6 +862,8 @@ void SystemData::loadAdditionnalConfig(pugi::xml_node& srcSystems)
 //creates systems from information located in a config file
 bool SystemData::loadConfig(Window* window)
 {
+	TRACE_ZONE("SystemData::loadConfig");
+
 	deleteSystems();
 	ThemeData::setDefaultTheme(nullptr);
 	UIModeController::getInstance(); // Init UIModeController before loading systems
@@ -1022,6 +1026,17 @@ bool SystemData::loadConfig(Window* window)
 		}
 	}
 
+	// Packed in the background, once the systems are loaded. A trusted gamelist was packed while loading
+	if (!Settings::IgnoreGamelist() && Settings::PackGamelists() && !Settings::ParseGamelistOnly())
+	{
+		std::vector<SystemData*> systems;
+		for (auto sys : sSystemVector)
+			if (!sys->isHidden())
+				systems.push_back(sys);
+
+		GamelistMaintenance::getInstance()->start(window, systems, GamelistMaintenance::PACK);
+	}
+
 	if (window != nullptr && !ThreadedHasher::isRunning())
 	{
 		int checkIndex = 0;
@@ -1038,6 +1053,13 @@ bool SystemData::loadConfig(Window* window)
 
 	ThemeFileCache::getInstance().clear();
 
+	// Build the screensaver media pool in the background, so starting the screensaver does not walk every gamelist
+	std::string screensaverBehavior = Settings::getInstance()->getString("ScreenSaverBehavior");
+	if (screensaverBehavior == "random video" && !Settings::getInstance()->getBool("SlideshowScreenSaverCustomVideoSource"))
+		SystemMediaPool::getInstance()->prepare(nullptr, SystemRandomPlaylist::VIDEO);
+	else if (screensaverBehavior == "slideshow" && !Settings::getInstance()->getBool("SlideshowScreenSaverCustomImageSource"))
+		SystemMediaPool::getInstance()->prepare(nullptr, SystemRandomPlaylist::IMAGE);
+
 	return true;
 }
 
@@ -1292,19 +1314,42 @@ bool SystemData::hasDirtySystems()
 
 void SystemData::deleteSystems()
 {
+	SystemMediaPool::getInstance()->clear();
+	GamelistMaintenance::deinit();
+
 	bool saveOnExit = !Settings::IgnoreGamelist() && Settings::SaveGamelistsOnExit();
 
-	for (unsigned int i = 0; i < sSystemVector.size(); i++)
-	{
-		SystemData* pData = sSystemVector.at(i);
+	for (auto pData : sSystemVector)
 		pData->getRootFolder()->removeVirtualFolders();
 
-		if (saveOnExit && !pData->mIsCollectionSystem)
-			updateGamelist(pData);
+	if (saveOnExit)
+	{
+		// Gamelists are written in parallel, like they're loaded
+		ThreadPool* pThreadPool = NULL;
+		if (std::thread::hardware_concurrency() > 1 && Settings::ThreadedLoading())
+			pThreadPool = new ThreadPool("updateGamelist");
 
-		delete pData;
+		for (auto pData : sSystemVector)
+		{
+			if (pData->mIsCollectionSystem)
+				continue;
+
+			if (pThreadPool != NULL)
+				pThreadPool->queueWorkItem([pData] { updateGamelist(pData); });
+			else
+				updateGamelist(pData);
+		}
+
+		if (pThreadPool != NULL)
+		{
+			pThreadPool->wait();
+			delete pThreadPool;
+		}
 	}
 
+	for (auto pData : sSystemVector)
+		delete pData;
+
 	sSystemVector.clear();
 	IsManufacturerSupported = false;
 }
@@ -1670,7 +1715,7 @@ void SystemData::loadTheme()
 void SystemData::setSortId(const unsigned int sortId)
 {
 	mSortId = sortId;
-	Settings::getInstance()->setInt(getName() + ".sort", mSortId);
+	mSortSetting.set(mSortId);
 }
 
 bool SystemData::setSystemViewMode(std::string newViewMode, Vector2f gridSizeOverride, bool setChanged)
@@ -2101,6 +2146,17 @@ bool SystemData::getBoolSetting(const std::string& settingName)
 	return show;
 }
 
+bool SystemData::getShowHiddenFiles(bool defaultValue)
+{
+	auto& shv = mShowHiddenFilesSetting.get();
+	if (shv == "1")
+		return true;
+	else if (shv == "0")
+		return false;
+
+	return defaultValue;
+}
+
 bool SystemData::getShowParentFolder()
 {
 	return getBoolSetting("ShowParentFolder");
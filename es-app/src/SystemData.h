@@ -18,6 +18,7 @@
 #include "CustomFeatures.h"
 #include "utils/VectorEx.h"
 #include "BindingManager.h"
+#include "Settings.h"
 
 class FileData;
 class FolderData;
@@ -148,9 +149,13 @@ public:
 	void deleteIndex();
 
 	void removeFromIndex(FileData* game) {
+		mGamesGeneration++;
 		if (mFilterIndex != nullptr) mFilterIndex->removeFromIndex(game);
 	};
 
+	// Changes when a game leaves the system, for the readers that keep game pointers between frames
+	inline unsigned int getGamesGeneration() const { return mGamesGeneration; }
+
 	void addToIndex(FileData* game) {
 		if (mFilterIndex != nullptr) mFilterIndex->addToIndex(game);
 	};
@@ -227,6 +232,10 @@ public:
 	std::string getFolderViewMode();
 	bool getBoolSetting(const std::string& settingName);
 
+	// Per-system "<name>.ShowHiddenFiles" override ("1" / "0"), or defaultValue when not set
+	bool getShowHiddenFiles(bool defaultValue);
+	const std::string& getHiddenExtensions() { return mHiddenExtSetting.get(); }
+
 	static void resetSettings();
 
 	SaveStateRepository* getSaveStateRepository();
@@ -273,8 +282,13 @@ private:
 	
 	std::shared_ptr<bool> mShowFilenames;
 
+	SettingHandle<int>			mSortSetting;
+	SettingHandle<std::string>	mShowHiddenFilesSetting;
+	SettingHandle<std::string>	mHiddenExtSetting;
+
 	GameCountInfo* mGameCountInfo;
 	SaveStateRepository* mSaveRepository;
+	unsigned int mGamesGeneration;
 
 	bool mHidden;
 };
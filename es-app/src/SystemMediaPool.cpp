@@ -0,0 +1,483 @@
+#include "SystemMediaPool.h"
+#include "utils/FileSystemUtil.h"
+#include "utils/Randomizer.h"
+#include "SystemData.h"
+#include "FileData.h"
+#include "Log.h"
+#include <unordered_set>
+#include <algorithm>
+
+// Games read on the UI thread per frame
+#define MEDIA_POOL_GAMES_PER_FRAME 250
+
+SystemMediaPool* SystemMediaPool::sInstance = nullptr;
+
+SystemMediaPool* SystemMediaPool::getInstance()
+{
+	if (sInstance == nullptr)
+		sInstance = new SystemMediaPool();
+
+	return sInstance;
+}
+
+SystemMediaPool::SystemMediaPool() : mPending(false), mThread(nullptr), mExit(false)
+{
+
+}
+
+SystemMediaPool::~SystemMediaPool()
+{
+	clear();
+}
+
+void SystemMediaPool::ensureThread()
+{
+	if (mThread == nullptr)
+	{
+		mExit = false;
+		mThread = new std::thread(&SystemMediaPool::run, this);
+	}
+}
+
+void SystemMediaPool::queue(const PoolKey& key)
+{
+	mWanted.insert(key);
+	mPending = true;
+}
+
+bool SystemMediaPool::isBuilding(const PoolKey& key)
+{
+	if (mWanted.find(key) != mWanted.cend())
+		return true;
+
+	for (auto& snapshot : mReading)
+		if (snapshot.key == key)
+			return true;
+
+	for (auto& snapshot : mQueue)
+		if (snapshot.key == key && !snapshot.partial)
+			return true;
+
+	return false;
+}
+
+void SystemMediaPool::prepare(SystemData* system, MediaType type)
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	PoolKey key(system, (int)type);
+	if (mPools.find(key) == mPools.cend() && !isBuilding(key))
+		queue(key);
+}
+
+void SystemMediaPool::refresh()
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	for (auto& pool : mPools)
+		queue(pool.first);
+}
+
+void SystemMediaPool::refresh(SystemData* system)
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	for (auto& pool : mPools)
+		if (pool.first.first == system)
+			queue(pool.first);
+}
+
+void SystemMediaPool::clear()
+{
+	std::thread* thread = nullptr;
+
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+		mExit = true;
+		mWanted.clear();
+		mReading.clear();
+		mQueue.clear();
+		mPending = false;
+		thread = mThread;
+		mThread = nullptr;
+		mEvent.notify_one();
+	}
+
+	if (thread != nullptr)
+	{
+		thread->join();
+		delete thread;
+	}
+
+	std::unique_lock<std::mutex> lock(mLock);
+	mPools.clear();
+}
+
+bool SystemMediaPool::isScreenSaverSystem(SystemData* system)
+{
+	// We only want nodes from game systems that are not collections
+	return system->isGameSystem() && !system->isCollection() && !system->hasPlatformId(PlatformIds::IMAGEVIEWER) && !system->hasPlatformId(PlatformIds::PLATFORM_IGNORE);
+}
+
+std::vector<SystemData*> SystemMediaPool::getPoolSystems(SystemData* system)
+{
+	std::vector<SystemData*> systems;
+
+	if (system != nullptr)
+		systems.push_back(system);
+	else
+	{
+		for (auto sys : SystemData::sSystemVector)
+			if (isScreenSaverSystem(sys))
+				systems.push_back(sys);
+	}
+
+	return systems;
+}
+
+void SystemMediaPool::update()
+{
+	if (!mPending)
+		return;
+
+	std::unique_lock<std::mutex> lock(mLock);
+
+	for (auto key : mWanted)
+	{
+		Snapshot snapshot;
+		snapshot.key = key;
+		snapshot.systems = getPoolSystems(key.first);
+
+		// A refresh restarts the reading of a pool
+		auto it = std::find_if(mReading.begin(), mReading.end(), [key](const Snapshot& s) { return s.key == key; });
+		if (it != mReading.end())
+			*it = snapshot;
+		else
+			mReading.push_back(snapshot);
+	}
+
+	mWanted.clear();
+
+	if (mReading.size() == 0)
+	{
+		mPending = false;
+		return;
+	}
+
+	Snapshot snapshot = std::move(mReading.front());
+	mReading.pop_front();
+
+	lock.unlock();
+
+	if (snapshot.systems.size() > 0)
+	{
+		SystemData* system = snapshot.systems.back();
+		MediaType type = (MediaType)snapshot.key.second;
+
+		// The pointers kept from the previous frames can't be used if games were deleted
+		if (!snapshot.listed || snapshot.generation != system->getGamesGeneration())
+		{
+			// The screensaver pool follows what is displayed, random playlists use the whole system
+			snapshot.files = system->getRootFolder()->getFilesRecursive(GAME, snapshot.key.first == nullptr);
+			snapshot.generation = system->getGamesGeneration();
+			snapshot.listed = true;
+			snapshot.index = 0;
+			snapshot.candidates.resize(snapshot.systemStart);
+		}
+
+		size_t end = std::min(snapshot.files.size(), snapshot.index + MEDIA_POOL_GAMES_PER_FRAME);
+		for (; snapshot.index < end; snapshot.index++)
+		{
+			Candidate candidate = getCandidate(snapshot.files[snapshot.index], type);
+			candidate.system = system;
+			snapshot.candidates.push_back(candidate);
+		}
+
+		if (snapshot.index >= snapshot.files.size())
+		{
+			snapshot.systems.pop_back();
+			snapshot.files.clear();
+			snapshot.listed = false;
+			snapshot.systemStart = snapshot.candidates.size();
+		}
+	}
+
+	lock.lock();
+
+	if (snapshot.systems.size() > 0)
+	{
+		mReading.push_front(std::move(snapshot));
+		return;
+	}
+
+	mQueue.push_back(std::move(snapshot));
+	ensureThread();
+	mEvent.notify_one();
+}
+
+void SystemMediaPool::onFileChanged(FileData* file, FileChangeType change)
+{
+	if (file == nullptr || change == FILE_SORTED)
+		return;
+
+	if (file->getType() != GAME)
+	{
+		// Games were added or removed in the folder
+		SystemData* system = file->getSystem();
+		refresh(system);
+
+		if (isScreenSaverSystem(system))
+			refresh(nullptr);
+
+		return;
+	}
+
+	FileData* source = file->getSourceFileData();
+	std::string gamePath = source->getPath();
+
+	if (change == FILE_REMOVED)
+	{
+		remove(gamePath);
+		return;
+	}
+
+	std::vector<PoolKey> keys;
+
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+
+		for (auto& pool : mPools)
+		{
+			SystemData* system = pool.first.first;
+			if (system == nullptr ? isScreenSaverSystem(source->getSystem()) : (system == source->getSystem() || system == file->getSystem()))
+				keys.push_back(pool.first);
+		}
+	}
+
+	if (keys.size() == 0)
+		return;
+
+	std::vector<Snapshot> snapshots;
+
+	for (auto key : keys)
+	{
+		Snapshot snapshot;
+		snapshot.key = key;
+		snapshot.partial = true;
+
+		Candidate candidate = getCandidate(source, (MediaType)key.second);
+		candidate.system = key.first == nullptr ? source->getSystem() : key.first;
+		snapshot.candidates.push_back(candidate);
+
+		snapshots.push_back(snapshot);
+	}
+
+	std::unique_lock<std::mutex> lock(mLock);
+
+	for (auto& snapshot : snapshots)
+		mQueue.push_back(std::move(snapshot));
+
+	ensureThread();
+	mEvent.notify_one();
+}
+
+void SystemMediaPool::removeEntries(Pool& pool, const std::string& gamePath)
+{
+	for (size_t i = pool.entries.size(); i-- > 0; )
+	{
+		if (pool.entries[i].gamePath != gamePath)
+			continue;
+
+		size_t index = i;
+
+		// Keep the entries that were not picked yet in front
+		if (index < pool.remaining)
+		{
+			pool.remaining--;
+			std::swap(pool.entries[index], pool.entries[pool.remaining]);
+			index = pool.remaining;
+		}
+
+		std::swap(pool.entries[index], pool.entries.back());
+		pool.entries.pop_back();
+	}
+}
+
+void SystemMediaPool::remove(const std::string& gamePath)
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	for (auto& pool : mPools)
+		removeEntries(pool.second, gamePath);
+}
+
+void SystemMediaPool::run()
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	while (!mExit)
+	{
+		if (mQueue.size() == 0)
+		{
+			mEvent.wait(lock);
+			continue;
+		}
+
+		Snapshot snapshot = std::move(mQueue.front());
+		mQueue.pop_front();
+
+		lock.unlock();
+
+		std::vector<MediaEntry> entries;
+		validate(snapshot, entries);
+
+		lock.lock();
+
+		if (mExit)
+			break;
+
+		if (!snapshot.partial)
+		{
+			Pool& pool = mPools[snapshot.key];
+			pool.entries = std::move(entries);
+			pool.remaining = pool.entries.size();
+			continue;
+		}
+
+		// Not built yet : the build will read the game
+		auto it = mPools.find(snapshot.key);
+		if (it == mPools.cend())
+			continue;
+
+		Pool& pool = it->second;
+
+		for (auto& candidate : snapshot.candidates)
+			removeEntries(pool, candidate.gamePath);
+
+		for (auto& entry : entries)
+		{
+			pool.entries.push_back(entry);
+			std::swap(pool.entries[pool.remaining], pool.entries.back());
+			pool.remaining++;
+		}
+	}
+}
+
+std::string SystemMediaPool::getMediaPath(FileData* file, MediaType type)
+{
+	switch (type)
+	{
+	case SystemRandomPlaylist::IMAGE:
+		return file->getImagePath();
+	case SystemRandomPlaylist::THUMBNAIL:
+		return file->getThumbnailPath();
+	case SystemRandomPlaylist::MARQUEE:
+		return file->getMarqueePath();
+	case SystemRandomPlaylist::FANART:
+		return file->getMetadata(MetaDataId::FanArt);
+	case SystemRandomPlaylist::TITLESHOT:
+		return file->getMetadata(MetaDataId::TitleShot);
+	case SystemRandomPlaylist::VIDEO:
+		return file->getVideoPath();
+	}
+
+	return "";
+}
+
+SystemMediaPool::Candidate SystemMediaPool::getCandidate(FileData* file, MediaType type)
+{
+	Candidate candidate;
+	candidate.system = file->getSystem();
+	candidate.gamePath = file->getPath();
+	candidate.path = getMediaPath(file, type);
+
+	if (type == SystemRandomPlaylist::FANART)
+		candidate.fallback = file->getThumbnailPath();
+
+	return candidate;
+}
+
+void SystemMediaPool::validate(Snapshot& snapshot, std::vector<MediaEntry>& entries)
+{
+	std::unordered_set<std::string> seen;
+
+	for (auto& candidate : snapshot.candidates)
+	{
+		if (!seen.insert(candidate.gamePath).second)
+			continue;
+
+		if (!candidate.path.empty() && Utils::FileSystem::exists(candidate.path))
+			entries.push_back(MediaEntry(candidate.system, candidate.gamePath, candidate.path));
+	}
+
+	if (snapshot.key.second == SystemRandomPlaylist::FANART && entries.size() == 0 && !snapshot.partial)
+	{
+		seen.clear();
+
+		for (auto& candidate : snapshot.candidates)
+		{
+			if (!seen.insert(candidate.gamePath).second)
+				continue;
+
+			if (!candidate.fallback.empty() && Utils::FileSystem::exists(candidate.fallback))
+				entries.push_back(MediaEntry(candidate.system, candidate.gamePath, candidate.fallback));
+		}
+	}
+}
+
+bool SystemMediaPool::pick(SystemData* system, MediaType type, MediaEntry& entry)
+{
+	PoolKey key(system, (int)type);
+
+	std::unique_lock<std::mutex> lock(mLock);
+
+	auto it = mPools.find(key);
+	if (it == mPools.cend())
+	{
+		if (!isBuilding(key))
+			queue(key);
+
+		return false;
+	}
+
+	Pool& pool = it->second;
+	if (pool.entries.size() == 0)
+		return false;
+
+	if (pool.remaining == 0)
+		pool.remaining = pool.entries.size();
+
+	size_t index = (size_t)Randomizer::random((int)pool.remaining);
+	size_t last = pool.remaining - 1;
+
+	if (index != last)
+		std::swap(pool.entries[index], pool.entries[last]);
+
+	pool.remaining--;
+
+	entry = pool.entries[last];
+	return true;
+}
+
+size_t SystemMediaPool::count(SystemData* system, MediaType type)
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	auto it = mPools.find(PoolKey(system, (int)type));
+	if (it == mPools.cend())
+		return 0;
+
+	return it->second.remaining;
+}
+
+FileData* SystemMediaPool::findGame(const MediaEntry& entry)
+{
+	if (entry.system == nullptr || entry.gamePath.empty())
+		return nullptr;
+
+	// The systems may have been reloaded since the entry was picked
+	if (std::find(SystemData::sSystemVector.cbegin(), SystemData::sSystemVector.cend(), entry.system) == SystemData::sSystemVector.cend())
+		return nullptr;
+
+	return entry.system->getRootFolder()->FindByPath(entry.gamePath);
+}
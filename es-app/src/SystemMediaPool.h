@@ -0,0 +1,135 @@
+#pragma once
+#ifndef ES_APP_SYSTEM_MEDIA_POOL_H
+#define ES_APP_SYSTEM_MEDIA_POOL_H
+
+#include "SystemRandomPlaylist.h"
+#include "FileData.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+
+class SystemData;
+
+// Existing game medias per system & media type, used by random playlists and the screensaver.
+// The games & their media paths are read on the UI thread, a few hundred games per frame, the background thread only checks that the medias exist.
+// Entries keep paths, not FileData : the game of an entry is looked up again when it's needed.
+// A pick is O(1) : a random index is swapped out of the remaining part of the pool, so medias don't repeat until the pool is exhausted.
+class SystemMediaPool
+{
+public:
+	typedef SystemRandomPlaylist::PlaylistType MediaType;
+
+	struct MediaEntry
+	{
+		MediaEntry() : system(nullptr) { }
+		MediaEntry(SystemData* sys, const std::string& game, const std::string& filePath) : system(sys), gamePath(game), path(filePath) { }
+
+		SystemData*	system;		// System of the game
+		std::string gamePath;
+		std::string path;		// Media
+	};
+
+	static SystemMediaPool* getInstance();
+
+	// Ask for a pool. Can be called from any thread. A null system means all game systems ( screensaver pool, displayed games only )
+	void prepare(SystemData* system, MediaType type);
+
+	// Rebuild every pool, or the pools of a system. Existing pools are still served until their replacement is ready
+	void refresh();
+	void refresh(SystemData* system);
+
+	// Stop the builder and drop every pool. Must be called before systems are deleted
+	void clear();
+
+	// UI thread : reads the games of the pools waiting for a build, a bounded number per call
+	void update();
+
+	// UI thread : keeps the pools up to date when a game is added, changed or removed
+	void onFileChanged(FileData* file, FileChangeType change);
+
+	// Removes the entries of a game that does not exist anymore
+	void remove(const std::string& gamePath);
+
+	// Returns false if the pool is empty or not built yet. Never builds : the pool is queued instead
+	bool pick(SystemData* system, MediaType type, MediaEntry& entry);
+	size_t count(SystemData* system, MediaType type);
+
+	// UI thread : the game of an entry, or null if it was removed
+	static FileData* findGame(const MediaEntry& entry);
+
+private:
+	SystemMediaPool();
+	~SystemMediaPool();
+
+	typedef std::pair<SystemData*, int> PoolKey;
+
+	struct Pool
+	{
+		Pool() : remaining(0) { }
+
+		std::vector<MediaEntry> entries;
+		size_t remaining; // entries [0, remaining) have not been picked during the current round
+	};
+
+	// Media paths of a game, read on the UI thread
+	struct Candidate
+	{
+		SystemData*	system;
+		std::string gamePath;
+		std::string path;
+		std::string fallback; // thumbnail, used when no game of a FANART pool has a fanart
+	};
+
+	// Games read so far for a pool
+	struct Snapshot
+	{
+		Snapshot() : partial(false), listed(false), index(0), generation(0), systemStart(0) { }
+
+		PoolKey						key;
+		std::vector<SystemData*>	systems;	// left to read, the last one is being read
+		std::vector<Candidate>		candidates;
+		bool						partial;	// update of some games of an existing pool
+
+		// Games of the system being read, listed again if games left it since
+		std::vector<FileData*>		files;
+		bool						listed;
+		size_t						index;
+		unsigned int				generation;
+		size_t						systemStart; // its first candidate
+	};
+
+	static bool isScreenSaverSystem(SystemData* system);
+	static std::vector<SystemData*> getPoolSystems(SystemData* system);
+	static std::string getMediaPath(FileData* file, MediaType type);
+	static Candidate getCandidate(FileData* file, MediaType type);
+
+	void run();
+	void ensureThread();
+	void queue(const PoolKey& key);			// Lock held
+	bool isBuilding(const PoolKey& key);	// Lock held
+
+	static void validate(Snapshot& snapshot, std::vector<MediaEntry>& entries);
+	static void removeEntries(Pool& pool, const std::string& gamePath);
+
+	std::map<PoolKey, Pool>		mPools;
+	std::set<PoolKey>			mWanted;	// waiting for the UI thread
+	std::deque<Snapshot>		mReading;	// being read by the UI thread
+	std::deque<Snapshot>		mQueue;		// waiting for validation
+
+	std::atomic<bool>			mPending;
+
+	std::mutex					mLock;
+	std::condition_variable		mEvent;
+	std::thread*				mThread;
+	bool						mExit;
+
+	static SystemMediaPool* sInstance;
+};
+
+#endif // ES_APP_SYSTEM_MEDIA_POOL_H
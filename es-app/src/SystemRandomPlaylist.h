@@ -1,7 +1,5 @@
+#pragma once
 #include "components/ImageComponent.h"
-#include <random>
-#include <vector>
-#include <map>
 
 class SystemData;
 
@@ -25,14 +23,5 @@ public:
 
 private:
 	SystemData*		mSystem;
-	bool			mFirstRun;
 	PlaylistType	mType;
-
-	std::vector<std::string> mPaths;
-
-	static std::map<std::string, std::vector<std::string>> mFileCache;
-
-	//std::random_device	mRandomDevice;
-	std::mt19937		mMt19937;
-	std::uniform_int_distribution<int> mUniformDistribution;
 };
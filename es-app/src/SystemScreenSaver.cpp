@@ -25,6 +25,8 @@
 #include "utils/Randomizer.h"
 #include "Paths.h"
 #include "ApiSystem.h"
+#include "SystemMediaPool.h"
+#include "resources/TextureResource.h"
 #include <algorithm>
 
 #define FADE_TIME					(500)
@@ -35,8 +37,7 @@ SystemScreenSaver::SystemScreenSaver(Window* window) :
 	mVideoScreensaver(NULL),
 	mImageScreensaver(NULL),
 	mWindow(window),
-	mGamesWithVideosLoaded(false),
-	mGamesWithImagesLoaded(false),
+	mNextIsVideo(false),
 	mState(STATE_INACTIVE),
 	mOpacity(0.0f),
 	mTimer(0),
@@ -169,6 +170,9 @@ void SystemScreenSaver::startScreenSaver()
 			mVideoScreensaver->setGame(mCurrentGame);
 			mVideoScreensaver->setVideo(path);
 
+			if (!Settings::getInstance()->getBool("SlideshowScreenSaverCustomVideoSource"))
+				prefetchNextGameMedia(true);
+
 			if (mCurrentGame)
 				Scripting::fireEvent("game-selected", mCurrentGame->getSystem()->getName(), mCurrentGame->getPath(), mCurrentGame->getName());
 
@@ -213,6 +217,9 @@ void SystemScreenSaver::startScreenSaver()
 			mImageScreensaver->setGame(mCurrentGame);
 			mImageScreensaver->setImage(path);
 
+			if (!Settings::getInstance()->getBool("SlideshowScreenSaverCustomImageSource"))
+				prefetchNextGameMedia(false);
+
 			if (mCurrentGame)
 				Scripting::fireEvent("game-selected", mCurrentGame->getSystem()->getName(), mCurrentGame->getPath(), mCurrentGame->getName());
 
@@ -320,53 +327,26 @@ void SystemScreenSaver::renderScreenSaver()
 
 unsigned long SystemScreenSaver::countGameListNodes(bool video)
 {
-	if (video && mGamesWithVideosLoaded)
-		return mGamesWithVideos.size();
-
-	if (!video && mGamesWithImagesLoaded)
-		return mGamesWithImages.size();
-
-	unsigned long nodeCount = 0;
-
-	if (video)
-	{
-		mGamesWithVideosLoaded = true;
-		mGamesWithVideos.clear();
-	}
-	else
-	{
-		mGamesWithImagesLoaded = true;
-		mGamesWithImages.clear();
-	}
+	return SystemMediaPool::getInstance()->count(nullptr, video ? SystemRandomPlaylist::VIDEO : SystemRandomPlaylist::IMAGE);
+}
 
-	std::unordered_set<FileData*> seen;
+void SystemScreenSaver::resetCounts()
+{
+	// The pools are kept up to date by ViewController::onFileChanged, only the prefetched media may be stale
+	mNextEntry = SystemMediaPool::MediaEntry();
+	mNextTexture = nullptr;
+}
 
-	for (auto system : SystemData::sSystemVector)
+std::string SystemScreenSaver::selectGameMedia(const SystemMediaPool::MediaEntry& entry, bool video)
+{
+	FileData* game = SystemMediaPool::findGame(entry);
+	if (game == nullptr)
 	{
-		// We only want nodes from game systems that are not collections
-		if (!system->isGameSystem() || system->isCollection() || system->hasPlatformId(PlatformIds::IMAGEVIEWER) || system->hasPlatformId(PlatformIds::PLATFORM_IGNORE))
-			continue;
-
-		auto games = system->getRootFolder()->getFilesRecursive(GAME, true);
-		for (auto game : games)
-		{
-			if (!seen.insert(game).second)
-				continue;
-
-			if (video && !game->getVideoPath().empty())
-			{
-				mGamesWithVideos.push_back(game);
-				nodeCount++;
-			}
-			else if (!video && !game->getImagePath().empty())
-			{
-				mGamesWithImages.push_back(game);
-				nodeCount++;
-			}
-		}
+		SystemMediaPool::getInstance()->remove(entry.gamePath);
+		return "";
 	}
 
-	return nodeCount;
+	return selectGameMedia(game, video);
 }
 
 std::string  SystemScreenSaver::selectGameMedia(FileData* game, bool video)
@@ -400,37 +380,47 @@ std::string SystemScreenSaver::pickRandomGameMedia(bool video)
 {
 	mCurrentGame = nullptr;
 
-	int count = countGameListNodes(video);
-	if (count == 0)
-		return "";
+	std::string path;
 
-	std::vector<FileData*>* games = video ? &mGamesWithVideos : &mGamesWithImages;
+	// Use the media prefetched while the previous one was displayed
+	if (!mNextEntry.gamePath.empty() && mNextIsVideo == video)
+		path = selectGameMedia(mNextEntry, video);
 
-	int index = Randomizer::random(count) % count;
+	mNextEntry = SystemMediaPool::MediaEntry();
 
-	while (!games->empty())
-	{
-		auto path = selectGameMedia(games->at(index), video);
-		games->erase(games->begin() + index);
+	auto type = video ? SystemRandomPlaylist::VIDEO : SystemRandomPlaylist::IMAGE;
 
-		if (!path.empty())
-		{
-			if (games->empty())
-			{
-				(video ? mGamesWithVideosLoaded : mGamesWithImagesLoaded) = false;
-				if (video)
-					LOG(LogDebug) << "VideoScreenSaver::pickRandomGameMedia - All videos used, resetting list.";
-				else
-					LOG(LogDebug) << "ImageScreenSaver::pickRandomGameMedia - All images used, resetting list.";
-			}
-			return path;
-		}
+	SystemMediaPool::MediaEntry entry;
 
-		// move index one step backward with wrap-around
-		index = (index + games->size() - 1) % games->size();
-	}
+	int retry = 10;
+	while (path.empty() && retry-- > 0 && SystemMediaPool::getInstance()->pick(nullptr, type, entry))
+		path = selectGameMedia(entry, video);
+
+	return path;
+}
+
+void SystemScreenSaver::prefetchNextGameMedia(bool video)
+{
+	mNextTexture = nullptr;
+	mNextEntry = SystemMediaPool::MediaEntry();
+
+	SystemMediaPool::MediaEntry entry;
+	if (!SystemMediaPool::getInstance()->pick(nullptr, video ? SystemRandomPlaylist::VIDEO : SystemRandomPlaylist::IMAGE, entry))
+		return;
 
-	return "";
+	mNextEntry = entry;
+	mNextIsVideo = video;
+
+	// Queue the decoding now, so the texture is ready when the slideshow swaps.
+	// The screensaver image component will find it in the texture cache.
+	if (!video)
+	{
+		MaxSizeInfo maxSize(Renderer::getScreenWidth(), Renderer::getScreenHeight());
+
+		mNextTexture = TextureResource::get(mNextEntry.path, false, false, false, true, true, Settings::getInstance()->getBool("SlideshowScreenSaverStretch") ? nullptr : &maxSize);
+		if (mNextTexture != nullptr)
+			mNextTexture->reload();
+	}
 }
 
 std::string SystemScreenSaver::pickRandomCustomImage(bool video)
@@ -483,6 +473,9 @@ std::string SystemScreenSaver::pickRandomCustomImage(bool video)
 
 void SystemScreenSaver::update(int deltaTime)
 {
+	// Called every frame, even while the screensaver is off : the media pools read the games from here
+	SystemMediaPool::getInstance()->update();
+
 	// Use this to update the fade value for the current fade stage
 	if (mState == STATE_FADE_OUT_WINDOW)
 	{
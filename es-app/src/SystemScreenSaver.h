@@ -5,11 +5,13 @@
 #include "Window.h"
 #include "GuiComponent.h"
 #include "renderers/Renderer.h"
+#include "SystemMediaPool.h"
 
 class ImageComponent;
 class Sound;
 class VideoComponent;
 class TextComponent;
+class TextureResource;
 
 class GameScreenSaverBase : public GuiComponent
 {
@@ -92,15 +94,17 @@ public:
 
 	virtual FileData* getCurrentGame();
 	virtual void launchGame();
-	inline virtual void resetCounts() { mGamesWithVideosLoaded = false; mGamesWithImagesLoaded = false; mGamesWithImages.clear(); mGamesWithVideos.clear(); };
+	virtual void resetCounts();
 
 private:
 	unsigned long countGameListNodes(bool video = false);
 
 	std::string pickRandomGameMedia(bool video = false);
+	void prefetchNextGameMedia(bool video);
 	std::string pickRandomCustomImage(bool video = false);
 	
 	std::string	selectGameMedia(FileData* game, bool video = false);
+	std::string	selectGameMedia(const SystemMediaPool::MediaEntry& entry, bool video = false);
 	
 	enum STATE {
 		STATE_INACTIVE,
@@ -114,11 +118,11 @@ private:
 	std::shared_ptr<ImageScreenSaver>		mFadingImageScreensaver;
 	std::shared_ptr<ImageScreenSaver>		mImageScreensaver;
 
-	std::vector<FileData*> mGamesWithImages;
-	std::vector<FileData*> mGamesWithVideos;
+	// Next media, picked and decoded while the current one is displayed
+	SystemMediaPool::MediaEntry	mNextEntry;
+	bool			mNextIsVideo;
+	std::shared_ptr<TextureResource> mNextTexture;
 
-	bool			mGamesWithVideosLoaded;
-	bool			mGamesWithImagesLoaded;
 	Window*			mWindow;
 	STATE			mState;
 	float			mOpacity;
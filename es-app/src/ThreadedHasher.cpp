@@ -5,6 +5,7 @@
 #include "guis/GuiMsgBox.h"
 #include "Gamelist.h"
 #include "RetroAchievements.h"
+#include "CheevosHashDatabase.h"
 #include "SystemConf.h"
 #include "SystemData.h"
 #include "FileData.h"
@@ -37,8 +38,9 @@ ThreadedHasher::ThreadedHasher(Window* window, HasherType type, std::queue<FileD
 	{
 		try
 		{
-			mCheevosHashes = RetroAchievements::getCheevosHashes();
-			if (mCheevosHashes.size() == 0)
+			// Conditional requests : only what changed on the server since the last run is downloaded
+			CheevosHashDatabase::getInstance()->refresh();
+			if (CheevosHashDatabase::getInstance()->size() == 0)
 				while (!mSearchQueue.empty())
 					mSearchQueue.pop();
 		}
@@ -133,9 +135,9 @@ void ThreadedHasher::run()
 			auto hash = Utils::String::toUpper(game->getMetadata(MetaDataId::CheevosHash));
 			if (!hash.empty())
 			{
-				auto cheevos = mCheevosHashes.find(hash);
-				if (cheevos != mCheevosHashes.cend())
-					game->setMetadata(MetaDataId::CheevosId, cheevos->second);
+				int gameId = CheevosHashDatabase::getInstance()->getGameId(hash);
+				if (gameId > 0)
+					game->setMetadata(MetaDataId::CheevosId, std::to_string(gameId));
 				else
 					game->setMetadata(MetaDataId::CheevosId, "");
 			}
@@ -39,7 +39,6 @@ private:
 	std::string		mCurrentAction;
 
 	std::vector<std::string> mErrors;
-	std::map<std::string, std::string>    mCheevosHashes;
 
 	HasherType mType;
 
@@ -59,6 +59,7 @@
 #include "guis/GuiBios.h"
 #include "guis/GuiKeyMappingEditor.h"
 #include "Gamelist.h"
+#include "GamelistMaintenance.h"
 #include "TextToSpeech.h"
 #include "Paths.h"
 #include <set> 
@@ -133,6 +134,10 @@ GuiMenu::GuiMenu(Window *window, bool animate) : GuiComponent(window), mMenu(win
 	// MAIN MENU
 	bool isFullUI = !UIModeController::getInstance()->isUIModeKid() && !UIModeController::getInstance()->isUIModeKiosk();
 
+	// Run the slow helper queries while the user browses the main menu
+	if (isFullUI)
+		ApiSystem::getInstance()->prefetchMenuQueries();
+
 	// KODI >
 	// GAMES SETTINGS >
 	// CONTROLLER & BLUETOOTH >
@@ -841,15 +846,8 @@ void GuiMenu::openDeveloperSettings()
 	{
 		mWindow->pushGui(new GuiMsgBox(mWindow, _("ARE YOU SURE?"), _("YES"), [&]
 		{
-			int idx = 0;
-			for (auto system : SystemData::sSystemVector)
-			{
-				mWindow->renderSplashScreen(_("Cleaning") + ": " + system->getFullName(), (float)idx / (float)SystemData::sSystemVector.size());
-				cleanupGamelist(system);
-				idx++;
-			}
-
-			mWindow->closeSplashScreen();
+			// In the background, the progress is notified
+			GamelistMaintenance::getInstance()->start(mWindow, SystemData::sSystemVector, GamelistMaintenance::CLEANUP, true);
 		}, _("NO"), nullptr));
 	});
 
@@ -1129,6 +1127,9 @@ void GuiMenu::openDeveloperSettings()
 	s->addWithLabel(_("OPTIMIZE VIDEO VRAM USAGE"), optimizeVideo);
 	s->addSaveFunc([optimizeVideo] { Settings::getInstance()->setBool("OptimizeVideo", optimizeVideo->getState()); });
 
+	if (Renderer::supportDistanceField())
+		s->addSwitch(_("SHARE FONT GLYPHS BETWEEN SIZES"), _("Renders all sizes of a font from a single distance field texture."), "FontDistanceField", true, [s] { s->setVariable("reboot", true); });
+
 	s->addSwitch(_("USE FILESYSTEM CACHE"), "UseFileCache", true, [s] { Utils::FileSystem::FileSystemCache::reset(); });
 
 	s->onFinalize([s, window]
@@ -1653,13 +1654,20 @@ void GuiMenu::openSystemSettings()
 	}
 
 #ifdef BATOCERA
-	// video device
-	std::vector<std::string> availableVideo = ApiSystem::getInstance()->getAvailableVideoOutputDevices();
-	if (availableVideo.size())
+	// video device, the outputs are filled in when batocera-config answers
+	auto optionsVideo = std::make_shared<OptionListComponent<std::string> >(mWindow, _("VIDEO OUTPUT"), false);
+	std::string currentDevice = SystemConf::getInstance()->get("global.videooutput");
+	if (currentDevice.empty()) currentDevice = "auto";
+
+	optionsVideo->add(currentDevice, currentDevice, true);
+
+	s->whenReady(ApiSystem::runAsync<std::vector<std::string>>([] { return ApiSystem::getInstance()->getAvailableVideoOutputDevices(); }),
+		[optionsVideo, currentDevice](const std::vector<std::string>& availableVideo)
 	{
-		auto optionsVideo = std::make_shared<OptionListComponent<std::string> >(mWindow, _("VIDEO OUTPUT"), false);
-		std::string currentDevice = SystemConf::getInstance()->get("global.videooutput");
-		if (currentDevice.empty()) currentDevice = "auto";
+		if (availableVideo.size() == 0)
+			return;
+
+		optionsVideo->clear();
 
 		bool vfound = false;
 		for (auto it = availableVideo.begin(); it != availableVideo.end(); it++)
@@ -1671,18 +1679,18 @@ void GuiMenu::openSystemSettings()
 
 		if (!vfound)
 			optionsVideo->add(currentDevice, currentDevice, true);
+	});
 
-		s->addWithLabel(_("VIDEO OUTPUT"), optionsVideo);
-		s->addSaveFunc([this, optionsVideo, currentDevice, s] 
+	s->addWithLabel(_("VIDEO OUTPUT"), optionsVideo);
+	s->addSaveFunc([this, optionsVideo, currentDevice, s] 
+	{
+		if (optionsVideo->changed()) 
 		{
-			if (optionsVideo->changed()) 
-			{
-				SystemConf::getInstance()->set("global.videooutput", optionsVideo->getSelected());
-				SystemConf::getInstance()->saveSystemConf();				
-				s->setVariable("exitreboot", true);
-			}
-		});
-	}
+			SystemConf::getInstance()->set("global.videooutput", optionsVideo->getSelected());
+			SystemConf::getInstance()->saveSystemConf();				
+			s->setVariable("exitreboot", true);
+		}
+	});
 	// es resolution
 	if (ApiSystem::getInstance()->isScriptingSupported(ApiSystem::RESOLUTION))
 	{
@@ -1694,16 +1702,33 @@ void GuiMenu::openSystemSettings()
 
 	if (ApiSystem::getInstance()->isScriptingSupported(ApiSystem::AUDIODEVICE))
 	{
-		std::vector<std::string> availableAudio = ApiSystem::getInstance()->getAvailableAudioOutputDevices();
-		if (availableAudio.size())
+		// audio device, the outputs are filled in when batocera-audio answers
+		auto optionsAudio = std::make_shared<OptionListComponent<std::string> >(mWindow, _("AUDIO OUTPUT"), false);
+
+		std::string configuredAudio = SystemConf::getInstance()->get("audio.device");
+		if (configuredAudio.empty())
+			configuredAudio = "auto";
+
+		optionsAudio->add(configuredAudio, configuredAudio, true);
+
+		auto audioDevices = ApiSystem::runAsync<std::pair<std::vector<std::string>, std::string>>([]
 		{
-			// audio device
-			auto optionsAudio = std::make_shared<OptionListComponent<std::string> >(mWindow, _("AUDIO OUTPUT"), false);
+			auto api = ApiSystem::getInstance();
+			return std::make_pair(api->getAvailableAudioOutputDevices(), api->getCurrentAudioOutputDevice());
+		});
 
-			std::string selectedAudio = ApiSystem::getInstance()->getCurrentAudioOutputDevice();
+		s->whenReady(audioDevices, [optionsAudio](const std::pair<std::vector<std::string>, std::string>& devices)
+		{
+			auto& availableAudio = devices.first;
+			if (availableAudio.size() == 0)
+				return;
+
+			std::string selectedAudio = devices.second;
 			if (selectedAudio.empty())
 				selectedAudio = "auto";
 
+			optionsAudio->clear();
+
 			bool afound = false;
 			for (auto it = availableAudio.begin(); it != availableAudio.end(); it++)
 			{
@@ -1729,30 +1754,47 @@ void GuiMenu::openSystemSettings()
 
 			if (!afound)
 				optionsAudio->add(selectedAudio, selectedAudio, true);
+		});
 
-			s->addWithLabel(_("AUDIO OUTPUT"), optionsAudio);
+		s->addWithLabel(_("AUDIO OUTPUT"), optionsAudio);
 
-			s->addSaveFunc([this, optionsAudio, selectedAudio]
+		s->addSaveFunc([this, optionsAudio]
+		{
+			if (optionsAudio->changed())
 			{
-				if (optionsAudio->changed())
-				{
-					SystemConf::getInstance()->set("audio.device", optionsAudio->getSelected());
-					ApiSystem::getInstance()->setAudioOutputDevice(optionsAudio->getSelected());
-				}
-				SystemConf::getInstance()->saveSystemConf();
-			});
-		}
+				SystemConf::getInstance()->set("audio.device", optionsAudio->getSelected());
+				ApiSystem::getInstance()->setAudioOutputDevice(optionsAudio->getSelected());
+			}
+			SystemConf::getInstance()->saveSystemConf();
+		});
+
+		// audio profile, filled in the same way
+		auto optionsAudioProfile = std::make_shared<OptionListComponent<std::string> >(mWindow, _("AUDIO PROFILE"), false);
+
+		std::string configuredAudioProfile = SystemConf::getInstance()->get("audio.profile");
+		if (configuredAudioProfile.empty())
+			configuredAudioProfile = "auto";
+
+		optionsAudioProfile->add(configuredAudioProfile, configuredAudioProfile, true);
+
+		auto audioProfiles = ApiSystem::runAsync<std::pair<std::vector<std::string>, std::string>>([]
+		{
+			auto api = ApiSystem::getInstance();
+			return std::make_pair(api->getAvailableAudioOutputProfiles(), api->getCurrentAudioOutputProfile());
+		});
 
-		// audio profile
-		std::vector<std::string> availableAudioProfiles = ApiSystem::getInstance()->getAvailableAudioOutputProfiles();
-		if (availableAudioProfiles.size())
+		s->whenReady(audioProfiles, [optionsAudioProfile](const std::pair<std::vector<std::string>, std::string>& profiles)
 		{
-			auto optionsAudioProfile = std::make_shared<OptionListComponent<std::string> >(mWindow, _("AUDIO PROFILE"), false);
+			auto& availableAudioProfiles = profiles.first;
+			if (availableAudioProfiles.size() == 0)
+				return;
 
-			std::string selectedAudioProfile = ApiSystem::getInstance()->getCurrentAudioOutputProfile();
+			std::string selectedAudioProfile = profiles.second;
 			if (selectedAudioProfile.empty())
 				selectedAudioProfile = "auto";
 
+			optionsAudioProfile->clear();
+
 			bool afound = false;
 			for (auto it = availableAudioProfiles.begin(); it != availableAudioProfiles.end(); it++)
 			{
@@ -1791,18 +1833,18 @@ void GuiMenu::openSystemSettings()
 
 			if (afound == false)
 				optionsAudioProfile->add(selectedAudioProfile, selectedAudioProfile, true);
+		});
 
-			s->addWithDescription(_("AUDIO PROFILE"), _("Available options can change depending on current audio output."), optionsAudioProfile);
+		s->addWithDescription(_("AUDIO PROFILE"), _("Available options can change depending on current audio output."), optionsAudioProfile);
 
-			s->addSaveFunc([this, optionsAudioProfile, selectedAudioProfile]
-			{
-				if (optionsAudioProfile->changed()) {
-					SystemConf::getInstance()->set("audio.profile", optionsAudioProfile->getSelected());
-					ApiSystem::getInstance()->setAudioOutputProfile(optionsAudioProfile->getSelected());
-				}
-				SystemConf::getInstance()->saveSystemConf();
-			});
-		}
+		s->addSaveFunc([this, optionsAudioProfile]
+		{
+			if (optionsAudioProfile->changed()) {
+				SystemConf::getInstance()->set("audio.profile", optionsAudioProfile->getSelected());
+				ApiSystem::getInstance()->setAudioOutputProfile(optionsAudioProfile->getSelected());
+			}
+			SystemConf::getInstance()->saveSystemConf();
+		});
 	}
 
 #ifdef BATOCERA
@@ -1983,40 +2025,49 @@ void GuiMenu::openSystemSettings()
 		if (currentOverclock == "")
 			currentOverclock = "none";
 
-		std::vector<std::string> availableOverclocking = ApiSystem::getInstance()->getAvailableOverclocking();
+		if (currentOverclock == "none")
+			overclock_choice->add(_("NONE"), currentOverclock, true);
+		else
+			overclock_choice->add(currentOverclock, currentOverclock, true);
 
-		// Overclocking device
-		bool isOneSet = false;
-		for (auto it = availableOverclocking.begin(); it != availableOverclocking.end(); it++)
+		// Overclocking device, filled in when batocera-overclock answers
+		s->whenReady(ApiSystem::runAsync<std::vector<std::string>>([] { return ApiSystem::getInstance()->getAvailableOverclocking(); }),
+			[overclock_choice, currentOverclock](const std::vector<std::string>& availableOverclocking)
 		{
-			std::vector<std::string> tokens = Utils::String::split(*it, ' ');
-			if (tokens.size() >= 2)
+			overclock_choice->clear();
+
+			bool isOneSet = false;
+			for (auto it = availableOverclocking.begin(); it != availableOverclocking.end(); it++)
 			{
-				// concatenat the ending words
-				std::string vname;
-				for (unsigned int i = 1; i < tokens.size(); i++)
+				std::vector<std::string> tokens = Utils::String::split(*it, ' ');
+				if (tokens.size() >= 2)
 				{
-					if (i > 1) vname += " ";
-					vname += tokens.at(i);
-				}
-				bool isSet = currentOverclock == std::string(tokens.at(0));
-				if (isSet)
-					isOneSet = true;
+					// concatenat the ending words
+					std::string vname;
+					for (unsigned int i = 1; i < tokens.size(); i++)
+					{
+						if (i > 1) vname += " ";
+						vname += tokens.at(i);
+					}
+					bool isSet = currentOverclock == std::string(tokens.at(0));
+					if (isSet)
+						isOneSet = true;
 
-				if (vname == "NONE" || vname == "none")
-					vname = _("NONE");
+					if (vname == "NONE" || vname == "none")
+						vname = _("NONE");
 
-				overclock_choice->add(vname, tokens.at(0), isSet);
+					overclock_choice->add(vname, tokens.at(0), isSet);
+				}
 			}
-		}
 
-		if (isOneSet == false)
-		{
-			if (currentOverclock == "none")
-				overclock_choice->add(_("NONE"), currentOverclock, true);
-			else
-				overclock_choice->add(currentOverclock, currentOverclock, true);
-		}
+			if (isOneSet == false)
+			{
+				if (currentOverclock == "none")
+					overclock_choice->add(_("NONE"), currentOverclock, true);
+				else
+					overclock_choice->add(currentOverclock, currentOverclock, true);
+			}
+		});
 
 		// overclocking
 		s->addWithLabel(_("OVERCLOCK"), overclock_choice);
@@ -2160,13 +2211,23 @@ void GuiMenu::openSystemSettings()
 #ifdef BATOCERA
 	s->addGroup(_("STORAGE"));
 
-	// Storage device
-	std::vector<std::string> availableStorage = ApiSystem::getInstance()->getAvailableStorageDevices();
-	if (availableStorage.size())
-	{		
-		std::string selectedStorage = ApiSystem::getInstance()->getCurrentStorage();
+	// Storage device, filled in when batocera-config answers
+	auto optionsStorage = std::make_shared<OptionListComponent<std::string> >(window, _("STORAGE DEVICE"), false);
+	optionsStorage->add("...", "", true);
+
+	auto storages = ApiSystem::runAsync<std::pair<std::vector<std::string>, std::string>>([]
+	{
+		auto api = ApiSystem::getInstance();
+		return std::make_pair(api->getAvailableStorageDevices(), api->getCurrentStorage());
+	});
+
+	s->whenReady(storages, [optionsStorage](const std::pair<std::vector<std::string>, std::string>& storage)
+	{
+		auto& availableStorage = storage.first;
+		auto& selectedStorage = storage.second;
+
+		optionsStorage->clear();
 
-		auto optionsStorage = std::make_shared<OptionListComponent<std::string> >(window, _("STORAGE DEVICE"), false);
 		for (auto it = availableStorage.begin(); it != availableStorage.end(); it++)
 		{
 				if (Utils::String::startsWith(*it, "DEV"))
@@ -2198,16 +2259,20 @@ void GuiMenu::openSystemSettings()
 				}
 		}
 
-		s->addWithLabel(_("STORAGE DEVICE"), optionsStorage);
-		s->addSaveFunc([optionsStorage, selectedStorage, s]
+		// Nothing to choose from : keep a placeholder, which saves nothing
+		if (optionsStorage->size() == 0)
+			optionsStorage->add(selectedStorage, "", true);
+	});
+
+	s->addWithLabel(_("STORAGE DEVICE"), optionsStorage);
+	s->addSaveFunc([optionsStorage, s]
+	{
+		if (optionsStorage->changed() && !optionsStorage->getSelected().empty())
 		{
-			if (optionsStorage->changed())
-			{
-				ApiSystem::getInstance()->setStorage(optionsStorage->getSelected());
-				s->setVariable("reboot", true);
-			}
-		});
-	}
+			ApiSystem::getInstance()->setStorage(optionsStorage->getSelected());
+			s->setVariable("reboot", true);
+		}
+	});
 
 	// backup
 	if (ApiSystem::getInstance()->isScriptingSupported(ApiSystem::BACKUP))
@@ -2225,16 +2290,25 @@ void GuiMenu::openSystemSettings()
     
     if (selectedFormat.empty()) selectedFormat = "btrfs";
 
-    std::vector<std::string> fstypes = ApiSystem::getInstance()->getFormatFileSystems();
-    if (fstypes.empty()) fstypes = { "ext4", "btrfs", "exfat" };
+    diskFormat->add(Utils::String::toUpper(selectedFormat), selectedFormat, true);
 
-    for (const auto& fs : fstypes) {
-        diskFormat->add(Utils::String::toUpper(fs), fs, selectedFormat == fs);
-    }
+    // Filled in when batocera-format answers
+    s->whenReady(ApiSystem::runAsync<std::vector<std::string>>([] { return ApiSystem::getInstance()->getFormatFileSystems(); }),
+        [diskFormat, selectedFormat](const std::vector<std::string>& types)
+    {
+        std::vector<std::string> fstypes = types;
+        if (fstypes.empty()) fstypes = { "ext4", "btrfs", "exfat" };
+
+        diskFormat->clear();
+
+        for (const auto& fs : fstypes) {
+            diskFormat->add(Utils::String::toUpper(fs), fs, selectedFormat == fs);
+        }
     
-    if (!diskFormat->hasSelection()) {
-         diskFormat->selectFirstItem();
-    }
+        if (!diskFormat->hasSelection()) {
+             diskFormat->selectFirstItem();
+        }
+    });
 
     s->addWithLabel(_("EXTRA DRIVE FILESYSTEM TYPE"), diskFormat);
     
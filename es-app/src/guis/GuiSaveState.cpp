@@ -18,6 +18,7 @@ GuiSaveState::GuiSaveState(Window* window, FileData* game, const std::function<v
 {
 	mGame = game;
 	mRepository = game->getSourceFileData()->getSystem()->getSaveStateRepository();
+	mRepository->hold();
 	mRunCallback = callback;
 
 	// Form background
@@ -99,6 +100,11 @@ GuiSaveState::GuiSaveState(Window* window, FileData* game, const std::function<v
 	centerWindow();
 }
 
+GuiSaveState::~GuiSaveState()
+{
+	mRepository->release();
+}
+
 void GuiSaveState::loadGrid()
 {
 	mGrid->clear();
@@ -94,6 +94,30 @@ void GuiSettings::save()
 	SystemConf::getInstance()->saveSystemConf();
 }
 
+void GuiSettings::update(int deltaTime)
+{
+	GuiComponent::update(deltaTime);
+
+	if (mPendingFuncs.empty())
+		return;
+
+	// A func can register another one
+	auto pending = mPendingFuncs;
+	mPendingFuncs.clear();
+
+	bool changed = false;
+	for (auto& func : pending)
+	{
+		if (func())
+			changed = true;
+		else
+			mPendingFuncs.push_back(func);
+	}
+
+	if (changed)
+		mMenu.updateSize();
+}
+
 bool GuiSettings::input(InputConfig* config, Input input)
 {
 	if(config->isMappedTo(BUTTON_BACK, input) && input.value != 0)
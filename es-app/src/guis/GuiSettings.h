@@ -4,6 +4,7 @@
 
 #include "components/MenuComponent.h"
 #include "guis/GuiFileBrowser.h"
+#include <future>
 
 class SwitchComponent;
 
@@ -59,6 +60,20 @@ public:
 		mSaveFuncs.push_back(func); 
 	}
 
+	// Calls func with the answer of a background query once it arrives, the menu shows placeholders until then
+	template<typename T, typename F>
+	void whenReady(const std::shared_future<T>& future, const F& func)
+	{
+		mPendingFuncs.push_back([future, func]
+		{
+			if (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+				return false;
+
+			func(future.get());
+			return true;
+		});
+	}
+
 	inline void addEntry(const std::string name, bool add_arrow = false, const std::function<void()>& func = nullptr, const std::string iconName = "", bool onButtonRelease = false, bool setCursorHere = false) 
 	{ 
 		mMenu.addEntry(name, add_arrow, func, iconName, setCursorHere, onButtonRelease); 
@@ -94,6 +109,7 @@ public:
     inline void setSave(bool sav) { mDoSave = sav; };
 
 	bool input(InputConfig* config, Input input) override;
+	void update(int deltaTime) override;
 	std::vector<HelpPrompt> getHelpPrompts() override;
 	HelpStyle getHelpStyle() override;
 
@@ -136,6 +152,7 @@ private:
 	bool mDoSave = true;
 
 	std::vector< std::function<void()> > mSaveFuncs;
+	std::vector< std::function<bool()> > mPendingFuncs;
 	std::function<void()> mOnFinalizeFunc;
 
 	std::map<std::string, bool> mVariableMap;
@@ -6,7 +6,7 @@
 #include "views/UIModeController.h"
 
 
-GuiSystemInformation::GuiSystemInformation(Window* window) : GuiSettings(window, _("INFORMATION").c_str())
+GuiSystemInformation::GuiSystemInformation(Window* window) : GuiSettings(window, _("INFORMATION").c_str()), mSystemRow(-1)
 {
 	auto theme = ThemeData::getMenuTheme();
 	std::shared_ptr<Font> font = theme->Text.font;
@@ -16,7 +16,17 @@ GuiSystemInformation::GuiSystemInformation(Window* window) : GuiSettings(window,
 
 	addGroup(_("INFORMATION"));
 
-	addWithLabel(_("VERSION"), std::make_shared<TextComponent>(window, ApiSystem::getInstance()->getVersion(), font, color));
+	mInfos = ApiSystem::getInstance()->getSystemInformationsAsync();
+
+	if (ApiSystem::getInstance()->isScriptingSupported(ApiSystem::VERSIONINFO))
+	{
+		mVersion = ApiSystem::getInstance()->queryAsync("batocera-version");
+		mVersionText = std::make_shared<TextComponent>(window, "...", font, color);
+	}
+	else
+		mVersionText = std::make_shared<TextComponent>(window, ApiSystem::getInstance()->getVersion(), font, color);
+
+	addWithLabel(_("VERSION"), mVersionText);
 	addWithLabel(_("USER DISK USAGE"), std::make_shared<TextComponent>(window, ApiSystem::getInstance()->getFreeSpaceUserInfo(), font, warning ? 0xFF0000FF : color));
 	addWithLabel(_("SYSTEM DISK USAGE"), std::make_shared<TextComponent>(window, ApiSystem::getInstance()->getFreeSpaceSystemInfo(), font, color));
 
@@ -29,7 +39,26 @@ GuiSystemInformation::GuiSystemInformation(Window* window) : GuiSettings(window,
 		}
 	#endif
 
-	std::vector<std::string> infos = ApiSystem::getInstance()->getSystemInformations();
+	// Already known if the query was made recently
+	if (mInfos.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+	{
+		addSystemInformations(mInfos.get());
+		mInfos = std::shared_future<std::vector<std::string>>();
+	}
+	else
+		mSystemRow = getMenu().getList()->size();
+
+	addGroup(_("VIDEO DRIVER"));
+	for (auto info : Renderer::getDriverInformation())
+		addWithLabel(_(info.first.c_str()), std::make_shared<TextComponent>(window, info.second, font, color));
+}
+
+void GuiSystemInformation::addSystemInformations(const std::vector<std::string>& infos)
+{
+	auto theme = ThemeData::getMenuTheme();
+	std::shared_ptr<Font> font = theme->Text.font;
+	unsigned int color = theme->Text.color;
+
 	if (infos.size() > 0)
 	{
 		addGroup(_("SYSTEM"));
@@ -53,12 +82,33 @@ GuiSystemInformation::GuiSystemInformation(Window* window) : GuiSettings(window,
 					vname += tokens.at(i);
 				}
 
-				addWithLabel(_(tokens.at(0).c_str()), std::make_shared<TextComponent>(window, vname, font, color));
+				addWithLabel(_(tokens.at(0).c_str()), std::make_shared<TextComponent>(mWindow, vname, font, color));
 			}
 		}
 	}
+}
 
-	addGroup(_("VIDEO DRIVER"));
-	for (auto info : Renderer::getDriverInformation())
-		addWithLabel(_(info.first.c_str()), std::make_shared<TextComponent>(window, info.second, font, color));
+void GuiSystemInformation::update(int deltaTime)
+{
+	GuiSettings::update(deltaTime);
+
+	if (mVersion.valid() && mVersion.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+	{
+		// getVersion reads the cached answer, or falls back to version.info
+		mVersionText->setText(ApiSystem::getInstance()->getVersion());
+		mVersion = std::shared_future<std::vector<std::string>>();
+	}
+
+	if (mInfos.valid() && mInfos.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+	{
+		auto list = getMenu().getList();
+		int first = list->size();
+
+		addSystemInformations(mInfos.get());
+		mInfos = std::shared_future<std::vector<std::string>>();
+
+		// Back above the VIDEO DRIVER group
+		list->moveRows(first, list->size() - first, mSystemRow);
+		updateSize();
+	}
 }
@@ -1,11 +1,25 @@
 #pragma once
 
 #include "GuiSettings.h"
+#include <future>
 
 class Window;
+class TextComponent;
 
 class GuiSystemInformation : public GuiSettings
 {
 public:
 	GuiSystemInformation(Window* window);
+
+	void update(int deltaTime) override;
+
+private:
+	void addSystemInformations(const std::vector<std::string>& infos);
+
+	// The helpers are slow : the screen opens at once and the values are filled in as they arrive
+	std::shared_future<std::vector<std::string>> mVersion;
+	std::shared_future<std::vector<std::string>> mInfos;
+
+	std::shared_ptr<TextComponent> mVersionText;
+	int mSystemRow; // where the SYSTEM group goes when the informations arrive late
 };
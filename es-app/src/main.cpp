@@ -26,12 +26,16 @@
 #include <SystemConf.h>
 #include "ApiSystem.h"
 #include "AudioManager.h"
+#include "MusicLibrary.h"
 #include "NetworkThread.h"
 #include "scrapers/ThreadedScraper.h"
 #include "ThreadedHasher.h"
 #include <FreeImage.h>
 #include "ImageIO.h"
 #include "components/VideoVlcComponent.h"
+#include "resources/VideoThumbnailExtractor.h"
+#include "components/VideoVlcPreloader.h"
+#include "GamelistWriter.h"
 #include <csignal>
 #include "InputConfig.h"
 #include "RetroAchievements.h"
@@ -44,6 +48,10 @@
 #include <thread>
 #include "ZaparooSupport.h"
 #include "utils/ThreadPool.h"
+#include "Tracing.h"
+#ifdef _ENABLE_BENCHMARK_
+#include "Benchmark.h"
+#endif
 
 #ifdef WIN32
 #include <Windows.h>
@@ -76,6 +84,24 @@ bool parseArgs(int argc, char* argv[])
 		}
 	}
 
+#ifdef _ENABLE_BENCHMARK_
+	// The benchmark runs on a synthetic home folder
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--benchmark") == 0)
+		{
+			if (i == argc - 1 || !Benchmark::setScenario(argv[i + 1]))
+			{
+				std::cerr << "Invalid benchmark scenario supplied.";
+				return false;
+			}
+
+			Paths::setHomePath(Benchmark::getHomePath());
+			break;
+		}
+	}
+#endif
+
 	for(int i = 1; i < argc; i++)
 	{
 		if (strcmp(argv[i], "--videoduration") == 0)
@@ -163,6 +189,35 @@ bool parseArgs(int argc, char* argv[])
 		}else if(strcmp(argv[i], "--draw-framerate") == 0)
 		{
 			Settings::getInstance()->setBool("DrawFramerate", true);
+		}else if(strcmp(argv[i], "--trace") == 0)
+		{
+			Tracing::setEnabled(true);
+#ifdef _ENABLE_BENCHMARK_
+		}else if(strcmp(argv[i], "--benchmark") == 0)
+		{
+			enable_startup_game = false;
+			i++; // skip the argument value
+		}else if(strcmp(argv[i], "--benchmark-output") == 0)
+		{
+			if (i >= argc - 1)
+			{
+				std::cerr << "Invalid benchmark output supplied.";
+				return false;
+			}
+
+			Benchmark::setOutputPath(argv[i + 1]);
+			i++; // skip the argument value
+		}else if(strcmp(argv[i], "--benchmark-renderer") == 0)
+		{
+			if (i >= argc - 1)
+			{
+				std::cerr << "Invalid benchmark renderer supplied.";
+				return false;
+			}
+
+			Benchmark::setRenderer(argv[i + 1]);
+			i++; // skip the argument value
+#endif
 		}else if(strcmp(argv[i], "--no-exit") == 0)
 		{
 			Settings::getInstance()->setBool("ShowExit", false);
@@ -241,6 +296,12 @@ bool parseArgs(int argc, char* argv[])
 				"--gamelist-only			skip automatic game search, only read from gamelist.xml\n"
 				"--ignore-gamelist		ignore the gamelist (useful for troubleshooting)\n"
 				"--draw-framerate		display the framerate\n"
+				"--trace				record tracing zones ( export with SIGUSR1 or /trace )\n"
+#ifdef _ENABLE_BENCHMARK_
+				"--benchmark [scenario]		headless run on a synthetic library, reports frame stats as JSON ( gamelist, grid, textlist, systems, menus, all, archives, memory100k, memory250k, search, arcade40k, folders, savestates, cheevoshashes, videothumbs, videoframes, videostart, gamelistparse, gamelistwrites )\n"
+				"--benchmark-output [file]	write the benchmark report to a file instead of stdout\n"
+				"--benchmark-renderer [name]	run the benchmark on a real renderer instead of NULL, in a window ( driver name as in the renderer option, e.g. \"OPENGL 2.1\" )\n"
+#endif
 				"--no-exit			don't show the exit option in the menu\n"
 				"--no-splash			don't show the splash screen\n"
 				"--debug				more logging, show console on Windows\n"				
@@ -352,6 +413,13 @@ void signalHandler(int signum)
 	exit(signum);
 }
 
+#ifndef WIN32
+void traceSignalHandler(int /*signum*/)
+{
+	Tracing::requestDump();
+}
+#endif
+
 void playVideo()
 {
 	ApiSystem::getInstance()->setReadyFlag(false);
@@ -458,6 +526,9 @@ int main(int argc, char* argv[])
 	signal(SIGINT, signalHandler);
 	signal(SIGSEGV, signalHandler);
 	// signal(SIGTERM, signalHandler);
+#ifndef WIN32
+	signal(SIGUSR1, traceSignalHandler);
+#endif
 
 	srand((unsigned int)time(NULL));
 
@@ -466,6 +537,8 @@ int main(int argc, char* argv[])
 	if(!parseArgs(argc, argv))
 		return 0;
 
+	Tracing::setThreadName("Main");
+
 	// only show the console on Windows if HideConsole is false
 #ifdef WIN32
 	// MSVC has a "SubSystem" option, with two primary options: "WINDOWS" and "CONSOLE".
@@ -519,6 +592,15 @@ int main(int argc, char* argv[])
 
 	LOG(LogInfo) << "EmulationStation - v" << PROGRAM_VERSION_STRING << ", built " << PROGRAM_BUILT_STRING;
 
+#ifdef _ENABLE_BENCHMARK_
+	if (Benchmark::isEnabled())
+	{
+		Benchmark::setupEnvironment();
+		if (!Benchmark::prepare())
+			return 1;
+	}
+#endif
+
 	//always close the log on exit
 	atexit(&onExit);
 
@@ -671,6 +753,15 @@ int main(int argc, char* argv[])
 	int ps_time = SDL_GetTicks();
 
 	bool running = true;
+	int exitCode = 0;
+
+#ifdef _ENABLE_BENCHMARK_
+	if (Benchmark::isEnabled())
+	{
+		exitCode = Benchmark::run(&window);
+		running = false;
+	}
+#endif
 
 #ifdef BATOCERA
 	bool hotkeyPressed = false;
@@ -841,10 +932,13 @@ int main(int argc, char* argv[])
 	if (SystemData::hasDirtySystems())
 		window.renderSplashScreen(_("SAVING METADATA. PLEASE WAIT..."));
 
+	VideoThumbnailExtractor::deinit();
+	VideoVlcPreloader::deinit();
 	MameNames::deinit();
 	ViewController::saveState();
 	CollectionSystemManager::deinit();
 	SystemData::deleteSystems();
+	GamelistWriter::deinit();
 	Scripting::exitScriptingEngine();
 
 	// call this ONLY when linking with FreeImage as a static library
@@ -858,12 +952,16 @@ int main(int argc, char* argv[])
 
 	window.deinit();
 
+	// Stop the music first, its end callback uses the library
+	AudioManager::getInstance()->deinit();
+	MusicLibrary::deinit();
+
 	Utils::Platform::processQuitMode();
 
 	LOG(LogInfo) << "EmulationStation cleanly shutting down.";
 
 	Log::flush();
 
-	return 0;
+	return exitCode;
 }
 
@@ -24,6 +24,7 @@
 #include "scrapers/ThreadedScraper.h"
 #include "guis/GuiUpdate.h"
 #include "ContentInstaller.h"
+#include "Tracing.h"
 
 /* 
 
@@ -287,6 +288,40 @@ void HttpServerThread::run()
 			res.set_content(ret, "application/json");
 	});
 
+	mHttpServer->Get("/trace", [](const httplib::Request& req, httplib::Response& res)
+	{
+		if (!isAllowed(req, res))
+			return;
+
+		if (!Tracing::isEnabled())
+		{
+			res.set_content("{\"msg\":\"TRACING IS DISABLED\"}", "application/json");
+			res.status = 201;
+			return;
+		}
+
+		res.set_header("Content-Disposition", "attachment; filename=\"trace.json\"");
+		res.set_content(Tracing::getChromeTrace(), "application/json");
+	});
+
+	mHttpServer->Get("/trace/start", [](const httplib::Request& req, httplib::Response& res)
+	{
+		if (!isAllowed(req, res))
+			return;
+
+		Tracing::setEnabled(true);
+		res.set_content("OK", "text/html");
+	});
+
+	mHttpServer->Get("/trace/stop", [](const httplib::Request& req, httplib::Response& res)
+	{
+		if (!isAllowed(req, res))
+			return;
+
+		Tracing::setEnabled(false);
+		res.set_content("OK", "text/html");
+	});
+
 	mHttpServer->Get("/isIdle", [](const httplib::Request& req, httplib::Response& res)
 	{
 		if (!isAllowed(req, res))
@@ -21,6 +21,7 @@
 #include "guis/GuiDetectDevice.h"
 #include "SystemConf.h"
 #include "AudioManager.h"
+#include "MusicLibrary.h"
 #include "FileSorts.h"
 #include "CollectionSystemManager.h"
 #include "guis/GuiImageViewer.h"
@@ -32,6 +33,7 @@
 #include "VolumeControl.h"
 #include "guis/GuiNetPlay.h"
 #include "Gamelist.h"
+#include "SystemMediaPool.h"
 
 ViewController* ViewController::sInstance = nullptr;
 
@@ -423,6 +425,8 @@ void ViewController::playViewTransition(bool forceImmediate)
 
 void ViewController::onFileChanged(FileData* file, FileChangeType change)
 {
+	SystemMediaPool::getInstance()->onFileChanged(file, change);
+
 	std::string key = file->getFullPath();
 	auto sourceSystem = file->getSourceFileData()->getSystem();
 
@@ -1127,6 +1131,7 @@ void ViewController::reloadAll(Window* window, bool reloadTheme)
 		Renderer::resetCache();
 
 	Utils::FileSystem::FileSystemCache::reset();
+	MusicLibrary::getInstance()->reset();
 
 	if (mCurrentView != nullptr)
 	{
@@ -192,6 +192,14 @@ int BasicGameListView::getCursorIndex()
 	return mList.getCursorIndex();
 }
 
+FileData* BasicGameListView::getEntryAt(int index)
+{
+	if (index < 0 || index >= mList.size())
+		return nullptr;
+
+	return mList.getObjectAt(index);
+}
+
 std::vector<FileData*> BasicGameListView::getFileDataEntries()
 {
 	return mList.getObjects();	
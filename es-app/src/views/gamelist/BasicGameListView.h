@@ -33,6 +33,7 @@ public:
 
 	virtual void launch(FileData* game) override;
 	virtual std::vector<FileData*> getFileDataEntries() override;
+	virtual FileData* getEntryAt(int index) override;
 
 	virtual void onLongMouseClick(GuiComponent* component) override;
 
@@ -34,6 +34,7 @@ public:
 
 	virtual void launch(FileData* game) override;
 	virtual std::vector<FileData*> getFileDataEntries() override;
+	virtual FileData* getEntryAt(int index) override;
 	virtual void update(int deltaTime) override;
 
 protected:
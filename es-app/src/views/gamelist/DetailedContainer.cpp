@@ -18,6 +18,7 @@
 #include "components/VideoPlayerComponent.h"
 #endif
 #include "components/VideoVlcComponent.h"
+#include "components/VideoVlcPreloader.h"
 
 DetailedContainer::DetailedContainer(ISimpleGameListView* parent, GuiComponent* list, Window* window, DetailedContainerType viewType) :
 	mParent(parent), mList(list), mWindow(window), mViewType(viewType),
@@ -323,6 +324,28 @@ void DetailedContainer::createVideo()
 	mParent->addChild(mVideo);
 }
 
+// Opens the videos the cursor may show next : the current one, waiting for its start delay, and its neighbours, the closest in the direction of the move first
+void DetailedContainer::preloadVideos(FileData* file, int moveBy)
+{
+	if (dynamic_cast<VideoVlcComponent*>(mVideo) == nullptr || !Settings::getInstance()->getBool("PreloadVideos"))
+		return;
+
+	int cursor = mParent->getCursorIndex();
+	int direction = moveBy < 0 ? -1 : 1;
+
+	std::vector<std::string> paths;
+	paths.push_back(file->getVideoPath());
+
+	for (int offset : { direction, -direction })
+	{
+		FileData* entry = mParent->getEntryAt(cursor + offset);
+		if (entry != nullptr && entry->getType() == GAME)
+			paths.push_back(entry->getVideoPath());
+	}
+
+	VideoVlcPreloader::getInstance()->preload(paths);
+}
+
 void DetailedContainer::initMDLabels()
 {
 	auto mSize = mParent->getSize();
@@ -806,6 +829,9 @@ void DetailedContainer::updateControls(FileData* file, bool isClearing, int move
 			if (!mVideo->setVideo(file->getVideoPath()))
 				mVideo->setDefaultVideo();
 
+			if (!isClearing && !isDeactivating)
+				preloadVideos(file, moveBy);
+
 			std::string snapShot = imagePath;
 
 			auto src = mVideo->getSnapshotSource();
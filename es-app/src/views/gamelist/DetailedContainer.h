@@ -88,6 +88,7 @@ protected:
 	TextComponent mDescription;
 
 	void createVideo();
+	void preloadVideos(FileData* file, int moveBy);
 	void createImageComponent(ImageComponent** pImage, bool forceLoad = false, bool allowFading = false);
 	void loadIfThemed(ImageComponent** pImage, const std::shared_ptr<ThemeData>& theme, const std::string& element, bool forceLoad = false, bool loadPath = false);
 	void loadThemedExtras(FileData* file);
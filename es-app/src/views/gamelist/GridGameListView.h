@@ -42,6 +42,7 @@ public:
 	virtual void setThemeName(std::string name);
 	virtual void onShow();
 	virtual std::vector<FileData*> getFileDataEntries() override;
+	virtual FileData* getEntryAt(int index) override;
 	virtual void update(int deltaTime) override;
 
 	virtual void onLongMouseClick(GuiComponent* component) override;
@@ -26,6 +26,7 @@ public:
 	virtual FileData* getCursor() = 0;
 	virtual void setCursor(FileData*) = 0;
 	virtual int getCursorIndex() =0; 
+	virtual FileData* getEntryAt(int index) = 0; // nullptr out of the list
 	virtual void setCursorIndex(int index) =0; 
 
 	virtual void resetLastCursor() = 0;
@@ -11,7 +11,7 @@
 #include "SystemConf.h"
 #include "ThemeData.h"
 #include "Paths.h"
-#include "id3v2lib/include/id3v2lib.h"
+#include "MusicLibrary.h"
 
 #include <fstream>
 #include <sstream>
@@ -25,14 +25,10 @@
 #include <unistd.h>
 #endif
 
-// batocera
-// Size of last played music history as a percentage of file total
-#define LAST_PLAYED_SIZE 0.4
-
 AudioManager* AudioManager::sInstance = NULL;
 std::vector<std::shared_ptr<Sound>> AudioManager::sSoundVector;
 
-AudioManager::AudioManager() : mInitialized(false), mCurrentMusic(nullptr), mMusicVolume(MIX_MAX_VOLUME), mVideoPlaying(false)
+AudioManager::AudioManager() : mInitialized(false), mCurrentMusic(nullptr), mNextGeneration(0), mMusicVolume(MIX_MAX_VOLUME), mVideoPlaying(false)
 {
 	init();
 }
@@ -66,7 +62,6 @@ void AudioManager::init()
 	
 	mSongNameChanged = false;
 	mPlayingSystemThemeSong = "none";
-	std::deque<std::string> mLastPlayed;
 
 	if (SDL_InitSubSystem(SDL_INIT_AUDIO) != 0)
 	{
@@ -91,6 +86,12 @@ void AudioManager::init()
 
 		mMusicVolume = getMaxMusicVolume();
 		Mix_VolumeMusic(mMusicVolume);
+
+		// Index the music folders before the first song is requested
+		auto library = MusicLibrary::getInstance();
+		library->prepare(Paths::getUserMusicPath());
+		library->prepare(Paths::getMusicPath());
+		library->prepare(Paths::getUserEmulationStationPath() + "/music");
 	}
 }
 
@@ -156,249 +157,85 @@ void AudioManager::stop()
 			sSoundVector[i]->stop();
 }
 
-void AudioManager::getMusicIn(const std::string &path, std::vector<std::string>& all_matching_files)
+std::string AudioManager::getPlaylist()
 {
-	if (!Utils::FileSystem::isDirectory(path))
-		return;
-
-	bool anySystem = !Settings::getInstance()->getBool("audio.persystem");
+	auto library = MusicLibrary::getInstance();
 
-	auto dirContent = Utils::FileSystem::getDirContent(path);
-	for (auto it = dirContent.cbegin(); it != dirContent.cend(); ++it)
+	if (Settings::getInstance()->getBool("audio.useFavoriteMusic"))
 	{
-		if (Utils::FileSystem::isDirectory(*it))
-		{
-			if (*it == "." || *it == "..")
-				continue;
+		std::string favorites = library->getFavoritesPlaylist();
+		if (!favorites.empty())
+			return favorites;
 
-			if (anySystem || mSystemName == Utils::FileSystem::getFileName(*it))
-				getMusicIn(*it, all_matching_files);
-		}
-		else if (Utils::FileSystem::isAudio(*it))
-			all_matching_files.push_back(*it);
+		LOG(LogInfo) << "No favorite music found in " << FavoriteMusicManager::getFavoriteMusicFilePath();
+		Settings::getInstance()->setBool("audio.useFavoriteMusic", false);
+		Settings::getInstance()->saveFile();
 	}
-}
 
-// batocera
-// Add the current song to the last played history, truncating as needed
-void AudioManager::addLastPlayed(const std::string& newSong, int totalMusic)
-{
-	int historySize = std::floor(totalMusic * LAST_PLAYED_SIZE);
-	if (historySize < 1)
-	{
-		// Number of songs is too small to bother with
-		return;
-	}
-	
-	while (mLastPlayed.size() > historySize)
-		mLastPlayed.pop_back();
+	bool anySystem = !Settings::getInstance()->getBool("audio.persystem");
 
-	mLastPlayed.push_front(newSong);
-	
-	LOG(LogDebug) << "Adding " << newSong << " to last played, " << mLastPlayed.size() << " in history";
-}
+	std::string playlist = library->getPlaylist(mCurrentThemeMusicDirectory, mSystemName, anySystem);
 
-// batocera
-// Check if current song exists in last played history
-bool AudioManager::songWasPlayedRecently(const std::string& song)
-{
-	for (std::string i : mLastPlayed)
-	{
-		if (song == i)
-		{
-			return true;
-		}
-	}
-	return false;
+	if (playlist.empty())
+		playlist = library->getPlaylist(Paths::getUserMusicPath(), mSystemName, anySystem);
+
+	if (playlist.empty())
+		playlist = library->getPlaylist(Paths::getMusicPath(), mSystemName, anySystem);
+
+	if (playlist.empty())
+		playlist = library->getPlaylist(Paths::getUserEmulationStationPath() + "/music", mSystemName, anySystem);
+
+	return playlist;
 }
 
 void AudioManager::playRandomMusic(bool continueIfPlaying)
 {
-    if (!Settings::BackgroundMusic())
-        return;
-
-    if (Settings::getInstance()->getBool("audio.useFavoriteMusic"))
-    {
-        std::string favoritesFile = FavoriteMusicManager::getFavoriteMusicFilePath();
-        auto favorites = FavoriteMusicManager::loadFavoriteSongs(favoritesFile);
-
-        if (favorites.empty())
-        {
-            LOG(LogInfo) << "No favorite music found in " << favoritesFile;
-            Settings::getInstance()->setBool("audio.useFavoriteMusic", false);
-            Settings::getInstance()->saveFile();
-        }
-        else
-        {
-            // Normal favorite playback logic
-            int randomIndex = Randomizer::random(favorites.size());
-            std::string chosenSongPath = favorites[randomIndex].first;
-
-            if (mCurrentMusic != nullptr && continueIfPlaying)
-                return;
-
-            LOG(LogInfo) << "Playing favorite music: " << favorites[randomIndex].second
-                        << " (" << chosenSongPath << ")";
-            playMusic(chosenSongPath);
-            playSong(chosenSongPath);
-            addLastPlayed(chosenSongPath, favorites.size());
-            mPlayingSystemThemeSong = "";
-            return;
-        }
-    }
+	if (!Settings::BackgroundMusic())
+		return;
 
 	if (mCurrentMusic != nullptr && continueIfPlaying)
 		return;
 
-    std::vector<std::string> musics;
+	std::string playlist = getPlaylist();
+	if (playlist.empty())
+		return;
 
-    if (!mCurrentThemeMusicDirectory.empty())
-        getMusicIn(mCurrentThemeMusicDirectory, musics);
+	auto library = MusicLibrary::getInstance();
 
-    if (musics.empty())
-        getMusicIn(Paths::getUserMusicPath(), musics);
+	// Use the song picked & preloaded when the previous one started, if the playlist did not change
+	std::string path;
+	if (!mNextSong.empty() && mNextPlaylist == playlist && mNextGeneration == library->getGeneration())
+		path = mNextSong;
 
-    if (musics.empty())
-        getMusicIn(Paths::getMusicPath(), musics);
+	mNextSong = "";
 
-    if (musics.empty())
-        getMusicIn(Paths::getUserEmulationStationPath() + "/music", musics);
+	if (path.empty() && !library->pick(playlist, path))
+		return;
 
-    if (musics.empty())
-        return;
-retry:
+	playMusic(path);
 
-    int randomIndex = Randomizer::random(musics.size());
+	while (mInitialized && mCurrentMusic == nullptr && Settings::BackgroundMusic())
+	{
+		library->discard(path);
+		if (!library->pick(playlist, path))
+			return;
 
-	int maxRecent = musics.size() - 1; // Security for retry goto
-    while (maxRecent > 0 && songWasPlayedRecently(musics[randomIndex]))
-    {
-        LOG(LogDebug) << "Music "" << musics.at(randomIndex) << "" was played recently, trying again";
-        randomIndex = Randomizer::random(musics.size());
+		playMusic(path);
+	}
+
+	if (playlist == MusicLibrary::FAVORITES)
+		LOG(LogInfo) << "Playing favorite music: " << path;
 
-		maxRecent--;
-    }
+	playSong(path);
+	mPlayingSystemThemeSong = "";
 
-	std::string path = musics[randomIndex];
-    playMusic(path);
+	mNextGeneration = library->getGeneration();
 
-	if (mInitialized && mCurrentMusic == nullptr && Settings::BackgroundMusic() && musics.size() > 1)
+	if (library->pick(playlist, mNextSong))
 	{
-		musics.erase(std::remove(musics.begin(), musics.end(), path), musics.end());		
-		goto retry;
+		mNextPlaylist = playlist;
+		library->preload(mNextSong);
 	}
-
-    playSong(path);
-    addLastPlayed(path, musics.size());
-    mPlayingSystemThemeSong = "";
-}
-
-static std::string utf16_to_utf8(const std::u16string& u16)
-{
-    std::string out;
-    out.reserve(u16.size() * 3); // upper bound for BMP chars
-
-    for (size_t i = 0; i < u16.size(); ++i)
-    {
-        uint32_t code = u16[i];
-
-        // Handle surrogate pairs (just in case)
-        if (code >= 0xD800 && code <= 0xDBFF && (i + 1) < u16.size())
-        {
-            uint32_t low = u16[i + 1];
-            if (low >= 0xDC00 && low <= 0xDFFF)
-            {
-                code = (((code - 0xD800) << 10) | (low - 0xDC00)) + 0x10000;
-                ++i; // consumed low surrogate
-            }
-        }
-
-        if (code <= 0x7F)
-        {
-            out.push_back(static_cast<char>(code));
-        }
-        else if (code <= 0x7FF)
-        {
-            out.push_back(static_cast<char>(0xC0 | (code >> 6)));
-            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
-        }
-        else if (code <= 0xFFFF)
-        {
-            out.push_back(static_cast<char>(0xE0 | (code >> 12)));
-            out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
-            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
-        }
-        else
-        {
-            out.push_back(static_cast<char>(0xF0 | (code >> 18)));
-            out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
-            out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
-            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
-        }
-    }
-
-    return out;
-}
-
-static std::string decode_text_frame(const ID3v2_TextFrameData* data)
-{
-    if (!data || !data->text || data->size <= 0)
-        return {};
-
-    const unsigned char* bytes =
-        reinterpret_cast<const unsigned char*>(data->text);
-    size_t len = static_cast<size_t>(data->size);
-
-    // ISO-8859-1 / “ANSI” branch
-    if (data->encoding == ID3v2_ENCODING_ISO)
-    {
-        if (len > 0 && bytes[len - 1] == 0x00)
-            --len; // drop trailing NUL
-
-        return std::string(reinterpret_cast<const char*>(bytes),
-                           reinterpret_cast<const char*>(bytes) + len);
-    }
-
-    // UNICODE branch: UTF‑16 with BOM + 0x0000 terminator
-    if (len < 4)
-        return {};
-
-    bool little_endian = false;
-    size_t offset = 0;
-
-    if (bytes[0] == 0xFF && bytes[1] == 0xFE) {
-        little_endian = true;
-        offset = 2;
-    } else if (bytes[0] == 0xFE && bytes[1] == 0xFF) {
-        little_endian = false;
-        offset = 2;
-    }
-
-    if (offset >= len)
-        return {};
-
-    const unsigned char* p = bytes + offset;
-    len -= offset;
-
-    // Trim trailing UTF‑16 0x0000
-    if (len >= 2 && p[len - 2] == 0x00 && p[len - 1] == 0x00)
-        len -= 2;
-
-    std::u16string u16;
-    u16.reserve(len / 2);
-
-    for (size_t i = 0; i + 1 < len; i += 2)
-    {
-        char16_t ch;
-        if (little_endian)
-            ch = static_cast<char16_t>(p[i] | (p[i + 1] << 8));
-        else
-            ch = static_cast<char16_t>(p[i + 1] | (p[i] << 8));
-
-        u16.push_back(ch);
-    }
-
-	return utf16_to_utf8(u16);
 }
 
 void AudioManager::playMusic(const std::string& path)
@@ -412,14 +249,21 @@ void AudioManager::playMusic(const std::string& path)
 	if (!Settings::BackgroundMusic())
 		return;
 
-	// load a new music
-	mCurrentMusic = Mix_LoadMUS(path.c_str());
+	// load a new music, from memory if it was preloaded
+	auto data = MusicLibrary::getInstance()->getPreloadedData(path);
+	if (data != nullptr)
+		mCurrentMusic = Mix_LoadMUS_RW(SDL_RWFromConstMem(data->data(), (int)data->size()), 1);
+	else
+		mCurrentMusic = Mix_LoadMUS(path.c_str());
+
 	if (mCurrentMusic == NULL)
 	{
 		LOG(LogError) << Mix_GetError() << " for " << path;
 		return;
 	}
 
+	mCurrentMusicData = data;
+
 	if (Mix_FadeInMusic(mCurrentMusic, 1, 1000) == -1)
 	{
 		stopMusic();
@@ -457,6 +301,7 @@ void AudioManager::stopMusic(bool fadeOut)
 
 	Mix_HaltMusic();
 	Mix_FreeMusic(mCurrentMusic);
+	mCurrentMusicData = nullptr;
 	mCurrentMusicPath = "";
 	mCurrentMusic = NULL;
 }
@@ -466,13 +311,6 @@ std::string AudioManager::getCurrentSongPath() const
     return mCurrentMusicPath;  
 }
 
-// Fast string hash in order to use strings in switch/case
-// How does this work? Look for Dan Bernstein hash on the internet
-constexpr unsigned int sthash(const char *s, int off = 0)
-{
-	return !s[off] ? 5381 : (sthash(s, off+1)*33) ^ s[off];
-}
-
 void AudioManager::setSongName(const std::string& song)
 {
 	if (song == mCurrentSong)
@@ -494,146 +332,7 @@ void AudioManager::playSong(const std::string& song)
 		return;
 	}
 
-	std::string ext = Utils::String::toLower(Utils::FileSystem::getExtension(song));
-	// chiptunes mod song titles parsing
-	if (ext == ".mod" || ext == ".s3m" || ext == ".stm" || ext == ".669" || ext == ".mtm" || ext == ".far" || ext == ".xm" || ext == ".it" )
-	{
-		int title_offset;
-		int title_break;
-		struct {
-			char title[108] = "";
-		} info;
-		switch (sthash(ext.c_str())) {
-			case sthash(".mod"):
-			case sthash(".stm"):
-				title_offset = 0;
-				title_break = 20;
-				break;
-			case sthash(".s3m"):
-				title_offset = 0;
-				title_break = 28;
-				break;
-			case sthash(".669"):
-				title_offset = 0;
-				title_break = 108;
-				break;
-			case sthash(".mtm"):
-			case sthash(".it"):
-				title_offset = 4;
-				title_break = 20;
-				break;
-			case sthash(".far"):
-				title_offset = 4;
-				title_break = 40;
-				break;
-			case sthash(".xm"):
-				title_offset = 17;
-				title_break = 20;
-				break;
-			default:
-				LOG(LogError) << "Error AudioManager unexpected case while loading mofile " << song;
-				setSongName(Utils::FileSystem::getStem(song.c_str()));				
-				return;
-		}
-
-		FILE* file = fopen(song.c_str(), "r");
-		if (file != NULL)
-		{
-			if (fseek(file, title_offset, SEEK_SET) < 0)
-				LOG(LogError) << "Error AudioManager seeking " << song;
-			else if (fread(&info, sizeof(info), 1, file) != 1)
-				LOG(LogError) << "Error AudioManager reading " << song;
-			else  
-			{
-				info.title[title_break] = '\0';
-
-				std::string name = info.title;
-				if (!name.empty())
-				{
-					setSongName(name);
-					fclose(file);
-					return;
-				}
-			}
-
-			fclose(file);
-		}
-		else
-			LOG(LogError) << "Error AudioManager opening modfile " << song;
-	}
-
-	// now only mp3 will be parsed for ID3: .ogg, .wav and .flac will display file name
-	if (ext != ".mp3")
-	{
-		setSongName(Utils::FileSystem::getStem(song.c_str()));
-		return;
-	}
-
-	LOG(LogDebug) << "AudioManager::setSongName";
-
-	// First let's try with an ID3 v2 tag
-	ID3v2_Tag* tag = ID3v2_read_tag(song.c_str());
-	if (tag != nullptr)
-	{
-		ID3v2_TextFrame* title_frame = ID3v2_Tag_get_title_frame(tag);
-		if (title_frame != nullptr)
-		{
-			std::string song_name = decode_text_frame(title_frame->data);
-
-			ID3v2_TextFrame* artist_frame = ID3v2_Tag_get_artist_frame(tag);
-			if (artist_frame != nullptr)
-			{
-				song_name += " - " + decode_text_frame(artist_frame->data);
-				free(artist_frame);
-			}
-
-			setSongName(Utils::String::trim(song_name));
-
-			free(title_frame);
-			free(tag);
-			return;
-		}
-		free(tag);
-	}
-
-	// Then, if no v2, let's try with an ID3 v1 tag	
-	struct {
-		char tag[3];	// i.e. "TAG"
-		char title[30];
-		char artist[30];
-		char album[30];
-		char year[4];
-		char comment[30];
-		unsigned char genre;
-	} info;
-
-	FILE* file = fopen(song.c_str(), "r");
-	if (file != NULL)
-	{
-		if (fseek(file, -128, SEEK_END) < 0)
-			LOG(LogError) << "Error AudioManager seeking " << song;
-		else if (fread(&info, sizeof(info), 1, file) != 1)
-			LOG(LogError) << "Error AudioManager reading " << song;
-		else if (strncmp(info.tag, "TAG", 3) == 0) 
-		{
-			std::string songTitle(info.title, 30);
-			songTitle = " - " + songTitle.substr(0, 30);
-			if (info.artist != NULL) 
-			{
-				std::string songArtist(info.artist, 30);
-				songTitle += " - " + songArtist.substr(0, 30);
-			}
-			setSongName(songTitle);
-			fclose(file);
-			return;
-		}
-
-		fclose(file);
-	}
-	else
-		LOG(LogError) << "Error AudioManager opening mp3 file " << song;
-
-	setSongName(Utils::FileSystem::getStem(song.c_str()));
+	setSongName(MusicLibrary::getInstance()->getSongTitle(song));
 }
 
 void AudioManager::changePlaylist(const std::shared_ptr<ThemeData>& theme, bool force)
@@ -655,7 +354,10 @@ void AudioManager::changePlaylist(const std::shared_ptr<ThemeData>& theme, bool
 	if (Settings::getInstance()->getBool("audio.thememusics"))
 	{
 		if (elem && elem->has("path") && !Settings::getInstance()->getBool("audio.persystem"))
+		{
 			mCurrentThemeMusicDirectory = elem->get<std::string>("path");
+			MusicLibrary::getInstance()->prepare(mCurrentThemeMusicDirectory);
+		}
 
 		std::string bgSound;
 
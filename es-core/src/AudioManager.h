@@ -23,7 +23,8 @@ private:
 	static AudioManager* sInstance;
 	
 	Mix_Music* mCurrentMusic; 
-	void getMusicIn(const std::string &path, std::vector<std::string>& all_matching_files); 
+	std::shared_ptr<std::vector<char>> mCurrentMusicData; // Preloaded file content, must live as long as mCurrentMusic
+	std::string getPlaylist();
 	void playMusic(const std::string& path);
 	static void musicEnd_callback();	
 
@@ -31,7 +32,9 @@ private:
 	std::string mCurrentSong;			// Song name displayed in pop-ups
 	std::string mCurrentThemeMusicDirectory;
 	std::string mCurrentMusicPath;                  //  Stores the full path of the currently playing song
-	std::deque<std::string> mLastPlayed;            // Stores recently played songs
+	std::string mNextSong;                          // Picked & preloaded while the current song is playing
+	std::string mNextPlaylist;
+	int			mNextGeneration;                    // MusicLibrary generation of mNextSong
 
 	bool		mInitialized;
 	std::string	mPlayingSystemThemeSong;
@@ -77,8 +80,6 @@ public:
 private:
 	void playSong(const std::string& song);
 	void setSongName(const std::string& song);
-	void addLastPlayed(const std::string& newSong, int totalMusic);
-	bool songWasPlayedRecently(const std::string& song);
 
 	bool mSongNameChanged;
 };
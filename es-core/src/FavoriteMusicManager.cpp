@@ -3,6 +3,7 @@
 #include "LocaleES.h"
 #include "utils/FileSystemUtil.h"
 #include "Settings.h"
+#include "MusicLibrary.h"
 #include "Window.h"
 #include "guis/GuiMsgBox.h"
 
@@ -77,6 +78,8 @@ bool FavoriteMusicManager::saveSongToFavorites(const std::string& path, const st
     ofs << path << ";" << name << "\n";
     ofs.close();
 
+    MusicLibrary::getInstance()->resetFavorites();
+
     return true;
 }
 
@@ -123,5 +126,7 @@ bool FavoriteMusicManager::removeSongFromFavorites(const std::string& path, cons
         ofs.close();
     }
 
+    MusicLibrary::getInstance()->resetFavorites();
+
     return true;
 }
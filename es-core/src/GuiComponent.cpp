@@ -14,6 +14,7 @@
 #include "Sound.h"
 #include "utils/StringUtil.h"
 #include "BindingManager.h"
+#include "Tracing.h"
 
 bool GuiComponent::isLaunchTransitionRunning = false;
 
@@ -127,8 +128,13 @@ void GuiComponent::render(const Transform4x4f& parentTrans)
 void GuiComponent::renderChildren(const Transform4x4f& transform) const
 {
 	for (auto child : mChildren)
+	{
 		if (child->mVisible)
+		{
+			TRACE_ZONE("GuiComponent::render");
 			TRYCATCH("GuiComponent::renderChildren", child->render(transform));
+		}
+	}
 }
 
 Vector3f GuiComponent::getPosition() const
@@ -414,7 +414,9 @@ HttpReq::Status HttpReq::status()
 					int http_status_code;
 					curl_easy_getinfo(msg->easy_handle, CURLINFO_RESPONSE_CODE, &http_status_code);					
 
-					if (http_status_code < 200 || http_status_code > 299)
+					if (http_status_code == 304)
+						req->mStatus = REQ_304_NOTMODIFIED;
+					else if (http_status_code < 200 || http_status_code > 299)
 					{
 						std::string err;
 
@@ -554,6 +556,11 @@ std::string HttpReq::getResponseHeader(const std::string& header)
 	auto it = mResponseHeaders.find(header);
 	if (it != mResponseHeaders.cend())
 		return it->second;
+
+	// HTTP/2 servers send lower case names
+	for (auto& item : mResponseHeaders)
+		if (Utils::String::compareIgnoreCase(item.first, header) == 0)
+			return item.second;
 		
 	return "";
 }
@@ -83,6 +83,7 @@ public:
 		REQ_FILESTREAM_ERROR = 4,		
 
 		REQ_SUCCESS = 200,
+		REQ_304_NOTMODIFIED = 304,		// conditional request ( If-None-Match / If-Modified-Since ) : the content is unchanged
 		REQ_400_BADREQUEST = 400,
 		REQ_401_FORBIDDEN = 401,
 		REQ_403_BADLOGIN = 403,
@@ -114,7 +115,7 @@ public:
 	std::string getUrl() { return mUrl; }
 	std::string getFilePath() { return mFilePath; }	
 	std::map<std::string, std::string>& getResponseHeaders() { return mResponseHeaders; }
-	std::string getResponseHeader(const std::string& header);
+	std::string getResponseHeader(const std::string& header); // header names are case insensitive
 
 	bool wait();
 
@@ -71,6 +71,9 @@ public:
 	void sendMouseClick(Window* window, int button);
 	InputConfig* getInputConfigByDevice(int deviceId);
 
+	// Maps the keyboard to the default keys ( arrows, enter, escape... ). Used by the benchmark, there's no user to configure it
+	void loadDefaultKBConfig();
+
 private:
 	InputManager();
 
@@ -80,7 +83,6 @@ private:
 	static const int DEADZONE = 23000;
 	static std::string getTemporaryConfigPath();
 
-	void loadDefaultKBConfig();
   	void loadDefaultGunConfig();
 
 	std::map<std::string, int> mJoysticksInitialValues;
@@ -0,0 +1,657 @@
+#include "MusicLibrary.h"
+#include "FavoriteMusicManager.h"
+
+#include "Log.h"
+#include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+#include "utils/Randomizer.h"
+#include "id3v2lib/include/id3v2lib.h"
+
+#include <algorithm>
+#include <string.h>
+
+// Bigger files are loaded by SDL_mixer from the disk
+#define MAX_PRELOAD_SIZE (32 * 1024 * 1024)
+
+const std::string MusicLibrary::FAVORITES = "favorites";
+
+MusicLibrary* MusicLibrary::sInstance = nullptr;
+
+MusicLibrary* MusicLibrary::getInstance()
+{
+	if (sInstance == nullptr)
+		sInstance = new MusicLibrary();
+
+	return sInstance;
+}
+
+void MusicLibrary::deinit()
+{
+	if (sInstance != nullptr)
+	{
+		delete sInstance;
+		sInstance = nullptr;
+	}
+}
+
+MusicLibrary::MusicLibrary() : mGeneration(0), mThread(nullptr), mExit(false)
+{
+
+}
+
+MusicLibrary::~MusicLibrary()
+{
+	std::thread* thread = nullptr;
+
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+		mExit = true;
+		thread = mThread;
+		mThread = nullptr;
+		mEvent.notify_one();
+	}
+
+	if (thread != nullptr)
+	{
+		thread->join();
+		delete thread;
+	}
+}
+
+void MusicLibrary::ensureThread()
+{
+	if (mThread == nullptr)
+	{
+		mExit = false;
+		mThread = new std::thread(&MusicLibrary::run, this);
+	}
+}
+
+void MusicLibrary::prepare(const std::string& path)
+{
+	if (path.empty())
+		return;
+
+	std::unique_lock<std::mutex> lock(mLock);
+
+	if (mFolders.find(path) != mFolders.cend() || !mQueued.insert(path).second)
+		return;
+
+	mQueue.push_back(path);
+	ensureThread();
+	mEvent.notify_one();
+}
+
+void MusicLibrary::reset()
+{
+	std::unique_lock<std::mutex> lock(mLock);
+	mFolders.clear();
+	mPlaylists.clear();
+	mQueue.clear();
+	mQueued.clear();
+	mPreloadPath = "";
+	mPreloadedPath = "";
+	mPreloadedData = nullptr;
+	mGeneration++;
+}
+
+void MusicLibrary::resetFavorites()
+{
+	std::unique_lock<std::mutex> lock(mLock);
+	mPlaylists.erase(FAVORITES);
+	mPreloadPath = "";
+	mPreloadedPath = "";
+	mPreloadedData = nullptr;
+	mGeneration++;
+}
+
+void MusicLibrary::run()
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	while (!mExit)
+	{
+		if (mQueue.size() > 0)
+		{
+			std::string path = mQueue.front();
+			mQueue.erase(mQueue.begin());
+
+			// The folder may have been listed synchronously in the meantime : only titles are missing then
+			std::shared_ptr<Folder> folder;
+
+			auto it = mFolders.find(path);
+			if (it != mFolders.cend())
+				folder = it->second;
+			else
+			{
+				int generation = mGeneration;
+
+				lock.unlock();
+				folder = scanFolder(path);
+				lock.lock();
+
+				if (mExit)
+					break;
+
+				// Reset while scanning : the folder will be scanned again when needed
+				if (generation != mGeneration)
+					continue;
+
+				auto result = mFolders.insert(std::make_pair(path, folder));
+				folder = result.first->second;
+			}
+
+			mQueued.erase(path);
+
+			lock.unlock();
+			readTitles(folder);
+			lock.lock();
+			continue;
+		}
+
+		if (!mPreloadPath.empty())
+		{
+			std::string path = mPreloadPath;
+			mPreloadPath = "";
+
+			lock.unlock();
+
+			std::shared_ptr<std::vector<char>> data;
+			if (Utils::FileSystem::getFileSize(path) <= MAX_PRELOAD_SIZE)
+			{
+				data = std::make_shared<std::vector<char>>(Utils::FileSystem::readAllBytes(path));
+				if (data->size() == 0)
+					data = nullptr;
+			}
+
+			lock.lock();
+
+			// Another song was requested while loading this one
+			if (data != nullptr && mPreloadPath.empty())
+			{
+				mPreloadedPath = path;
+				mPreloadedData = data;
+			}
+
+			continue;
+		}
+
+		mEvent.wait(lock);
+	}
+}
+
+void MusicLibrary::readTitles(const std::shared_ptr<Folder>& folder)
+{
+	for (auto song : folder->songs)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mLock);
+			if (mExit)
+				return;
+
+			if (mTitles.find(song) != mTitles.cend())
+				continue;
+		}
+
+		std::string title = readSongTitle(song);
+
+		std::unique_lock<std::mutex> lock(mLock);
+		mTitles[song] = title;
+	}
+
+	for (auto child : folder->folders)
+		readTitles(child.second);
+}
+
+std::shared_ptr<MusicLibrary::Folder> MusicLibrary::scanFolder(const std::string& path)
+{
+	auto folder = std::make_shared<Folder>();
+
+	for (auto file : Utils::FileSystem::getDirectoryFiles(path))
+	{
+		if (file.hidden)
+			continue;
+
+		if (file.directory)
+			folder->folders[Utils::FileSystem::getFileName(file.path)] = scanFolder(file.path);
+		else if (Utils::FileSystem::isAudio(file.path))
+			folder->songs.push_back(file.path);
+	}
+
+	return folder;
+}
+
+void MusicLibrary::collectSongs(const std::shared_ptr<Folder>& folder, const std::string& systemName, bool anySystem, std::vector<std::string>& songs)
+{
+	songs.insert(songs.end(), folder->songs.cbegin(), folder->songs.cend());
+
+	for (auto child : folder->folders)
+		if (anySystem || systemName == child.first)
+			collectSongs(child.second, systemName, anySystem, songs);
+}
+
+std::string MusicLibrary::getPlaylist(const std::string& path, const std::string& systemName, bool anySystem)
+{
+	if (path.empty())
+		return "";
+
+	std::string key = path + (anySystem ? "|*" : "|" + systemName);
+
+	std::unique_lock<std::mutex> lock(mLock);
+
+	auto it = mPlaylists.find(key);
+	if (it != mPlaylists.cend())
+		return it->second.songs.size() == 0 ? "" : key;
+
+	std::shared_ptr<Folder> folder;
+
+	auto fit = mFolders.find(path);
+	if (fit != mFolders.cend())
+		folder = fit->second;
+	else
+	{
+		// Not indexed yet : list it now, titles will be read by the background thread
+		lock.unlock();
+		folder = scanFolder(path);
+		lock.lock();
+
+		auto result = mFolders.insert(std::make_pair(path, folder));
+		folder = result.first->second;
+
+		if (folder->songs.size() > 0 || folder->folders.size() > 0)
+		{
+			if (mQueued.insert(path).second)
+				mQueue.push_back(path);
+
+			ensureThread();
+			mEvent.notify_one();
+		}
+	}
+
+	Playlist& playlist = mPlaylists[key];
+	collectSongs(folder, systemName, anySystem, playlist.songs);
+	playlist.remaining = playlist.songs.size();
+
+	return playlist.songs.size() == 0 ? "" : key;
+}
+
+std::string MusicLibrary::getFavoritesPlaylist()
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	auto it = mPlaylists.find(FAVORITES);
+	if (it == mPlaylists.cend())
+	{
+		lock.unlock();
+		auto favorites = FavoriteMusicManager::loadFavoriteSongs(FavoriteMusicManager::getFavoriteMusicFilePath());
+		lock.lock();
+
+		Playlist& playlist = mPlaylists[FAVORITES];
+		playlist.songs.clear();
+
+		for (auto favorite : favorites)
+			playlist.songs.push_back(favorite.first);
+
+		playlist.remaining = playlist.songs.size();
+
+		it = mPlaylists.find(FAVORITES);
+	}
+
+	return it->second.songs.size() == 0 ? "" : FAVORITES;
+}
+
+bool MusicLibrary::pick(const std::string& playlistName, std::string& song)
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	auto it = mPlaylists.find(playlistName);
+	if (it == mPlaylists.cend())
+		return false;
+
+	Playlist& playlist = it->second;
+	if (playlist.songs.size() == 0)
+		return false;
+
+	if (playlist.remaining == 0)
+		playlist.remaining = playlist.songs.size();
+
+	size_t index = (size_t)Randomizer::random((int)playlist.remaining);
+
+	// Don't play the same song twice when a new round starts
+	if (playlist.remaining > 1 && playlist.songs[index] == playlist.last)
+		index = (index + 1) % playlist.remaining;
+
+	size_t last = playlist.remaining - 1;
+	if (index != last)
+		std::swap(playlist.songs[index], playlist.songs[last]);
+
+	playlist.remaining--;
+
+	song = playlist.songs[last];
+	playlist.last = song;
+	return true;
+}
+
+void MusicLibrary::discard(const std::string& song)
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	for (auto& it : mPlaylists)
+	{
+		Playlist& playlist = it.second;
+
+		auto sit = std::find(playlist.songs.begin(), playlist.songs.end(), song);
+		if (sit == playlist.songs.end())
+			continue;
+
+		size_t index = sit - playlist.songs.begin();
+		if (index < playlist.remaining)
+		{
+			std::swap(playlist.songs[index], playlist.songs[playlist.remaining - 1]);
+			playlist.remaining--;
+			index = playlist.remaining;
+		}
+
+		playlist.songs.erase(playlist.songs.begin() + index);
+	}
+
+	if (mPreloadedPath == song)
+	{
+		mPreloadedPath = "";
+		mPreloadedData = nullptr;
+	}
+}
+
+std::string MusicLibrary::getSongTitle(const std::string& song)
+{
+	if (song.empty())
+		return "";
+
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+
+		auto it = mTitles.find(song);
+		if (it != mTitles.cend())
+			return it->second;
+	}
+
+	std::string title = readSongTitle(song);
+
+	std::unique_lock<std::mutex> lock(mLock);
+	mTitles[song] = title;
+	return title;
+}
+
+void MusicLibrary::preload(const std::string& song)
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	if (song.empty() || mPreloadedPath == song || mPreloadPath == song)
+		return;
+
+	mPreloadPath = song;
+	ensureThread();
+	mEvent.notify_one();
+}
+
+std::shared_ptr<std::vector<char>> MusicLibrary::getPreloadedData(const std::string& song)
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	if (mPreloadedPath != song)
+		return nullptr;
+
+	auto data = mPreloadedData;
+	mPreloadedPath = "";
+	mPreloadedData = nullptr;
+	return data;
+}
+
+static std::string utf16_to_utf8(const std::u16string& u16)
+{
+    std::string out;
+    out.reserve(u16.size() * 3); // upper bound for BMP chars
+
+    for (size_t i = 0; i < u16.size(); ++i)
+    {
+        uint32_t code = u16[i];
+
+        // Handle surrogate pairs (just in case)
+        if (code >= 0xD800 && code <= 0xDBFF && (i + 1) < u16.size())
+        {
+            uint32_t low = u16[i + 1];
+            if (low >= 0xDC00 && low <= 0xDFFF)
+            {
+                code = (((code - 0xD800) << 10) | (low - 0xDC00)) + 0x10000;
+                ++i; // consumed low surrogate
+            }
+        }
+
+        if (code <= 0x7F)
+        {
+            out.push_back(static_cast<char>(code));
+        }
+        else if (code <= 0x7FF)
+        {
+            out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        }
+        else if (code <= 0xFFFF)
+        {
+            out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        }
+        else
+        {
+            out.push_back(static_cast<char>(0xF0 | (code >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        }
+    }
+
+    return out;
+}
+
+static std::string decode_text_frame(const ID3v2_TextFrameData* data)
+{
+    if (!data || !data->text || data->size <= 0)
+        return {};
+
+    const unsigned char* bytes =
+        reinterpret_cast<const unsigned char*>(data->text);
+    size_t len = static_cast<size_t>(data->size);
+
+    // ISO-8859-1 / “ANSI” branch
+    if (data->encoding == ID3v2_ENCODING_ISO)
+    {
+        if (len > 0 && bytes[len - 1] == 0x00)
+            --len; // drop trailing NUL
+
+        return std::string(reinterpret_cast<const char*>(bytes),
+                           reinterpret_cast<const char*>(bytes) + len);
+    }
+
+    // UNICODE branch: UTF‑16 with BOM + 0x0000 terminator
+    if (len < 4)
+        return {};
+
+    bool little_endian = false;
+    size_t offset = 0;
+
+    if (bytes[0] == 0xFF && bytes[1] == 0xFE) {
+        little_endian = true;
+        offset = 2;
+    } else if (bytes[0] == 0xFE && bytes[1] == 0xFF) {
+        little_endian = false;
+        offset = 2;
+    }
+
+    if (offset >= len)
+        return {};
+
+    const unsigned char* p = bytes + offset;
+    len -= offset;
+
+    // Trim trailing UTF‑16 0x0000
+    if (len >= 2 && p[len - 2] == 0x00 && p[len - 1] == 0x00)
+        len -= 2;
+
+    std::u16string u16;
+    u16.reserve(len / 2);
+
+    for (size_t i = 0; i + 1 < len; i += 2)
+    {
+        char16_t ch;
+        if (little_endian)
+            ch = static_cast<char16_t>(p[i] | (p[i + 1] << 8));
+        else
+            ch = static_cast<char16_t>(p[i + 1] | (p[i] << 8));
+
+        u16.push_back(ch);
+    }
+
+	return utf16_to_utf8(u16);
+}
+
+// Fast string hash in order to use strings in switch/case
+// How does this work? Look for Dan Bernstein hash on the internet
+constexpr unsigned int sthash(const char *s, int off = 0)
+{
+	return !s[off] ? 5381 : (sthash(s, off+1)*33) ^ s[off];
+}
+
+std::string MusicLibrary::readSongTitle(const std::string& song)
+{
+	std::string ext = Utils::String::toLower(Utils::FileSystem::getExtension(song));
+	// chiptunes mod song titles parsing
+	if (ext == ".mod" || ext == ".s3m" || ext == ".stm" || ext == ".669" || ext == ".mtm" || ext == ".far" || ext == ".xm" || ext == ".it" )
+	{
+		int title_offset;
+		int title_break;
+		struct {
+			char title[108] = "";
+		} info;
+		switch (sthash(ext.c_str())) {
+			case sthash(".mod"):
+			case sthash(".stm"):
+				title_offset = 0;
+				title_break = 20;
+				break;
+			case sthash(".s3m"):
+				title_offset = 0;
+				title_break = 28;
+				break;
+			case sthash(".669"):
+				title_offset = 0;
+				title_break = 108;
+				break;
+			case sthash(".mtm"):
+			case sthash(".it"):
+				title_offset = 4;
+				title_break = 20;
+				break;
+			case sthash(".far"):
+				title_offset = 4;
+				title_break = 40;
+				break;
+			case sthash(".xm"):
+				title_offset = 17;
+				title_break = 20;
+				break;
+			default:
+				LOG(LogError) << "Error MusicLibrary unexpected case while loading mofile " << song;
+				return Utils::FileSystem::getStem(song.c_str());
+		}
+
+		FILE* file = fopen(song.c_str(), "r");
+		if (file != NULL)
+		{
+			if (fseek(file, title_offset, SEEK_SET) < 0)
+				LOG(LogError) << "Error MusicLibrary seeking " << song;
+			else if (fread(&info, sizeof(info), 1, file) != 1)
+				LOG(LogError) << "Error MusicLibrary reading " << song;
+			else  
+			{
+				info.title[title_break] = '\0';
+
+				std::string name = info.title;
+				if (!name.empty())
+				{
+					fclose(file);
+					return name;
+				}
+			}
+
+			fclose(file);
+		}
+		else
+			LOG(LogError) << "Error MusicLibrary opening modfile " << song;
+	}
+
+	// now only mp3 will be parsed for ID3: .ogg, .wav and .flac will display file name
+	if (ext != ".mp3")
+		return Utils::FileSystem::getStem(song.c_str());
+
+	// First let's try with an ID3 v2 tag
+	ID3v2_Tag* tag = ID3v2_read_tag(song.c_str());
+	if (tag != nullptr)
+	{
+		ID3v2_TextFrame* title_frame = ID3v2_Tag_get_title_frame(tag);
+		if (title_frame != nullptr)
+		{
+			std::string song_name = decode_text_frame(title_frame->data);
+
+			ID3v2_TextFrame* artist_frame = ID3v2_Tag_get_artist_frame(tag);
+			if (artist_frame != nullptr)
+			{
+				song_name += " - " + decode_text_frame(artist_frame->data);
+				free(artist_frame);
+			}
+
+			free(title_frame);
+			free(tag);
+			return Utils::String::trim(song_name);
+		}
+		free(tag);
+	}
+
+	// Then, if no v2, let's try with an ID3 v1 tag	
+	struct {
+		char tag[3];	// i.e. "TAG"
+		char title[30];
+		char artist[30];
+		char album[30];
+		char year[4];
+		char comment[30];
+		unsigned char genre;
+	} info;
+
+	FILE* file = fopen(song.c_str(), "r");
+	if (file != NULL)
+	{
+		if (fseek(file, -128, SEEK_END) < 0)
+			LOG(LogError) << "Error MusicLibrary seeking " << song;
+		else if (fread(&info, sizeof(info), 1, file) != 1)
+			LOG(LogError) << "Error MusicLibrary reading " << song;
+		else if (strncmp(info.tag, "TAG", 3) == 0) 
+		{
+			std::string songTitle(info.title, 30);
+			songTitle = " - " + songTitle.substr(0, 30);
+			if (info.artist != NULL) 
+			{
+				std::string songArtist(info.artist, 30);
+				songTitle += " - " + songArtist.substr(0, 30);
+			}
+			fclose(file);
+			return songTitle;
+		}
+
+		fclose(file);
+	}
+	else
+		LOG(LogError) << "Error MusicLibrary opening mp3 file " << song;
+
+	return Utils::FileSystem::getStem(song.c_str());
+}
@@ -0,0 +1,107 @@
+#pragma once
+#ifndef ES_CORE_MUSIC_LIBRARY_H
+#define ES_CORE_MUSIC_LIBRARY_H
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <map>
+#include <set>
+#include <string>
+
+// Index of the music folders used by AudioManager.
+// Folders are scanned once by a background thread, song titles ( mod titles, ID3 tags ) are extracted there too.
+// Playlists are partitioned per system folder and shuffled without repeat : a pick is O(1).
+// The next song can be preloaded in memory so that switching songs doesn't hit the disk.
+class MusicLibrary
+{
+public:
+	static const std::string FAVORITES;
+
+	static MusicLibrary* getInstance();
+
+	// Stops the background thread
+	static void deinit();
+
+	// Queue a background scan of a music folder
+	void prepare(const std::string& path);
+
+	// Forget every folder, playlist & preloaded song. Folders will be scanned again when needed
+	void reset();
+
+	// Favorites playlist must be rebuilt ( favorites.m3u was modified )
+	void resetFavorites();
+
+	// Changes on every reset : a song picked before is not valid anymore
+	int getGeneration() { return mGeneration; }
+
+	// Returns the playlist of a music folder : songs at its root, and songs in subfolders named systemName unless anySystem is set.
+	// Returns an empty string if there's no song. If the folder is not indexed yet, it is listed synchronously
+	std::string getPlaylist(const std::string& path, const std::string& systemName, bool anySystem);
+	std::string getFavoritesPlaylist();
+
+	// Pick a song in a playlist. Songs don't repeat until every song of the playlist was played
+	bool pick(const std::string& playlist, std::string& song);
+
+	// Remove a song which can't be played from every playlist
+	void discard(const std::string& song);
+
+	// Song name displayed in pop-ups, read from the file if it is not known yet
+	std::string getSongTitle(const std::string& song);
+
+	// Load the file content in the background
+	void preload(const std::string& song);
+	std::shared_ptr<std::vector<char>> getPreloadedData(const std::string& song);
+
+private:
+	MusicLibrary();
+	~MusicLibrary();
+
+	struct Folder
+	{
+		std::vector<std::string> songs;
+		std::map<std::string, std::shared_ptr<Folder>> folders;
+	};
+
+	struct Playlist
+	{
+		Playlist() : remaining(0) { }
+
+		std::vector<std::string> songs;
+		size_t remaining; // songs [0, remaining) have not been played during the current round
+		std::string last;
+	};
+
+	static std::shared_ptr<Folder> scanFolder(const std::string& path);
+	static void collectSongs(const std::shared_ptr<Folder>& folder, const std::string& systemName, bool anySystem, std::vector<std::string>& songs);
+	static std::string readSongTitle(const std::string& song);
+
+	void run();
+	void ensureThread();
+	void readTitles(const std::shared_ptr<Folder>& folder);
+
+	std::map<std::string, std::shared_ptr<Folder>> mFolders;
+	std::map<std::string, Playlist> mPlaylists;
+	std::map<std::string, std::string> mTitles;
+
+	std::vector<std::string> mQueue;
+	std::set<std::string>	 mQueued;
+
+	std::string							mPreloadPath;
+	std::string							mPreloadedPath;
+	std::shared_ptr<std::vector<char>>	mPreloadedData;
+
+	std::atomic<int>		mGeneration;
+
+	std::mutex				mLock;
+	std::condition_variable mEvent;
+	std::thread*			mThread;
+	bool					mExit;
+
+	static MusicLibrary* sInstance;
+};
+
+#endif // ES_CORE_MUSIC_LIBRARY_H
@@ -5,10 +5,30 @@
 #include "utils/StringUtil.h"
 #include "utils/VectorEx.h"
 #include "Paths.h"
+#include "Settings.h"
 #include <thread>
 #include <set>
 #include <map>
+#include <list>
 #include <mutex>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+
+#ifndef WIN32
+#include <sys/inotify.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// High frequency events are delayed, only the last one of a burst runs its scripts
+#define SCRIPT_DEBOUNCE_MS          150
+// Lifetime of the script inventory when a folder can't be watched for changes
+#define SCRIPT_INVENTORY_TTL_MS     5000
 
 using namespace Utils::Platform;
 
@@ -72,18 +92,11 @@ namespace Scripting
     }
 #endif
 
-    void exitScriptingEngine()
-    {
-#if WIN32
-        std::unique_lock<std::mutex> lock(mScriptQueueLock);
-        mExitScriptQueue = true;
-        mScriptQueueEvent.notify_one();
-#endif
-    }
-
     static std::set<std::string> _asyncEvents = { "game-start", "game-end", "game-selected", "system-selected", "screensaver-start", "screensaver-stop", "sleep", "wake" };
+    static std::set<std::string> _debouncedEvents = { "game-selected", "system-selected" };
 
     static inline bool isAsyncEvent(const std::string& eventName) { return _asyncEvents.find(eventName) != _asyncEvents.cend(); }
+    static inline bool isDebouncedEvent(const std::string& eventName) { return _debouncedEvents.find(eventName) != _debouncedEvents.cend(); }
 
     static void executeScript(const std::string& script, const std::string& eventName, const std::string& arg1, const std::string& arg2, const std::string& arg3, bool allowAsync = true)
     {
@@ -150,60 +163,498 @@ namespace Scripting
 
     static std::set<std::string> _supportedExtensions = { ".exe", ".cmd", ".bat", ".ps1", ".sh", ".py" };
 
-    void fireEvent(const std::string& eventName, const std::string& arg1, const std::string& arg2, const std::string& arg3)
-    {
-        LOG(LogDebug) << "fireEvent: " << eventName << " " << arg1 << " " << arg2 << " " << arg3;
+    // Script inventory : folder listings are cached until a change is notified by inotify.
+    // Folders that can't be watched ( no inotify ) make the inventory expire after SCRIPT_INVENTORY_TTL_MS
+    static std::mutex                                           mInventoryLock;
+    static std::map<std::string, std::vector<std::string>>      mEventScripts;  // scripts/<event>/*, called without the event name
+    static std::vector<std::string>                             mGlobalScripts; // scripts/*, called with the event name as 1st arg
+    static bool                                                 mGlobalScriptsLoaded = false;
+    static bool                                                 mInventoryWatched = true;
+    static std::chrono::steady_clock::time_point                mInventoryTime = std::chrono::steady_clock::now();
+#ifndef WIN32
+    static int                                                  mInotifyFd = -1;
+    static bool                                                 mInotifyClosed = false; // exiting : "quit" scripts may still be listed
+#endif
 
-        // Process splitted paths scripts
-        std::vector<std::string> scriptDirList =
+    static std::vector<std::string> getGlobalScriptDirs()
+    {
+        std::vector<std::string> paths =
         {
-            Paths::getUserEmulationStationPath() + "/scripts/" + eventName,
-            Paths::getEmulationStationPath() + "/scripts/" + eventName,
+            Paths::getUserEmulationStationPath() + "/scripts",
+            Paths::getEmulationStationPath() + "/scripts",
 #ifndef WIN32
-            "/var/run/emulationstation/scripts/" + eventName
+            "/var/run/emulationstation/scripts"
 #endif
         };
 
-        for (auto dir : VectorHelper::distinct(scriptDirList, [](auto x) { return x; }))
+        return VectorHelper::distinct(paths, [](auto x) { return x; });
+    }
+
+    // Must be called with mInventoryLock held. Returns false if changes in path won't be notified
+    static bool watchDirectory(const std::string& path)
+    {
+#ifndef WIN32
+        if (mInotifyClosed)
+            return true;
+
+        if (mInotifyFd < 0)
+            mInotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+        if (mInotifyFd < 0)
+            return false;
+
+        const uint32_t mask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ATTRIB | IN_CLOSE_WRITE | IN_DELETE_SELF | IN_MOVE_SELF;
+        return inotify_add_watch(mInotifyFd, path.c_str(), mask) >= 0;
+#else
+        return false;
+#endif
+    }
+
+    // A missing folder is covered by its nearest existing ancestor : creating the next level clears the inventory, which then watches deeper
+    static void watchScriptDirectory(const std::string& path)
+    {
+        std::string dir = path;
+        while (!dir.empty() && !Utils::FileSystem::exists(dir))
         {
-            auto scripts = Utils::FileSystem::getDirContent(dir);
-            for (auto script : scripts)
+            std::string parent = Utils::FileSystem::getParent(dir);
+            if (parent == dir)
+                break;
+
+            dir = parent;
+        }
+
+        if (dir.empty() || !Utils::FileSystem::exists(dir) || !watchDirectory(dir))
+            mInventoryWatched = false;
+    }
+
+    // Must be called with mInventoryLock held
+    static void checkInventory()
+    {
+        bool changed = false;
+
+#ifndef WIN32
+        if (mInotifyFd >= 0)
+        {
+            char buffer[4096];
+            while (read(mInotifyFd, buffer, sizeof(buffer)) > 0)
+                changed = true;
+        }
+#endif
+
+        if (!mInventoryWatched && std::chrono::steady_clock::now() - mInventoryTime > std::chrono::milliseconds(SCRIPT_INVENTORY_TTL_MS))
+            changed = true;
+
+        if (!changed)
+            return;
+
+        mEventScripts.clear();
+        mGlobalScripts.clear();
+        mGlobalScriptsLoaded = false;
+        mInventoryWatched = true;
+        mInventoryTime = std::chrono::steady_clock::now();
+    }
+
+    static void getScripts(const std::string& eventName, std::vector<std::string>& eventScripts, std::vector<std::string>& globalScripts)
+    {
+        std::unique_lock<std::mutex> lock(mInventoryLock);
+
+        checkInventory();
+
+        auto it = mEventScripts.find(eventName);
+        if (it == mEventScripts.cend())
+        {
+            std::vector<std::string> scripts;
+
+            for (auto root : getGlobalScriptDirs())
             {
+                std::string dir = root + "/" + eventName;
+                watchScriptDirectory(dir);
+
+                for (auto script : Utils::FileSystem::getDirContent(dir))
+                {
 #if WIN32
-                auto ext = Utils::String::toLower(Utils::FileSystem::getExtension(script));
-                if (_supportedExtensions.find(ext) == _supportedExtensions.cend())
-                    continue;
+                    auto ext = Utils::String::toLower(Utils::FileSystem::getExtension(script));
+                    if (_supportedExtensions.find(ext) == _supportedExtensions.cend())
+                        continue;
 #endif
-                executeScript(script, "", arg1, arg2, arg3, isAsyncEvent(eventName));
+                    scripts.push_back(script);
+                }
             }
+
+            it = mEventScripts.insert(std::make_pair(eventName, scripts)).first;
         }
 
-        // Process single scripts. This type of scripts are called with the event name as 1st arg
-        std::vector<std::string> paths =
+        if (!mGlobalScriptsLoaded)
         {
-            Paths::getUserEmulationStationPath() + "/scripts",
-            Paths::getEmulationStationPath() + "/scripts",
+            for (auto dir : getGlobalScriptDirs())
+            {
+                watchScriptDirectory(dir);
+
+                if (!Utils::FileSystem::exists(dir))
+                    continue;
+
+                for (auto script : Utils::FileSystem::getDirectoryFiles(dir))
+                {
+                    if (script.directory)
+                        continue;
+
+                    auto ext = Utils::String::toLower(Utils::FileSystem::getExtension(script.path));
+                    if (_supportedExtensions.find(ext) == _supportedExtensions.cend())
+                        continue;
+
+                    mGlobalScripts.push_back(script.path);
+                }
+            }
+
+            mGlobalScriptsLoaded = true;
+        }
+
+        eventScripts = it->second;
+        globalScripts = mGlobalScripts;
+    }
+
 #ifndef WIN32
-            "/var/run/emulationstation/scripts"
+    // Subscriber channel : clients connected to the unix socket receive every event as a line of JSON,
+    // {"event":"game-selected","args":["arg1","arg2","arg3"]}. Debounced events are sent once, like scripts.
+    // Clients are never read from, and are dropped as soon as they can't keep up.
+    static int                  mSocketFd = -1;
+    static int                  mSocketWakePipe[2] = { -1, -1 };
+    static std::thread*         mSocketThread = nullptr;
+    static std::string          mSocketPath;
+    static std::vector<int>     mSubscribers;
+    static std::mutex           mSubscribersLock;
+
+    static void socketThread()
+    {
+        while (true)
+        {
+            struct pollfd fds[2];
+            fds[0].fd = mSocketFd;
+            fds[0].events = POLLIN;
+            fds[1].fd = mSocketWakePipe[0];
+            fds[1].events = POLLIN;
+
+            if (poll(fds, 2, -1) < 0)
+                continue;
+
+            if (fds[1].revents != 0)
+                break;
+
+            if ((fds[0].revents & POLLIN) == 0)
+                continue;
+
+            int client = accept4(mSocketFd, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+            if (client < 0)
+                continue;
+
+            LOG(LogDebug) << "Scripting : event subscriber connected";
+
+            std::unique_lock<std::mutex> lock(mSubscribersLock);
+            mSubscribers.push_back(client);
+        }
+    }
+
+    static void startEventSocket()
+    {
+        mSocketPath = Paths::getUserEmulationStationPath() + "/events.sock";
+
+        struct sockaddr_un address;
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+
+        if (mSocketPath.size() >= sizeof(address.sun_path))
+        {
+            LOG(LogError) << "Scripting : event socket path is too long " << mSocketPath;
+            return;
+        }
+
+        strcpy(address.sun_path, mSocketPath.c_str());
+        unlink(mSocketPath.c_str());
+
+        mSocketFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (mSocketFd < 0 || bind(mSocketFd, (struct sockaddr*)&address, sizeof(address)) < 0 || listen(mSocketFd, 4) < 0 || pipe2(mSocketWakePipe, O_CLOEXEC) < 0)
+        {
+            LOG(LogError) << "Scripting : unable to create event socket " << mSocketPath;
+
+            if (mSocketFd >= 0)
+                close(mSocketFd);
+
+            mSocketFd = -1;
+            return;
+        }
+
+        chmod(mSocketPath.c_str(), 0600);
+
+        LOG(LogInfo) << "Scripting : events are published on " << mSocketPath;
+        mSocketThread = new std::thread(&socketThread);
+    }
+
+    static void stopEventSocket()
+    {
+        if (mSocketThread == nullptr)
+            return;
+
+        char wake = 1;
+        if (write(mSocketWakePipe[1], &wake, 1) < 0)
+            LOG(LogWarning) << "Scripting : unable to stop the event socket thread";
+
+        mSocketThread->join();
+        delete mSocketThread;
+        mSocketThread = nullptr;
+
+        std::unique_lock<std::mutex> lock(mSubscribersLock);
+
+        for (auto client : mSubscribers)
+            close(client);
+
+        mSubscribers.clear();
+
+        close(mSocketFd);
+        close(mSocketWakePipe[0]);
+        close(mSocketWakePipe[1]);
+        mSocketFd = -1;
+
+        unlink(mSocketPath.c_str());
+    }
+
+    static std::string jsonEscape(const std::string& value)
+    {
+        std::string ret;
+        ret.reserve(value.size());
+
+        for (auto c : value)
+        {
+            switch (c)
+            {
+            case '"': ret += "\\\""; break;
+            case '\\': ret += "\\\\"; break;
+            case '\n': ret += "\\n"; break;
+            case '\r': ret += "\\r"; break;
+            case '\t': ret += "\\t"; break;
+            default:
+                if ((unsigned char)c < 0x20)
+                {
+                    char hex[8];
+                    snprintf(hex, sizeof(hex), "\\u%04x", (unsigned char)c);
+                    ret += hex;
+                }
+                else
+                    ret += c;
+            }
+        }
+
+        return ret;
+    }
+
+    static void publishEvent(const std::string& eventName, const std::string& arg1, const std::string& arg2, const std::string& arg3)
+    {
+        std::unique_lock<std::mutex> lock(mSubscribersLock);
+        if (mSubscribers.size() == 0)
+            return;
+
+        std::string line = "{\"event\":\"" + jsonEscape(eventName) + "\",\"args\":[\"" + jsonEscape(arg1) + "\",\"" + jsonEscape(arg2) + "\",\"" + jsonEscape(arg3) + "\"]}\n";
+
+        for (auto it = mSubscribers.begin(); it != mSubscribers.end(); )
+        {
+            ssize_t written = send(*it, line.c_str(), line.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (written == (ssize_t)line.size())
+            {
+                it++;
+                continue;
+            }
+
+            // Disconnected, or a partial line would break the stream
+            LOG(LogDebug) << "Scripting : event subscriber dropped";
+
+            close(*it);
+            it = mSubscribers.erase(it);
+        }
+    }
 #endif
-        };
 
-        for (auto dir : VectorHelper::distinct(paths, [](auto x) { return x; }))
+    static void runEvent(const std::string& eventName, const std::string& arg1, const std::string& arg2, const std::string& arg3)
+    {
+#ifndef WIN32
+        publishEvent(eventName, arg1, arg2, arg3);
+#endif
+
+        std::vector<std::string> eventScripts;
+        std::vector<std::string> globalScripts;
+        getScripts(eventName, eventScripts, globalScripts);
+
+        // Process splitted paths scripts
+        for (auto script : eventScripts)
+            executeScript(script, "", arg1, arg2, arg3, isAsyncEvent(eventName));
+
+        // Process single scripts. This type of scripts are called with the event name as 1st arg
+        for (auto script : globalScripts)
+            executeScript(script, eventName, arg1, arg2, arg3, isAsyncEvent(eventName));
+    }
+
+    // Async events are run by a dispatcher thread, so scripts are never started from the UI thread
+    struct ScriptEvent
+    {
+        std::string                             name;
+        std::string                             arg1;
+        std::string                             arg2;
+        std::string                             arg3;
+        std::chrono::steady_clock::time_point   due;
+    };
+
+    static std::thread*                 mEventThread = nullptr;
+    static std::list<ScriptEvent>       mEventQueue;
+    static std::mutex                   mEventLock;
+    static std::condition_variable      mEventSignal;
+    static bool                         mExitEventThread = false;
+    static bool                         mEventSocketChecked = false;
+
+    static void eventThread()
+    {
+        std::unique_lock<std::mutex> lock(mEventLock);
+
+        // When exiting, the pending events are flushed without waiting for their delay
+        while (!mExitEventThread || !mEventQueue.empty())
         {
-            if (!Utils::FileSystem::exists(dir))
+            if (mEventQueue.empty())
+            {
+                mEventSignal.wait(lock);
                 continue;
+            }
+
+            // First due event. Debounced events waiting for their delay don't block the others
+            auto now = mExitEventThread ? std::chrono::steady_clock::time_point::max() : std::chrono::steady_clock::now();
+            auto next = mEventQueue.end();
+            auto earliest = std::chrono::steady_clock::time_point::max();
 
-            for (auto script : Utils::FileSystem::getDirectoryFiles(dir))
+            for (auto it = mEventQueue.begin(); it != mEventQueue.end(); it++)
             {
-                if (script.directory)
-                    continue;
+                if (it->due <= now)
+                {
+                    next = it;
+                    break;
+                }
+
+                if (it->due < earliest)
+                    earliest = it->due;
+            }
+
+            if (next == mEventQueue.end())
+            {
+                mEventSignal.wait_until(lock, earliest);
+                continue;
+            }
+
+            ScriptEvent evt = *next;
+            mEventQueue.erase(next);
+
+            lock.unlock();
+            runEvent(evt.name, evt.arg1, evt.arg2, evt.arg3);
+            lock.lock();
+        }
+    }
+
+    void exitScriptingEngine()
+    {
+        {
+            std::unique_lock<std::mutex> lock(mEventLock);
+            mExitEventThread = true;
+            mEventSignal.notify_one();
+        }
+
+        if (mEventThread != nullptr)
+        {
+            mEventThread->join();
+            delete mEventThread;
+            mEventThread = nullptr;
+        }
+
+#ifndef WIN32
+        stopEventSocket();
+
+        std::unique_lock<std::mutex> inventoryLock(mInventoryLock);
+        mInotifyClosed = true;
+        if (mInotifyFd >= 0)
+        {
+            close(mInotifyFd);
+            mInotifyFd = -1;
+        }
+#else
+        std::unique_lock<std::mutex> lock(mScriptQueueLock);
+        mExitScriptQueue = true;
+        mScriptQueueEvent.notify_one();
+#endif
+    }
+
+    void fireEvent(const std::string& eventName, const std::string& arg1, const std::string& arg2, const std::string& arg3)
+    {
+        LOG(LogDebug) << "fireEvent: " << eventName << " " << arg1 << " " << arg2 << " " << arg3;
+
+        std::unique_lock<std::mutex> lock(mEventLock);
+
+        // The engine is stopped before the quit mode is processed : its scripts still run on the calling thread
+        if (mExitEventThread)
+        {
+            if (isAsyncEvent(eventName))
+                return;
+
+            lock.unlock();
+            runEvent(eventName, arg1, arg2, arg3);
+            return;
+        }
+
+#ifndef WIN32
+        if (!mEventSocketChecked)
+        {
+            mEventSocketChecked = true;
+
+            if (Settings::getInstance()->getBool("ScriptEventSocket"))
+                startEventSocket();
+        }
+#endif
 
-                auto ext = Utils::String::toLower(Utils::FileSystem::getExtension(script.path));
-                if (_supportedExtensions.find(ext) == _supportedExtensions.cend())
+        // Other events keep running on the calling thread : "quit" scripts must be done before exiting
+        if (!isAsyncEvent(eventName))
+        {
+            lock.unlock();
+            runEvent(eventName, arg1, arg2, arg3);
+            return;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+
+        if (isDebouncedEvent(eventName))
+        {
+            // Coalesce with the pending one : only the last arguments matter
+            for (auto& pending : mEventQueue)
+            {
+                if (pending.name != eventName)
                     continue;
 
-                executeScript(script.path, eventName, arg1, arg2, arg3, isAsyncEvent(eventName));
+                pending.arg1 = arg1;
+                pending.arg2 = arg2;
+                pending.arg3 = arg3;
+                pending.due = now + std::chrono::milliseconds(SCRIPT_DEBOUNCE_MS);
+                return;
             }
         }
+        else
+        {
+            // Keep the order : pending debounced events run before this one
+            for (auto& pending : mEventQueue)
+                pending.due = now;
+        }
+
+        ScriptEvent evt;
+        evt.name = eventName;
+        evt.arg1 = arg1;
+        evt.arg2 = arg2;
+        evt.arg3 = arg3;
+        evt.due = isDebouncedEvent(eventName) ? now + std::chrono::milliseconds(SCRIPT_DEBOUNCE_MS) : now;
+        mEventQueue.push_back(evt);
+
+        if (mEventThread == nullptr)
+            mEventThread = new std::thread(&eventThread);
+
+        mEventSignal.notify_one();
     }
 } // Scripting::
@@ -9,10 +9,13 @@
 #include <vector>
 #include "utils/StringUtil.h"
 #include "Paths.h"
+#include "watchers/WatchersManager.h"
 
 Settings* Settings::sInstance = NULL;
 static std::string mEmptyString = "";
 Delegate<ISettingsChangedEvent> Settings::settingChanged;
+std::atomic<unsigned int> Settings::sLookupCount(0);
+std::atomic<unsigned int> Settings::sGeneration(0);
 
 IMPLEMENT_STATIC_BOOL_SETTING(DebugText, false)
 IMPLEMENT_STATIC_BOOL_SETTING(DebugImage, false)
@@ -72,6 +75,17 @@ void Settings::updateCachedSetting(const std::string& name)
 				mHiddenSystems.insert(hiddenSystem);
 	}
 
+	sGeneration.fetch_add(1, std::memory_order_release);
+
+	{
+		std::unique_lock<std::recursive_mutex> lock(mHandlesLock);
+
+		auto it = mHandles.find(name);
+		if (it != mHandles.cend())
+			for (auto handle : it->second)
+				handle->refresh(this);
+	}
+
 	if (mLoaded)
 		settingChanged.invoke([name](ISettingsChangedEvent* c) { c->onSettingChanged(name); });
 }
@@ -343,7 +357,10 @@ void Settings::setDefaults()
 	mBoolMap["PreloadUI"] = false;
 	mBoolMap["PreloadMedias"] = Settings::_PreloadMedias;
 	mBoolMap["OptimizeVRAM"] = true;
+	mBoolMap["FontDistanceField"] = false;
+	mBoolMap["ScriptEventSocket"] = false;
 	mBoolMap["OptimizeVideo"] = true;
+	mBoolMap["PreloadVideos"] = true;
 
 	mBoolMap["ShowFilenames"] = false;
 
@@ -485,6 +502,8 @@ bool Settings::saveFile()
 	Scripting::fireEvent("config-changed");
 	Scripting::fireEvent("settings-changed");
 
+	WatchersManager::CheckEnabledComponents();
+
 	return true;
 }
 
@@ -533,6 +552,7 @@ void Settings::loadFile()
 //Print a warning message if the setting we're trying to get doesn't already exist in the map, then return the value in the map.
 #define SETTINGS_GETSET(type, mapName, getMethodName, setMethodName, defaultValue) type Settings::getMethodName(const std::string& name) \
 { \
+	sLookupCount.fetch_add(1, std::memory_order_relaxed); \
 	auto it = mapName.find(name); \
 	if (it == mapName.cend()) \
 		return defaultValue; \
@@ -557,6 +577,8 @@ SETTINGS_GETSET(float, mFloatMap, getFloat, setFloat, 0.0f);
 
 std::string Settings::getString(const std::string& name)
 {
+	sLookupCount.fetch_add(1, std::memory_order_relaxed);
+
 	auto it = mStringMap.find(name);
 	if (it == mStringMap.cend())
 		return mEmptyString;
@@ -618,3 +640,56 @@ std::vector<std::string> Settings::getSettingsNames()
 
 	return ret;
 }
+
+const std::string* Settings::internString(const std::string& value)
+{
+	std::unique_lock<std::recursive_mutex> lock(mHandlesLock);
+	return &(*mInternedStrings.insert(value).first);
+}
+
+void Settings::registerHandle(ISettingHandle* handle)
+{
+	std::unique_lock<std::recursive_mutex> lock(mHandlesLock);
+
+	if (handle->mRegistered.load(std::memory_order_acquire))
+		return;
+
+	mHandles[handle->getName()].push_back(handle);
+	handle->refresh(this);
+	handle->mRegistered.store(true, std::memory_order_release);
+}
+
+void Settings::unregisterHandle(ISettingHandle* handle)
+{
+	std::unique_lock<std::recursive_mutex> lock(mHandlesLock);
+
+	auto it = mHandles.find(handle->getName());
+	if (it == mHandles.cend())
+		return;
+
+	auto& handles = it->second;
+	handles.erase(std::remove(handles.begin(), handles.end(), handle), handles.end());
+	if (handles.empty())
+		mHandles.erase(it);
+}
+
+ISettingHandle::~ISettingHandle()
+{
+	if (mRegistered.load(std::memory_order_acquire))
+		Settings::getInstance()->unregisterHandle(this);
+}
+
+void ISettingHandle::registerHandle()
+{
+	Settings::getInstance()->registerHandle(this);
+}
+
+bool SettingHandle<std::string>::set(const std::string& value)
+{
+	return Settings::getInstance()->setString(getName(), value);
+}
+
+void SettingHandle<std::string>::refresh(Settings* settings)
+{
+	mValue.store(settings->internString(settings->getString(getName())), std::memory_order_release);
+}
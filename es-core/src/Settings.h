@@ -6,6 +6,8 @@
 #include <string>
 #include <vector>
 #include <set>
+#include <atomic>
+#include <mutex>
 #include "utils/Delegate.h"
 
 // Non-cached settings macros
@@ -43,6 +45,76 @@ public:
 	virtual void onSettingChanged(const std::string& name) = 0;
 };
 
+class Settings;
+
+// Typed accessor bound to a precomputed key. Values are pushed by Settings when the key changes (before settingChanged is invoked),
+// so a read is a single atomic load : no key building, no map lookup, no lock. Handles register lazily on first read, so they can be static.
+class ISettingHandle
+{
+	friend class Settings;
+
+public:
+	ISettingHandle(const std::string& name) : mName(name), mRegistered(false) { }
+	virtual ~ISettingHandle();
+
+	const std::string& getName() const { return mName; }
+
+protected:
+	void ensureRegistered() const 
+	{ 
+		if (!mRegistered.load(std::memory_order_acquire))
+			const_cast<ISettingHandle*>(this)->registerHandle();
+	}
+
+	virtual void refresh(Settings* settings) = 0;
+
+private:
+	ISettingHandle(const ISettingHandle&) = delete;
+	ISettingHandle& operator=(const ISettingHandle&) = delete;
+
+	void registerHandle();
+
+	std::string mName;
+	std::atomic<bool> mRegistered;
+};
+
+template<typename T>
+class SettingHandle : public ISettingHandle
+{
+public:
+	SettingHandle(const std::string& name) : ISettingHandle(name), mValue(T()) { }
+
+	T get() const { ensureRegistered(); return mValue.load(std::memory_order_acquire); }
+	operator T() const { return get(); }
+
+	bool set(T value);
+
+protected:
+	void refresh(Settings* settings) override;
+
+private:
+	std::atomic<T> mValue;
+};
+
+// Strings are interned by Settings and never freed, which keeps the published pointer valid for readers on any thread
+template<>
+class SettingHandle<std::string> : public ISettingHandle
+{
+public:
+	SettingHandle(const std::string& name) : ISettingHandle(name), mValue(nullptr) { }
+
+	const std::string& get() const { ensureRegistered(); return *mValue.load(std::memory_order_acquire); }
+	operator const std::string&() const { return get(); }
+
+	bool set(const std::string& value);
+
+protected:
+	void refresh(Settings* settings) override;
+
+private:
+	std::atomic<const std::string*> mValue;
+};
+
 enum class SettingType
 {
 	Unknown,
@@ -55,6 +127,8 @@ enum class SettingType
 //This is a singleton for storing settings.
 class Settings
 {
+	friend class ISettingHandle;
+
 public:
 	static Settings* getInstance();
 
@@ -126,6 +200,15 @@ public:
 
 	static Delegate<ISettingsChangedEvent> settingChanged;
 
+	// Number of string-keyed get calls since the last reset. Displayed with DrawFramerate to spot hot paths needing a SettingHandle.
+	static unsigned int getLookupCount() { return sLookupCount.load(std::memory_order_relaxed); }
+	static unsigned int resetLookupCount() { return sLookupCount.exchange(0, std::memory_order_relaxed); }
+
+	// Incremented on every setting change. Lets callers cache values derived from many settings.
+	static unsigned int getGeneration() { return sGeneration.load(std::memory_order_acquire); }
+
+	const std::string* internString(const std::string& value);
+
 	const std::set<std::string>& getHiddenSystems() { return mHiddenSystems; }
 
 private:
@@ -152,6 +235,39 @@ private:
 
 	bool mLoaded;
 	void updateCachedSetting(const std::string& name);
+
+	void registerHandle(ISettingHandle* handle);
+	void unregisterHandle(ISettingHandle* handle);
+
+	std::recursive_mutex mHandlesLock;
+	std::map<std::string, std::vector<ISettingHandle*>> mHandles;
+	std::set<std::string> mInternedStrings;
+
+	static std::atomic<unsigned int> sLookupCount;
+	static std::atomic<unsigned int> sGeneration;
 };
 
+template<typename T>
+bool SettingHandle<T>::set(T value)
+{
+	if (std::is_same<T, bool>::value)
+		return Settings::getInstance()->setBool(getName(), value);
+	
+	if (std::is_same<T, int>::value)
+		return Settings::getInstance()->setInt(getName(), (int)value);
+
+	return Settings::getInstance()->setFloat(getName(), (float)value);
+}
+
+template<typename T>
+void SettingHandle<T>::refresh(Settings* settings)
+{
+	if (std::is_same<T, bool>::value)
+		mValue.store(settings->getBool(getName()), std::memory_order_release);
+	else if (std::is_same<T, int>::value)
+		mValue.store((T) settings->getInt(getName()), std::memory_order_release);
+	else
+		mValue.store((T) settings->getFloat(getName()), std::memory_order_release);
+}
+
 #endif // ES_CORE_SETTINGS_H
@@ -6,6 +6,7 @@
 #include "utils/FileSystemUtil.h"
 #include "Settings.h"
 #include "Paths.h"
+#include "watchers/WatchersManager.h"
 
 #include <set>
 #include <regex>
@@ -205,6 +206,8 @@ bool SystemConf::saveSystemConf()
 	remove(mSystemConfFileTmp.c_str());
 	changedConf.clear();
 
+	WatchersManager::CheckEnabledComponents();
+
 	return true;
 }
 
@@ -742,6 +742,53 @@ void ThemeFileCache::clear()
 	_cache.clear();
 }
 
+// "settings.xxx" theme variables. Rebuilt only when a setting has changed since the last theme load, instead of once per system
+static std::mutex sSettingsVariablesLock;
+static bool sSettingsVariablesValid = false;
+static unsigned int sSettingsVariablesGeneration = 0;
+static std::map<std::string, std::string> sSettingsVariables;
+
+static std::map<std::string, std::string> getSettingsVariables()
+{
+	std::unique_lock<std::mutex> lock(sSettingsVariablesLock);
+
+	unsigned int generation = Settings::getGeneration();
+	if (!sSettingsVariablesValid || sSettingsVariablesGeneration != generation)
+	{
+		sSettingsVariables.clear();
+
+		for (auto name : Settings::getInstance()->getSettingsNames())
+		{
+			if (name.find(".") != std::string::npos)
+				continue;
+
+			std::string variableName = "settings." + name;
+
+			SettingType type = Settings::getInstance()->getSettingType(name);
+			switch (type)
+			{
+			case SettingType::String:
+				sSettingsVariables[variableName] = Settings::getInstance()->getString(name);
+				break;
+			case SettingType::Bool:
+				sSettingsVariables[variableName] = Settings::getInstance()->getBool(name) ? "true" : "false";
+				break;
+			case SettingType::Int:
+				sSettingsVariables[variableName] = std::to_string(Settings::getInstance()->getInt(name));
+				break;
+			case SettingType::Float:
+				sSettingsVariables[variableName] = std::to_string(Settings::getInstance()->getFloat(name));
+				break;
+			}
+		}
+
+		sSettingsVariablesGeneration = generation;
+		sSettingsVariablesValid = true;
+	}
+
+	return sSettingsVariables;
+}
+
 void ThemeData::loadFile(const std::string& system, const std::map<std::string, std::string>& sysDataMap, const std::string& path, bool fromFile)
 {
 	mPaths.push_back(path);
@@ -767,30 +814,8 @@ void ThemeData::loadFile(const std::string& system, const std::map<std::string,
 	mVariables["region"] = mRegion;
 	mVariables["root"] = Utils::FileSystem::getParent(mPaths.back());
 
-	for (auto name : Settings::getInstance()->getSettingsNames())
-	{
-		if (name.find(".") != std::string::npos)
-			continue;
-
-		std::string variableName = "settings." + name;
-
-		SettingType type = Settings::getInstance()->getSettingType(name);
-		switch (type)
-		{
-		case SettingType::String:
-			mVariables[variableName] = Settings::getInstance()->getString(name);
-			break;
-		case SettingType::Bool:
-			mVariables[variableName] = Settings::getInstance()->getBool(name) ? "true" : "false";
-			break;
-		case SettingType::Int:
-			mVariables[variableName] = std::to_string(Settings::getInstance()->getInt(name));
-			break;
-		case SettingType::Float:
-			mVariables[variableName] = std::to_string(Settings::getInstance()->getFloat(name));
-			break;
-		}
-	}
+	for (auto var : getSettingsVariables())
+		mVariables[var.first] = var.second;
 
 	for (auto var : mVariables)
 	{
@@ -0,0 +1,207 @@
+#include "Tracing.h"
+#include "Log.h"
+#include "Paths.h"
+#include "utils/FileSystemUtil.h"
+#include "utils/TimeUtil.h"
+
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include <sstream>
+#include <fstream>
+
+// Events kept per thread. The oldest events are overwritten
+#define TRACE_BUFFER_SIZE 65536
+
+struct TraceEvent
+{
+	const char*			name;
+	unsigned long long	start;
+	unsigned long long	end;
+};
+
+struct TraceBuffer
+{
+	TraceBuffer(int threadId) : id(threadId), owned(true), position(0) { events.resize(TRACE_BUFFER_SIZE); }
+
+	int									id;
+	std::string							name;
+	std::atomic<bool>					owned;    // false when the thread has exited : the buffer can be reused
+	std::atomic<unsigned long long>		position; // total number of events written
+	std::vector<TraceEvent>				events;
+};
+
+static std::mutex					sBuffersLock;
+static std::vector<TraceBuffer*>	sBuffers;
+static int							sNextThreadId = 1;
+
+static std::chrono::steady_clock::time_point sStartTime = std::chrono::steady_clock::now();
+
+// Releases the buffer of the thread when it exits
+struct TraceThreadSlot
+{
+	TraceThreadSlot() : buffer(nullptr) { }
+	~TraceThreadSlot()
+	{
+		if (buffer != nullptr)
+			buffer->owned = false;
+	}
+
+	TraceBuffer* buffer;
+};
+
+static thread_local TraceThreadSlot sThreadSlot;
+
+static TraceBuffer* getThreadBuffer()
+{
+	if (sThreadSlot.buffer != nullptr)
+		return sThreadSlot.buffer;
+
+	std::unique_lock<std::mutex> lock(sBuffersLock);
+
+	TraceBuffer* buffer = nullptr;
+
+	for (auto buf : sBuffers)
+	{
+		if (!buf->owned)
+		{
+			buffer = buf;
+			buffer->id = sNextThreadId++;
+			buffer->name = "";
+			buffer->position = 0;
+			buffer->owned = true;
+			break;
+		}
+	}
+
+	if (buffer == nullptr)
+	{
+		buffer = new TraceBuffer(sNextThreadId++);
+		sBuffers.push_back(buffer);
+	}
+
+	sThreadSlot.buffer = buffer;
+	return buffer;
+}
+
+std::atomic<bool> Tracing::sEnabled(false);
+std::atomic<bool> Tracing::sDumpRequested(false);
+
+unsigned long long Tracing::now()
+{
+	return (unsigned long long) std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - sStartTime).count();
+}
+
+void Tracing::setEnabled(bool enabled)
+{
+	if (sEnabled == enabled)
+		return;
+
+	LOG(LogInfo) << "Tracing " << (enabled ? "enabled" : "disabled");
+	sEnabled = enabled;
+}
+
+void Tracing::setThreadName(const std::string& name)
+{
+	TraceBuffer* buffer = getThreadBuffer();
+
+	std::unique_lock<std::mutex> lock(sBuffersLock);
+	buffer->name = name;
+}
+
+void Tracing::record(const char* name, unsigned long long start, unsigned long long end)
+{
+	TraceBuffer* buffer = getThreadBuffer();
+
+	unsigned long long position = buffer->position.load(std::memory_order_relaxed);
+
+	TraceEvent& evt = buffer->events[position % TRACE_BUFFER_SIZE];
+	evt.name = name;
+	evt.start = start;
+	evt.end = end;
+
+	buffer->position.store(position + 1, std::memory_order_release);
+}
+
+std::string Tracing::getChromeTrace()
+{
+	std::stringstream ss;
+	ss << "{\"traceEvents\":[";
+
+	bool first = true;
+
+	std::unique_lock<std::mutex> lock(sBuffersLock);
+
+	for (auto buffer : sBuffers)
+	{
+		std::string threadName = buffer->name.empty() ? "Thread " + std::to_string(buffer->id) : buffer->name;
+
+		if (!first)
+			ss << ",";
+
+		first = false;
+		ss << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->id << ",\"args\":{\"name\":\"" << threadName << "\"}}";
+
+		// Copy the events, then drop the ones the thread may have overwritten while copying
+		unsigned long long end = buffer->position.load(std::memory_order_acquire);
+		unsigned long long begin = end > TRACE_BUFFER_SIZE ? end - TRACE_BUFFER_SIZE : 0;
+
+		std::vector<TraceEvent> events;
+		events.reserve((size_t)(end - begin));
+
+		for (unsigned long long i = begin; i < end; i++)
+			events.push_back(buffer->events[i % TRACE_BUFFER_SIZE]);
+
+		// The thread may be filling the slot of event "written" too, which holds the oldest event "written - TRACE_BUFFER_SIZE"
+		unsigned long long written = buffer->position.load(std::memory_order_acquire);
+		unsigned long long valid = written >= TRACE_BUFFER_SIZE ? written + 1 - TRACE_BUFFER_SIZE : 0;
+
+		for (unsigned long long i = begin; i < end; i++)
+		{
+			if (i < valid)
+				continue;
+
+			const TraceEvent& evt = events[(size_t)(i - begin)];
+			ss << ",{\"name\":\"" << evt.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->id << ",\"ts\":" << evt.start << ",\"dur\":" << (evt.end - evt.start) << "}";
+		}
+	}
+
+	ss << "],\"displayTimeUnit\":\"ms\"}";
+	return ss.str();
+}
+
+bool Tracing::saveChromeTrace(const std::string& path)
+{
+	std::ofstream file(path, std::ios::binary);
+	if (!file.is_open())
+	{
+		LOG(LogError) << "Tracing : unable to write " << path;
+		return false;
+	}
+
+	file << getChromeTrace();
+	file.close();
+
+	LOG(LogInfo) << "Tracing : trace saved to " << path;
+	return true;
+}
+
+void Tracing::requestDump()
+{
+	sDumpRequested = true;
+}
+
+void Tracing::processPendingDump()
+{
+	if (!sDumpRequested.exchange(false))
+		return;
+
+	if (!isEnabled())
+	{
+		setEnabled(true);
+		return;
+	}
+
+	std::string fileName = "trace-" + Utils::Time::timeToString(Utils::Time::now(), "%Y%m%d-%H%M%S") + ".json";
+	saveChromeTrace(Utils::FileSystem::combine(Paths::getUserEmulationStationPath(), fileName));
+}
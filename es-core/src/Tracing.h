@@ -0,0 +1,63 @@
+#pragma once
+#ifndef ES_CORE_TRACING_H
+#define ES_CORE_TRACING_H
+
+#include <atomic>
+#include <string>
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+// Scoped zone, recorded only while tracing is enabled. name must be a string literal
+#define TRACE_ZONE(name) Tracing::Zone TRACE_CONCAT(__traceZone, __LINE__)(name)
+
+// Low-overhead tracing : zones are recorded in per-thread ring buffers, and exported in Chrome trace format ( chrome://tracing, Perfetto ).
+// When disabled, a zone costs an atomic load.
+class Tracing
+{
+public:
+	class Zone
+	{
+	public:
+		Zone(const char* name) : mName(sEnabled.load(std::memory_order_relaxed) ? name : nullptr), mStart(0)
+		{
+			if (mName != nullptr)
+				mStart = now();
+		}
+
+		~Zone()
+		{
+			if (mName != nullptr)
+				record(mName, mStart, now());
+		}
+
+	private:
+		const char*			mName;
+		unsigned long long	mStart;
+	};
+
+	static bool isEnabled() { return sEnabled.load(std::memory_order_relaxed); }
+	static void setEnabled(bool enabled);
+
+	// Name displayed for the calling thread in the trace viewer
+	static void setThreadName(const std::string& name);
+
+	static std::string getChromeTrace();
+	static bool saveChromeTrace(const std::string& path);
+
+	// Async-signal-safe : the dump is written by the next processPendingDump call ( main loop ).
+	// If tracing is disabled, it is enabled instead, so a second request gets a trace.
+	static void requestDump();
+	static void processPendingDump();
+
+	// Microseconds since startup
+	static unsigned long long now();
+
+private:
+	static void record(const char* name, unsigned long long start, unsigned long long end);
+
+	static std::atomic<bool> sEnabled;
+	static std::atomic<bool> sDumpRequested;
+};
+
+#endif // ES_CORE_TRACING_H
@@ -22,18 +22,22 @@
 #include "components/BatteryIndicatorComponent.h"
 #include "guis/GuiMsgBox.h"
 #include "components/VolumeInfoComponent.h"
+#include "components/VideoVlcPreloader.h"
 #include "Splash.h"
 #include "PowerSaver.h"
 #include "renderers/Renderer.h"
 #include <thread>
 #include "../es-app/src/ApiSystem.h"
 #include "utils/StringUtil.h"
+#include "Tracing.h"
 
 #if WIN32
 #include <SDL_syswm.h>
 #endif
 
-Window::Window() : mNormalizeNextUpdate(false), mFrameTimeElapsed(0), mFrameCountElapsed(0), mAverageDeltaTime(10),
+#define FRAME_TIMES_COUNT 120
+
+Window::Window() : mNormalizeNextUpdate(false), mFrameTimeElapsed(0), mFrameCountElapsed(0), mAverageDeltaTime(10), mFrameTimesIndex(0),
   mAllowSleep(true), mSleeping(false), mTimeSinceLastInput(0), mScreenSaver(NULL), mRenderScreenSaver(false), mClockElapsed(0), mMouseCapture(nullptr), mMenuBackgroundShaderTextureCache(-1)
 {			
 	mTransitionOffset = 0;
@@ -200,6 +204,7 @@ void Window::deinit(bool deinitRenderer)
 		InputManager::getInstance()->deinit();
 
 	TextureResource::clearQueue();
+	VideoVlcPreloader::clear();
 	ResourceManager::getInstance()->unloadAll();
 
 	if (deinitRenderer)
@@ -432,6 +437,19 @@ void Window::processSongTitleNotifications()
 
 void Window::update(int deltaTime)
 {
+	TRACE_ZONE("Window::update");
+
+	Tracing::processPendingDump();
+
+	if (Settings::DrawFramerate())
+	{
+		if (mFrameTimes.size() != FRAME_TIMES_COUNT)
+			mFrameTimes.resize(FRAME_TIMES_COUNT, 0);
+
+		mFrameTimes[mFrameTimesIndex] = deltaTime;
+		mFrameTimesIndex = (mFrameTimesIndex + 1) % FRAME_TIMES_COUNT;
+	}
+
 	TextureResource::cleanupVRAM();
 
 	if (mLastShowCursor >= 0)
@@ -467,6 +485,8 @@ void Window::update(int deltaTime)
 	{
 		mAverageDeltaTime = mFrameTimeElapsed / mFrameCountElapsed;
 
+		unsigned int settingsLookups = Settings::resetLookupCount();
+
 		if (Settings::DrawFramerate())
 		{
 			std::stringstream ss;
@@ -485,6 +505,7 @@ void Window::update(int deltaTime)
 			int queueSize = TextureResource::getQueueSize();
 
 			ss << "\nFont VRAM: " << fontVramUsageMb << " Tex VRAM: " << textureVramUsageMb << " Cached Tex RAM: " << textureCacheUsageMb << " Known Tex: " << textureKnownUsageMb << " Max VRAM: " << max_texture << " Queued : " << queueSize;
+			ss << "\nSettings lookups/frame: " << std::fixed << std::setprecision(1) << ((float)settingsLookups / (float)mFrameCountElapsed);
 			
 			mFrameDataText = std::unique_ptr<TextCache>(mDefaultFonts[3]->buildTextCache(ss.str(), Vector2f(50.f, 50.f), 0xFFFF40FF, 0.0f, ALIGN_LEFT, 1.2f));
 		}
@@ -669,8 +690,40 @@ void Window::resetMenuBackgroundShader()
 	}
 }
 
+// Frame time graph under the FPS overlay : one bar per frame, the line marks 60fps
+void Window::renderFrameTimes(const Transform4x4f& transform)
+{
+	if (mFrameTimes.size() != FRAME_TIMES_COUNT)
+		return;
+
+	const float barWidth = 3.0f;
+	const float maxHeight = 100.0f; // 1px per ms
+
+	float x = 40.0f;
+	float y = 45.0f + mFrameDataText->metrics.size.y() + 20.0f;
+
+	Renderer::setMatrix(transform);
+	Renderer::drawRect(x, y, barWidth * FRAME_TIMES_COUNT, maxHeight, 0x00000080);
+
+	for (int i = 0; i < FRAME_TIMES_COUNT; i++)
+	{
+		int frameTime = mFrameTimes[(mFrameTimesIndex + i) % FRAME_TIMES_COUNT];
+		if (frameTime <= 0)
+			continue;
+
+		unsigned int color = frameTime <= 17 ? 0x40FF40C0 : frameTime <= 34 ? 0xFFFF40C0 : 0xFF4040C0;
+		float height = Math::min((float)frameTime, maxHeight);
+
+		Renderer::drawRect(x + i * barWidth, y + maxHeight - height, barWidth - 1.0f, height, color);
+	}
+
+	Renderer::drawRect(x, y + maxHeight - 16.7f, barWidth * FRAME_TIMES_COUNT, 1.0f, 0xFFFFFF80);
+}
+
 void Window::render()
 {
+	TRACE_ZONE("Window::render");
+
 	Transform4x4f transform = Transform4x4f::Identity();
 
 	mRenderedHelpPrompts = false;
@@ -743,6 +796,8 @@ void Window::render()
 
 		mFrameDataText->setColor(0xFFFF40FF);		
 		mDefaultFonts.at(1)->renderTextCache(mFrameDataText.get());
+
+		renderFrameTimes(transform);
 	}
 
 	// clock 
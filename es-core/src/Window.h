@@ -160,6 +160,10 @@ private:
 
 	std::unique_ptr<TextCache> mFrameDataText;
 
+	std::vector<int> mFrameTimes; // last frame times in ms, displayed with DrawFramerate
+	int mFrameTimesIndex;
+	void renderFrameTimes(const Transform4x4f& transform);
+
 	int mClockElapsed;
 	std::shared_ptr<TextComponent>	mClock;
 	std::shared_ptr<ControllerActivityComponent>	mControllerActivity;
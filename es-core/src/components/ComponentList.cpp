@@ -7,6 +7,7 @@
 #include "components/SliderComponent.h"
 #include "components/OptionListComponent.h"
 #include "InputManager.h"
+#include <algorithm>
 
 #define TOTAL_HORIZONTAL_PADDING_PX 20
 
@@ -69,6 +70,22 @@ void ComponentList::removeLastRowIfGroup()
 		mEntries.erase(mEntries.begin() + index);
 }
 
+void ComponentList::moveRows(int first, int count, int index)
+{
+	if (count <= 0 || index < 0 || index >= first || first + count > (int)mEntries.size())
+		return;
+
+	std::rotate(mEntries.begin() + index, mEntries.begin() + first, mEntries.begin() + first + count);
+
+	// The cursor stays on the same row
+	if (mCursor >= first && mCursor < first + count)
+		mCursor = index + mCursor - first;
+	else if (mCursor >= index && mCursor < first)
+		mCursor += count;
+
+	onSizeChanged();
+}
+
 void ComponentList::addGroup(const std::string& label, bool forceVisible)
 {	
 	auto theme = ThemeData::getMenuTheme();
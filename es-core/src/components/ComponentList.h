@@ -79,6 +79,9 @@ public:
 	void addGroup(const std::string& label, bool forceVisible = false);
 	void removeLastRowIfGroup();
 
+	// Moves the rows [first, first + count) before the row at index ( index <= first ). Used to place rows added late
+	void moveRows(int first, int count, int index);
+
 	void textInput(const char* text) override;
 	bool input(InputConfig* config, Input input) override;
 	void update(int deltaTime) override;
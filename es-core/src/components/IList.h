@@ -233,6 +233,8 @@ public:
 
 	inline int size() const { return (int)mEntries.size(); }
 
+	inline const UserData& getObjectAt(int index) const { return mEntries.at(index).object; }
+
 	inline std::vector<UserData> getObjects()
 	{
 		std::vector<UserData> objects;
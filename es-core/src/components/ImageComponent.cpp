@@ -665,11 +665,15 @@ void ImageComponent::render(const Transform4x4f& parentTrans)
 		if(Settings::DebugImage())
 			Renderer::drawRect(targetSizePos.x(), targetSizePos.y(), mTargetSize.x(), mTargetSize.y(), 0xFF000033, 0xFF000033);
 
+		// Small static images may be bound from a shared atlas page ( custom shaders & rounded corners need the whole texture )
+		Vector4f atlasRect;
+		const bool allowAtlas = mRoundCorners == 0 && (!mCustomShaderEnabled || mCustomShader.path.empty()) && !isTiled();
+
 		// actually draw the image
 		// The bind() function returns false if the texture is not currently loaded. A blank
 		// texture is bound in this case but we want to handle a fade so it doesn't just 'jump' in
 		// when it finally loads
-		if (!mTexture->bind())
+		if (!mTexture->bind(allowAtlas ? &atlasRect : nullptr))
 		{
 			fadeIn(false);
 			return;
@@ -695,16 +699,33 @@ void ImageComponent::render(const Transform4x4f& parentTrans)
 		mVertices->saturation = mSaturation;
 		mVertices->customShader = !mCustomShaderEnabled || mCustomShader.path.empty() ? nullptr : &mCustomShader;
 
+		Renderer::Vertex* vertices = mVertices;
+		Renderer::Vertex atlasVertices[4];
+
+		if (allowAtlas && (atlasRect.x() != 0 || atlasRect.y() != 0 || atlasRect.z() != 1 || atlasRect.w() != 1))
+		{
+			const float atlasWidth = atlasRect.z() - atlasRect.x();
+			const float atlasHeight = atlasRect.w() - atlasRect.y();
+
+			for (int i = 0; i < 4; i++)
+			{
+				atlasVertices[i] = mVertices[i];
+				atlasVertices[i].tex = Vector2f(atlasRect.x() + mVertices[i].tex.x() * atlasWidth, atlasRect.y() + mVertices[i].tex.y() * atlasHeight);
+			}
+
+			vertices = atlasVertices;
+		}
+
 		if (mRoundCorners > 0 && mRoundCornerStencil.size() > 0)
 		{
 			Renderer::setStencil(mRoundCornerStencil.data(), mRoundCornerStencil.size());
-			Renderer::drawTriangleStrips(&mVertices[0], 4);
+			Renderer::drawTriangleStrips(&vertices[0], 4);
 			Renderer::disableStencil();
 		}
 		else
 		{
-			mVertices->cornerRadius = mRoundCorners < 1 ? Math::max(mSize.x(), mSize.y()) * mRoundCorners : mRoundCorners;			
-			Renderer::drawTriangleStrips(&mVertices[0], 4);
+			vertices->cornerRadius = mRoundCorners < 1 ? Math::max(mSize.x(), mSize.y()) * mRoundCorners : mRoundCorners;			
+			Renderer::drawTriangleStrips(&vertices[0], 4);
 		}
 
 		if (mReflection.x() != 0 || mReflection.y() != 0)
@@ -728,22 +749,22 @@ void ImageComponent::render(const Transform4x4f& parentTrans)
 
 			mirrorVertices[0] = {
 				{ mVertices[0].pos.x(), mVertices[0].pos.y() + h },
-				{ mVertices[0].tex.x(), mVertices[1].tex.y() },
+				{ vertices[0].tex.x(), vertices[1].tex.y() },
 				colorT };
 
 			mirrorVertices[1] = {
 				{ mVertices[1].pos.x(), mVertices[1].pos.y() + h },
-				{ mVertices[1].tex.x(), mVertices[0].tex.y() },
+				{ vertices[1].tex.x(), vertices[0].tex.y() },
 				colorB };
 
 			mirrorVertices[2] = {
 				{ mVertices[2].pos.x(), mVertices[2].pos.y() + h },
-				{ mVertices[2].tex.x(), mVertices[3].tex.y() },
+				{ vertices[2].tex.x(), vertices[3].tex.y() },
 				colorT };
 
 			mirrorVertices[3] = {
 				{ mVertices[3].pos.x(), mVertices[3].pos.y() + h },
-				{ mVertices[3].tex.x(), mVertices[2].tex.y() },
+				{ vertices[3].tex.x(), vertices[2].tex.y() },
 				colorB };
 
 			Renderer::drawTriangleStrips(&mirrorVertices[0], 4);
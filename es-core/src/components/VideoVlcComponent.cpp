@@ -1,4 +1,5 @@
 #include "components/VideoVlcComponent.h"
+#include "components/VideoVlcPreloader.h"
 
 #include "renderers/Renderer.h"
 #include "resources/TextureResource.h"
@@ -28,12 +29,7 @@ libvlc_instance_t* VideoVlcComponent::mVLC = NULL;
 static void *lock(void *data, void **p_pixels) 
 {
 	struct VideoContext *c = (struct VideoContext *)data;
-
-	int frame = (c->surfaceId ^ 1);
-	
-	c->mutexes[frame].lock();
-	c->hasFrame[frame] = false;
-	*p_pixels = c->surfaces[frame];
+	*p_pixels = c->lockFrame();
 	return NULL; // Picture identifier, not needed here.
 }
 
@@ -41,12 +37,7 @@ static void *lock(void *data, void **p_pixels)
 static void unlock(void *data, void* /*id*/, void *const* /*p_pixels*/) 
 {
 	struct VideoContext *c = (struct VideoContext *)data;
-
-	int frame = (c->surfaceId ^ 1);	
-
-	c->surfaceId = frame;
-	c->hasFrame[frame] = true;
-	c->mutexes[frame].unlock();
+	c->unlockFrame();
 }
 
 // VLC wants to display a video frame.
@@ -61,10 +52,12 @@ static void display(void* data, void* id)
 }
 
 VideoVlcComponent::VideoVlcComponent(Window* window) : VideoComponent(window), 
-	mMediaPlayer(nullptr), mMedia(nullptr),
+	mMediaPlayer(nullptr), mPreloadedPlayer(nullptr), mMedia(nullptr),
 	mTopLeftCrop(0.0f, 0.0f), mBottomRightCrop(1.0f, 1.0f), mContext(nullptr)
 {
 	mIsParsing = false;
+	mPreloaded = false;
+	mStartTicks = 0;
 	mSaturation = 1.0f;
 	mElapsed = 0;
 	mColorShift = 0xFFFFFFFF;
@@ -86,7 +79,8 @@ static void mediaplayer_release_async(VideoContext* ctx, libvlc_media_player_t*
 	if (p_mi == nullptr)
 		return;
 
-	ctx->component = nullptr;
+	if (ctx)
+		ctx->component = nullptr;
 
 	std::thread([p_mi, ctx]()
 		{			
@@ -471,8 +465,17 @@ void VideoVlcComponent::render(const Transform4x4f& parentTrans)
 	// Build a texture for the video frame
 	if (initFromPixels)
 	{		
-		int frame = mContext->surfaceId;
-		if (mContext->hasFrame[frame])
+		bool upload = true;
+
+#ifdef _RPI_
+		// Rpi : A lot of videos are encoded in 60fps on screenscraper
+		// Try to limit transfert to opengl textures to 30fps to save CPU
+		upload = !Settings::getInstance()->getBool("OptimizeVideo") || mElapsed >= 40; // 40ms = 25fps, 33.33 = 30 fps
+#endif
+
+		// Only frames VLC published since the last upload are sent, redraws of the same frame upload nothing
+		unsigned char* frame = upload ? mContext->takeFrame() : nullptr;
+		if (frame != nullptr)
 		{
 			if (mTexture == nullptr)
 			{
@@ -480,21 +483,14 @@ void VideoVlcComponent::render(const Transform4x4f& parentTrans)
 
 				resize();
 				trans = parentTrans * getTransform();
-			}
-
-#ifdef _RPI_
-			// Rpi : A lot of videos are encoded in 60fps on screenscraper
-			// Try to limit transfert to opengl textures to 30fps to save CPU
-			if (!Settings::getInstance()->getBool("OptimizeVideo") || mElapsed >= 40) // 40ms = 25fps, 33.33 = 30 fps
-#endif
-			{
-				mContext->mutexes[frame].lock();
-				mTexture->updateFromExternalPixels(mContext->surfaces[frame], mVideoWidth, mVideoHeight);
-				mContext->hasFrame[frame] = false;
-				mContext->mutexes[frame].unlock();
 
-				mElapsed = 0;
+				unsigned int firstFrame = SDL_GetTicks() - mStartTicks;
+				VideoVlcPreloader::getInstance()->addFirstFrameTime(mPreloaded, firstFrame);
+				LOG(LogDebug) << "[VideoVlcComponent] first frame after " << firstFrame << "ms" << (mPreloaded ? " ( preloaded )" : "");
 			}
+
+			mTexture->updateFromExternalPixels(frame, mVideoWidth, mVideoHeight);
+			mElapsed = 0;
 		}
 	}
 
@@ -576,12 +572,11 @@ void VideoVlcComponent::render(const Transform4x4f& parentTrans)
 
 VideoContext* VideoVlcComponent::createContext()
 {
-	// Create an RGBA surface to render the video into
+	// Create the RGBA surfaces to render the video into
 	VideoContext* ctx = new VideoContext();
-	ctx->surfaces[0] = new unsigned char[mVideoWidth * mVideoHeight * 4];
-	ctx->surfaces[1] = new unsigned char[mVideoWidth * mVideoHeight * 4];
-	ctx->hasFrame[0] = false;
-	ctx->hasFrame[1] = false;
+	for (int i = 0; i < 3; i++)
+		ctx->surfaces[i] = new unsigned char[mVideoWidth * mVideoHeight * 4];
+
 	ctx->component = this;
 
 	resize();	
@@ -794,7 +789,8 @@ void VideoVlcComponent::onMediaParsed()
 		}
 	}
 
-	mMediaPlayer = libvlc_media_player_new_from_media(mMedia);
+	mMediaPlayer = mPreloadedPlayer != nullptr ? mPreloadedPlayer : libvlc_media_player_new_from_media(mMedia);
+	mPreloadedPlayer = nullptr;
 	if (!mMediaPlayer)
 		return;
 
@@ -836,7 +832,13 @@ void VideoVlcComponent::startVideo()
 	std::string path = mVideoPath;
 #endif
 
-	mMedia = libvlc_media_new_path(mVLC, path.c_str());
+	mStartTicks = SDL_GetTicks();
+
+	// Parsed media & player ready when the video was preloaded
+	mPreloaded = VideoVlcPreloader::getInstance()->take(mVideoPath, &mMedia, &mPreloadedPlayer);
+	if (!mPreloaded)
+		mMedia = libvlc_media_new_path(mVLC, path.c_str());
+
 	if (!mMedia)
 	{
 		stopVideo();
@@ -911,6 +913,13 @@ void VideoVlcComponent::stopVideo()
 	else if (mContext)
 		delete mContext;
 
+	// Stopped before the media was parsed
+	if (mPreloadedPlayer)
+	{
+		mediaplayer_release_async(nullptr, mPreloadedPlayer);
+		mPreloadedPlayer = nullptr;
+	}
+
 	mContext = nullptr;
 
 	// Release the media
@@ -6,41 +6,59 @@
 #include "ThemeData.h"
 #include "renderers/Renderer.h"
 #include <mutex>
+#include <atomic>
 
 struct libvlc_instance_t;
 struct libvlc_media_t;
 struct libvlc_media_player_t;
 
+// Frames exchanged between the VLC decoding thread & the render thread through three surfaces : VLC decodes into the back surface
+// and publishes it by swapping it with the ready one, the render thread takes the ready surface by swapping it with the front one.
+// Neither side waits for the other, and the front surface, that the texture keeps pointing to, is never written by VLC
 struct VideoContext 
 {
-	VideoContext()
+	VideoContext() : ready(1), back(0), front(2)
 	{
 		surfaces[0] = nullptr;
 		surfaces[1] = nullptr;
-		component = nullptr;		
-		hasFrame[0] = false;
-		hasFrame[1] = false;
-		surfaceId = 0;
+		surfaces[2] = nullptr;
+		component = nullptr;
 	}
 
 	~VideoContext()
 	{
-		if (surfaces[0])
-			delete[] surfaces[0];
+		for (int i = 0; i < 3; i++)
+		{
+			if (surfaces[i])
+				delete[] surfaces[i];
 
-		if (surfaces[1])
-			delete[] surfaces[1];
-
-		surfaces[0] = nullptr;
-		surfaces[1] = nullptr;
+			surfaces[i] = nullptr;
+		}
 	}
 
-	int					surfaceId;
-	unsigned char*		surfaces[2];	
-	std::mutex			mutexes[2];
-	bool				hasFrame[2];
+	// VLC thread
+	unsigned char* lockFrame() { return surfaces[back]; }
+	void unlockFrame() { back = ready.exchange(back | FRESH_FRAME) & ~FRESH_FRAME; }
+
+	// Render thread : the last frame VLC published, nullptr when there's none since the previous call
+	unsigned char* takeFrame()
+	{
+		if ((ready.load() & FRESH_FRAME) == 0)
+			return nullptr;
+
+		front = ready.exchange(front) & ~FRESH_FRAME;
+		return surfaces[front];
+	}
 
+	unsigned char*		surfaces[3];
 	VideoComponent*		component;	
+
+private:
+	static const int FRESH_FRAME = 4;
+
+	std::atomic<int>	ready;	// surface index | FRESH_FRAME
+	int					back;	// VLC thread only
+	int					front;	// render thread only
 };
 
 
@@ -57,6 +75,8 @@ namespace VideoVlcFlags
 
 class VideoVlcComponent : public VideoComponent
 {
+	friend class VideoVlcPreloader;
+
 	// Structure that groups together the configuration of the video component
 	struct Configuration
 	{
@@ -138,7 +158,11 @@ private:
 	static libvlc_instance_t*		mVLC;
 	libvlc_media_t*					mMedia;
 	libvlc_media_player_t*			mMediaPlayer;
+	libvlc_media_player_t*			mPreloadedPlayer;	// taken from VideoVlcPreloader, used once the media is parsed
 	VideoContext*					mContext;
+
+	bool							mPreloaded;
+	unsigned int					mStartTicks;
 	std::shared_ptr<TextureResource> mTexture;
 
 	std::string					    mSubtitlePath;
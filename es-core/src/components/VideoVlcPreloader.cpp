@@ -0,0 +1,301 @@
+#include "components/VideoVlcPreloader.h"
+#include "components/VideoVlcComponent.h"
+#include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+#include "Log.h"
+#include "Tracing.h"
+
+#include <vlc/vlc.h>
+#include <vlc/libvlc_version.h>
+#include <algorithm>
+
+#define VIDEO_PRELOAD_MAX	3 // current entry, next & previous
+
+VideoVlcPreloader* VideoVlcPreloader::sInstance = nullptr;
+
+static std::mutex sInstanceLock;
+
+VideoVlcPreloader* VideoVlcPreloader::getInstance()
+{
+	std::unique_lock<std::mutex> lock(sInstanceLock);
+
+	if (sInstance == nullptr)
+		sInstance = new VideoVlcPreloader();
+
+	return sInstance;
+}
+
+void VideoVlcPreloader::deinit()
+{
+	std::unique_lock<std::mutex> lock(sInstanceLock);
+
+	if (sInstance != nullptr)
+		sInstance->stop();
+}
+
+void VideoVlcPreloader::clear()
+{
+	std::unique_lock<std::mutex> instanceLock(sInstanceLock);
+
+	if (sInstance == nullptr)
+		return;
+
+	std::vector<Entry> ready;
+
+	{
+		std::unique_lock<std::mutex> lock(sInstance->mLock);
+		sInstance->mWanted.clear();
+		ready.swap(sInstance->mReady);
+		sInstance->mStats.released += ready.size();
+	}
+
+	for (auto& entry : ready)
+		release(entry);
+}
+
+VideoVlcPreloader::VideoVlcPreloader() : mChanged(false), mExit(false)
+{
+}
+
+void VideoVlcPreloader::stop()
+{
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+		if (mExit)
+			return;
+
+		mExit = true;
+		mWanted.clear();
+	}
+
+	mEvent.notify_all();
+
+	if (mThread.joinable())
+		mThread.join();
+
+	for (auto& entry : mReady)
+		release(entry);
+
+	mReady.clear();
+}
+
+void VideoVlcPreloader::preload(const std::vector<std::string>& paths)
+{
+#if LIBVLC_VERSION_MAJOR >= 3
+	#if WIN32
+		// Vlc 2 can't parse asynchronously
+		const char* vlc_ver = libvlc_get_version();
+		if (vlc_ver[0] < '3')
+			return;
+	#endif
+
+	// Same paths as VideoComponent::setVideo
+	std::vector<std::string> wanted;
+	for (auto& path : paths)
+	{
+		if (path.empty() || wanted.size() >= VIDEO_PRELOAD_MAX)
+			continue;
+
+		std::string fullPath = Utils::FileSystem::getCanonicalPath(path);
+		if (std::find(wanted.cbegin(), wanted.cend(), fullPath) == wanted.cend())
+			wanted.push_back(fullPath);
+	}
+
+	std::unique_lock<std::mutex> lock(mLock);
+	if (mExit || wanted == mWanted)
+		return;
+
+	mWanted = wanted;
+	mChanged = true;
+
+	if (!mThread.joinable())
+		mThread = std::thread(&VideoVlcPreloader::threadProc, this);
+
+	mEvent.notify_one();
+#endif
+}
+
+bool VideoVlcPreloader::take(const std::string& path, libvlc_media_t** media, libvlc_media_player_t** player)
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	// When it's still being prepared, it will be released
+	auto wanted = std::find(mWanted.begin(), mWanted.end(), path);
+	if (wanted != mWanted.end())
+		mWanted.erase(wanted);
+
+	for (auto it = mReady.begin(); it != mReady.end(); it++)
+	{
+		if (it->path != path)
+			continue;
+
+		*media = it->media;
+		*player = it->player;
+		mReady.erase(it);
+		return true;
+	}
+
+	return false;
+}
+
+// mLock must be held
+bool VideoVlcPreloader::isWanted(const std::string& path)
+{
+	return std::find(mWanted.cbegin(), mWanted.cend(), path) != mWanted.cend();
+}
+
+void VideoVlcPreloader::threadProc()
+{
+	Tracing::setThreadName("VideoVlcPreloader");
+
+	while (true)
+	{
+		std::vector<Entry> unwanted;
+		std::string next;
+
+		{
+			std::unique_lock<std::mutex> lock(mLock);
+			mEvent.wait(lock, [this]() { return mExit || mChanged; });
+
+			if (mExit)
+				break;
+
+			mChanged = false;
+
+			for (auto it = mReady.begin(); it != mReady.end(); )
+			{
+				if (isWanted(it->path))
+				{
+					it++;
+					continue;
+				}
+
+				unwanted.push_back(*it);
+				it = mReady.erase(it);
+				mStats.released++;
+			}
+
+			for (auto& path : mWanted)
+			{
+				if (std::find_if(mReady.cbegin(), mReady.cend(), [&path](const Entry& e) { return e.path == path; }) == mReady.cend())
+				{
+					next = path;
+					mChanged = true; // Come back for the following ones
+					break;
+				}
+			}
+		}
+
+		for (auto& entry : unwanted)
+			release(entry);
+
+		if (next.empty())
+			continue;
+
+		Entry entry;
+		entry.path = next;
+
+		bool prepared = false;
+
+		{
+			TRACE_ZONE("VideoVlcPreloader::prepare");
+			prepared = prepare(entry);
+		}
+
+		std::unique_lock<std::mutex> lock(mLock);
+
+		if (prepared && !mExit && isWanted(entry.path))
+		{
+			mReady.push_back(entry);
+			mStats.preloaded++;
+			continue;
+		}
+
+		// Don't try again before the video is asked for again
+		if (!prepared)
+		{
+			auto it = std::find(mWanted.begin(), mWanted.end(), entry.path);
+			if (it != mWanted.end())
+				mWanted.erase(it);
+		}
+
+		lock.unlock();
+		release(entry);
+	}
+}
+
+bool VideoVlcPreloader::prepare(Entry& entry)
+{
+#if LIBVLC_VERSION_MAJOR >= 3
+	libvlc_instance_t* vlc = VideoVlcComponent::mVLC;
+	if (vlc == nullptr)
+		return false;
+
+#ifdef WIN32
+	std::string path = Utils::String::replace(entry.path, "/", "\\");
+#else
+	std::string path = entry.path;
+#endif
+
+	entry.media = libvlc_media_new_path(vlc, path.c_str());
+	if (entry.media == nullptr)
+		return false;
+
+	if (libvlc_media_parse_with_options(entry.media, libvlc_media_parse_local, 0) != 0)
+		return false;
+
+	while ((int)libvlc_media_get_parsed_status(entry.media) == 0)
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+		if (mExit || !isWanted(entry.path))
+			return false;
+
+		mEvent.wait_for(lock, std::chrono::milliseconds(10));
+	}
+
+	if (libvlc_media_get_parsed_status(entry.media) != libvlc_media_parsed_status_done)
+	{
+		LOG(LogDebug) << "VideoVlcPreloader : unable to parse " << entry.path;
+		return false;
+	}
+
+	entry.player = libvlc_media_player_new_from_media(entry.media);
+	return entry.player != nullptr;
+#else
+	return false;
+#endif
+}
+
+void VideoVlcPreloader::release(Entry& entry)
+{
+	if (entry.player != nullptr)
+		libvlc_media_player_release(entry.player);
+
+	if (entry.media != nullptr)
+		libvlc_media_release(entry.media);
+
+	entry.player = nullptr;
+	entry.media = nullptr;
+}
+
+void VideoVlcPreloader::addFirstFrameTime(bool preloaded, unsigned int ms)
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	if (preloaded)
+	{
+		mStats.warmStarts++;
+		mStats.warmFirstFrameMs += ms;
+	}
+	else
+	{
+		mStats.coldStarts++;
+		mStats.coldFirstFrameMs += ms;
+	}
+}
+
+VideoVlcPreloader::Stats VideoVlcPreloader::getStats()
+{
+	std::unique_lock<std::mutex> lock(mLock);
+	return mStats;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#ifndef ES_CORE_COMPONENTS_VIDEO_VLC_PRELOADER_H
+#define ES_CORE_COMPONENTS_VIDEO_VLC_PRELOADER_H
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+struct libvlc_media_t;
+struct libvlc_media_player_t;
+
+// Media players opened ahead of time for the videos the cursor may reach next ( the current gamelist entry & its neighbours ).
+// A worker thread creates the media, waits for VLC to parse it, and creates its player : VideoVlcComponent::startVideo takes a ready
+// player instead of waiting for the probing, and for the creation of the player & its audio output. Unwanted players are released on the worker.
+class VideoVlcPreloader
+{
+public:
+	static VideoVlcPreloader* getInstance();
+
+	// Stops the worker & releases the players
+	static void deinit();
+
+	// Releases the players, ie before a game is launched
+	static void clear();
+
+	// Videos to keep ready, most wanted first. The others are released
+	void preload(const std::vector<std::string>& paths);
+
+	// Ready media & player of a video, owned by the caller. False when the video isn't ready ( it is no longer preloaded in that case )
+	bool take(const std::string& path, libvlc_media_t** media, libvlc_media_player_t** player);
+
+	// Time from startVideo to the first frame uploaded
+	void addFirstFrameTime(bool preloaded, unsigned int ms);
+
+	struct Stats
+	{
+		Stats() : preloaded(0), released(0), warmStarts(0), coldStarts(0), warmFirstFrameMs(0), coldFirstFrameMs(0) { }
+
+		int preloaded;	// players made ready
+		int released;	// players released without being used
+		int warmStarts;
+		int coldStarts;
+		unsigned long long warmFirstFrameMs;
+		unsigned long long coldFirstFrameMs;
+	};
+
+	Stats getStats();
+
+private:
+	VideoVlcPreloader();
+
+	struct Entry
+	{
+		Entry() : media(nullptr), player(nullptr) { }
+
+		std::string				path;
+		libvlc_media_t*			media;
+		libvlc_media_player_t*	player;
+	};
+
+	void threadProc();
+	void stop();
+	bool isWanted(const std::string& path);
+	bool prepare(Entry& entry);
+
+	static void release(Entry& entry);
+
+	static VideoVlcPreloader* sInstance;
+
+	std::vector<std::string>	mWanted;
+	std::vector<Entry>			mReady;
+
+	std::thread					mThread;
+	std::mutex					mLock;
+	std::condition_variable		mEvent;
+	bool						mChanged;
+	bool						mExit;
+
+	Stats						mStats;
+};
+
+#endif // ES_CORE_COMPONENTS_VIDEO_VLC_PRELOADER_H
@@ -22,6 +22,7 @@ namespace glext
 	PFNGLGETATTRIBLOCATIONPROC glGetAttribLocation = nullptr;
 	PFNGLBUFFERDATAPROC glBufferData = nullptr;
 	PFNGLBUFFERSUBDATAARBPROC glBufferSubData = nullptr;
+	PFNGLDELETEBUFFERSPROC glDeleteBuffers = nullptr;
 	PFNGLVERTEXATTRIBPOINTERPROC glVertexAttribPointer = nullptr;
 	PFNGLENABLEVERTEXATTRIBARRAYPROC glEnableVertexAttribArray = nullptr;
 	PFNGLDISABLEVERTEXATTRIBARRAYPROC glDisableVertexAttribArray = nullptr;
@@ -95,6 +96,7 @@ namespace glext
 		glGetAttribLocation = (PFNGLGETATTRIBLOCATIONPROC)_glProcAddress("glGetAttribLocation");
 		glBufferData = (PFNGLBUFFERDATAPROC)_glProcAddress("glBufferData");
 		glBufferSubData = (PFNGLBUFFERSUBDATAARBPROC)_glProcAddress("glBufferSubData");
+		glDeleteBuffers = (PFNGLDELETEBUFFERSPROC)_glProcAddress("glDeleteBuffers");
 		glVertexAttribPointer = (PFNGLVERTEXATTRIBPOINTERPROC)_glProcAddress("glVertexAttribPointer");
 		glEnableVertexAttribArray = (PFNGLENABLEVERTEXATTRIBARRAYPROC)_glProcAddress("glEnableVertexAttribArray");
 		glDisableVertexAttribArray = (PFNGLDISABLEVERTEXATTRIBARRAYPROC)_glProcAddress("glDisableVertexAttribArray");
@@ -31,6 +31,7 @@ namespace glext
 	extern PFNGLGETATTRIBLOCATIONPROC glGetAttribLocation;
 	extern PFNGLBUFFERDATAPROC glBufferData;
 	extern PFNGLBUFFERSUBDATAARBPROC glBufferSubData;
+	extern PFNGLDELETEBUFFERSPROC glDeleteBuffers;
 	extern PFNGLVERTEXATTRIBPOINTERPROC glVertexAttribPointer;
 	extern PFNGLENABLEVERTEXATTRIBARRAYPROC glEnableVertexAttribArray;
 	extern PFNGLDISABLEVERTEXATTRIBARRAYPROC glDisableVertexAttribArray;
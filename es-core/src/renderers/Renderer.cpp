@@ -4,6 +4,7 @@
 #include "Renderer_GLES10.h"
 #include "Renderer_GLES20.h"
 #include "Renderer_GLES30.h"
+#include "Renderer_Null.h"
 
 #include "math/Transform4x4f.h"
 #include "math/Vector2i.h"
@@ -853,6 +854,13 @@ namespace Renderer
 		if (name.empty())
 			return nullptr;
 
+		// Not listed in getRendererNames : only used for headless runs ( benchmark )
+		{
+			NullRenderer rd;
+			if (rd.getDriverName() == name)
+				return new NullRenderer();
+		}
+
 #if defined(RENDERER_GLES_30)
 		{
 			GLES30Renderer rd;
@@ -1008,6 +1016,11 @@ namespace Renderer
 		return Instance()->supportShaders();
 	}
 
+	bool supportDistanceField()
+	{
+		return Instance()->supportDistanceField();
+	}
+
 	void setProjection(const Transform4x4f& _projection)
 	{
 		Instance()->setProjection(_projection);
@@ -38,7 +38,8 @@ namespace Renderer
 		enum Type
 		{
 			RGBA  = 0,
-			ALPHA = 1
+			ALPHA = 1,
+			DISTANCE_FIELD = 2 // alpha texture holding a signed distance : 0.5 is the outline
 
 		}; // Type
 
@@ -96,7 +97,6 @@ namespace Renderer
 
 	}; // Vertex
 
-#if defined(USE_OPENGLES_30)
 	// Compact GPU-only representation. CPU-side Vertex also carries shader metadata
 	// that must never consume streaming-buffer bandwidth.
 	struct GpuVertex
@@ -107,7 +107,6 @@ namespace Renderer
 		float v;
 		unsigned int col;
 	};
-#endif
 
 	class IRenderer
 	{
@@ -154,6 +153,7 @@ namespace Renderer
 		virtual size_t		 getTotalMemUsage() { return (size_t) -1; };
 
 		virtual bool		 supportShaders() { return false; }
+		virtual bool		 supportDistanceField() { return false; }
 		virtual bool		 shaderSupportsCornerSize(const std::string& shader) { return false; };
 	};
 	
@@ -228,6 +228,7 @@ namespace Renderer
 	size_t		 getTotalMemUsage  ();
 
 	bool		 supportShaders();
+	bool		 supportDistanceField();
 	bool		 shaderSupportsCornerSize(const std::string& shader);
 
 	std::string  getDriverName();
@@ -10,12 +10,47 @@
 #include <SDL_opengl.h>
 #include <SDL.h>
 #include <vector>
+#include <cstdint>
 
 namespace Renderer
 {
 	static SDL_GLContext sdlContext = nullptr;
 	static unsigned int boundTexture = 0;
 
+	static Transform4x4f worldViewMatrix = Transform4x4f::Identity();
+
+	// Quads are transformed on the CPU, so batches survive setMatrix. Only for 2D matrices
+	static bool worldViewIs2D = true;
+
+	// Client arrays use the compact vertex format, so the driver copies half the data
+	static std::vector<GpuVertex> packedScratch;
+
+	struct QuadBatch
+	{
+		// Four vertices per quad, in triangle-strip order, already transformed by the world view matrix.
+		std::vector<GpuVertex> vertices;
+		unsigned int texture = 0;
+		Blend::Factor sourceBlend = Blend::SRC_ALPHA;
+		Blend::Factor destinationBlend = Blend::ONE_MINUS_SRC_ALPHA;
+		bool active = false;
+	};
+
+	struct GL21PerformanceCounters
+	{
+		uint64_t submittedQuads = 0;
+		uint64_t batchFlushes = 0;
+		uint64_t drawCalls = 0;
+	};
+
+	static QuadBatch quadBatch;
+	static GL21PerformanceCounters performanceCounters;
+
+	static const size_t MAX_BATCH_QUADS = 1024;
+	static const size_t MAX_BATCH_VERTICES = MAX_BATCH_QUADS * 4;
+
+	// Strip order (0,1,2,3) of each quad becomes two triangles with matching winding.
+	static std::vector<GLushort> quadIndices;
+
 	static GLenum convertBlendFactor(const Blend::Factor _blendFactor)
 	{
 		switch(_blendFactor)
@@ -40,12 +75,135 @@ namespace Renderer
 		switch(_type)
 		{
 			case Texture::RGBA:  { return GL_RGBA;  } break;
-			case Texture::ALPHA: { return GL_ALPHA; } break;
+			case Texture::ALPHA:
+			case Texture::DISTANCE_FIELD: { return GL_ALPHA; } break;
 			default:             { return GL_ZERO;  }
 		}
 
 	} // convertTextureType
 
+	static void setVertexPointers(const GpuVertex* _vertices)
+	{
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+		glEnableClientState(GL_COLOR_ARRAY);
+
+		glVertexPointer(  2, GL_FLOAT,         sizeof(GpuVertex), &_vertices[0].x);
+		glTexCoordPointer(2, GL_FLOAT,         sizeof(GpuVertex), &_vertices[0].u);
+		glColorPointer(   4, GL_UNSIGNED_BYTE, sizeof(GpuVertex), &_vertices[0].col);
+	}
+
+	static void resetVertexPointers()
+	{
+		glDisableClientState(GL_COLOR_ARRAY);
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		glDisableClientState(GL_VERTEX_ARRAY);
+	}
+
+	static void drawPackedVertices(const GLenum _mode, const Vertex* _vertices, const unsigned int _numVertices)
+	{
+		packedScratch.resize(_numVertices);
+		for (unsigned int i = 0; i < _numVertices; ++i)
+		{
+			GpuVertex& packed = packedScratch[i];
+			packed.x = _vertices[i].pos.x();
+			packed.y = _vertices[i].pos.y();
+			packed.u = _vertices[i].tex.x();
+			packed.v = _vertices[i].tex.y();
+			packed.col = _vertices[i].col;
+		}
+
+		setVertexPointers(packedScratch.data());
+		glDrawArrays(_mode, 0, _numVertices);
+		resetVertexPointers();
+
+		++performanceCounters.drawCalls;
+	}
+
+	static void flushQuadBatch()
+	{
+		if (!quadBatch.active || quadBatch.vertices.empty())
+			return;
+
+		const size_t quadCount = quadBatch.vertices.size() / 4;
+
+		if (quadIndices.size() < quadCount * 6)
+		{
+			quadIndices.resize(MAX_BATCH_QUADS * 6);
+			for (size_t quad = 0; quad < MAX_BATCH_QUADS; ++quad)
+			{
+				const GLushort base = static_cast<GLushort>(quad * 4);
+				GLushort* out = &quadIndices[quad * 6];
+
+				out[0] = base + 0;
+				out[1] = base + 1;
+				out[2] = base + 2;
+				out[3] = base + 2;
+				out[4] = base + 1;
+				out[5] = base + 3;
+			}
+		}
+
+		// Batched vertices are already in world space
+		glMatrixMode(GL_MODELVIEW);
+		glLoadIdentity();
+
+		glEnable(GL_BLEND);
+		glBlendFunc(convertBlendFactor(quadBatch.sourceBlend), convertBlendFactor(quadBatch.destinationBlend));
+
+		setVertexPointers(quadBatch.vertices.data());
+
+		if (quadCount == 1)
+			glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+		else
+			glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(quadCount * 6), GL_UNSIGNED_SHORT, quadIndices.data());
+
+		resetVertexPointers();
+
+		glDisable(GL_BLEND);
+		glLoadMatrixf((GLfloat*)&worldViewMatrix);
+
+		++performanceCounters.drawCalls;
+		++performanceCounters.batchFlushes;
+		quadBatch.vertices.clear();
+		quadBatch.active = false;
+	}
+
+	static void queueQuad(const Vertex* _vertices, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor)
+	{
+		if (quadBatch.active && (quadBatch.texture != boundTexture || quadBatch.sourceBlend != _srcBlendFactor || quadBatch.destinationBlend != _dstBlendFactor))
+			flushQuadBatch();
+
+		if (!quadBatch.active)
+		{
+			quadBatch.texture = boundTexture;
+			quadBatch.sourceBlend = _srcBlendFactor;
+			quadBatch.destinationBlend = _dstBlendFactor;
+			quadBatch.active = true;
+		}
+
+		const float* m = (const float*)&worldViewMatrix;
+
+		for (int i = 0; i < 4; ++i)
+		{
+			const float x = _vertices[i].pos.x();
+			const float y = _vertices[i].pos.y();
+
+			GpuVertex packed;
+			packed.x = m[0] * x + m[4] * y + m[12];
+			packed.y = m[1] * x + m[5] * y + m[13];
+			packed.u = _vertices[i].tex.x();
+			packed.v = _vertices[i].tex.y();
+			packed.col = _vertices[i].col;
+			quadBatch.vertices.push_back(packed);
+		}
+
+		++performanceCounters.submittedQuads;
+
+		if (quadBatch.vertices.size() >= MAX_BATCH_VERTICES)
+			flushQuadBatch();
+	}
+
 	unsigned int OpenGL21Renderer::getWindowFlags()
 	{
 		return SDL_WINDOW_OPENGL;
@@ -104,6 +262,10 @@ namespace Renderer
 
 		glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
 
+		quadBatch = QuadBatch();
+		quadBatch.vertices.reserve(MAX_BATCH_VERTICES);
+		performanceCounters = GL21PerformanceCounters();
+
 		std::string glExts = (const char*)glGetString(GL_EXTENSIONS);
 		LOG(LogInfo) << "Checking available OpenGL extensions...";
 		LOG(LogInfo) << " ARB_texture_non_power_of_two: " << (glExts.find("ARB_texture_non_power_of_two") != std::string::npos ? "ok" : "MISSING");
@@ -112,11 +274,22 @@ namespace Renderer
 
 	void OpenGL21Renderer::resetCache()
 	{
-		
+		flushQuadBatch();
 	}
 
 	void OpenGL21Renderer::destroyContext()
 	{
+		flushQuadBatch();
+		LOG(LogInfo) << "GL21 performance counters: queued quads=" << performanceCounters.submittedQuads
+			<< ", batch draws=" << performanceCounters.batchFlushes
+			<< ", quads per draw=" << (performanceCounters.batchFlushes > 0
+				? (double)performanceCounters.submittedQuads / (double)performanceCounters.batchFlushes : 0.0)
+			<< ", draw calls=" << performanceCounters.drawCalls;
+
+		quadBatch = QuadBatch();
+		packedScratch.clear();
+		packedScratch.shrink_to_fit();
+
 		SDL_GL_DeleteContext(sdlContext);
 		sdlContext = nullptr;
 
@@ -124,6 +297,8 @@ namespace Renderer
 
 	unsigned int OpenGL21Renderer::createTexture(const Texture::Type _type, const bool _linear, const bool _repeat, const unsigned int _width, const unsigned int _height, void* _data)
 	{
+		flushQuadBatch();
+
 		const GLenum type = convertTextureType(_type);
 		unsigned int texture;
 
@@ -157,12 +332,15 @@ namespace Renderer
 	
 	void OpenGL21Renderer::destroyTexture(const unsigned int _texture)
 	{
+		flushQuadBatch();
 		glDeleteTextures(1, &_texture);
 
 	} // destroyTexture
 
 	void OpenGL21Renderer::updateTexture(const unsigned int _texture, const Texture::Type _type, const unsigned int _x, const unsigned _y, const unsigned int _width, const unsigned int _height, void* _data)
 	{
+		flushQuadBatch();
+
 		glBindTexture(GL_TEXTURE_2D, _texture);
 
 		if (_x == -1 && _y == -1)
@@ -182,6 +360,8 @@ namespace Renderer
 		if (boundTexture == _texture)
 			return;
 
+		flushQuadBatch();
+
 		boundTexture = _texture;
 
 		glBindTexture(GL_TEXTURE_2D, _texture);
@@ -193,22 +373,12 @@ namespace Renderer
 
 	void OpenGL21Renderer::drawLines(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor)
 	{
+		flushQuadBatch();
+
 		glEnable(GL_BLEND);
 		glBlendFunc(convertBlendFactor(_srcBlendFactor), convertBlendFactor(_dstBlendFactor));
 
-		glEnableClientState(GL_VERTEX_ARRAY);
-		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-		glEnableClientState(GL_COLOR_ARRAY);
-
-		glVertexPointer(  2, GL_FLOAT,         sizeof(Vertex), &_vertices[0].pos);
-		glTexCoordPointer(2, GL_FLOAT,         sizeof(Vertex), &_vertices[0].tex);
-		glColorPointer(   4, GL_UNSIGNED_BYTE, sizeof(Vertex), &_vertices[0].col);
-
-		glDrawArrays(GL_LINES, 0, _numVertices);
-
-		glDisableClientState(GL_COLOR_ARRAY);
-		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-		glDisableClientState(GL_VERTEX_ARRAY);
+		drawPackedVertices(GL_LINES, _vertices, _numVertices);
 
 		glDisable(GL_BLEND);
 
@@ -216,27 +386,33 @@ namespace Renderer
 
 	void OpenGL21Renderer::drawTriangleStrips(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor, bool verticesChanged)
 	{
+		if (_vertices == nullptr || _numVertices == 0)
+			return;
+
+		// Same rules as GLES20 : quads with a saturation, a corner radius or a custom shader are drawn on their own
+		const bool batchable = _numVertices == 4 && worldViewIs2D &&
+			_vertices->customShader == nullptr && _vertices->saturation == 1.0f && _vertices->cornerRadius == 0.0f;
+
+		if (batchable)
+		{
+			queueQuad(_vertices, _srcBlendFactor, _dstBlendFactor);
+			return;
+		}
+
+		flushQuadBatch();
+
 		glEnable(GL_BLEND);
 		glBlendFunc(convertBlendFactor(_srcBlendFactor), convertBlendFactor(_dstBlendFactor));
 
-		glEnableClientState(GL_VERTEX_ARRAY);
-		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-		glEnableClientState(GL_COLOR_ARRAY);
-
-		glVertexPointer(2, GL_FLOAT, sizeof(Vertex), &_vertices[0].pos);
-		glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), &_vertices[0].tex);
-		glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex), &_vertices[0].col);
-		glDrawArrays(GL_TRIANGLE_STRIP, 0, _numVertices);
-		
-		glDisableClientState(GL_COLOR_ARRAY);
-		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-		glDisableClientState(GL_VERTEX_ARRAY);
+		drawPackedVertices(GL_TRIANGLE_STRIP, _vertices, _numVertices);
 
 		glDisable(GL_BLEND);
 	} // drawTriangleStrips
 
 	void OpenGL21Renderer::setProjection(const Transform4x4f& _projection)
 	{
+		flushQuadBatch();
+
 		glMatrixMode(GL_PROJECTION);
 		glLoadMatrixf((GLfloat*)&_projection);
 
@@ -244,15 +420,20 @@ namespace Renderer
 
 	void OpenGL21Renderer::setMatrix(const Transform4x4f& _matrix)
 	{
-		Transform4x4f matrix = _matrix;
-		// matrix.round();
+		worldViewMatrix = _matrix;
+		// worldViewMatrix.round();
 		glMatrixMode(GL_MODELVIEW);
-		glLoadMatrixf((GLfloat*)&matrix);
+		glLoadMatrixf((GLfloat*)&worldViewMatrix);
+
+		const float* m = (const float*)&worldViewMatrix;
+		worldViewIs2D = m[2] == 0.0f && m[3] == 0.0f && m[6] == 0.0f && m[7] == 0.0f && m[14] == 0.0f && m[15] == 1.0f;
 
 	} // setMatrix
 
 	void OpenGL21Renderer::setViewport(const Rect& _viewport)
 	{
+		flushQuadBatch();
+
 		// glViewport starts at the bottom left of the window
 		glViewport( _viewport.x, getWindowHeight() - _viewport.y - _viewport.h, _viewport.w, _viewport.h);
 
@@ -260,6 +441,8 @@ namespace Renderer
 
 	void OpenGL21Renderer::setScissor(const Rect& _scissor)
 	{
+		flushQuadBatch();
+
 		if((_scissor.x == 0) && (_scissor.y == 0) && (_scissor.w == 0) && (_scissor.h == 0))
 		{
 			glDisable(GL_SCISSOR_TEST);
@@ -294,6 +477,8 @@ namespace Renderer
 
 	void OpenGL21Renderer::swapBuffers()
 	{		
+		flushQuadBatch();
+
 #ifdef WIN32		
 		glFlush();
 		Sleep(0);
@@ -311,24 +496,14 @@ namespace Renderer
 
 	void OpenGL21Renderer::drawTriangleFan(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor)
 	{
+		flushQuadBatch();
+
 		glEnable(GL_MULTISAMPLE);
 
 		glEnable(GL_BLEND);
 		glBlendFunc(convertBlendFactor(_srcBlendFactor), convertBlendFactor(_dstBlendFactor));
 
-		glEnableClientState(GL_VERTEX_ARRAY);
-		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-		glEnableClientState(GL_COLOR_ARRAY);
-
-		glVertexPointer(2, GL_FLOAT, sizeof(Vertex), &_vertices[0].pos);
-		glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), &_vertices[0].tex);
-		glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex), &_vertices[0].col);
-
-		glDrawArrays(GL_TRIANGLE_FAN, 0, _numVertices);
-
-		glDisableClientState(GL_COLOR_ARRAY);
-		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-		glDisableClientState(GL_VERTEX_ARRAY);
+		drawPackedVertices(GL_TRIANGLE_FAN, _vertices, _numVertices);
 
 		glDisable(GL_BLEND);
 		glDisable(GL_MULTISAMPLE);
@@ -361,6 +536,7 @@ namespace Renderer
 		};
 
 		bindTexture(0);
+		flushQuadBatch();
 
 		glEnable(GL_BLEND);
 		glBlendFunc(convertBlendFactor(Blend::SRC_ALPHA), convertBlendFactor(Blend::ONE_MINUS_SRC_ALPHA));
@@ -407,6 +583,8 @@ namespace Renderer
 
 	void OpenGL21Renderer::setStencil(const Vertex* _vertices, const unsigned int _numVertices)
 	{
+		flushQuadBatch();
+
 		bool tx = glIsEnabled(GL_TEXTURE_2D);
 		glDisable(GL_TEXTURE_2D);
 
@@ -434,6 +612,7 @@ namespace Renderer
 
 	void OpenGL21Renderer::disableStencil()
 	{
+		flushQuadBatch();
 		glDisable(GL_STENCIL_TEST);
 	}
 
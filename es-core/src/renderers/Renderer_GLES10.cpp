@@ -44,7 +44,8 @@ namespace Renderer
 		switch(_type)
 		{
 			case Texture::RGBA:  { return GL_RGBA;  } break;
-			case Texture::ALPHA: { return GL_ALPHA; } break;
+			case Texture::ALPHA:
+			case Texture::DISTANCE_FIELD: { return GL_ALPHA; } break;
 			default:             { return GL_ZERO;  }
 		}
 
@@ -10,9 +10,11 @@
 #include "Log.h"
 #include "Settings.h"
 
+#include <algorithm>
 #include <vector>
 #include <set>
 #include <fstream>
+#include <cstdint>
 
 #include "GlExtensions.h"
 #include "Shader.h"
@@ -28,6 +30,7 @@ namespace Renderer
 	{
 		GLenum type;
 		Vector2f size;
+		bool distanceField = false;
 	};
 
 	static SDL_GLContext	sdlContext       = nullptr;
@@ -39,9 +42,72 @@ namespace Renderer
 	static ShaderProgram    shaderProgramColorTexture;
 	static ShaderProgram    shaderProgramColorNoTexture;
 	static ShaderProgram    shaderProgramAlpha;
+	static ShaderProgram    shaderProgramDistanceField;
+	static bool             distanceFieldSupported = false;
 
 	static GLuint			vertexBuffer     = 0;
 
+	// Uploads are appended to the streaming buffer. When it is full, its storage is orphaned
+	// ( the driver keeps the old one for pending draws ) instead of waiting for the GPU.
+	struct StreamRange
+	{
+		GLint first = 0;
+		GLsizei vertexCount = 0;
+		unsigned int generation = 0;
+		bool valid = false;
+	};
+
+	static const size_t STREAM_BUFFER_VERTICES = 32 * 1024;
+
+	static size_t			streamCapacity = 0;
+	static size_t			streamPosition = 0;
+	static unsigned int		streamGeneration = 1;
+	static StreamRange		lastStripRange;
+
+	// Reused across every upload so the hot path never touches the allocator.
+	static std::vector<GpuVertex> packedScratch;
+
+	enum class QuadBatchShader
+	{
+		NO_TEXTURE,
+		COLOR_TEXTURE
+	};
+
+	struct QuadBatch
+	{
+		// Four vertices per quad, in triangle-strip order, already transformed by the world view matrix.
+		std::vector<GpuVertex> vertices;
+		unsigned int texture = 0;
+		Blend::Factor sourceBlend = Blend::SRC_ALPHA;
+		Blend::Factor destinationBlend = Blend::ONE_MINUS_SRC_ALPHA;
+		QuadBatchShader shader = QuadBatchShader::NO_TEXTURE;
+		bool active = false;
+	};
+
+	struct GLES20PerformanceCounters
+	{
+		uint64_t submittedQuads = 0;
+		uint64_t batchFlushes = 0;
+		uint64_t singleQuadFlushes = 0;
+		uint64_t indexedFlushes = 0;
+		uint64_t drawCalls = 0;
+		uint64_t streamOrphans = 0;
+		uint64_t uploadedBytes = 0;
+	};
+
+	static QuadBatch quadBatch;
+	static GLES20PerformanceCounters performanceCounters;
+
+	static const size_t MAX_BATCH_QUADS = 1024;
+	static const size_t MAX_BATCH_VERTICES = MAX_BATCH_QUADS * 4;
+
+	static GLuint quadIndexBuffer = 0;
+
+	// Quads are transformed on the CPU, so batches survive setMatrix. Only for 2D matrices
+	static bool worldViewIs2D = true;
+
+	static void flushQuadBatch();
+
 	static std::map<unsigned int, TextureInfo*> _textures;
 
 	static unsigned int		boundTexture = 0;
@@ -357,6 +423,34 @@ namespace Renderer
 		auto fragmentShaderAlpha = Shader::createShader(GL_FRAGMENT_SHADER, fragmentSourceAlpha);
 
 		shaderProgramAlpha.createShaderProgram(vertexShaderAlpha, fragmentShaderAlpha);
+
+		// fragment shader (distance field texture) : the outline is smoothed over about one screen pixel
+		std::string fragmentSourceDistanceField =
+			SHADER_VERSION_STRING +
+			R"=====(
+			#ifdef GL_ES
+			#extension GL_OES_standard_derivatives : enable
+			precision mediump float;
+			precision mediump sampler2D;
+			#endif
+
+			varying   vec4      v_col;
+			varying   vec2      v_tex;
+			uniform   sampler2D u_tex;
+
+			void main(void)
+			{
+			    float distance = texture2D(u_tex, v_tex).a;
+			    float width = max(fwidth(distance) * 0.7, 0.001);
+			    float a = smoothstep(0.5 - width, 0.5 + width, distance);
+			    gl_FragColor = vec4(1.0, 1.0, 1.0, a) * v_col;
+			}
+			)=====";
+
+		auto vertexShaderDistanceField = Shader::createShader(GL_VERTEX_SHADER, vertexSourceTexture);
+		auto fragmentShaderDistanceField = Shader::createShader(GL_FRAGMENT_SHADER, fragmentSourceDistanceField);
+
+		distanceFieldSupported = shaderProgramDistanceField.createShaderProgram(vertexShaderDistanceField, fragmentShaderDistanceField);
 		
 		useProgram(nullptr);
 
@@ -364,13 +458,118 @@ namespace Renderer
 
 //////////////////////////////////////////////////////////////////////////
 
+	static void setupQuadIndexBuffer()
+	{
+		std::vector<GLushort> indices(MAX_BATCH_QUADS * 6);
+		for (size_t quad = 0; quad < MAX_BATCH_QUADS; ++quad)
+		{
+			const GLushort base = static_cast<GLushort>(quad * 4);
+			GLushort* out = &indices[quad * 6];
+
+			// Strip order (0,1,2,3) becomes two triangles with matching winding.
+			out[0] = base + 0;
+			out[1] = base + 1;
+			out[2] = base + 2;
+			out[3] = base + 2;
+			out[4] = base + 1;
+			out[5] = base + 3;
+		}
+
+		GL_CHECK_ERROR(glGenBuffers(1, &quadIndexBuffer));
+		if (quadIndexBuffer == 0)
+		{
+			LOG(LogWarning) << "Unable to create the quad index buffer; falling back to expanded quad batching";
+			return;
+		}
+
+		// Stays bound : nothing else uses element buffers
+		GL_CHECK_ERROR(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, quadIndexBuffer));
+
+		while (glGetError() != GL_NO_ERROR)
+			;
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLushort), indices.data(), GL_STATIC_DRAW);
+		if (glGetError() != GL_NO_ERROR)
+		{
+			LOG(LogWarning) << "Unable to upload the quad index buffer; falling back to expanded quad batching";
+			GL_CHECK_ERROR(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+			GL_CHECK_ERROR(glDeleteBuffers(1, &quadIndexBuffer));
+			quadIndexBuffer = 0;
+		}
+	}
+
 	static void setupVertexBuffer()
 	{
 		GL_CHECK_ERROR(glGenBuffers(1, &vertexBuffer));
 		GL_CHECK_ERROR(glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer));
 
+		streamCapacity = STREAM_BUFFER_VERTICES;
+		streamPosition = 0;
+		streamGeneration = 1;
+		lastStripRange = StreamRange();
+		GL_CHECK_ERROR(glBufferData(GL_ARRAY_BUFFER, streamCapacity * sizeof(GpuVertex), nullptr, GL_STREAM_DRAW));
+
+		quadBatch = QuadBatch();
+		performanceCounters = GLES20PerformanceCounters();
+
+		quadBatch.vertices.reserve(MAX_BATCH_VERTICES);
+		packedScratch.reserve(MAX_BATCH_QUADS * 6);
+
+		setupQuadIndexBuffer();
+
 	} // setupVertexBuffer
 
+	static GpuVertex packVertex(const Vertex& vertex)
+	{
+		GpuVertex packed;
+		packed.x = vertex.pos.x();
+		packed.y = vertex.pos.y();
+		packed.u = vertex.tex.x();
+		packed.v = vertex.tex.y();
+		packed.col = vertex.col;
+		return packed;
+	}
+
+	static StreamRange uploadPackedVertices(const GpuVertex* vertices, const size_t vertexCount)
+	{
+		static_assert(sizeof(GpuVertex) == 20, "Packed vertex must remain 20 bytes");
+
+		StreamRange range;
+		if (vertices == nullptr || vertexCount == 0 || vertexBuffer == 0)
+			return range;
+
+		if (streamPosition + vertexCount > streamCapacity)
+		{
+			streamCapacity = std::max(STREAM_BUFFER_VERTICES, vertexCount);
+			GL_CHECK_ERROR(glBufferData(GL_ARRAY_BUFFER, streamCapacity * sizeof(GpuVertex), nullptr, GL_STREAM_DRAW));
+			streamPosition = 0;
+			++streamGeneration;
+			++performanceCounters.streamOrphans;
+		}
+
+		GL_CHECK_ERROR(glBufferSubData(GL_ARRAY_BUFFER, streamPosition * sizeof(GpuVertex), vertexCount * sizeof(GpuVertex), vertices));
+		performanceCounters.uploadedBytes += vertexCount * sizeof(GpuVertex);
+
+		range.first = static_cast<GLint>(streamPosition);
+		range.vertexCount = static_cast<GLsizei>(vertexCount);
+		range.generation = streamGeneration;
+		range.valid = true;
+
+		streamPosition += vertexCount;
+		return range;
+	}
+
+	static StreamRange uploadVertices(const Vertex* vertices, const size_t vertexCount)
+	{
+		if (vertices == nullptr || vertexCount == 0)
+			return StreamRange();
+
+		packedScratch.resize(vertexCount);
+		for (size_t i = 0; i < vertexCount; ++i)
+			packedScratch[i] = packVertex(vertices[i]);
+
+		return uploadPackedVertices(packedScratch.data(), vertexCount);
+	}
+
 //////////////////////////////////////////////////////////////////////////
 
 	static GLenum convertBlendFactor(const Blend::Factor _blendFactor)
@@ -392,6 +591,141 @@ namespace Renderer
 
 	} // convertBlendFactor
 
+	// Returns true if blending was enabled : the caller disables it after drawing
+	static bool applyBlendFactors(const Blend::Factor source, const Blend::Factor destination)
+	{
+		if (source != Blend::ONE && destination != Blend::ONE)
+		{
+			GL_CHECK_ERROR(glEnable(GL_BLEND));
+			GL_CHECK_ERROR(glBlendFunc(convertBlendFactor(source), convertBlendFactor(destination)));
+			return true;
+		}
+
+		GL_CHECK_ERROR(glDisable(GL_BLEND));
+		return false;
+	}
+
+	static void drawStreamRange(const GLenum mode, const StreamRange& range, const Blend::Factor source, const Blend::Factor destination)
+	{
+		if (!range.valid)
+			return;
+
+		if (currentProgram != nullptr)
+			currentProgram->setVertexOffset(0);
+
+		const bool blend = applyBlendFactors(source, destination);
+		GL_CHECK_ERROR(glDrawArrays(mode, range.first, range.vertexCount));
+		++performanceCounters.drawCalls;
+
+		if (blend)
+			GL_CHECK_ERROR(glDisable(GL_BLEND));
+	}
+
+	static void flushQuadBatch()
+	{
+		if (!quadBatch.active || quadBatch.vertices.empty())
+			return;
+
+		ShaderProgram* program = quadBatch.shader == QuadBatchShader::COLOR_TEXTURE ? &shaderProgramColorTexture : &shaderProgramColorNoTexture;
+		useProgram(program);
+
+		// Batched vertices are already in world space
+		program->setMatrix(projectionMatrix);
+		if (quadBatch.shader == QuadBatchShader::COLOR_TEXTURE)
+		{
+			program->setSaturation(1.0f);
+			program->setCornerRadius(0.0f);
+		}
+
+		const GpuVertex* vertices = quadBatch.vertices.data();
+		const size_t quadCount = quadBatch.vertices.size() / 4;
+
+		if (quadCount == 1)
+		{
+			// Nothing merged, so draw the strip rather than expanding it.
+			const StreamRange range = uploadPackedVertices(vertices, 4);
+			drawStreamRange(GL_TRIANGLE_STRIP, range, quadBatch.sourceBlend, quadBatch.destinationBlend);
+			++performanceCounters.singleQuadFlushes;
+		}
+		else if (quadIndexBuffer != 0 && quadCount <= MAX_BATCH_QUADS)
+		{
+			// Four vertices per quad; the static index buffer does the expansion.
+			const StreamRange range = uploadPackedVertices(vertices, quadCount * 4);
+			if (range.valid)
+			{
+				program->setVertexOffset(range.first);
+
+				const bool blend = applyBlendFactors(quadBatch.sourceBlend, quadBatch.destinationBlend);
+				GL_CHECK_ERROR(glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(quadCount * 6), GL_UNSIGNED_SHORT, nullptr));
+				if (blend)
+					GL_CHECK_ERROR(glDisable(GL_BLEND));
+
+				++performanceCounters.drawCalls;
+				++performanceCounters.indexedFlushes;
+			}
+		}
+		else
+		{
+			packedScratch.resize(quadCount * 6);
+			for (size_t quad = 0; quad < quadCount; ++quad)
+			{
+				const GpuVertex* src = vertices + quad * 4;
+				GpuVertex* out = &packedScratch[quad * 6];
+
+				out[0] = src[0];
+				out[1] = src[1];
+				out[2] = src[2];
+				out[3] = src[2];
+				out[4] = src[1];
+				out[5] = src[3];
+			}
+
+			const StreamRange range = uploadPackedVertices(packedScratch.data(), quadCount * 6);
+			drawStreamRange(GL_TRIANGLES, range, quadBatch.sourceBlend, quadBatch.destinationBlend);
+		}
+
+		++performanceCounters.batchFlushes;
+		quadBatch.vertices.clear();
+		quadBatch.active = false;
+	}
+
+	static void queueQuad(const Vertex* vertices, const Blend::Factor source, const Blend::Factor destination, const QuadBatchShader shader)
+	{
+		if (quadBatch.active && (quadBatch.texture != boundTexture || quadBatch.sourceBlend != source ||
+			quadBatch.destinationBlend != destination || quadBatch.shader != shader))
+			flushQuadBatch();
+
+		if (!quadBatch.active)
+		{
+			quadBatch.texture = boundTexture;
+			quadBatch.sourceBlend = source;
+			quadBatch.destinationBlend = destination;
+			quadBatch.shader = shader;
+			quadBatch.active = true;
+		}
+
+		const float* m = (const float*)&worldViewMatrix;
+
+		for (int i = 0; i < 4; ++i)
+		{
+			const float x = vertices[i].pos.x();
+			const float y = vertices[i].pos.y();
+
+			GpuVertex packed;
+			packed.x = m[0] * x + m[4] * y + m[12];
+			packed.y = m[1] * x + m[5] * y + m[13];
+			packed.u = vertices[i].tex.x();
+			packed.v = vertices[i].tex.y();
+			packed.col = vertices[i].col;
+			quadBatch.vertices.push_back(packed);
+		}
+
+		++performanceCounters.submittedQuads;
+
+		if (quadBatch.vertices.size() >= MAX_BATCH_VERTICES)
+			flushQuadBatch();
+	}
+
 //////////////////////////////////////////////////////////////////////////
 
 	static GLenum convertTextureType(const Texture::Type _type)
@@ -400,9 +734,11 @@ namespace Renderer
 		{
 			case Texture::RGBA:  { return GL_RGBA;            } break;
 #if defined(USE_OPENGLES_20)
-			case Texture::ALPHA: { return GL_ALPHA; } break;
+			case Texture::ALPHA:
+			case Texture::DISTANCE_FIELD: { return GL_ALPHA; } break;
 #else
-			case Texture::ALPHA: { return GL_LUMINANCE_ALPHA; } break;
+			case Texture::ALPHA:
+			case Texture::DISTANCE_FIELD: { return GL_LUMINANCE_ALPHA; } break;
 #endif
 			default:             { return GL_ZERO;            }
 		}
@@ -605,6 +941,7 @@ namespace Renderer
 
 	void GLES20Renderer::resetCache()
 	{
+		flushQuadBatch();
 		bindTexture(0);
 
 		for (auto customShader : _customShaderBatch)
@@ -644,7 +981,35 @@ namespace Renderer
 
 	void GLES20Renderer::destroyContext()
 	{
+		flushQuadBatch();
+		LOG(LogInfo) << "GLES2 performance counters: queued quads=" << performanceCounters.submittedQuads
+			<< ", batch draws=" << performanceCounters.batchFlushes
+			<< " (single-quad=" << performanceCounters.singleQuadFlushes
+			<< ", indexed=" << performanceCounters.indexedFlushes << ")"
+			<< ", quads per draw=" << (performanceCounters.batchFlushes > 0
+				? (double)performanceCounters.submittedQuads / (double)performanceCounters.batchFlushes : 0.0)
+			<< ", draw calls=" << performanceCounters.drawCalls
+			<< ", vertex bytes=" << performanceCounters.uploadedBytes
+			<< ", buffer orphans=" << performanceCounters.streamOrphans;
+
 		resetCache();
+		useProgram(nullptr);
+
+		if (quadIndexBuffer != 0)
+		{
+			GL_CHECK_ERROR(glDeleteBuffers(1, &quadIndexBuffer));
+			quadIndexBuffer = 0;
+		}
+
+		if (vertexBuffer != 0)
+		{
+			GL_CHECK_ERROR(glDeleteBuffers(1, &vertexBuffer));
+			vertexBuffer = 0;
+			lastStripRange = StreamRange();
+			quadBatch = QuadBatch();
+			packedScratch.clear();
+			packedScratch.shrink_to_fit();
+		}
 
 		SDL_GL_DeleteContext(sdlContext);
 		sdlContext = nullptr;
@@ -655,6 +1020,7 @@ namespace Renderer
 
 	unsigned int GLES20Renderer::createTexture(const Texture::Type _type, const bool _linear, const bool _repeat, const unsigned int _width, const unsigned int _height, void* _data)
 	{
+		flushQuadBatch();
 		const GLenum type = convertTextureType(_type);
 
 		unsigned int texture = -1;
@@ -718,12 +1084,14 @@ namespace Renderer
 			{
 				it->second->type = type;
 				it->second->size = Vector2f(_width, _height);
+				it->second->distanceField = _type == Texture::DISTANCE_FIELD;
 			}
 			else
 			{
 				auto info = new TextureInfo();
 				info->type = type;
 				info->size = Vector2f(_width, _height);
+				info->distanceField = _type == Texture::DISTANCE_FIELD;
 				_textures[texture] = info;
 			}
 		}
@@ -736,6 +1104,7 @@ namespace Renderer
 
 	void GLES20Renderer::destroyTexture(const unsigned int _texture)
 	{
+		flushQuadBatch();
 		auto it = _textures.find(_texture);
 		if (it != _textures.cend())
 		{
@@ -756,6 +1125,7 @@ namespace Renderer
 
 	void GLES20Renderer::updateTexture(const unsigned int _texture, const Texture::Type _type, const unsigned int _x, const unsigned _y, const unsigned int _width, const unsigned int _height, void* _data)
 	{
+		flushQuadBatch();
 		const GLenum type = convertTextureType(_type);
 
 		bindTexture(_texture);
@@ -807,6 +1177,8 @@ namespace Renderer
 		if (boundTexture == _texture)
 			return;
 
+		flushQuadBatch();
+
 		boundTexture = _texture;
 
 		if(_texture == 0)
@@ -826,24 +1198,12 @@ namespace Renderer
 
 	void GLES20Renderer::drawLines(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor)
 	{
-		// Pass buffer data
-		GL_CHECK_ERROR(glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * _numVertices, _vertices, GL_DYNAMIC_DRAW));
+		flushQuadBatch();
 
-		useProgram(&shaderProgramColorNoTexture);
+		const StreamRange range = uploadVertices(_vertices, _numVertices);
 
-		// Do rendering
-		if (_srcBlendFactor != Blend::ONE && _dstBlendFactor != Blend::ONE)
-		{
-			GL_CHECK_ERROR(glEnable(GL_BLEND));
-			GL_CHECK_ERROR(glBlendFunc(convertBlendFactor(_srcBlendFactor), convertBlendFactor(_dstBlendFactor)));
-			GL_CHECK_ERROR(glDrawArrays(GL_LINES, 0, _numVertices));
-			GL_CHECK_ERROR(glDisable(GL_BLEND));
-		}
-		else
-		{
-			GL_CHECK_ERROR(glDisable(GL_BLEND));
-			GL_CHECK_ERROR(glDrawArrays(GL_LINES, 0, _numVertices));
-		}
+		useProgram(&shaderProgramColorNoTexture);
+		drawStreamRange(GL_LINES, range, _srcBlendFactor, _dstBlendFactor);
 
 	} // drawLines
 
@@ -866,17 +1226,15 @@ namespace Renderer
 		}
 
 		bindTexture(0);
+		flushQuadBatch();
 		useProgram(&shaderProgramColorNoTexture);
 
-		GL_CHECK_ERROR(glEnable(GL_BLEND));
-		GL_CHECK_ERROR(glBlendFunc(convertBlendFactor(Blend::SRC_ALPHA), convertBlendFactor(Blend::ONE_MINUS_SRC_ALPHA)));
-
 		auto inner = createRoundRect(_x + borderWidth, _y + borderWidth, _w - borderWidth - borderWidth, _h - borderWidth - borderWidth, cornerRadius, _fillColor);
 
 		if ((_fillColor) & 0xFF)
 		{
-			GL_CHECK_ERROR(glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * inner.size(), inner.data(), GL_DYNAMIC_DRAW));
-			GL_CHECK_ERROR(glDrawArrays(GL_TRIANGLE_FAN, 0, inner.size()));
+			const StreamRange range = uploadVertices(inner.data(), inner.size());
+			drawStreamRange(GL_TRIANGLE_FAN, range, Blend::SRC_ALPHA, Blend::ONE_MINUS_SRC_ALPHA);
 		}
 
 		if ((_borderColor) & 0xFF && borderWidth > 0)
@@ -886,28 +1244,49 @@ namespace Renderer
 			setStencil(inner.data(), inner.size());
 			GL_CHECK_ERROR(glStencilFunc(GL_NOTEQUAL, 1, ~0));
 
-			GL_CHECK_ERROR(glEnable(GL_BLEND));
-			GL_CHECK_ERROR(glBlendFunc(convertBlendFactor(Blend::SRC_ALPHA), convertBlendFactor(Blend::ONE_MINUS_SRC_ALPHA)));
-
-			GL_CHECK_ERROR(glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * outer.size(), outer.data(), GL_DYNAMIC_DRAW));
-			GL_CHECK_ERROR(glDrawArrays(GL_TRIANGLE_FAN, 0, outer.size()));
+			const StreamRange range = uploadVertices(outer.data(), outer.size());
+			drawStreamRange(GL_TRIANGLE_FAN, range, Blend::SRC_ALPHA, Blend::ONE_MINUS_SRC_ALPHA);
 			
 			disableStencil();
 		}
-
-		GL_CHECK_ERROR(glDisable(GL_BLEND));
 	}
 
 	void GLES20Renderer::drawTriangleStrips(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor, bool verticesChanged)
 	{
-		if (verticesChanged)
-			GL_CHECK_ERROR(glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * _numVertices, _vertices, GL_DYNAMIC_DRAW));
+		if (_vertices == nullptr || _numVertices == 0)
+			return;
+
+		auto it = boundTexture != 0 ? _textures.find(boundTexture) : _textures.cend();
+		const bool alphaTexture = it != _textures.cend() && it->second != nullptr && it->second->type == GL_ALPHA;
+		const bool distanceField = it != _textures.cend() && it->second != nullptr && it->second->distanceField && distanceFieldSupported;
+
+		const bool batchable = verticesChanged && _numVertices == 4 && worldViewIs2D && !alphaTexture && !distanceField &&
+			_vertices->customShader == nullptr && _vertices->saturation == 1.0f && _vertices->cornerRadius == 0.0f;
+
+		if (batchable)
+		{
+			queueQuad(_vertices, _srcBlendFactor, _dstBlendFactor, boundTexture != 0 ? QuadBatchShader::COLOR_TEXTURE : QuadBatchShader::NO_TEXTURE);
+			return;
+		}
+
+		flushQuadBatch();
+
+		// When vertices didn't change, the previous upload is still in the buffer unless its storage was orphaned since
+		StreamRange range;
+		if (!verticesChanged && lastStripRange.valid && lastStripRange.generation == streamGeneration && lastStripRange.vertexCount == (GLsizei)_numVertices)
+			range = lastStripRange;
+		else
+		{
+			range = uploadVertices(_vertices, _numVertices);
+			lastStripRange = range;
+		}
 
 		// Setup shader
 		if (boundTexture != 0)
 		{
-			auto it = _textures.find(boundTexture);
-			if (it != _textures.cend() && it->second != nullptr && it->second->type == GL_ALPHA)
+			if (distanceField)
+				useProgram(&shaderProgramDistanceField);
+			else if (alphaTexture)
 				useProgram(&shaderProgramAlpha);
 			else
 			{
@@ -958,19 +1337,7 @@ namespace Renderer
 		else
 			useProgram(&shaderProgramColorNoTexture);
 
-		// Do rendering
-		if (_srcBlendFactor != Blend::ONE && _dstBlendFactor != Blend::ONE)
-		{
-			GL_CHECK_ERROR(glEnable(GL_BLEND));
-			GL_CHECK_ERROR(glBlendFunc(convertBlendFactor(_srcBlendFactor), convertBlendFactor(_dstBlendFactor)));
-			GL_CHECK_ERROR(glDrawArrays(GL_TRIANGLE_STRIP, 0, _numVertices));
-			GL_CHECK_ERROR(glDisable(GL_BLEND));
-		}
-		else
-		{
-			GL_CHECK_ERROR(glDisable(GL_BLEND));
-			GL_CHECK_ERROR(glDrawArrays(GL_TRIANGLE_STRIP, 0, _numVertices));
-		}
+		drawStreamRange(GL_TRIANGLE_STRIP, range, _srcBlendFactor, _dstBlendFactor);
 
 	} // drawTriangleStrips
 
@@ -978,6 +1345,7 @@ namespace Renderer
 
 	void GLES20Renderer::setProjection(const Transform4x4f& _projection)
 	{
+		flushQuadBatch();
 		projectionMatrix = _projection;
 		mvpMatrix = projectionMatrix * worldViewMatrix;
 	} // setProjection
@@ -989,12 +1357,17 @@ namespace Renderer
 		worldViewMatrix = _matrix;
 		// worldViewMatrix.round();
 		mvpMatrix = projectionMatrix * worldViewMatrix;
+
+		const float* m = (const float*)&worldViewMatrix;
+		worldViewIs2D = m[2] == 0.0f && m[3] == 0.0f && m[6] == 0.0f && m[7] == 0.0f && m[14] == 0.0f && m[15] == 1.0f;
 	} // setMatrix
 
 //////////////////////////////////////////////////////////////////////////
 
 	void GLES20Renderer::setViewport(const Rect& _viewport)
 	{
+		flushQuadBatch();
+
 		// glViewport starts at the bottom left of the window
 		GL_CHECK_ERROR(glViewport( _viewport.x, getWindowHeight() - _viewport.y - _viewport.h, _viewport.w, _viewport.h));
 
@@ -1004,6 +1377,8 @@ namespace Renderer
 
 	void GLES20Renderer::setScissor(const Rect& _scissor)
 	{
+		flushQuadBatch();
+
 		if((_scissor.x == 0) && (_scissor.y == 0) && (_scissor.w == 0) && (_scissor.h == 0))
 		{
 			GL_CHECK_ERROR(glDisable(GL_SCISSOR_TEST));
@@ -1042,6 +1417,7 @@ namespace Renderer
 
 	void GLES20Renderer::swapBuffers()
 	{
+		flushQuadBatch();
 		useProgram(nullptr);
 
 #ifdef WIN32		
@@ -1056,8 +1432,9 @@ namespace Renderer
 	
 	void GLES20Renderer::drawTriangleFan(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor)
 	{		
-		// Pass buffer data
-		GL_CHECK_ERROR(glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * _numVertices, _vertices, GL_DYNAMIC_DRAW));
+		flushQuadBatch();
+
+		const StreamRange range = uploadVertices(_vertices, _numVertices);
 
 		// Setup shader
 		if (boundTexture != 0)
@@ -1075,23 +1452,12 @@ namespace Renderer
 		else
 			useProgram(&shaderProgramColorNoTexture);
 
-		// Do rendering
-		if (_srcBlendFactor != Blend::ONE && _dstBlendFactor != Blend::ONE)
-		{
-			GL_CHECK_ERROR(glEnable(GL_BLEND));
-			GL_CHECK_ERROR(glBlendFunc(convertBlendFactor(_srcBlendFactor), convertBlendFactor(_dstBlendFactor)));
-			GL_CHECK_ERROR(glDrawArrays(GL_TRIANGLE_FAN, 0, _numVertices));
-			GL_CHECK_ERROR(glDisable(GL_BLEND));
-		}
-		else
-		{
-			GL_CHECK_ERROR(glDisable(GL_BLEND));
-			GL_CHECK_ERROR(glDrawArrays(GL_TRIANGLE_FAN, 0, _numVertices));			
-		}
+		drawStreamRange(GL_TRIANGLE_FAN, range, _srcBlendFactor, _dstBlendFactor);
 	}
 
 	void GLES20Renderer::setStencil(const Vertex* _vertices, const unsigned int _numVertices)
 	{
+		flushQuadBatch();
 		useProgram(&shaderProgramColorNoTexture);
 
 		glEnable(GL_STENCIL_TEST);
@@ -1105,11 +1471,8 @@ namespace Renderer
 		glStencilFunc(GL_ALWAYS, 1, ~0);
 		glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
 
-		glEnable(GL_BLEND);
-		glBlendFunc(convertBlendFactor(Blend::SRC_ALPHA), convertBlendFactor(Blend::ONE_MINUS_SRC_ALPHA));
-		glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * _numVertices, _vertices, GL_DYNAMIC_DRAW);
-		glDrawArrays(GL_TRIANGLE_FAN, 0, _numVertices);
-		glDisable(GL_BLEND);
+		const StreamRange range = uploadVertices(_vertices, _numVertices);
+		drawStreamRange(GL_TRIANGLE_FAN, range, Blend::SRC_ALPHA, Blend::ONE_MINUS_SRC_ALPHA);
 
 		glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
 		glDepthMask(GL_TRUE);
@@ -1120,6 +1483,7 @@ namespace Renderer
 
 	void GLES20Renderer::disableStencil()
 	{
+		flushQuadBatch();
 		glDisable(GL_STENCIL_TEST);
 	}
 
@@ -1148,6 +1512,11 @@ namespace Renderer
 		return customShader->supportsCornerRadius();
 	}
 
+	bool GLES20Renderer::supportDistanceField()
+	{
+		return distanceFieldSupported;
+	}
+
 	void GLES20Renderer::postProcessShader(const std::string& path, const float _x, const float _y, const float _w, const float _h, const std::map<std::string, std::string>& parameters, unsigned int* data)
 	{
 #if OPENGL_EXTENSIONS
@@ -1161,6 +1530,8 @@ namespace Renderer
 		if (shaderBatch == nullptr || shaderBatch->size() == 0)
 			return;
 
+		flushQuadBatch();
+
 		if (mFrameBuffer == -1)
 			GL_CHECK_ERROR(glGenFramebuffers(1, &mFrameBuffer));
 
@@ -1283,7 +1654,7 @@ namespace Renderer
 			for (int i = 0; i < 4; ++i)
 				vertices[i].pos.round();
 
-			GL_CHECK_ERROR(glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * 4, &vertices, GL_DYNAMIC_DRAW));
+			StreamRange range = uploadVertices(vertices, 4);
 
 			for (int i = 0; i < shaderBatch->size(); i++)
 			{
@@ -1331,7 +1702,7 @@ namespace Renderer
 
 						for (int i = 0; i < 4; ++i) vertices[i].pos.round();
 
-						GL_CHECK_ERROR(glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * 4, &vertices, GL_DYNAMIC_DRAW));
+						range = uploadVertices(vertices, 4);
 
 						GL_CHECK_ERROR(glBindFramebuffer(GL_FRAMEBUFFER, 0));
 					}
@@ -1359,8 +1730,7 @@ namespace Renderer
 
 				customShader->setCustomUniformsParameters(params);
 
-				GL_CHECK_ERROR(glDisable(GL_BLEND));
-				GL_CHECK_ERROR(glDrawArrays(GL_TRIANGLE_STRIP, 0, 4));
+				drawStreamRange(GL_TRIANGLE_STRIP, range, Blend::ONE, Blend::ONE);
 			}
 
 			if (data != nullptr)
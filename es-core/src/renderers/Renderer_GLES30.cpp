@@ -43,6 +43,7 @@ namespace Renderer
 		Vector2f size;
 		unsigned int mipLevels = 1;
 		size_t memorySize = 0;
+		bool distanceField = false;
 	};
 
 	static SDL_GLContext	sdlContext       = nullptr;
@@ -56,6 +57,8 @@ namespace Renderer
 	static ShaderProgram    shaderProgramColorTextureFast;
 	static ShaderProgram    shaderProgramColorNoTexture;
 	static ShaderProgram    shaderProgramAlpha;
+	static ShaderProgram    shaderProgramDistanceField;
+	static bool             distanceFieldSupported = false;
 
 	static GLuint			vertexBuffer     = 0;
 
@@ -589,6 +592,38 @@ namespace Renderer
 
 		shaderProgramAlpha.createShaderProgram(vertexShaderAlpha, fragmentShaderAlpha);
 
+		// fragment shader (distance field texture) : the outline is smoothed over about one screen pixel
+		std::string fragmentSourceDistanceField =
+			SHADER_VERSION_STRING +
+			R"=====(
+			#if defined(GL_ES) && __VERSION__ < 300
+			#extension GL_OES_standard_derivatives : enable
+			#endif
+			)=====" + fragmentCompatibility +
+			R"=====(
+			#ifdef GL_ES
+			precision mediump float;
+			precision mediump sampler2D;
+			#endif
+
+			COMPAT_VARYING vec4 v_col;
+			COMPAT_VARYING vec2 v_tex;
+			uniform sampler2D u_tex;
+
+			void main(void)
+			{
+			    float distance = COMPAT_ALPHA(COMPAT_TEXTURE(u_tex, v_tex));
+			    float width = max(fwidth(distance) * 0.7, 0.001);
+			    float alpha = smoothstep(0.5 - width, 0.5 + width, distance);
+			    FragColor = vec4(1.0, 1.0, 1.0, alpha) * v_col;
+			}
+			)=====";
+
+		auto vertexShaderDistanceField = Shader::createShader(GL_VERTEX_SHADER, vertexSourceTexture);
+		auto fragmentShaderDistanceField = Shader::createShader(GL_FRAGMENT_SHADER, fragmentSourceDistanceField);
+
+		distanceFieldSupported = shaderProgramDistanceField.createShaderProgram(vertexShaderDistanceField, fragmentShaderDistanceField);
+
 		useProgram(nullptr);
 
 	} // setupDefaultShaders
@@ -1007,11 +1042,14 @@ namespace Renderer
 		{
 			case Texture::RGBA:  { return GL_RGBA; } break;
 #if defined(USE_OPENGLES_30)
-			case Texture::ALPHA: { return GL_RED; } break;
+			case Texture::ALPHA:
+			case Texture::DISTANCE_FIELD: { return GL_RED; } break;
 #elif defined(USE_OPENGLES_20)
-			case Texture::ALPHA: { return GL_ALPHA; } break;
+			case Texture::ALPHA:
+			case Texture::DISTANCE_FIELD: { return GL_ALPHA; } break;
 #else
-			case Texture::ALPHA: { return GL_LUMINANCE_ALPHA; } break;
+			case Texture::ALPHA:
+			case Texture::DISTANCE_FIELD: { return GL_LUMINANCE_ALPHA; } break;
 #endif
 			default:             { return GL_ZERO; }
 		}
@@ -1021,7 +1059,7 @@ namespace Renderer
 	static GLenum convertTextureInternalFormat(const Texture::Type _type)
 	{
 #if defined(USE_OPENGLES_30)
-		return _type == Texture::ALPHA ? GL_R8 : GL_RGBA8;
+		return _type == Texture::ALPHA || _type == Texture::DISTANCE_FIELD ? GL_R8 : GL_RGBA8;
 #else
 		return convertTextureType(_type);
 #endif
@@ -1375,6 +1413,7 @@ namespace Renderer
 		shaderProgramColorTextureFast.deleteProgram();
 		shaderProgramColorNoTexture.deleteProgram();
 		shaderProgramAlpha.deleteProgram();
+		shaderProgramDistanceField.deleteProgram();
 
 		destroyPixelUploadBuffers();
 
@@ -1473,7 +1512,7 @@ namespace Renderer
 		glTexStorage2D(GL_TEXTURE_2D, levels, internalFormat, _width, _height);
 		GLES30_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
 
-		if (_type == Texture::ALPHA && _data == nullptr)
+		if ((_type == Texture::ALPHA || _type == Texture::DISTANCE_FIELD) && _data == nullptr)
 		{
 			const size_t texelCount = static_cast<size_t>(_width) * static_cast<size_t>(_height);
 			std::vector<uint8_t> alphaData(texelCount, 0);
@@ -1509,6 +1548,7 @@ namespace Renderer
 		info->size = Vector2f(_width, _height);
 		info->mipLevels = levels;
 		info->memorySize = memorySize;
+		info->distanceField = _type == Texture::DISTANCE_FIELD;
 		_textures[texture] = info;
 
 		// Still bound from the upload above, and cached before this entry existed.
@@ -1727,7 +1767,9 @@ namespace Renderer
 		// Setup shader
 		if (boundTexture != 0)
 		{
-			if (boundTextureInfo != nullptr && isAlphaTexture(boundTextureInfo->type))
+			if (boundTextureInfo != nullptr && boundTextureInfo->distanceField && distanceFieldSupported)
+				useProgram(&shaderProgramDistanceField);
+			else if (boundTextureInfo != nullptr && isAlphaTexture(boundTextureInfo->type))
 				useProgram(&shaderProgramAlpha);
 			else
 			{
@@ -1960,6 +2002,11 @@ namespace Renderer
 		return customShader->supportsCornerRadius();
 	}
 
+	bool GLES30Renderer::supportDistanceField()
+	{
+		return distanceFieldSupported;
+	}
+
 	void GLES30Renderer::postProcessShader(const std::string& path, const float _x, const float _y, const float _w, const float _h, const std::map<std::string, std::string>& parameters, unsigned int* data)
 	{
 		flushQuadBatch();
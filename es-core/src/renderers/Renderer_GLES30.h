@@ -56,6 +56,7 @@ namespace Renderer
 		size_t		 getTotalMemUsage() override;
 
 		bool		 supportShaders() { return true; }
+		bool		 supportDistanceField() override;
 		bool		 shaderSupportsCornerSize(const std::string& shader) override;
 
 	private:
@@ -0,0 +1,190 @@
+#include "Renderer_Null.h"
+
+#include "math/Transform4x4f.h"
+#include "Log.h"
+
+namespace Renderer
+{
+	NullRenderer::Stats NullRenderer::sFrameStats;
+	NullRenderer::Stats NullRenderer::sLastFrameStats;
+
+	static size_t getTextureSize(const Texture::Type _type, const unsigned int _width, const unsigned int _height)
+	{
+		return (size_t)_width * (size_t)_height * (_type == Texture::RGBA ? 4 : 1);
+	}
+
+	std::string NullRenderer::getDriverName()
+	{
+		return "NULL";
+	}
+
+	std::vector<std::pair<std::string, std::string>> NullRenderer::getDriverInformation()
+	{
+		std::vector<std::pair<std::string, std::string>> info;
+		info.push_back(std::pair<std::string, std::string>("GRAPHICS API", getDriverName()));
+		return info;
+	}
+
+	unsigned int NullRenderer::getWindowFlags()
+	{
+		return 0;
+
+	} // getWindowFlags
+
+	void NullRenderer::setupWindow()
+	{
+
+	} // setupWindow
+
+	void NullRenderer::createContext()
+	{
+		LOG(LogInfo) << "Using NULL renderer : nothing will be displayed";
+
+	} // createContext
+
+	void NullRenderer::destroyContext()
+	{
+		mTextures.clear();
+
+	} // destroyContext
+
+	void NullRenderer::resetCache()
+	{
+
+	} // resetCache
+
+	unsigned int NullRenderer::createTexture(const Texture::Type _type, const bool _linear, const bool _repeat, const unsigned int _width, const unsigned int _height, void* _data)
+	{
+		unsigned int texture = mNextTexture++;
+
+		size_t size = getTextureSize(_type, _width, _height);
+		mTextures[texture] = size;
+
+		if (_data != nullptr)
+		{
+			sFrameStats.textureUploads++;
+			sFrameStats.textureUploadBytes += size;
+		}
+
+		return texture;
+
+	} // createTexture
+
+#if defined(USE_OPENGLES_30)
+	unsigned int NullRenderer::createMipmappedTexture(const Texture::Type _type, const bool _linear, const bool _repeat, const unsigned int _width, const unsigned int _height, void* _data)
+	{
+		return createTexture(_type, _linear, _repeat, _width, _height, _data);
+
+	} // createMipmappedTexture
+#endif
+
+	void NullRenderer::destroyTexture(const unsigned int _texture)
+	{
+		mTextures.erase(_texture);
+
+	} // destroyTexture
+
+	void NullRenderer::updateTexture(const unsigned int _texture, const Texture::Type _type, const unsigned int _x, const unsigned _y, const unsigned int _width, const unsigned int _height, void* _data)
+	{
+		if (_data == nullptr)
+			return;
+
+		sFrameStats.textureUploads++;
+		sFrameStats.textureUploadBytes += getTextureSize(_type, _width, _height);
+
+	} // updateTexture
+
+	void NullRenderer::bindTexture(const unsigned int _texture)
+	{
+
+	} // bindTexture
+
+	void NullRenderer::drawLines(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor)
+	{
+		sFrameStats.drawCalls++;
+		sFrameStats.vertices += _numVertices;
+
+	} // drawLines
+
+	void NullRenderer::drawTriangleStrips(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor, bool verticesChanged)
+	{
+		sFrameStats.drawCalls++;
+		sFrameStats.vertices += _numVertices;
+
+	} // drawTriangleStrips
+
+	void NullRenderer::drawTriangleFan(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor)
+	{
+		sFrameStats.drawCalls++;
+		sFrameStats.vertices += _numVertices;
+
+	} // drawTriangleFan
+
+	void NullRenderer::drawSolidRectangle(const float _x, const float _y, const float _w, const float _h, const unsigned int _fillColor, const unsigned int _borderColor, float borderWidth, float cornerRadius)
+	{
+		if (_fillColor != 0)
+			drawRect(_x + borderWidth, _y + borderWidth, _w - borderWidth - borderWidth, _h - borderWidth - borderWidth, _fillColor);
+
+		if (_borderColor != 0 && borderWidth > 0)
+		{
+			drawRect(_x, _y, _w, borderWidth, _borderColor);
+			drawRect(_x + _w - borderWidth, _y + borderWidth, borderWidth, _h - borderWidth, _borderColor);
+			drawRect(_x, _y + _h - borderWidth, _w - borderWidth, borderWidth, _borderColor);
+			drawRect(_x, _y + borderWidth, borderWidth, _h - borderWidth - borderWidth, _borderColor);
+		}
+
+	} // drawSolidRectangle
+
+	void NullRenderer::setProjection(const Transform4x4f& _projection)
+	{
+
+	} // setProjection
+
+	void NullRenderer::setMatrix(const Transform4x4f& _matrix)
+	{
+
+	} // setMatrix
+
+	void NullRenderer::setViewport(const Rect& _viewport)
+	{
+
+	} // setViewport
+
+	void NullRenderer::setScissor(const Rect& _scissor)
+	{
+
+	} // setScissor
+
+	void NullRenderer::setStencil(const Vertex* _vertices, const unsigned int _numVertices)
+	{
+
+	} // setStencil
+
+	void NullRenderer::disableStencil()
+	{
+
+	} // disableStencil
+
+	void NullRenderer::setSwapInterval()
+	{
+
+	} // setSwapInterval
+
+	void NullRenderer::swapBuffers()
+	{
+		sLastFrameStats = sFrameStats;
+		sFrameStats.reset();
+
+	} // swapBuffers
+
+	size_t NullRenderer::getTotalMemUsage()
+	{
+		size_t total = 0;
+		for (auto texture : mTextures)
+			total += texture.second;
+
+		return total;
+
+	} // getTotalMemUsage
+
+} // Renderer::
@@ -0,0 +1,87 @@
+#pragma once
+
+#ifndef ES_CORE_RENDERER_NULL_H
+#define ES_CORE_RENDERER_NULL_H
+
+#include "Renderer.h"
+#include <map>
+
+namespace Renderer
+{
+	// Renderer without GPU : nothing is drawn, calls are only counted. Used by the benchmark mode
+	class NullRenderer : public IRenderer
+	{
+	public:
+		struct Stats
+		{
+			Stats() { reset(); }
+
+			void reset()
+			{
+				drawCalls = 0;
+				vertices = 0;
+				textureUploads = 0;
+				textureUploadBytes = 0;
+			}
+
+			unsigned int		drawCalls;
+			unsigned int		vertices;
+			unsigned int		textureUploads;
+			unsigned long long	textureUploadBytes;
+		};
+
+		NullRenderer() : mNextTexture(1) { }
+
+		std::string getDriverName() override;
+		std::vector<std::pair<std::string, std::string>> getDriverInformation() override;
+
+		unsigned int getWindowFlags() override;
+		void         setupWindow() override;
+
+		void         createContext() override;
+		void         destroyContext() override;
+
+		void		 resetCache() override;
+
+		unsigned int createTexture(const Texture::Type _type, const bool _linear, const bool _repeat, const unsigned int _width, const unsigned int _height, void* _data) override;
+#if defined(USE_OPENGLES_30)
+		unsigned int createMipmappedTexture(const Texture::Type _type, const bool _linear, const bool _repeat, const unsigned int _width, const unsigned int _height, void* _data) override;
+#endif
+		void         destroyTexture(const unsigned int _texture) override;
+		void         updateTexture(const unsigned int _texture, const Texture::Type _type, const unsigned int _x, const unsigned _y, const unsigned int _width, const unsigned int _height, void* _data) override;
+		void         bindTexture(const unsigned int _texture) override;
+
+		void         drawLines(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor = Blend::SRC_ALPHA, const Blend::Factor _dstBlendFactor = Blend::ONE_MINUS_SRC_ALPHA) override;
+		void         drawTriangleStrips(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor = Blend::SRC_ALPHA, const Blend::Factor _dstBlendFactor = Blend::ONE_MINUS_SRC_ALPHA, bool verticesChanged = true) override;
+		void		 drawTriangleFan(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor = Blend::SRC_ALPHA, const Blend::Factor _dstBlendFactor = Blend::ONE_MINUS_SRC_ALPHA) override;
+		void		 drawSolidRectangle(const float _x, const float _y, const float _w, const float _h, const unsigned int _fillColor, const unsigned int _borderColor, float borderWidth = 1, float cornerRadius = 0) override;
+
+		void         setProjection(const Transform4x4f& _projection) override;
+		void         setMatrix(const Transform4x4f& _matrix) override;
+		void         setViewport(const Rect& _viewport) override;
+		void         setScissor(const Rect& _scissor) override;
+
+		void         setStencil(const Vertex* _vertices, const unsigned int _numVertices) override;
+		void		 disableStencil() override;
+
+		void         setSwapInterval() override;
+		void         swapBuffers() override;
+
+		size_t		 getTotalMemUsage() override;
+
+		// Nothing is drawn : lets --benchmark compare distance field fonts
+		bool		 supportDistanceField() override { return true; }
+
+		// Counters since the last swapBuffers
+		static const Stats& getFrameStats() { return sLastFrameStats; }
+
+	private:
+		std::map<unsigned int, size_t> mTextures; // texture -> size in bytes
+		unsigned int mNextTexture;
+
+		static Stats sFrameStats;
+		static Stats sLastFrameStats;
+	};
+};
+
+#endif // ES_CORE_RENDERER_NULL_H
@@ -94,6 +94,8 @@ namespace Renderer
 		mResolution(-1), mCornerRadius(-1), mFrameCount(-1), mFrameDirection(-1)
 #if defined(USE_OPENGLES_30)
 		, mSamplerUniform(-1), mSamplerInitialized(false), mVertexArray(0)
+#else
+		, mVertexOffset(0)
 #endif
 	{
 	}
@@ -601,26 +603,45 @@ namespace Renderer
 		else
 			SHADER_GL_CALL(glBindVertexArray(mVertexArray));
 #else
+		mVertexOffset = 0;
+		setAttributePointers();
+
 		if (mPositionAttribute != -1)
-		{
-			SHADER_GL_CALL(glVertexAttribPointer(mPositionAttribute, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, pos)));
 			SHADER_GL_CALL(glEnableVertexAttribArray(mPositionAttribute));
-		}
 
 		if (mColorAttribute != -1)
-		{
-			SHADER_GL_CALL(glVertexAttribPointer(mColorAttribute, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), (const void*)offsetof(Vertex, col)));
 			SHADER_GL_CALL(glEnableVertexAttribArray(mColorAttribute));
-		}
 
 		if (mTexCoordAttribute != -1)
-		{
-			SHADER_GL_CALL(glVertexAttribPointer(mTexCoordAttribute, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, tex)));
 			SHADER_GL_CALL(glEnableVertexAttribArray(mTexCoordAttribute));
-		}
 #endif
 	}
 
+#if !defined(USE_OPENGLES_30)
+	void ShaderProgram::setVertexOffset(GLint firstVertex)
+	{
+		if (mVertexOffset == firstVertex)
+			return;
+
+		mVertexOffset = firstVertex;
+		setAttributePointers();
+	}
+
+	void ShaderProgram::setAttributePointers()
+	{
+		const size_t base = (size_t)mVertexOffset * sizeof(GpuVertex);
+
+		if (mPositionAttribute != -1)
+			SHADER_GL_CALL(glVertexAttribPointer(mPositionAttribute, 2, GL_FLOAT, GL_FALSE, sizeof(GpuVertex), (const void*)(base + offsetof(GpuVertex, x))));
+
+		if (mColorAttribute != -1)
+			SHADER_GL_CALL(glVertexAttribPointer(mColorAttribute, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(GpuVertex), (const void*)(base + offsetof(GpuVertex, col))));
+
+		if (mTexCoordAttribute != -1)
+			SHADER_GL_CALL(glVertexAttribPointer(mTexCoordAttribute, 2, GL_FLOAT, GL_FALSE, sizeof(GpuVertex), (const void*)(base + offsetof(GpuVertex, u))));
+	}
+#endif
+
 	void ShaderProgram::unSelect()
 	{
 #if defined(USE_OPENGLES_30)
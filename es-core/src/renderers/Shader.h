@@ -48,6 +48,9 @@ namespace Renderer
 		void select(GLuint vertexBuffer, GLuint indexBuffer);
 #else
 		void select();
+
+		// Attributes start at this vertex of the bound array buffer ( no base vertex for indexed draws in ES2 )
+		void setVertexOffset(GLint firstVertex);
 #endif
 		void unSelect();
 
@@ -139,6 +142,11 @@ namespace Renderer
 
 	private:
 		void findAttribsAndUniforms();
+#if !defined(USE_OPENGLES_30)
+		void setAttributePointers();
+
+		GLint mVertexOffset;
+#endif
 	};
 
 } // Renderer::
@@ -13,18 +13,35 @@
 #include "ImageIO.h"
 #include <algorithm>
 #include "math/Transform4x4f.h"
+#include "Tracing.h"
+#include <cmath>
 
 #ifdef WIN32
 #include <Windows.h>
 #endif
 
+// Distance field glyphs are rasterized once at this size, and scaled to every font size
+#define DISTANCE_FIELD_SIZE		48
+#define DISTANCE_FIELD_SPREAD	6
+#define DISTANCE_FIELD_TEXTURE	1024
+
+// Entries kept per font by the layout caches
+#define LAYOUT_CACHE_SIZE		512
+#define SIZE_CACHE_SIZE			1024
+#define WRAP_CACHE_SIZE			128
+
 FT_Library Font::sLibrary = NULL;
 
 int Font::getSize() const { return mSize; }
 
 std::map< std::pair<std::string, int>, std::weak_ptr<Font> > Font::sFontMap;
+std::map< std::string, std::weak_ptr<Font> > Font::sDistanceFieldFonts;
 static std::map<unsigned int, std::string> substituableChars;
 
+std::atomic<int> Font::sLayoutGeneration(0);
+std::atomic<unsigned long long> Font::sLayoutCacheHits(0);
+std::atomic<unsigned long long> Font::sLayoutCacheMisses(0);
+
 Font::FontFace::FontFace(ResourceData&& d, int size) : data(d)
 {
 	int err = FT_New_Memory_Face(sLibrary, data.ptr.get(), (FT_Long)data.length, 0, &face);
@@ -82,17 +99,30 @@ size_t Font::getTotalMemoryUsage()
 		it++;
 	}
 
+	for (auto source = sDistanceFieldFonts.cbegin(); source != sDistanceFieldFonts.cend(); )
+	{
+		if (source->second.expired())
+		{
+			source = sDistanceFieldFonts.erase(source);
+			continue;
+		}
+
+		total += source->second.lock()->getMemoryUsage();
+		source++;
+	}
+
 	return total;
 }
 
-Font::Font(int size, const std::string& path, bool menuScaling) : mSize(size), mPath(path)
+Font::Font(int size, const std::string& path, bool menuScaling, bool distanceFieldSource) : mSize(size), mPath(path), mIsDistanceFieldSource(distanceFieldSource), mDistanceFieldScale(1.0f),
+	mLayoutCache(LAYOUT_CACHE_SIZE), mSizeCache(SIZE_CACHE_SIZE), mWrapCache(WRAP_CACHE_SIZE), mLayoutGeneration(sLayoutGeneration)
 {
 	mSize = size;
 	//if(mSize > 160) mSize = 160; // maximize the font size while it is causing issues on linux
 
 	// GPI
 	float scale = menuScaling ? Renderer::ScreenSettings::menuFontScale() : Renderer::ScreenSettings::fontScale();
-	if (scale > 0.0f && scale != 1.0f)
+	if (scale > 0.0f && scale != 1.0f && !distanceFieldSource)
 		mSize = size * scale;
 
 	if (mSize == 0)
@@ -104,6 +134,12 @@ Font::Font(int size, const std::string& path, bool menuScaling) : mSize(size), m
 	if(!sLibrary)
 		initLibrary();
 
+	if (!mIsDistanceFieldSource && Settings::getInstance()->getBool("FontDistanceField") && Renderer::supportDistanceField())
+	{
+		mDistanceFieldSource = getDistanceFieldSource(mPath);
+		mDistanceFieldScale = (float)mSize / (float)DISTANCE_FIELD_SIZE;
+	}
+
 	for (unsigned int i = 0; i < 255; i++)
 		mGlyphCacheArray[i] = NULL;
 
@@ -174,10 +210,23 @@ std::shared_ptr<Font> Font::get(int size, const std::string& path, bool menuScal
 	return font;
 }
 
+std::shared_ptr<Font> Font::getDistanceFieldSource(const std::string& path)
+{
+	auto found = sDistanceFieldFonts.find(path);
+	if (found != sDistanceFieldFonts.cend() && !found->second.expired())
+		return found->second.lock();
+
+	std::shared_ptr<Font> font = std::shared_ptr<Font>(new Font(DISTANCE_FIELD_SIZE, path, false, true));
+	sDistanceFieldFonts[path] = std::weak_ptr<Font>(font);
+	ResourceManager::getInstance()->addReloadable(font);
+	return font;
+}
+
 Font::FontTexture::FontTexture()
 {
 	textureId = 0;
 	textureSize = Vector2i(2048, 512);
+	type = Renderer::Texture::ALPHA;
 	writePos = Vector2i::Zero();
 	rowHeight = 0;
 }
@@ -219,7 +268,7 @@ void Font::FontTexture::initTexture()
 {
 	if (textureId == 0)
 	{
-		textureId = Renderer::createTexture(Renderer::Texture::ALPHA, true, false, textureSize.x(), textureSize.y(), nullptr);
+		textureId = Renderer::createTexture(type, true, false, textureSize.x(), textureSize.y(), nullptr);
 		if (textureId == 0)
 			LOG(LogError) << "FontTexture::initTexture() failed to create texture " << textureSize.x() << "x" << textureSize.y();
 	}
@@ -252,10 +301,20 @@ void Font::getTextureForNewGlyph(const Vector2i& glyphSize, FontTexture*& tex_ou
 	// make a new one
 	FontTexture* tex = new FontTexture();
 
-	int x = Math::min(2048, mSize * 64);
-	int y = Math::min(2048, Math::max(glyphSize.y(), mSize) + 2) * 1.2;
+	if (mIsDistanceFieldSource)
+	{
+		// Shared by every size : a single large page keeps text in one draw call
+		tex->type = Renderer::Texture::DISTANCE_FIELD;
+		tex->textureSize = Vector2i(DISTANCE_FIELD_TEXTURE, DISTANCE_FIELD_TEXTURE);
+	}
+	else
+	{
+		int x = Math::min(2048, mSize * 64);
+		int y = Math::min(2048, Math::max(glyphSize.y(), mSize) + 2) * 1.2;
+
+		tex->textureSize = Vector2i(x, y);
+	}
 
-	tex->textureSize = Vector2i(x, y);
 	tex->initTexture();
 
 	tex_out = tex;
@@ -349,6 +408,114 @@ void Font::clearFaceCache()
 	mFaceCache.clear();
 }
 
+// Squared distance transform of a sampled function, in place ( Felzenszwalb & Huttenlocher )
+static void squaredDistance1D(double* data, int count, int stride, std::vector<double>& f, std::vector<int>& v, std::vector<double>& z)
+{
+	for (int i = 0; i < count; i++)
+		f[i] = data[i * stride];
+
+	int k = 0;
+	v[0] = 0;
+	z[0] = -1e20;
+	z[1] = 1e20;
+
+	for (int q = 1; q < count; q++)
+	{
+		double s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+		while (s <= z[k])
+		{
+			k--;
+			s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+		}
+
+		k++;
+		v[k] = q;
+		z[k] = s;
+		z[k + 1] = 1e20;
+	}
+
+	k = 0;
+	for (int q = 0; q < count; q++)
+	{
+		while (z[k + 1] < q)
+			k++;
+
+		data[q * stride] = (q - v[k]) * (q - v[k]) + f[v[k]];
+	}
+}
+
+static void squaredDistance2D(std::vector<double>& grid, int width, int height)
+{
+	const int size = Math::max(width, height);
+
+	std::vector<double> f(size);
+	std::vector<int> v(size);
+	std::vector<double> z(size + 1);
+
+	for (int x = 0; x < width; x++)
+		squaredDistance1D(grid.data() + x, height, width, f, v, z);
+
+	for (int y = 0; y < height; y++)
+		squaredDistance1D(grid.data() + y * width, width, 1, f, v, z);
+}
+
+// Signed distance field of a glyph bitmap, with a border of spread pixels. 128 is the outline
+static std::vector<unsigned char> buildDistanceField(const FT_Bitmap& bitmap, int spread)
+{
+	const int width = (int)bitmap.width + spread * 2;
+	const int height = (int)bitmap.rows + spread * 2;
+
+	std::vector<double> outside((size_t)width * height);
+	std::vector<double> inside((size_t)width * height);
+
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			const int bx = x - spread;
+			const int by = y - spread;
+
+			bool in = false;
+			if (bx >= 0 && by >= 0 && bx < (int)bitmap.width && by < (int)bitmap.rows)
+				in = bitmap.buffer[by * bitmap.pitch + bx] >= 128;
+
+			outside[y * width + x] = in ? 0 : 1e20; // squared distance to the nearest inside pixel
+			inside[y * width + x] = in ? 1e20 : 0;
+		}
+	}
+
+	squaredDistance2D(outside, width, height);
+	squaredDistance2D(inside, width, height);
+
+	std::vector<unsigned char> field((size_t)width * height);
+
+	for (size_t i = 0; i < field.size(); i++)
+	{
+		const double distance = outside[i] > 0 ? std::sqrt(outside[i]) - 0.5 : 0.5 - std::sqrt(inside[i]);
+		const double value = 0.5 - distance / (2.0 * spread);
+		field[i] = (unsigned char)std::lround(std::min(1.0, std::max(0.0, value)) * 255.0);
+	}
+
+	return field;
+}
+
+void Font::uploadGlyphBitmap(const Glyph* glyph, const FT_Bitmap& bitmap)
+{
+	if (glyph->glyphSize.x() <= 0 || glyph->glyphSize.y() <= 0)
+		return;
+
+	if (glyph->spread > 0)
+	{
+		const int spread = (int)glyph->spread;
+		std::vector<unsigned char> field = buildDistanceField(bitmap, spread);
+
+		Renderer::updateTexture(glyph->texture->textureId, Renderer::Texture::DISTANCE_FIELD, glyph->cursor.x(), glyph->cursor.y(),
+			glyph->glyphSize.x() + spread * 2, glyph->glyphSize.y() + spread * 2, field.data());
+	}
+	else
+		Renderer::updateTexture(glyph->texture->textureId, Renderer::Texture::ALPHA, glyph->cursor.x(), glyph->cursor.y(), glyph->glyphSize.x(), glyph->glyphSize.y(), bitmap.buffer);
+}
+
 Font::Glyph* Font::getGlyph(unsigned int id)
 {
 	if (id < 255)
@@ -367,53 +534,75 @@ Font::Glyph* Font::getGlyph(unsigned int id)
 			return it->second;
 	}
 
-	// nope, need to make a glyph
-	FT_Face face = getFaceForChar(id);
-	if(!face)
+	Glyph* pGlyph = NULL;
+
+	if (mDistanceFieldSource != nullptr)
 	{
-		LOG(LogError) << "Could not find appropriate font face for character " << id << " for font " << mPath;
-		return NULL;
+		// Distance field glyphs are shared with the source font, only metrics are scaled
+		Glyph* source = mDistanceFieldSource->getGlyph(id);
+		if (source == NULL)
+			return NULL;
+
+		pGlyph = new Glyph(*source);
+		pGlyph->advance = source->advance * mDistanceFieldScale;
+		pGlyph->bearing = source->bearing * mDistanceFieldScale;
+		pGlyph->glyphSize = Vector2i((int)Math::round(source->glyphSize.x() * mDistanceFieldScale), (int)Math::round(source->glyphSize.y() * mDistanceFieldScale));
+		pGlyph->spread = source->spread * mDistanceFieldScale;
 	}
+	else
+	{
+		// nope, need to make a glyph
+		FT_Face face = getFaceForChar(id);
+		if(!face)
+		{
+			LOG(LogError) << "Could not find appropriate font face for character " << id << " for font " << mPath;
+			return NULL;
+		}
 
-	FT_GlyphSlot g = face->glyph;
+		FT_GlyphSlot g = face->glyph;
 
-	if(FT_Load_Char(face, id, FT_LOAD_RENDER))
-	{
-		LOG(LogError) << "Could not find glyph for character " << id << " for font " << mPath << ", size " << mSize << "!";
-		return NULL;
-	}
+		if(FT_Load_Char(face, id, FT_LOAD_RENDER))
+		{
+			LOG(LogError) << "Could not find glyph for character " << id << " for font " << mPath << ", size " << mSize << "!";
+			return NULL;
+		}
 
-	Vector2i glyphSize(g->bitmap.width, g->bitmap.rows);
+		Vector2i glyphSize(g->bitmap.width, g->bitmap.rows);
 
-	FontTexture* tex = NULL;
-	Vector2i cursor;
-	getTextureForNewGlyph(glyphSize, tex, cursor);
+		// Distance field glyphs are stored with a border, so the outline can be smoothed when scaled
+		const int spread = mIsDistanceFieldSource && glyphSize.x() > 0 && glyphSize.y() > 0 ? DISTANCE_FIELD_SPREAD : 0;
+		const Vector2i storedSize(glyphSize.x() + spread * 2, glyphSize.y() + spread * 2);
 
-	// getTextureForNewGlyph can fail if the glyph is bigger than the max texture size (absurdly large font size)
-	if(tex == NULL)
-	{
-		LOG(LogError) << "Could not create glyph for character " << id << " for font " << mPath << ", size " << mSize << " (no suitable texture found)!";
-		return NULL;
-	}
+		FontTexture* tex = NULL;
+		Vector2i cursor;
+		getTextureForNewGlyph(storedSize, tex, cursor);
 
-	// create glyph
-	Glyph* pGlyph = new Glyph();
-	
-	pGlyph->texture = tex;
-	pGlyph->texPos = Vector2f((float)cursor.x() / (float)tex->textureSize.x(), (float)cursor.y() / (float)tex->textureSize.y());
-	pGlyph->texSize = Vector2f((float)glyphSize.x() / (float)tex->textureSize.x(), (float)glyphSize.y() / (float)tex->textureSize.y());
-	pGlyph->advance = Vector2f((float)g->metrics.horiAdvance / 64.0f, (float)g->metrics.vertAdvance / 64.0f);
-	pGlyph->bearing = Vector2f((float)g->metrics.horiBearingX / 64.0f, (float)g->metrics.horiBearingY / 64.0f);	
-	pGlyph->cursor = cursor;
-	pGlyph->glyphSize = glyphSize;
-
-	// upload glyph bitmap to texture
-	if (glyphSize.x() > 0 && glyphSize.y() > 0)
-		Renderer::updateTexture(tex->textureId, Renderer::Texture::ALPHA, cursor.x(), cursor.y(), glyphSize.x(), glyphSize.y(), g->bitmap.buffer);
+		// getTextureForNewGlyph can fail if the glyph is bigger than the max texture size (absurdly large font size)
+		if(tex == NULL)
+		{
+			LOG(LogError) << "Could not create glyph for character " << id << " for font " << mPath << ", size " << mSize << " (no suitable texture found)!";
+			return NULL;
+		}
+
+		// create glyph
+		pGlyph = new Glyph();
+
+		pGlyph->texture = tex;
+		pGlyph->texPos = Vector2f((float)cursor.x() / (float)tex->textureSize.x(), (float)cursor.y() / (float)tex->textureSize.y());
+		pGlyph->texSize = Vector2f((float)storedSize.x() / (float)tex->textureSize.x(), (float)storedSize.y() / (float)tex->textureSize.y());
+		pGlyph->advance = Vector2f((float)g->metrics.horiAdvance / 64.0f, (float)g->metrics.vertAdvance / 64.0f);
+		pGlyph->bearing = Vector2f((float)g->metrics.horiBearingX / 64.0f, (float)g->metrics.horiBearingY / 64.0f);	
+		pGlyph->cursor = cursor;
+		pGlyph->glyphSize = glyphSize;
+		pGlyph->spread = (float)spread;
+
+		// upload glyph bitmap to texture
+		uploadGlyphBitmap(pGlyph, g->bitmap);
+	}
 
 	// update max glyph height - Limit to ascii table. If we don't it can take in the fallback fonts
-	if (glyphSize.y() > mMaxGlyphHeight && id >= 32 && id < 128)
-		mMaxGlyphHeight = glyphSize.y();
+	if (pGlyph->glyphSize.y() > mMaxGlyphHeight && id >= 32 && id < 128)
+		mMaxGlyphHeight = pGlyph->glyphSize.y();
 
 	mGlyphMap[id] = pGlyph;
 
@@ -427,6 +616,10 @@ Font::Glyph* Font::getGlyph(unsigned int id)
 // completely recreate the texture data for all textures based on mGlyphs information
 void Font::rebuildTextures()
 {
+	// Glyphs of distance field fonts are owned by the source font
+	if (mDistanceFieldSource != nullptr)
+		return;
+
 	// recreate OpenGL textures
 	for(auto tex : mTextures)
 		tex->initTexture();
@@ -440,13 +633,8 @@ void Font::rebuildTextures()
 		// load the glyph bitmap through FT
 		FT_Load_Char(face, it->first, FT_LOAD_RENDER);
 
-		Glyph* glyph = it->second;
-		
 		// upload to texture
-		Renderer::updateTexture(glyph->texture->textureId, Renderer::Texture::ALPHA,
-			glyph->cursor.x(), glyph->cursor.y(),
-			glyph->glyphSize.x(), glyph->glyphSize.y(),
-			glyphSlot->bitmap.buffer);
+		uploadGlyphBitmap(it->second, glyphSlot->bitmap);
 	}
 }
 
@@ -681,7 +869,108 @@ std::string tryFastBidi(const std::string& text)
     return ret;
 }
 
+//=============================================================================================================
+//Layout cache
+//=============================================================================================================
+
+Font::LayoutKey::LayoutKey(const std::string& _text, float _xLen, int _alignment, float _lineSpacing, bool _rtl)
+	: text(_text), xLen(_xLen), alignment(_alignment), lineSpacing(_lineSpacing), rtl(_rtl)
+{
+	hash = std::hash<std::string>()(text);
+	hash ^= std::hash<float>()(xLen) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	hash ^= std::hash<float>()(lineSpacing) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	hash ^= (size_t)(alignment * 2 + (rtl ? 1 : 0)) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+}
+
+// Must be called with mLayoutLock held
+void Font::checkLayoutCacheGeneration()
+{
+	int generation = sLayoutGeneration;
+	if (mLayoutGeneration == generation)
+		return;
+
+	mLayoutCache.clear();
+	mSizeCache.clear();
+	mWrapCache.clear();
+	mLayoutGeneration = generation;
+}
+
 Vector2f Font::sizeText(const std::string& text, float lineSpacing)
+{
+	LayoutKey key(text, 0.0f, 0, lineSpacing, false);
+
+	{
+		std::unique_lock<std::mutex> lock(mLayoutLock);
+		checkLayoutCacheGeneration();
+
+		Vector2f* size = mSizeCache.get(key);
+		if (size != nullptr)
+		{
+			sLayoutCacheHits++;
+			return *size;
+		}
+	}
+
+	sLayoutCacheMisses++;
+
+	Vector2f size = computeTextSize(text, lineSpacing);
+
+	std::unique_lock<std::mutex> lock(mLayoutLock);
+	mSizeCache.insert(key, size);
+	return size;
+}
+
+std::string Font::wrapText(std::string text, float maxWidth)
+{
+	LayoutKey key(text, maxWidth, 0, 0.0f, false);
+
+	{
+		std::unique_lock<std::mutex> lock(mLayoutLock);
+		checkLayoutCacheGeneration();
+
+		std::string* wrapped = mWrapCache.get(key);
+		if (wrapped != nullptr)
+		{
+			sLayoutCacheHits++;
+			return *wrapped;
+		}
+	}
+
+	sLayoutCacheMisses++;
+
+	std::string wrapped = computeWrappedText(text, maxWidth);
+
+	std::unique_lock<std::mutex> lock(mLayoutLock);
+	mWrapCache.insert(key, wrapped);
+	return wrapped;
+}
+
+std::shared_ptr<Font::TextLayout> Font::getLayout(const std::string& text, float xLen, Alignment alignment, float lineSpacing)
+{
+	LayoutKey key(text, xLen, (int)alignment, lineSpacing, EsLocale::isRTL());
+
+	{
+		std::unique_lock<std::mutex> lock(mLayoutLock);
+		checkLayoutCacheGeneration();
+
+		std::shared_ptr<TextLayout>* layout = mLayoutCache.get(key);
+		if (layout != nullptr)
+		{
+			sLayoutCacheHits++;
+			return *layout;
+		}
+	}
+
+	sLayoutCacheMisses++;
+
+	std::shared_ptr<TextLayout> layout = buildLayout(key.rtl ? tryFastBidi(text) : text, xLen, alignment, lineSpacing);
+
+	std::unique_lock<std::mutex> lock(mLayoutLock);
+	mLayoutCache.insert(key, layout);
+	return layout;
+}
+
+Vector2f Font::computeTextSize(const std::string& text, float lineSpacing)
 {
 	float lineWidth = 0.0f;
 	float highestWidth = 0.0f;
@@ -742,7 +1031,7 @@ static inline bool isWhiteSpace(unsigned int c)
 
 // Thanks eagle0wl'PR @ Retropie EmulationStation https://github.com/RetroPie/EmulationStation/pull/269/files
 // Breaks up a normal string with newlines to make it fit xLen
-std::string Font::wrapText(std::string text, float maxWidth)
+std::string Font::computeWrappedText(std::string text, float maxWidth)
 {
 	std::string out;
 
@@ -862,20 +1151,20 @@ float Font::getNewlineStartOffset(const std::string& text, const unsigned int& c
 	}
 }
 
-TextCache* Font::buildTextCache(const std::string& _text, Vector2f offset, unsigned int color, float xLen, Alignment alignment, float lineSpacing)
+// Positions of the glyphs & image substitutes of text, relative to the text offset. text is already bidi-processed
+std::shared_ptr<Font::TextLayout> Font::buildLayout(const std::string& text, float xLen, Alignment alignment, float lineSpacing)
 {
-	float x = offset[0] + (xLen != 0 ? getNewlineStartOffset(_text, 0, xLen, alignment) : 0);
+	TRACE_ZONE("Font::buildLayout");
+
+	std::shared_ptr<TextLayout> layout = std::make_shared<TextLayout>();
+
+	float x = (xLen != 0 ? getNewlineStartOffset(text, 0, xLen, alignment) : 0);
 	
 	auto glyph = getGlyph('S');
 	float yTop = glyph ? glyph->bearing.y() : 35;
 	float yBot = getHeight(lineSpacing);
 	float yDecal = (yBot + yTop) / 2.0f;
-	float y = offset[1] + (yBot + yTop)/2.0f;
-
-	// vertices by texture
-	std::map< FontTexture*, std::vector<Renderer::Vertex> > vertMap;
-
-	std::string text = EsLocale::isRTL() ? tryFastBidi(_text) : _text;
+	float y = (yBot + yTop)/2.0f;
 
 	std::map<int, int> tabStops;
 	int tabIndex = 0;
@@ -925,8 +1214,6 @@ TextCache* Font::buildTextCache(const std::string& _text, Vector2f offset, unsig
 		}
 	}
 
-	std::vector<TextImageSubstitute> imageSubstitutes;
-
 	bool inParenthesis = false;
 	bool inBlock = false;
 
@@ -943,9 +1230,9 @@ TextCache* Font::buildTextCache(const std::string& _text, Vector2f offset, unsig
 
 			//MaxSizeInfo mx(yBot - (2.0f * padding), yBot - (2.0f * padding));
 
-			TextImageSubstitute is;
-			is.texture = TextureResource::get(it->second, true, true, true, false, true/*, &mx*/);
-			if (is.texture != nullptr)
+			LayoutImage image;
+			image.texture = TextureResource::get(it->second, true, true, true, false, true/*, &mx*/);
+			if (image.texture != nullptr)
 			{
 				Renderer::Rect rect(
 					x,
@@ -953,7 +1240,7 @@ TextCache* Font::buildTextCache(const std::string& _text, Vector2f offset, unsig
 					yBot - (2.0f * padding),
 					yBot - padding);
 
-				auto imgSize = is.texture->getPhysicalSize();
+				auto imgSize = image.texture->getPhysicalSize();
 				auto sz = ImageIO::adjustPictureSize(Vector2i(imgSize.x(), imgSize.y()), Vector2i(rect.w, rect.h));
 
 				Renderer::Rect rc(
@@ -961,15 +1248,12 @@ TextCache* Font::buildTextCache(const std::string& _text, Vector2f offset, unsig
 					rect.y + (rect.h / 2.0f) - (sz.y() / 2.0f),
 					sz.x(),
 					sz.y());
-				
-				unsigned int vertexColor = Renderer::convertColor(0xFFFFFF00 | (color & 0xFF));
-				
-				is.vertex[0] = { { (float) rc.x			, (float) rc.y + rc.h }	, { 0.0f, 0.0f }, vertexColor };
-				is.vertex[1] = { { (float) rc.x			, (float) rc.y }		, { 0.0f, 1.0f }, vertexColor };
-				is.vertex[2] = { { (float) rc.x + rc.w  , (float) rc.y + rc.h }	, { 1.0f, 0.0f }, vertexColor };
-				is.vertex[3] = { { (float) rc.x + rc.w  , (float) rc.y }		, { 1.0f, 1.0f }, vertexColor };
 
-				imageSubstitutes.push_back(is);
+				image.x = rc.x;
+				image.y = rc.y;
+				image.w = rc.w;
+				image.h = rc.h;
+				layout->images.push_back(image);
 
 				x += yBot - (2.0f*padding);
 				continue;
@@ -989,7 +1273,7 @@ TextCache* Font::buildTextCache(const std::string& _text, Vector2f offset, unsig
 		{
 			tabIndex = 0;
 			y += getHeight(lineSpacing);
-			x = offset[0] + (xLen != 0 ? getNewlineStartOffset(text, (const unsigned int)cursor /* cursor is already advanced */, xLen, alignment) : 0);
+			x = (xLen != 0 ? getNewlineStartOffset(text, (const unsigned int)cursor /* cursor is already advanced */, xLen, alignment) : 0);
 			continue;
 		}
 
@@ -1021,44 +1305,86 @@ TextCache* Font::buildTextCache(const std::string& _text, Vector2f offset, unsig
 		if(glyph == NULL)
 			continue;
 
+		LayoutGlyph positioned;
+		positioned.glyph = glyph;
+		positioned.x = x;
+		positioned.y = y;
+		positioned.desaturate = inParenthesis || inBlock || character == ']' || character == ')';
+		layout->glyphs.push_back(positioned);
+
+		// advance
+		x += glyph->advance.x();
+	}
+
+	layout->size = sizeText(text, lineSpacing);
+
+	clearFaceCache();
+
+	return layout;
+}
+
+TextCache* Font::buildTextCache(const std::string& _text, Vector2f offset, unsigned int color, float xLen, Alignment alignment, float lineSpacing)
+{
+	TRACE_ZONE("Font::buildTextCache");
+
+	std::shared_ptr<TextLayout> layout = getLayout(_text, xLen, alignment, lineSpacing);
+
+	// vertices by texture
+	std::map< FontTexture*, std::vector<Renderer::Vertex> > vertMap;
+
+	const unsigned int convertedColor = Renderer::convertColor(color);
+
+	for (auto& positioned : layout->glyphs)
+	{
+		const Glyph* glyph = positioned.glyph;
+
 		std::vector<Renderer::Vertex>& verts = vertMap[glyph->texture];
 		size_t oldVertSize = verts.size();
 		verts.resize(oldVertSize + 6);
 		Renderer::Vertex* vertices = verts.data() + oldVertSize;
 
-		const float        glyphStartX    = x + glyph->bearing.x();
-		const unsigned int convertedColor = Renderer::convertColor(color);
+		const float        glyphStartX    = offset[0] + positioned.x + glyph->bearing.x() - glyph->spread;
+		const float        glyphStartY    = offset[1] + positioned.y - glyph->bearing.y() - glyph->spread;
+		const float        glyphWidth     = glyph->glyphSize.x() + glyph->spread * 2.0f;
+		const float        glyphHeight    = glyph->glyphSize.y() + glyph->spread * 2.0f;
 
-		vertices[1] = { { glyphStartX                                       , y - glyph->bearing.y()                                          }, { glyph->texPos.x(),                      glyph->texPos.y()                      }, convertedColor };
-		vertices[2] = { { glyphStartX                                       , y - glyph->bearing.y() + (glyph->glyphSize.y())                 }, { glyph->texPos.x(),                      glyph->texPos.y() + glyph->texSize.y() }, convertedColor };
-		vertices[3] = { { glyphStartX + glyph->glyphSize.x()                , y - glyph->bearing.y()                                          }, { glyph->texPos.x() + glyph->texSize.x(), glyph->texPos.y()                      }, convertedColor };
-		vertices[4] = { { glyphStartX + glyph->glyphSize.x()                , y - glyph->bearing.y() + (glyph->glyphSize.y())                 }, { glyph->texPos.x() + glyph->texSize.x(), glyph->texPos.y() + glyph->texSize.y() }, convertedColor };
+		vertices[1] = { { glyphStartX                                       , glyphStartY                                                     }, { glyph->texPos.x(),                      glyph->texPos.y()                      }, convertedColor };
+		vertices[2] = { { glyphStartX                                       , glyphStartY + glyphHeight                                       }, { glyph->texPos.x(),                      glyph->texPos.y() + glyph->texSize.y() }, convertedColor };
+		vertices[3] = { { glyphStartX + glyphWidth                          , glyphStartY                                                     }, { glyph->texPos.x() + glyph->texSize.x(), glyph->texPos.y()                      }, convertedColor };
+		vertices[4] = { { glyphStartX + glyphWidth                          , glyphStartY + glyphHeight                                       }, { glyph->texPos.x() + glyph->texSize.x(), glyph->texPos.y() + glyph->texSize.y() }, convertedColor };
 
 		// round vertices
 		for (int i = 1; i < 5; ++i)
 		{
 			vertices[i].pos.round();
-
-			if (inParenthesis || inBlock || character == ']' || character == ')')
-				vertices[i].saturation = 0.0f;
-			else
-				vertices[i].saturation = 1.0f;
+			vertices[i].saturation = positioned.desaturate ? 0.0f : 1.0f;
 		}
 
 		// make duplicates of first and last vertex so this can be rendered as a triangle strip
 		vertices[0] = vertices[1];
 		vertices[5] = vertices[4];
-
-		// advance
-		x += glyph->advance.x();
 	}
 
-	//TextCache::CacheMetrics metrics = { sizeText(text, lineSpacing) };
-
 	TextCache* cache = new TextCache();
 	cache->vertexLists.resize(vertMap.size());
-	cache->metrics = { sizeText(text, lineSpacing) };
-	cache->imageSubstitutes = imageSubstitutes;
+	cache->metrics = { layout->size };
+
+	unsigned int imageColor = Renderer::convertColor(0xFFFFFF00 | (color & 0xFF));
+
+	for (auto& image : layout->images)
+	{
+		const float x = offset[0] + image.x;
+		const float y = offset[1] + image.y;
+
+		TextImageSubstitute is;
+		is.texture = image.texture;
+		is.vertex[0] = { { x			, y + image.h }	, { 0.0f, 0.0f }, imageColor };
+		is.vertex[1] = { { x			, y }			, { 0.0f, 1.0f }, imageColor };
+		is.vertex[2] = { { x + image.w	, y + image.h }	, { 1.0f, 0.0f }, imageColor };
+		is.vertex[3] = { { x + image.w	, y }			, { 1.0f, 1.0f }, imageColor };
+
+		cache->imageSubstitutes.push_back(is);
+	}
 
 	unsigned int i = 0;
 	for(auto it = vertMap.cbegin(); it != vertMap.cend(); it++)
@@ -1070,8 +1396,6 @@ TextCache* Font::buildTextCache(const std::string& _text, Vector2f offset, unsig
 		i++;
 	}
 
-	clearFaceCache();
-
 	return cache;
 }
 
@@ -1204,4 +1528,7 @@ void Font::OnThemeChanged()
 			}
 		}
 	}
+
+	// Cached layouts may hold substituted images
+	sLayoutGeneration++;
 }
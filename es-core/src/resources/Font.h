@@ -7,10 +7,13 @@
 #include "renderers/Renderer.h"
 #include "resources/ResourceManager.h"
 #include "ThemeData.h"
+#include "utils/LruCache.h"
 #include <ft2build.h>
 #include FT_FREETYPE_H
 #include <vector>
 #include <unordered_map>
+#include <atomic>
+#include <mutex>
 
 class TextCache;
 class TextureResource;
@@ -79,19 +82,27 @@ public:
 	size_t getMemoryUsage() const; // returns an approximation of VRAM used by this font's texture (in bytes)
 	static size_t getTotalMemoryUsage(); // returns an approximation of total VRAM used by font textures (in bytes)
 
+	static unsigned long long getLayoutCacheHits() { return sLayoutCacheHits; }
+	static unsigned long long getLayoutCacheMisses() { return sLayoutCacheMisses; }
+
 private:
 	void renderSingleGlow(TextCache* cache, const Transform4x4f& parentTrans, float x, float y, bool verticesChanged = true);
 
 	static FT_Library sLibrary;
 	static std::map< std::pair<std::string, int>, std::weak_ptr<Font> > sFontMap;
 
-	Font(int size, const std::string& path, bool menuScaling = false);
+	// Fonts holding the distance field glyphs shared by every size of a font file
+	static std::map< std::string, std::weak_ptr<Font> > sDistanceFieldFonts;
+	static std::shared_ptr<Font> getDistanceFieldSource(const std::string& path);
+
+	Font(int size, const std::string& path, bool menuScaling = false, bool distanceFieldSource = false);
 
 	class FontTexture
 	{
 	public:
 		unsigned int textureId;
 		Vector2i textureSize;
+		Renderer::Texture::Type type;
 
 		Vector2i writePos;
 		int rowHeight;
@@ -136,12 +147,15 @@ private:
 
 		Vector2i cursor;
 		Vector2i glyphSize;
+
+		float spread; // distance field border around the glyph in the texture, in pixels
 	};
 
 	Glyph* mGlyphCacheArray[255]; // used to cache 255 first chars
 	std::unordered_map<unsigned int, Glyph*> mGlyphMap;
 
 	Glyph* getGlyph(unsigned int id);
+	void uploadGlyphBitmap(const Glyph* glyph, const FT_Bitmap& bitmap);
 
 	int mMaxGlyphHeight;
 	
@@ -149,8 +163,72 @@ private:
 	const std::string mPath;
 	bool mLoaded;
 
+	// Distance field mode : glyphs come from mDistanceFieldSource, and are scaled by mDistanceFieldScale
+	std::shared_ptr<Font> mDistanceFieldSource;
+	bool mIsDistanceFieldSource;
+	float mDistanceFieldScale;
+
 	float getNewlineStartOffset(const std::string& text, const unsigned int& charStart, const float& xLen, const Alignment& alignment);
 
+	// Layout cache : results of sizeText, wrapText & glyph positions of buildTextCache for recently used strings
+	struct LayoutKey
+	{
+		LayoutKey(const std::string& _text, float _xLen, int _alignment, float _lineSpacing, bool _rtl);
+
+		std::string text;
+		float xLen;
+		int alignment;
+		float lineSpacing;
+		bool rtl;
+		size_t hash;
+
+		bool operator==(const LayoutKey& other) const
+		{
+			return hash == other.hash && xLen == other.xLen && alignment == other.alignment && lineSpacing == other.lineSpacing && rtl == other.rtl && text == other.text;
+		}
+	};
+
+	struct LayoutKeyHash
+	{
+		size_t operator()(const LayoutKey& key) const { return key.hash; }
+	};
+
+	struct LayoutGlyph
+	{
+		Glyph* glyph;
+		float x, y; // pen position, relative to the text offset
+		bool desaturate;
+	};
+
+	struct LayoutImage
+	{
+		std::shared_ptr<TextureResource> texture;
+		float x, y, w, h;
+	};
+
+	struct TextLayout
+	{
+		std::vector<LayoutGlyph> glyphs;
+		std::vector<LayoutImage> images;
+		Vector2f size;
+	};
+
+	std::shared_ptr<TextLayout> getLayout(const std::string& text, float xLen, Alignment alignment, float lineSpacing);
+	std::shared_ptr<TextLayout> buildLayout(const std::string& text, float xLen, Alignment alignment, float lineSpacing);
+	Vector2f computeTextSize(const std::string& text, float lineSpacing);
+	std::string computeWrappedText(std::string text, float maxWidth);
+	void checkLayoutCacheGeneration();
+
+	Utils::LruCache<LayoutKey, std::shared_ptr<TextLayout>, LayoutKeyHash>	mLayoutCache;
+	Utils::LruCache<LayoutKey, Vector2f, LayoutKeyHash>						mSizeCache;
+	Utils::LruCache<LayoutKey, std::string, LayoutKeyHash>					mWrapCache;
+	std::mutex																mLayoutLock;
+	int																		mLayoutGeneration;
+
+	static std::atomic<int> sLayoutGeneration; // incremented when cached layouts become invalid ( substituable chars changed )
+	static std::atomic<unsigned long long> sLayoutCacheHits;
+	static std::atomic<unsigned long long> sLayoutCacheMisses;
+
 	friend TextCache;
 };
 
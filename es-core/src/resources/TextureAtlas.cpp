@@ -0,0 +1,184 @@
+#include "resources/TextureAtlas.h"
+
+#include "renderers/Renderer.h"
+#include "Log.h"
+#include <algorithm>
+#include <cstring>
+
+#define ATLAS_PAGE_SIZE		1024
+#define ATLAS_MAX_PAGES		4
+#define ATLAS_MAX_IMAGE		256
+
+TextureAtlas* TextureAtlas::sInstance = nullptr;
+
+TextureAtlas* TextureAtlas::getInstance()
+{
+	if (sInstance == nullptr)
+		sInstance = new TextureAtlas();
+
+	return sInstance;
+}
+
+bool TextureAtlas::isEligible(int width, int height)
+{
+	return width > 0 && height > 0 && width <= ATLAS_MAX_IMAGE && height <= ATLAS_MAX_IMAGE;
+}
+
+bool TextureAtlas::allocate(Page* page, int width, int height, Rect& rect)
+{
+	// Reuse the smallest released slot the image fits in
+	int bestFree = -1;
+	for (int i = 0; i < (int)page->freeRects.size(); i++)
+	{
+		const Rect& free = page->freeRects[i];
+		if (free.w < width || free.h < height)
+			continue;
+
+		if (bestFree < 0 || free.w * free.h < page->freeRects[bestFree].w * page->freeRects[bestFree].h)
+			bestFree = i;
+	}
+
+	if (bestFree >= 0)
+	{
+		rect = page->freeRects[bestFree];
+		page->freeRects.erase(page->freeRects.begin() + bestFree);
+		return true;
+	}
+
+	// Lowest shelf the image fits in, without wasting more than half of the image height
+	Shelf* bestShelf = nullptr;
+	for (auto& shelf : page->shelves)
+	{
+		if (shelf.h < height || shelf.h > height + height / 2 || shelf.x + width > ATLAS_PAGE_SIZE)
+			continue;
+
+		if (bestShelf == nullptr || shelf.h < bestShelf->h)
+			bestShelf = &shelf;
+	}
+
+	if (bestShelf == nullptr)
+	{
+		if (page->height + height > ATLAS_PAGE_SIZE)
+			return false;
+
+		page->shelves.push_back(Shelf(page->height, height));
+		page->height += height;
+		bestShelf = &page->shelves.back();
+	}
+
+	rect = Rect(bestShelf->x, bestShelf->y, width, bestShelf->h);
+	bestShelf->x += width;
+	return true;
+}
+
+bool TextureAtlas::add(const TextureData* owner, const unsigned char* dataRGBA, int width, int height, bool linear, unsigned int& texture, Vector4f& rect)
+{
+	if (dataRGBA == nullptr || !isEligible(width, height))
+		return false;
+
+	std::unique_lock<std::mutex> lock(mLock);
+
+	if (mEntries.find(owner) != mEntries.cend())
+		return false;
+
+	// Room for a 1 pixel border on each side
+	const int slotWidth = width + 2;
+	const int slotHeight = height + 2;
+
+	Page* page = nullptr;
+	Rect slot;
+
+	for (auto p : mPages)
+	{
+		if (p->linear == linear && allocate(p, slotWidth, slotHeight, slot))
+		{
+			page = p;
+			break;
+		}
+	}
+
+	if (page == nullptr)
+	{
+		if (mPages.size() >= ATLAS_MAX_PAGES)
+			return false;
+
+		unsigned int pageTexture = Renderer::createTexture(Renderer::Texture::RGBA, linear, false, ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE, nullptr);
+		if (pageTexture == 0)
+			return false;
+
+		page = new Page();
+		page->texture = pageTexture;
+		page->linear = linear;
+		mPages.push_back(page);
+
+		LOG(LogDebug) << "TextureAtlas : page " << mPages.size() << " created";
+
+		if (!allocate(page, slotWidth, slotHeight, slot))
+			return false;
+	}
+
+	// Copy the image with its edges extruded into the border
+	std::vector<unsigned char> pixels((size_t)slotWidth * slotHeight * 4);
+
+	for (int y = 0; y < slotHeight; y++)
+	{
+		const unsigned char* srcRow = dataRGBA + (size_t)std::min(std::max(y - 1, 0), height - 1) * width * 4;
+		unsigned char* dstRow = &pixels[(size_t)y * slotWidth * 4];
+
+		memcpy(dstRow + 4, srcRow, (size_t)width * 4);
+		memcpy(dstRow, srcRow, 4);
+		memcpy(dstRow + (size_t)(slotWidth - 1) * 4, srcRow + (size_t)(width - 1) * 4, 4);
+	}
+
+	Renderer::updateTexture(page->texture, Renderer::Texture::RGBA, slot.x, slot.y, slotWidth, slotHeight, pixels.data());
+
+	page->entries++;
+
+	Entry entry;
+	entry.page = page;
+	entry.rect = slot;
+	mEntries[owner] = entry;
+
+	const float scale = 1.0f / ATLAS_PAGE_SIZE;
+
+	texture = page->texture;
+	rect = Vector4f((slot.x + 1) * scale, (slot.y + 1) * scale, (slot.x + 1 + width) * scale, (slot.y + 1 + height) * scale);
+	return true;
+}
+
+void TextureAtlas::remove(const TextureData* owner)
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	auto it = mEntries.find(owner);
+	if (it == mEntries.cend())
+		return;
+
+	Page* page = it->second.page;
+	page->freeRects.push_back(it->second.rect);
+	page->entries--;
+
+	mEntries.erase(it);
+
+	if (page->entries > 0)
+		return;
+
+	Renderer::destroyTexture(page->texture);
+
+	mPages.erase(std::remove(mPages.begin(), mPages.end(), page), mPages.end());
+	delete page;
+
+	LOG(LogDebug) << "TextureAtlas : empty page released, " << mPages.size() << " pages left";
+}
+
+size_t TextureAtlas::getMemoryUsage()
+{
+	std::unique_lock<std::mutex> lock(mLock);
+	return mPages.size() * ATLAS_PAGE_SIZE * ATLAS_PAGE_SIZE * 4;
+}
+
+int TextureAtlas::getPageCount()
+{
+	std::unique_lock<std::mutex> lock(mLock);
+	return (int)mPages.size();
+}
@@ -0,0 +1,78 @@
+#pragma once
+#ifndef ES_CORE_RESOURCES_TEXTURE_ATLAS_H
+#define ES_CORE_RESOURCES_TEXTURE_ATLAS_H
+
+#include "math/Vector4f.h"
+#include <mutex>
+#include <map>
+#include <vector>
+
+class TextureData;
+
+// Shared texture pages for small static images ( icons, help prompts, badges... ).
+// Images sharing a page share the same GL texture, so the renderer can batch them.
+// Images are packed in shelves, with a 1 pixel border copied from their edges so linear filtering does not bleed.
+// Pages are destroyed as soon as they are empty. Under memory pressure, entries are released with their TextureData ( see TextureDataManager::cleanupVRAM ).
+class TextureAtlas
+{
+public:
+	static TextureAtlas* getInstance();
+
+	// Images larger than this are never packed
+	static bool isEligible(int width, int height);
+
+	// Copy the pixels of owner into a page. Returns false if there's no room left.
+	// texture & rect receive the page texture and the texture coordinates of the image ( x, y, x2, y2 ).
+	bool add(const TextureData* owner, const unsigned char* dataRGBA, int width, int height, bool linear, unsigned int& texture, Vector4f& rect);
+	void remove(const TextureData* owner);
+
+	size_t getMemoryUsage();
+	int getPageCount();
+
+private:
+	TextureAtlas() { }
+
+	struct Rect
+	{
+		Rect() : x(0), y(0), w(0), h(0) { }
+		Rect(int _x, int _y, int _w, int _h) : x(_x), y(_y), w(_w), h(_h) { }
+
+		int x, y, w, h;
+	};
+
+	struct Shelf
+	{
+		Shelf(int _y, int _h) : y(_y), h(_h), x(0) { }
+
+		int y, h;
+		int x;
+	};
+
+	struct Page
+	{
+		Page() : texture(0), linear(false), height(0), entries(0) { }
+
+		unsigned int		texture;
+		bool				linear;
+		int					height;  // used height : shelves are stacked from the top
+		int					entries;
+		std::vector<Shelf>	shelves;
+		std::vector<Rect>	freeRects;
+	};
+
+	struct Entry
+	{
+		Page*	page;
+		Rect	rect;
+	};
+
+	static bool allocate(Page* page, int width, int height, Rect& rect);
+
+	std::vector<Page*>					mPages;
+	std::map<const TextureData*, Entry>	mEntries;
+	std::mutex							mLock;
+
+	static TextureAtlas* sInstance;
+};
+
+#endif // ES_CORE_RESOURCES_TEXTURE_ATLAS_H
@@ -3,13 +3,14 @@
 #include "math/Misc.h"
 #include "renderers/Renderer.h"
 #include "resources/ResourceManager.h"
+#include "resources/TextureAtlas.h"
+#include "resources/VideoThumbnailExtractor.h"
 #include "ImageIO.h"
 #include "Log.h"
 #include <nanosvg/nanosvg.h>
 #include <nanosvg/nanosvgrast.h>
 #include <string.h>
 #include <algorithm>
-#include <vlc/vlc.h>
 
 #include "Settings.h"
 #include "utils/ZipFile.h"
@@ -25,7 +26,7 @@
 IPdfHandler* TextureData::PdfHandler = nullptr;
 
 TextureData::TextureData(bool tile, bool linear) : 
-	mTile(tile), mLinear(linear), mTextureID(0), mDataRGBA(nullptr), mScalable(false), mDynamic(true), mReloadable(false),
+	mTile(tile), mLinear(linear), mTextureID(0), mAtlasTexture(0), mAtlasDenied(false), mDataRGBA(nullptr), mScalable(false), mDynamic(true), mReloadable(false),
 #if defined(USE_OPENGLES_30)
 	mMipmapped(false),
 #endif
@@ -74,10 +75,10 @@ size_t TextureData::getMemoryUsage(MemoryUsageType type)
 	if (type == MemoryUsageType::RAM)
 		return mDataRGBA != nullptr ? baseSize : 0;
 	if (type == MemoryUsageType::VRAM)
-		return mTextureID != 0 ? textureSize : 0;
+		return mTextureID != 0 ? textureSize : (mAtlasTexture != 0 ? baseSize : 0);
 	if (type == MemoryUsageType::Estimated)
 		return textureSize;
-	return mTextureID != 0 ? textureSize : (mDataRGBA != nullptr ? baseSize : 0);
+	return mTextureID != 0 ? textureSize : (mAtlasTexture != 0 || mDataRGBA != nullptr ? baseSize : 0);
 }
 #endif
 
@@ -93,7 +94,7 @@ bool TextureData::initSVGFromMemory(const unsigned char* fileData, size_t length
 {
 	// If already initialised then don't read again
 	std::unique_lock<std::mutex> lock(mMutex);
-	if (mDataRGBA || (mTextureID != 0))
+	if (mDataRGBA || mTextureID != 0 || mAtlasTexture != 0)
 		return true;
 
 	// nsvgParse excepts a modifiable, null-terminated string
@@ -302,106 +303,18 @@ bool TextureData::updateFromExternalRGBA(unsigned char* dataRGBA, size_t width,
 // Avoid multiple extraction in the same file at the same time
 static Utils::StringListLockType mImageExtractorLock;
 
-#if WIN32
-extern void _checkUpgradedVlcVersion();
-#endif
-
 bool TextureData::loadFromVideo()
 {
-	Utils::StringListLock lock(mImageExtractorLock, mPath);
-
-	auto val = Utils::FileSystem::createRelativePath(Utils::FileSystem::changeExtension(mPath, ".jpg"), Paths::getHomePath(), true);
-	val = Utils::String::replace(val, "~/../", "./");
-
-	std::string localFile = Utils::FileSystem::resolveRelativePath(val, Paths::getUserEmulationStationPath() + "/tmp/videothumbs/", true);
-
-	if (Utils::FileSystem::exists(localFile))
-	{
-		auto date = Utils::FileSystem::getFileCreationDate(localFile);
-		auto duration = Utils::Time::DateTime::now().elapsedSecondsSince(date);
-		if (duration > 62 * 86400) // 2 months
-			Utils::FileSystem::removeFile(localFile);
-	}
-
-	if (!Utils::FileSystem::exists(localFile))
-	{
-		Utils::FileSystem::createDirectory(Utils::FileSystem::getParent(localFile));
-
-		libvlc_instance_t *vlcInstance = nullptr;
-		libvlc_media_t *vlcMedia = nullptr;
-		libvlc_media_player_t *vlcMediaPlayer = nullptr;
-
-		std::vector<std::string> cmdline;
-		cmdline.push_back("--quiet");
-		cmdline.push_back("--rate=1");
-		cmdline.push_back("--video-filter=scene");
-		cmdline.push_back("--intf=dummy");
-		cmdline.push_back("--vout=dummy");
-		cmdline.push_back("--scene-format=jpeg");
-		cmdline.push_back("--scene-ratio=1");
-		cmdline.push_back("--no-video-title-show");
-
-		const char** vlcArgs = new const char*[cmdline.size()];
-
-		for (int i = 0; i < cmdline.size(); i++)
-			vlcArgs[i] = cmdline[i].c_str();
-
-#if WIN32
-		_checkUpgradedVlcVersion();
-#endif
-
-		vlcInstance = libvlc_new(cmdline.size(), vlcArgs);
-		if (vlcInstance == nullptr)
-			return false;
-
-		vlcMedia = libvlc_media_new_path(vlcInstance, Utils::FileSystem::getPreferredPath(mPath).c_str());
-		if (vlcMedia == nullptr)
-		{
-			libvlc_release(vlcInstance);
-			return false;
-		}
-
-		libvlc_media_add_option(vlcMedia, ":no-audio");
-		libvlc_media_add_option(vlcMedia, ":start-time=1.5");
-
-		vlcMediaPlayer = libvlc_media_player_new_from_media(vlcMedia);
-		if (vlcMediaPlayer == nullptr)
-		{
-			libvlc_media_release(vlcMedia);
-			libvlc_release(vlcInstance);
-			return false;
-		}
-
-		int ms = 1500;
-
-		libvlc_media_player_set_rate(vlcMediaPlayer, 1);
-		libvlc_audio_set_mute(vlcMediaPlayer, 1);
-		libvlc_media_player_play(vlcMediaPlayer);
-		libvlc_media_player_set_time(vlcMediaPlayer, ms);
-
-		auto time = libvlc_media_player_get_time(vlcMediaPlayer);
-		int n = 100; // avoid infinite loop
-		while (time <= ms && n > 0) {
-			time = libvlc_media_player_get_time(vlcMediaPlayer);
-			n--;
-		}
-
-		int result = libvlc_video_take_snapshot(vlcMediaPlayer, 0, localFile.c_str(), 0, 0);
-
-		libvlc_media_player_stop(vlcMediaPlayer);
-		libvlc_media_player_release(vlcMediaPlayer);
-		libvlc_media_release(vlcMedia);
-		libvlc_release(vlcInstance);
-	}
+	std::string localFile = VideoThumbnailExtractor::getInstance()->getThumbnail(mPath);
+	if (localFile.empty())
+		return false;
 
-	if (Utils::FileSystem::exists(localFile))
-	{
-		std::shared_ptr<ResourceManager>& rm = ResourceManager::getInstance();
-		const ResourceData& data = rm->getFileData(localFile);
-		return initImageFromMemory((const unsigned char*)data.ptr.get(), data.length);
-	}
+	std::shared_ptr<ResourceManager>& rm = ResourceManager::getInstance();
+	const ResourceData& data = rm->getFileData(localFile);
+	if (data.length == 0)
+		return false;
 
-	return false;
+	return initImageFromMemory((const unsigned char*)data.ptr.get(), data.length);
 }
 
 bool TextureData::loadFromPdf(int pageIndex)
@@ -526,17 +439,55 @@ bool TextureData::load()
 bool TextureData::isLoaded()
 {
 	std::unique_lock<std::mutex> lock(mMutex);
-	if (mDataRGBA || (mTextureID != 0))
+	if (mDataRGBA || mTextureID != 0 || mAtlasTexture != 0)
 		return true;
 
 	return false;
 }
 
-bool TextureData::uploadAndBind()
+bool TextureData::isAtlasCandidate()
+{
+	return !mAtlasDenied && mReloadable && !mTile && !mIsExternalDataRGBA &&
+		!Utils::FileSystem::isVideo(mPath) && TextureAtlas::isEligible(mSize.x(), mSize.y());
+}
+
+void TextureData::releaseAtlas()
+{
+	if (mAtlasTexture == 0)
+		return;
+
+	TextureAtlas::getInstance()->remove(this);
+	mAtlasTexture = 0;
+}
+
+bool TextureData::uploadAndBind(Vector4f* atlasRect)
 {
-	// See if it's already been uploaded
 	std::unique_lock<std::mutex> lock(mMutex);
 
+	if (atlasRect != nullptr)
+	{
+		// The pixels are kept : a caller that can't use the atlas will upload them to a texture of its own without reloading the file
+		if (mAtlasTexture == 0 && mTextureID == 0 && mDataRGBA != nullptr && isAtlasCandidate())
+			TextureAtlas::getInstance()->add(this, mDataRGBA, mSize.x(), mSize.y(), mLinear, mAtlasTexture, mAtlasRect);
+
+		if (mAtlasTexture != 0)
+		{
+			Renderer::bindTexture(mAtlasTexture);
+			*atlasRect = mAtlasRect;
+			return true;
+		}
+
+		*atlasRect = Vector4f(0, 0, 1, 1);
+	}
+	else if (mAtlasTexture != 0)
+	{
+		// The image is needed with its own texture coordinates : leave the atlas, for good.
+		// If the pixels were released, the texture is not loaded anymore & the manager queues the reload on the loader
+		releaseAtlas();
+		mAtlasDenied = true;
+	}
+
+	// See if it's already been uploaded
 	if (mTextureID != 0)
 		Renderer::bindTexture(mTextureID);
 	else
@@ -579,6 +530,8 @@ bool TextureData::uploadAndBind()
 void TextureData::releaseVRAM()
 {
 	std::unique_lock<std::mutex> lock(mMutex);
+	releaseAtlas();
+
 	if (mTextureID != 0)
 	{
 		Renderer::destroyTexture(mTextureID);
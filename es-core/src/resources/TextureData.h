@@ -7,6 +7,7 @@
 #include <vector>
 #include "ImageIO.h"
 #include "TextureDataManager.h"
+#include "math/Vector4f.h"
 
 class TextureResource;
 
@@ -42,8 +43,10 @@ public:
 	bool isLoaded();
 
 	// Upload the texture to VRAM if necessary and bind. Returns true if bound ok or
-	// false if either not loaded
-	bool uploadAndBind();
+	// false if either not loaded.
+	// When atlasRect is set, small images may be packed in a TextureAtlas page : atlasRect receives the texture coordinates
+	// to use ( x, y, x2, y2 ), or ( 0, 0, 1, 1 ) if the image has its own texture
+	bool uploadAndBind(Vector4f* atlasRect = nullptr);
 
 	// Release the texture from VRAM
 	void releaseVRAM();
@@ -61,12 +64,12 @@ public:
 			return mDataRGBA != nullptr ? mSize.x() * mSize.y() * 4 : 0;
 
 		if (type == MemoryUsageType::VRAM)
-			return mTextureID != 0 ? mSize.x() * mSize.y() * 4 : 0;
+			return mTextureID != 0 || mAtlasTexture != 0 ? mSize.x() * mSize.y() * 4 : 0;
 
 		if (type == MemoryUsageType::Estimated)
 			return mSize.x() * mSize.y() * 4;
 
-		return mTextureID != 0 || mDataRGBA != nullptr ? mSize.x() * mSize.y() * 4 : 0;
+		return mTextureID != 0 || mAtlasTexture != 0 || mDataRGBA != nullptr ? mSize.x() * mSize.y() * 4 : 0;
 	}
 #endif
 
@@ -86,6 +89,8 @@ public:
 
 	bool updateFromExternalRGBA(unsigned char* dataRGBA, size_t width, size_t height);
 
+	inline bool isAtlased() { return mAtlasTexture != 0; }
+
 	inline bool isRequired() { return mRequired; };
 	void setRequired(bool value) { mRequired = value; };
 
@@ -98,6 +103,9 @@ public:
 	void setScalable(bool value) { mScalable = value; };
 
 private:
+	bool isAtlasCandidate();
+	void releaseAtlas();
+
 	bool			mRequired;
 
 	std::mutex		mMutex;
@@ -105,6 +113,9 @@ private:
 	bool			mLinear;
 	std::string		mPath;
 	unsigned int	mTextureID;
+	unsigned int	mAtlasTexture; // page texture when the image is packed in the TextureAtlas
+	Vector4f		mAtlasRect;
+	bool			mAtlasDenied;  // also used by a component which is not atlas aware
 	unsigned char*	mDataRGBA;
 	bool			mReloadable;
 	bool			mDynamic;
@@ -5,6 +5,7 @@
 #include "Settings.h"
 #include "Log.h"
 #include "utils/Platform.h"
+#include "Tracing.h"
 #include <algorithm>
 #include <SDL.h>
 
@@ -99,14 +100,19 @@ std::shared_ptr<TextureData> TextureDataManager::get(const TextureResource* key,
 	return tex;
 }
 
-bool TextureDataManager::bind(const TextureResource* key)
+bool TextureDataManager::bind(const TextureResource* key, Vector4f* atlasRect)
 {
 	std::shared_ptr<TextureData> tex = get(key);
 	bool bound = false;
 	if (tex != nullptr)
-		bound = tex->uploadAndBind();
+		bound = tex->uploadAndBind(atlasRect);
 	if (!bound)
+	{
+		if (atlasRect != nullptr)
+			*atlasRect = Vector4f(0, 0, 1, 1);
+
 		getBlankTexture()->uploadAndBind();
+	}
 	return bound;
 }
 
@@ -246,6 +252,8 @@ void TextureLoader::threadProc()
 		SetThreadDescription(GetCurrentThread(), L"TextureLoader::threadProc");
 #endif
 
+	Tracing::setThreadName("TextureLoader");
+
 	while (true)
 	{		
 		// Wait for an event to say there is something in the queue
@@ -268,7 +276,11 @@ void TextureLoader::threadProc()
 
 				lock.unlock();
 
-				try { textureData->load(); }
+				try 
+				{
+					TRACE_ZONE("TextureLoader::load");
+					textureData->load(); 
+				}
 				catch (...) { }
 
 				lock.lock();
@@ -15,6 +15,7 @@
 
 class TextureDataManager;
 class TextureData;
+class Vector4f;
 class TextureResource;
 
 enum class MemoryUsageType { Allocated, VRAM, RAM, Estimated };
@@ -80,7 +81,7 @@ public:
 
 	void cancelAsync(const TextureResource* key);
 	std::shared_ptr<TextureData> get(const TextureResource* key, TextureLoadMode enableLoading = TextureLoadMode::STANDARD);
-	bool bind(const TextureResource* key);
+	bool bind(const TextureResource* key, Vector4f* atlasRect = nullptr);
 
 	// Get the total size of all committed textures (in VRAM) in bytes
 	size_t	getTotalMemoryUsage(MemoryUsageType type = MemoryUsageType::Allocated);
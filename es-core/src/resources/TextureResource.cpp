@@ -231,15 +231,18 @@ void TextureResource::setRequired(bool value) const
 		data->setRequired(value);	
 }
 
-bool TextureResource::bind()
+bool TextureResource::bind(Vector4f* atlasRect)
 {
 	if (mTextureData != nullptr)
 	{
-		mTextureData->uploadAndBind();
+		// Not managed textures are loaded synchronously : reload the pixels released while the image was in the atlas
+		if (!mTextureData->uploadAndBind(atlasRect) && mTextureData->isReloadable() && !mTextureData->isLoaded() && mTextureData->load())
+			mTextureData->uploadAndBind(atlasRect);
+
 		return true;
 	}
 
-	return sTextureDataManager.bind(this);	
+	return sTextureDataManager.bind(this, atlasRect);
 }
 
 void TextureResource::cancelAsync(std::shared_ptr<TextureResource> texture)
@@ -42,7 +42,9 @@ public:
 	void setRequired(bool value) const;
 	bool isScalable() const;
 
-	bool bind();
+	// When atlasRect is set, the image may be bound from a shared TextureAtlas page : the texture coordinates
+	// of the image ( x, y, x2, y2 ) are returned there and must be used instead of ( 0, 0, 1, 1 )
+	bool bind(Vector4f* atlasRect = nullptr);
 
 	static size_t getTotalMemoryUsage(MemoryUsageType type = MemoryUsageType::Allocated); // returns an approximation of memory used by textures
 	size_t getMemoryUsage(MemoryUsageType type = MemoryUsageType::Allocated);
@@ -0,0 +1,285 @@
+#include "resources/VideoThumbnailExtractor.h"
+#include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+#include "utils/TimeUtil.h"
+#include "Paths.h"
+#include "Log.h"
+#include "Tracing.h"
+
+#include <vlc/vlc.h>
+
+#define VIDEO_THUMBNAIL_WORKERS		2
+#define VIDEO_THUMBNAIL_MAX_AGE		(62 * 86400) // 2 months
+#define VIDEO_THUMBNAIL_RETRY_DELAY	60			 // seconds before a failed video is tried again ( file being copied, share not mounted yet... )
+
+#if WIN32
+extern void _checkUpgradedVlcVersion();
+#endif
+
+VideoThumbnailExtractor* VideoThumbnailExtractor::sInstance = nullptr;
+
+static std::mutex sInstanceLock;
+
+VideoThumbnailExtractor* VideoThumbnailExtractor::getInstance()
+{
+	std::unique_lock<std::mutex> lock(sInstanceLock);
+
+	if (sInstance == nullptr)
+		sInstance = new VideoThumbnailExtractor();
+
+	return sInstance;
+}
+
+void VideoThumbnailExtractor::deinit()
+{
+	std::unique_lock<std::mutex> lock(sInstanceLock);
+
+	if (sInstance != nullptr)
+		sInstance->stop();
+}
+
+VideoThumbnailExtractor::VideoThumbnailExtractor() : mExit(false), mVlcInstance(nullptr)
+{
+	for (int i = 0; i < VIDEO_THUMBNAIL_WORKERS; i++)
+		mThreads.push_back(std::thread(&VideoThumbnailExtractor::threadProc, this));
+}
+
+void VideoThumbnailExtractor::stop()
+{
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+		if (mExit)
+			return;
+
+		mExit = true;
+
+		for (auto job : mQueue)
+			complete(job, false);
+
+		mQueue.clear();
+	}
+
+	mEvent.notify_all();
+
+	for (std::thread& t : mThreads)
+		t.join();
+
+	mThreads.clear();
+
+	std::unique_lock<std::mutex> lock(mVlcLock);
+	if (mVlcInstance != nullptr)
+	{
+		libvlc_release(mVlcInstance);
+		mVlcInstance = nullptr;
+	}
+}
+
+std::string VideoThumbnailExtractor::getThumbnailPath(const std::string& videoPath)
+{
+	auto val = Utils::FileSystem::createRelativePath(Utils::FileSystem::changeExtension(videoPath, ".jpg"), Paths::getHomePath(), true);
+	val = Utils::String::replace(val, "~/../", "./");
+
+	return Utils::FileSystem::resolveRelativePath(val, Paths::getUserEmulationStationPath() + "/tmp/videothumbs/", true);
+}
+
+libvlc_instance_t* VideoThumbnailExtractor::createVlcInstance()
+{
+	std::vector<std::string> cmdline;
+	cmdline.push_back("--quiet");
+	cmdline.push_back("--rate=1");
+	cmdline.push_back("--video-filter=scene");
+	cmdline.push_back("--intf=dummy");
+	cmdline.push_back("--vout=dummy");
+	cmdline.push_back("--scene-format=jpeg");
+	cmdline.push_back("--scene-ratio=1");
+	cmdline.push_back("--no-video-title-show");
+
+	std::vector<const char*> vlcArgs;
+	for (auto& arg : cmdline)
+		vlcArgs.push_back(arg.c_str());
+
+#if WIN32
+	_checkUpgradedVlcVersion();
+#endif
+
+	return libvlc_new(vlcArgs.size(), vlcArgs.data());
+}
+
+std::string VideoThumbnailExtractor::getThumbnail(const std::string& videoPath)
+{
+	std::string thumbnailPath = getThumbnailPath(videoPath);
+
+	std::unique_lock<std::mutex> lock(mLock);
+
+	if (mExit)
+		return "";
+
+	auto it = mIndex.find(thumbnailPath);
+	if (it != mIndex.cend())
+	{
+		if (it->second.available || std::chrono::steady_clock::now() - it->second.time < std::chrono::seconds(VIDEO_THUMBNAIL_RETRY_DELAY))
+		{
+			mStats.indexed++;
+			return it->second.available ? thumbnailPath : "";
+		}
+
+		mIndex.erase(it);
+	}
+
+	std::shared_ptr<Job> job;
+
+	auto pending = mPending.find(thumbnailPath);
+	if (pending != mPending.cend())
+		job = pending->second;
+	else
+	{
+		job = std::make_shared<Job>();
+		job->videoPath = videoPath;
+		job->thumbnailPath = thumbnailPath;
+
+		mPending[thumbnailPath] = job;
+		mQueue.push_back(job);
+
+		mEvent.notify_one();
+	}
+
+	mDone.wait(lock, [job]() { return job->done; });
+	return job->result ? thumbnailPath : "";
+}
+
+// mLock must be held
+void VideoThumbnailExtractor::complete(std::shared_ptr<Job> job, bool result)
+{
+	job->done = true;
+	job->result = result;
+
+	mPending.erase(job->thumbnailPath);
+	mDone.notify_all();
+}
+
+void VideoThumbnailExtractor::threadProc()
+{
+	Tracing::setThreadName("VideoThumbnailExtractor");
+
+	while (true)
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+		mEvent.wait(lock, [this]() { return mExit || !mQueue.empty(); });
+
+		if (mExit)
+			break;
+
+		std::shared_ptr<Job> job = mQueue.front();
+		mQueue.pop_front();
+
+		lock.unlock();
+
+		bool result = false;
+
+		try
+		{
+			TRACE_ZONE("VideoThumbnailExtractor::extract");
+			result = extract(*job);
+		}
+		catch (...) { }
+
+		lock.lock();
+
+		if (result)
+			mStats.extracted++;
+		else
+			mStats.failed++;
+
+		IndexEntry entry;
+		entry.available = result;
+		entry.time = std::chrono::steady_clock::now();
+		mIndex[job->thumbnailPath] = entry;
+
+		complete(job, result);
+	}
+}
+
+bool VideoThumbnailExtractor::extract(const Job& job)
+{
+	const std::string& localFile = job.thumbnailPath;
+
+	if (Utils::FileSystem::exists(localFile))
+	{
+		auto date = Utils::FileSystem::getFileCreationDate(localFile);
+		auto duration = Utils::Time::DateTime::now().elapsedSecondsSince(date);
+		if (duration <= VIDEO_THUMBNAIL_MAX_AGE)
+			return true;
+
+		Utils::FileSystem::removeFile(localFile);
+	}
+
+	Utils::FileSystem::createDirectory(Utils::FileSystem::getParent(localFile));
+
+	libvlc_instance_t* vlcInstance = nullptr;
+
+	{
+		std::unique_lock<std::mutex> lock(mVlcLock);
+
+		if (mVlcInstance == nullptr)
+		{
+			mVlcInstance = createVlcInstance();
+
+			std::unique_lock<std::mutex> statsLock(mLock);
+			if (mVlcInstance != nullptr)
+				mStats.instances++;
+		}
+
+		vlcInstance = mVlcInstance;
+	}
+
+	if (vlcInstance == nullptr)
+		return false;
+
+	libvlc_media_t* vlcMedia = libvlc_media_new_path(vlcInstance, Utils::FileSystem::getPreferredPath(job.videoPath).c_str());
+	if (vlcMedia == nullptr)
+		return false;
+
+	libvlc_media_add_option(vlcMedia, ":no-audio");
+	libvlc_media_add_option(vlcMedia, ":start-time=1.5");
+
+	libvlc_media_player_t* vlcMediaPlayer = libvlc_media_player_new_from_media(vlcMedia);
+	if (vlcMediaPlayer == nullptr)
+	{
+		libvlc_media_release(vlcMedia);
+		return false;
+	}
+
+	int ms = 1500;
+
+	libvlc_media_player_set_rate(vlcMediaPlayer, 1);
+	libvlc_audio_set_mute(vlcMediaPlayer, 1);
+	libvlc_media_player_play(vlcMediaPlayer);
+	libvlc_media_player_set_time(vlcMediaPlayer, ms);
+
+	auto time = libvlc_media_player_get_time(vlcMediaPlayer);
+	int n = 100; // avoid infinite loop
+	while (time <= ms && n > 0) {
+		time = libvlc_media_player_get_time(vlcMediaPlayer);
+		n--;
+	}
+
+	libvlc_video_take_snapshot(vlcMediaPlayer, 0, localFile.c_str(), 0, 0);
+
+	libvlc_media_player_stop(vlcMediaPlayer);
+	libvlc_media_player_release(vlcMediaPlayer);
+	libvlc_media_release(vlcMedia);
+
+	return Utils::FileSystem::exists(localFile);
+}
+
+VideoThumbnailExtractor::Stats VideoThumbnailExtractor::getStats()
+{
+	std::unique_lock<std::mutex> lock(mLock);
+	return mStats;
+}
+
+void VideoThumbnailExtractor::clearIndex()
+{
+	std::unique_lock<std::mutex> lock(mLock);
+	mIndex.clear();
+}
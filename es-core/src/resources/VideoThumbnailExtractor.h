@@ -0,0 +1,94 @@
+#pragma once
+#ifndef ES_CORE_RESOURCES_VIDEO_THUMBNAIL_EXTRACTOR_H
+#define ES_CORE_RESOURCES_VIDEO_THUMBNAIL_EXTRACTOR_H
+
+#include <string>
+#include <list>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include <chrono>
+
+struct libvlc_instance_t;
+
+// Video thumbnails for TextureData::loadFromVideo, stored in <es>/tmp/videothumbs.
+// Callers ( texture loader threads ) wait for their thumbnail : a few worker threads extract them in order, on a single libvlc instance
+// instead of an instance per video. Callers asking for the same video share its job.
+// Thumbnails found or extracted are indexed for the session. Failed videos are indexed for VIDEO_THUMBNAIL_RETRY_DELAY only.
+class VideoThumbnailExtractor
+{
+public:
+	static VideoThumbnailExtractor* getInstance();
+
+	// Stops the workers : waiting & later requests fail
+	static void deinit();
+
+	// Path of the thumbnail of a video, extracted if needed. Blocks until it's done, empty on failure
+	std::string getThumbnail(const std::string& videoPath);
+
+	struct Stats
+	{
+		Stats() : instances(0), extracted(0), failed(0), indexed(0) { }
+
+		int instances;	// libvlc instances created
+		int extracted;
+		int failed;
+		int indexed;	// requests answered by the index
+	};
+
+	Stats getStats();
+
+	// Forgets the index
+	void clearIndex();
+
+	// libvlc instance with the snapshot options
+	static libvlc_instance_t* createVlcInstance();
+
+private:
+	VideoThumbnailExtractor();
+
+	struct IndexEntry
+	{
+		bool available;
+		std::chrono::steady_clock::time_point time;
+	};
+
+	struct Job
+	{
+		Job() : done(false), result(false) { }
+
+		std::string videoPath;
+		std::string thumbnailPath;
+		bool done;
+		bool result;
+	};
+
+	void threadProc();
+	void stop();
+	bool extract(const Job& job);
+	void complete(std::shared_ptr<Job> job, bool result);
+
+	static std::string getThumbnailPath(const std::string& videoPath);
+
+	static VideoThumbnailExtractor* sInstance;
+
+	std::list<std::shared_ptr<Job>>							mQueue;
+	std::unordered_map<std::string, std::shared_ptr<Job>>	mPending;	// by thumbnail path, requests for the same video share a job
+	std::unordered_map<std::string, IndexEntry>				mIndex;		// by thumbnail path
+
+	std::vector<std::thread>	mThreads;
+	std::mutex					mLock;
+	std::condition_variable		mEvent;		// jobs to do
+	std::condition_variable		mDone;		// jobs done
+	bool						mExit;
+
+	std::mutex					mVlcLock;
+	libvlc_instance_t*			mVlcInstance;
+
+	Stats						mStats;
+};
+
+#endif // ES_CORE_RESOURCES_VIDEO_THUMBNAIL_EXTRACTOR_H
@@ -30,6 +30,8 @@
 #else // _WIN32
 #include <dirent.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
 #include <mutex>
 #endif // _WIN32
 
@@ -1464,6 +1466,99 @@ namespace Utils
 #endif
 		}
 
+		bool writeAllTextSynced(const std::string& fileName, const std::string& text)
+		{
+			bool ret = true;
+
+#if defined(_WIN32)
+			FILE* file = _wfopen(Utils::String::convertToWideString(fileName).c_str(), L"wb");
+			if (file == nullptr)
+				return false;
+
+			if (fwrite(text.data(), 1, text.size(), file) != text.size() || fflush(file) != 0 || _commit(_fileno(file)) != 0)
+				ret = false;
+
+			fclose(file);
+#else
+			int fd = open(fileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+			if (fd < 0)
+				return false;
+
+			const char* data = text.data();
+			size_t size = text.size();
+
+			while (size > 0)
+			{
+				ssize_t written = write(fd, data, size);
+				if (written < 0)
+				{
+					if (errno == EINTR)
+						continue;
+
+					ret = false;
+					break;
+				}
+
+				data += written;
+				size -= written;
+			}
+
+			if (ret && fsync(fd) != 0)
+				ret = false;
+
+			close(fd);
+#endif
+
+			FileCache::remove(getGenericPath(fileName));
+			return ret;
+		}
+
+		bool syncFile(const std::string& fileName)
+		{
+#if defined(_WIN32)
+			HANDLE file = CreateFileW(Utils::String::convertToWideString(fileName).c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+			if (file == INVALID_HANDLE_VALUE)
+				return false;
+
+			bool ret = FlushFileBuffers(file);
+			CloseHandle(file);
+			return ret;
+#else
+			int fd = open(fileName.c_str(), O_RDONLY);
+			if (fd < 0)
+				return false;
+
+			bool ret = fsync(fd) == 0;
+			close(fd);
+			return ret;
+#endif
+		}
+
+		bool replaceFile(const std::string& src, const std::string& dst)
+		{
+			FileCache::remove(getGenericPath(src));
+			FileCache::remove(getGenericPath(dst));
+
+#if WIN32
+			return MoveFileExW(Utils::String::convertToWideString(src).c_str(), Utils::String::convertToWideString(dst).c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+			return std::rename(src.c_str(), dst.c_str()) == 0;
+#endif
+		}
+
+		void syncDirectory(const std::string& path)
+		{
+#if !defined(_WIN32)
+			// Makes the renames in the folder durable. Windows has no equivalent, MOVEFILE_WRITE_THROUGH covers it
+			int fd = open(path.c_str(), O_RDONLY);
+			if (fd < 0)
+				return;
+
+			fsync(fd);
+			close(fd);
+#endif
+		}
+
 		bool copyFile(const std::string& src, const std::string& dst)
 		{
 			std::string path = getGenericPath(src);
@@ -73,6 +73,12 @@ namespace Utils
 		void		deleteDirectoryFiles(const std::string& path, bool deleteDirectory = false);
 		bool		renameFile(const std::string& src, const std::string& dst, bool overWrite = true);
 
+		// Crash safe writes : the content is written & synced to a temporary file, then renamed over the file in one step
+		bool		writeAllTextSynced(const std::string& fileName, const std::string& text);
+		bool		syncFile(const std::string& fileName);
+		bool		replaceFile(const std::string& src, const std::string& dst);
+		void		syncDirectory(const std::string& path);
+
 		std::string megaBytesToString(unsigned long size);
 		std::string kiloBytesToString(unsigned long size);
 
@@ -0,0 +1,67 @@
+#pragma once
+#ifndef ES_CORE_UTILS_LRU_CACHE_H
+#define ES_CORE_UTILS_LRU_CACHE_H
+
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+namespace Utils
+{
+	// Map with a fixed capacity : inserting in a full cache evicts the least recently used entry.
+	// Not thread safe.
+	template <typename K, typename V, typename H = std::hash<K>>
+	class LruCache
+	{
+	public:
+		LruCache(size_t capacity) : mCapacity(capacity) { }
+
+		// Returns nullptr if key is not cached. The pointer is valid until the next insert or clear
+		V* get(const K& key)
+		{
+			auto it = mMap.find(key);
+			if (it == mMap.cend())
+				return nullptr;
+
+			mItems.splice(mItems.begin(), mItems, it->second);
+			return &it->second->second;
+		}
+
+		void insert(const K& key, const V& value)
+		{
+			auto it = mMap.find(key);
+			if (it != mMap.cend())
+			{
+				it->second->second = value;
+				mItems.splice(mItems.begin(), mItems, it->second);
+				return;
+			}
+
+			if (mItems.size() >= mCapacity && mItems.size() > 0)
+			{
+				mMap.erase(mItems.back().first);
+				mItems.pop_back();
+			}
+
+			mItems.emplace_front(key, value);
+			mMap[key] = mItems.begin();
+		}
+
+		void clear()
+		{
+			mMap.clear();
+			mItems.clear();
+		}
+
+		size_t size() const { return mItems.size(); }
+
+	private:
+		typedef std::list<std::pair<K, V>> ItemList;
+
+		size_t mCapacity;
+		ItemList mItems;
+		std::unordered_map<K, typename ItemList::iterator, H> mMap;
+	};
+}
+
+#endif // ES_CORE_UTILS_LRU_CACHE_H
@@ -0,0 +1,407 @@
+#include "SevenZipFile.h"
+#include "FileSystemUtil.h"
+#include "StringUtil.h"
+#include "md5.h"
+#include "Log.h"
+
+#include <libcheevos/libretro-common/src/7zip/7z.h>
+#include <libcheevos/libretro-common/src/7zip/7zCrc.h>
+#include <libcheevos/libretro-common/src/7zip/7zFile.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+
+#define SEVENZIP_INPUT_BUFFER	(1 << 18)
+#define SEVENZIP_MAX_BLOCK		(64 * 1024 * 1024)  // larger solid blocks are left to the 7z executable
+#define SEVENZIP_LARGE_BLOCK	(16 * 1024 * 1024)  // decoded one at a time in the process, and released after the call
+#define SEVENZIP_CHUNK			(64 * 1024)       // size of the pieces given to the callbacks
+
+namespace Utils
+{
+	namespace Zip
+	{
+		static void* allocImpl(ISzAllocPtr p, size_t size) { return size == 0 ? nullptr : malloc(size); }
+		static void freeImpl(ISzAllocPtr p, void* address) { free(address); }
+
+		static const ISzAlloc sAlloc = { allocImpl, freeImpl };
+
+		static std::once_flag sCrcTableInit;
+		static std::mutex sLargeBlockLock; // hashers run in parallel : only one of them holds a large block
+
+		struct SevenZipArchive
+		{
+			CFileInStream				stream;
+			CLookToRead2				look;
+			CSzArEx						db;
+			std::vector<std::string>	names;
+
+			// Last decoded block
+			uint32_t					blockIndex;
+			Byte*						outBuffer;
+			size_t						outBufferSize;
+
+			std::unique_lock<std::mutex>	largeBlockLock; // owned while a large block is decoded or kept
+		};
+
+		#define mSevenZip   ((SevenZipArchive*) mArchive)
+
+		static std::string utf16ToUtf8(const uint16_t* src)
+		{
+			std::string ret;
+
+			for (; *src != 0; src++)
+			{
+				uint32_t c = *src;
+
+				// Surrogate pair
+				if (c >= 0xD800 && c <= 0xDBFF && src[1] >= 0xDC00 && src[1] <= 0xDFFF)
+				{
+					c = 0x10000 + ((c - 0xD800) << 10) + (src[1] - 0xDC00);
+					src++;
+				}
+
+				if (c < 0x80)
+					ret += (char)c;
+				else if (c < 0x800)
+				{
+					ret += (char)(0xC0 | (c >> 6));
+					ret += (char)(0x80 | (c & 0x3F));
+				}
+				else if (c < 0x10000)
+				{
+					ret += (char)(0xE0 | (c >> 12));
+					ret += (char)(0x80 | ((c >> 6) & 0x3F));
+					ret += (char)(0x80 | (c & 0x3F));
+				}
+				else
+				{
+					ret += (char)(0xF0 | (c >> 18));
+					ret += (char)(0x80 | ((c >> 12) & 0x3F));
+					ret += (char)(0x80 | ((c >> 6) & 0x3F));
+					ret += (char)(0x80 | (c & 0x3F));
+				}
+			}
+
+			return ret;
+		}
+
+		SevenZipFile::SevenZipFile() : mArchive(nullptr)
+		{
+
+		}
+
+		// Must be called at the end of each public call that decoded something
+		static void releaseLargeBlock(SevenZipArchive* archive)
+		{
+			if (!archive->largeBlockLock.owns_lock())
+				return;
+
+			ISzAlloc_Free(&sAlloc, archive->outBuffer);
+			archive->outBuffer = nullptr;
+			archive->outBufferSize = 0;
+			archive->blockIndex = 0xFFFFFFFF;
+
+			archive->largeBlockLock.unlock();
+		}
+
+		static bool readMember(SevenZipArchive* archive, uint32_t index, zip_callback pCallback, void* pOpaque)
+		{
+			uint32_t folder = archive->db.FileToFolder[index];
+			if (folder == (uint32_t)-1)
+				return true; // empty file
+
+			if (folder != archive->blockIndex)
+			{
+				uint64_t unpackSize = SzAr_GetFolderUnpackSize(&archive->db.db, folder);
+				if (unpackSize > SEVENZIP_MAX_BLOCK)
+				{
+					LOG(LogDebug) << "SevenZipFile::readBuffered " << archive->names[index] << " is in a block too large to be decoded in memory";
+					return false;
+				}
+
+				if (unpackSize > SEVENZIP_LARGE_BLOCK && !archive->largeBlockLock.owns_lock())
+					archive->largeBlockLock.lock();
+			}
+
+			size_t offset = 0;
+			size_t size = 0;
+
+			SRes res = SzArEx_Extract(&archive->db, &archive->look.vt, index,
+				&archive->blockIndex, &archive->outBuffer, &archive->outBufferSize,
+				&offset, &size, &sAlloc, &sAlloc);
+
+			if (res != SZ_OK)
+			{
+				LOG(LogDebug) << "SevenZipFile::readBuffered error " << res << " decoding " << archive->names[index];
+				return false;
+			}
+
+			const Byte* data = archive->outBuffer + offset;
+
+			for (size_t pos = 0; pos < size; pos += SEVENZIP_CHUNK)
+			{
+				size_t n = std::min((size_t)SEVENZIP_CHUNK, size - pos);
+				if (pCallback(pOpaque, pos, data + pos, n) != n)
+					return false;
+			}
+
+			return true;
+		}
+
+		// Member names come from the archive : no absolute path, no drive, no parent folder
+		static bool isSafeMemberName(const std::string& name)
+		{
+			if (name.empty() || name[0] == '/' || name[0] == '\\' || name.find(':') != std::string::npos)
+				return false;
+
+			for (auto part : Utils::String::splitAny(name, "/\\"))
+				if (part == "..")
+					return false;
+
+			return true;
+		}
+
+		SevenZipFile::~SevenZipFile()
+		{
+			close();
+		}
+
+		size_t SevenZipFile::getMaxBlockSize()
+		{
+			return SEVENZIP_MAX_BLOCK;
+		}
+
+		void SevenZipFile::close()
+		{
+			if (mArchive == nullptr)
+				return;
+
+			releaseLargeBlock(mSevenZip);
+
+			SzArEx_Free(&mSevenZip->db, &sAlloc);
+			ISzAlloc_Free(&sAlloc, mSevenZip->outBuffer);
+			free(mSevenZip->look.buf);
+			File_Close(&mSevenZip->stream.file);
+
+			delete mSevenZip;
+			mArchive = nullptr;
+		}
+
+		bool SevenZipFile::load(const std::string &filename)
+		{
+			close();
+
+			std::call_once(sCrcTableInit, [] { CrcGenerateTable(); });
+
+			SevenZipArchive* archive = new SevenZipArchive();
+			archive->largeBlockLock = std::unique_lock<std::mutex>(sLargeBlockLock, std::defer_lock);
+			archive->blockIndex = 0xFFFFFFFF;
+			archive->outBuffer = nullptr;
+			archive->outBufferSize = 0;
+
+			File_Construct(&archive->stream.file);
+			if (InFile_Open(&archive->stream.file, filename.c_str()) != 0)
+			{
+				delete archive;
+				return false;
+			}
+
+			FileInStream_CreateVTable(&archive->stream);
+			LookToRead2_CreateVTable(&archive->look, 0);
+
+			archive->look.buf = (Byte*)malloc(SEVENZIP_INPUT_BUFFER);
+			archive->look.bufSize = SEVENZIP_INPUT_BUFFER;
+			archive->look.realStream = &archive->stream.vt;
+			LookToRead2_Init(&archive->look);
+
+			SzArEx_Init(&archive->db);
+
+			mArchive = archive;
+
+			SRes res = SzArEx_Open(&archive->db, &archive->look.vt, &sAlloc, &sAlloc);
+			if (res != SZ_OK)
+			{
+				LOG(LogDebug) << "SevenZipFile::load error " << res << " reading " << filename;
+				close();
+				return false;
+			}
+
+			std::vector<uint16_t> name;
+
+			for (uint32_t i = 0; i < archive->db.NumFiles; i++)
+			{
+				name.resize(SzArEx_GetFileNameUtf16(&archive->db, i, nullptr));
+				SzArEx_GetFileNameUtf16(&archive->db, i, name.data());
+
+				// Same convention as ZipFile : directories end with a slash
+				std::string utf8 = utf16ToUtf8(name.data());
+				if (SzArEx_IsDir(&archive->db, i))
+					utf8 += "/";
+
+				archive->names.push_back(utf8);
+			}
+
+			return true;
+		}
+
+		int SevenZipFile::indexOf(const std::string &name)
+		{
+			if (mArchive == nullptr)
+				return -1;
+
+			for (int i = 0; i < (int)mSevenZip->names.size(); i++)
+				if (mSevenZip->names[i] == name)
+					return i;
+
+			return -1;
+		}
+
+		std::vector<std::string> SevenZipFile::namelist()
+		{
+			if (mArchive == nullptr)
+				return std::vector<std::string>();
+
+			return mSevenZip->names;
+		}
+
+		std::vector<ZipInfo> SevenZipFile::infolist()
+		{
+			std::vector<ZipInfo> ret;
+
+			if (mArchive == nullptr)
+				return ret;
+
+			CSzArEx* db = &mSevenZip->db;
+
+			for (uint32_t i = 0; i < db->NumFiles; i++)
+			{
+				ZipInfo zi;
+				zi.filename = mSevenZip->names[i];
+				zi.file_size = (size_t)SzArEx_GetFileSize(db, i);
+				zi.crc = SzBitWithVals_Check(&db->CRCs, i) ? db->CRCs.Vals[i] : 0;
+
+				// Members of a solid block have no size of their own
+				uint32_t folder = db->FileToFolder[i];
+				if (folder != (uint32_t)-1 && db->FolderToFile[folder] == i)
+				{
+					const CSzAr* ar = &db->db;
+					zi.compress_size = (size_t)(ar->PackPositions[ar->FoStartPackStreamIndex[folder + 1]] - ar->PackPositions[ar->FoStartPackStreamIndex[folder]]);
+				}
+
+				ret.push_back(zi);
+			}
+
+			return ret;
+		}
+
+		bool SevenZipFile::readBuffered(const std::string &name, zip_callback pCallback, void* pOpaque)
+		{
+			int index = indexOf(name);
+			if (index < 0 || SzArEx_IsDir(&mSevenZip->db, index))
+				return false;
+
+			bool ret = readMember(mSevenZip, index, pCallback, pOpaque);
+			releaseLargeBlock(mSevenZip);
+			return ret;
+		}
+
+		bool SevenZipFile::extract(const std::string &member, const std::string &path, bool pathIsFullPath)
+		{
+			if (mArchive == nullptr)
+				return false;
+
+			if (!pathIsFullPath && !isSafeMemberName(member))
+			{
+				LOG(LogWarning) << "SevenZipFile::extract refusing to extract " << member;
+				return false;
+			}
+
+			std::string fullPath = pathIsFullPath ? path : Utils::FileSystem::combine(path, member);
+
+			std::string parent = Utils::FileSystem::getParent(fullPath);
+			if (!Utils::FileSystem::exists(parent))
+				Utils::FileSystem::createDirectory(parent);
+
+			std::ofstream file(WINSTRINGW(fullPath), std::ios::binary);
+			if (!file.is_open())
+				return false;
+
+			zip_callback func = [](void *pOpaque, uint64_t ofs, const void *pBuf, size_t n) { ((std::ofstream*)pOpaque)->write((const char*)pBuf, n); return n; };
+			bool ret = readBuffered(member, func, &file);
+
+			file.close();
+
+			if (!ret)
+				Utils::FileSystem::removeFile(fullPath);
+
+			return ret;
+		}
+
+		std::string SevenZipFile::getFileCrc(const std::string &name)
+		{
+			int index = indexOf(name);
+			if (index < 0)
+				return "";
+
+			unsigned int crc = 0;
+
+			if (SzBitWithVals_Check(&mSevenZip->db.CRCs, index))
+				crc = mSevenZip->db.CRCs.Vals[index];
+			else
+			{
+				zip_callback func = [](void *pOpaque, uint64_t ofs, const void *pBuf, size_t n) { *((unsigned int*)pOpaque) = ZipFile::computeCRC(*((unsigned int*)pOpaque), pBuf, n); return n; };
+				if (!readBuffered(name, func, &crc))
+					return "";
+			}
+
+			char hex[10];
+			auto len = snprintf(hex, sizeof(hex) - 1, "%08X", crc);
+			hex[len] = 0;
+			return hex;
+		}
+
+		std::string SevenZipFile::getFileMd5(const std::string &name)
+		{
+			if (mArchive == nullptr)
+				return "";
+
+			MD5 md5 = MD5();
+			Utils::Zip::zip_callback func = [](void *pOpaque, uint64_t ofs, const void *pBuf, size_t n) { ((MD5*)pOpaque)->update((const char *)pBuf, n); return n; };
+			if (readBuffered(name, func, &md5))
+			{
+				md5.finalize();
+				return md5.hexdigest();
+			}
+
+			return "";
+		}
+
+		std::string SevenZipFile::getAllFilesMd5()
+		{
+			if (mArchive == nullptr)
+				return "";
+
+			MD5 md5 = MD5();
+			Utils::Zip::zip_callback func = [](void *pOpaque, uint64_t ofs, const void *pBuf, size_t n) { ((MD5*)pOpaque)->update((const char *)pBuf, n); return n; };
+
+			// A large solid block is kept until the last of its members is read
+			bool ret = true;
+			for (uint32_t i = 0; ret && i < mSevenZip->names.size(); i++)
+				if (!SzArEx_IsDir(&mSevenZip->db, i))
+					ret = readMember(mSevenZip, i, func, &md5);
+
+			releaseLargeBlock(mSevenZip);
+
+			if (!ret)
+				return "";
+
+			md5.finalize();
+			return md5.hexdigest();
+		}
+
+	} // Zip::
+
+} // Utils::
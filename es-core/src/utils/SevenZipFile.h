@@ -0,0 +1,48 @@
+#pragma once
+#ifndef ES_CORE_UTILS_SEVEN_ZIP_FILE_H
+#define ES_CORE_UTILS_SEVEN_ZIP_FILE_H
+
+#include "utils/ZipFile.h"
+
+namespace Utils
+{
+	namespace Zip
+	{
+		// In-process 7z reader ( LZMA SDK from libcheevos ), same interface as ZipFile.
+		// Members are decoded in memory one solid block at a time. The last block is kept, so reading all the members of a solid archive decodes each block once.
+		// Blocks over 16 MB are decoded by one archive at a time in the process, and released at the end of the call.
+		class SevenZipFile
+		{
+		public:
+			SevenZipFile();
+			~SevenZipFile();
+
+			bool load(const std::string &filename);
+			// Refuses absolute member names and names with a parent folder, unless path is the full destination path
+			bool extract(const std::string &member, const std::string &path, bool pathIsFullPath = false);
+
+			// Fails if the member lives in a block larger than getMaxBlockSize
+			bool readBuffered(const std::string &name, zip_callback pCallback, void* pOpaque);
+
+			// Crc stored in the header when the archive has one, else computed from the contents
+			std::string getFileCrc(const std::string &name);
+			std::string getFileMd5(const std::string &name);
+
+			// Md5 of all the members in archive order, the same as 7z x -so | md5sum
+			std::string getAllFilesMd5();
+
+			std::vector<std::string> namelist();
+			std::vector<ZipInfo> infolist();
+
+			static size_t getMaxBlockSize();
+
+		private:
+			void close();
+			int indexOf(const std::string &name);
+
+			void* mArchive;
+		};
+	}
+}
+
+#endif // ES_CORE_UTILS_SEVEN_ZIP_FILE_H
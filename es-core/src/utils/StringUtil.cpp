@@ -723,7 +723,7 @@ namespace Utils
 			return (it != _string.end());
 		}
 		
-		bool containsIgnoreCasePinyin(const std::string & _string, const std::string & _what)
+		std::vector<const char*> getPinyinInitials(const std::string & _string)
 		{
 			std::vector<const char*> vpinyin;
 			size_t len = _string.size();
@@ -745,10 +745,18 @@ namespace Utils
 					}
 				}
 			}
-			if (!ret) return false; // all chars < 0x80
+			if (!ret) return std::vector<const char*>(); // all chars < 0x80
+
+			return vpinyin;
+		}
+
+		bool containsPinyin(const std::vector<const char*> & _pinyin, const std::string & _what)
+		{
+			if (_pinyin.empty())
+				return false;
 
 			auto it = std::search(
-				vpinyin.begin(), vpinyin.end(),
+				_pinyin.begin(), _pinyin.end(),
 				_what.begin(), _what.end(),
 				[](const char *ptr, char ch2) {
 				    if (!ptr) return false;
@@ -759,7 +767,12 @@ namespace Utils
 					}
 				}
 			);
-			return (it != vpinyin.end());
+			return (it != _pinyin.end());
+		}
+
+		bool containsIgnoreCasePinyin(const std::string & _string, const std::string & _what)
+		{
+			return containsPinyin(getPinyinInitials(_string), _what);
 		}
 
 		std::string proper(const std::string& _string)
@@ -40,6 +40,8 @@ namespace Utils
 		std::string removeHtmlTags(const std::string& html);
 		bool        containsIgnoreCase(const std::string & _string, const std::string & _what);
 		bool        containsIgnoreCasePinyin(const std::string & _string, const std::string & _what);
+		std::vector<const char*> getPinyinInitials(const std::string & _string); // empty when _string has only ascii characters
+		bool        containsPinyin(const std::vector<const char*> & _pinyin, const std::string & _what);
 		bool		startsWithIgnoreCase(const std::string& name1, const std::string& name2);
 
 		int			toInteger(const std::string& string);
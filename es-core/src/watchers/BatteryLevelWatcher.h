@@ -1,6 +1,7 @@
 #pragma once
 
 #include "WatchersManager.h"
+#include "PowerSupplyMonitor.h"
 #include "utils/Platform.h"
 
 class BatteryLevelWatcher : public IWatcher
@@ -16,6 +17,13 @@ protected:
 
 	bool check() override;
 
+	int  eventFd() override { return mMonitor.getFd(); }
+	void readEvents() override { mMonitor.drain(); }
+
+	// Many fuel gauges don't send a uevent for each capacity change : keep polling on battery, for the indicator & the low battery warning
+	int  eventUpdateTime() override { return mBatteryInfo.hasBattery && !mBatteryInfo.isCharging ? 10 * 1000 : 60 * 1000; }
+
 private:
 	Utils::Platform::BatteryInformation mBatteryInfo;	
+	PowerSupplyMonitor mMonitor;
 };
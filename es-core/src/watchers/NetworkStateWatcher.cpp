@@ -1,12 +1,74 @@
 #include "NetworkStateWatcher.h"
 #include "components/IExternalActivity.h"
 #include "utils/Platform.h"
+#include "Log.h"
 
-NetworkStateWatcher::NetworkStateWatcher() : mIsConnected(false), mIsPlaneMode(false)
+#if defined(__linux__)
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <unistd.h>
+#endif
+
+NetworkStateWatcher::NetworkStateWatcher() : mIsConnected(false), mIsPlaneMode(false), mNetlinkFd(-1), mNetlinkOpened(false)
 {
 	mIsPlaneModeSupported = IExternalActivity::Instance != nullptr && IExternalActivity::Instance->isReadPlaneModeSupported();
 }
 
+NetworkStateWatcher::~NetworkStateWatcher()
+{
+#if defined(__linux__)
+	if (mNetlinkFd >= 0)
+		close(mNetlinkFd);
+#endif
+}
+
+int NetworkStateWatcher::eventFd()
+{
+#if defined(__linux__)
+	if (mNetlinkOpened)
+		return mNetlinkFd;
+
+	mNetlinkOpened = true;
+
+	int fd = socket(AF_NETLINK, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_ROUTE);
+	if (fd < 0)
+	{
+		LOG(LogWarning) << "NetworkStateWatcher : netlink is not available";
+		return -1;
+	}
+
+	struct sockaddr_nl address = {};
+	address.nl_family = AF_NETLINK;
+	address.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR;
+
+	if (bind(fd, (struct sockaddr*)&address, sizeof(address)) < 0)
+	{
+		LOG(LogWarning) << "NetworkStateWatcher : unable to bind netlink socket";
+		close(fd);
+		return -1;
+	}
+
+	mNetlinkFd = fd;
+	return mNetlinkFd;
+#else
+	return -1;
+#endif
+}
+
+void NetworkStateWatcher::readEvents()
+{
+#if defined(__linux__)
+	if (mNetlinkFd < 0)
+		return;
+
+	// Content doesn't matter, the state is queried again by check()
+	char buffer[8192];
+	while (recv(mNetlinkFd, buffer, sizeof(buffer), 0) > 0)
+		;
+#endif
+}
+
 bool NetworkStateWatcher::check()
 {
 	bool networkConnected = !Utils::Platform::queryIPAddress().empty();
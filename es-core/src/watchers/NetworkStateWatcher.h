@@ -6,6 +6,7 @@ class NetworkStateWatcher : public IWatcher
 {
 public:
 	NetworkStateWatcher();
+	~NetworkStateWatcher();
 
 	bool isConnected() { return mIsConnected; }
 	bool isPlaneMode() { return mIsPlaneMode; }
@@ -18,8 +19,17 @@ protected:
 
 	bool check() override;
 
+	int  eventFd() override;		// netlink route socket : links & addresses changes
+	void readEvents() override;
+
+	// Plane mode doesn't always change a link ( bluetooth only, radios without an interface up )
+	int  eventUpdateTime() override { return mIsPlaneModeSupported ? 10 * 1000 : 60 * 1000; }
+
 private:
 	bool mIsConnected;
 	bool mIsPlaneMode;
 	bool mIsPlaneModeSupported;
+
+	int  mNetlinkFd;
+	bool mNetlinkOpened;
 };
@@ -0,0 +1,62 @@
+#include "PowerSupplyMonitor.h"
+#include "Log.h"
+
+#ifdef HAVE_UDEV
+#include <libudev.h>
+#endif
+
+PowerSupplyMonitor::PowerSupplyMonitor() : mUdev(nullptr), mMonitor(nullptr), mOpened(false)
+{
+}
+
+PowerSupplyMonitor::~PowerSupplyMonitor()
+{
+#ifdef HAVE_UDEV
+	if (mMonitor != nullptr)
+		udev_monitor_unref(mMonitor);
+
+	if (mUdev != nullptr)
+		udev_unref(mUdev);
+#endif
+}
+
+int PowerSupplyMonitor::getFd()
+{
+#ifdef HAVE_UDEV
+	if (!mOpened)
+	{
+		mOpened = true;
+
+		mUdev = udev_new();
+		if (mUdev != nullptr)
+			mMonitor = udev_monitor_new_from_netlink(mUdev, "udev");
+
+		if (mMonitor != nullptr && (udev_monitor_filter_add_match_subsystem_devtype(mMonitor, "power_supply", NULL) < 0 || udev_monitor_enable_receiving(mMonitor) < 0))
+		{
+			udev_monitor_unref(mMonitor);
+			mMonitor = nullptr;
+		}
+
+		if (mMonitor == nullptr)
+			LOG(LogWarning) << "PowerSupplyMonitor : udev monitor is not available";
+	}
+
+	if (mMonitor != nullptr)
+		return udev_monitor_get_fd(mMonitor);
+#endif
+
+	return -1;
+}
+
+void PowerSupplyMonitor::drain()
+{
+#ifdef HAVE_UDEV
+	if (mMonitor == nullptr)
+		return;
+
+	// The monitor socket is non blocking : returns nullptr when there's nothing left
+	struct udev_device* dev;
+	while ((dev = udev_monitor_receive_device(mMonitor)) != nullptr)
+		udev_device_unref(dev);
+#endif
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+struct udev;
+struct udev_monitor;
+
+// udev monitor of the power_supply subsystem : batteries, chargers & pads batteries send change events.
+// Only available on builds with udev, getFd() returns -1 otherwise.
+class PowerSupplyMonitor
+{
+public:
+	PowerSupplyMonitor();
+	~PowerSupplyMonitor();
+
+	int  getFd();	// opened on first call
+	void drain();
+
+private:
+	struct udev*			mUdev;
+	struct udev_monitor*	mMonitor;
+	bool					mOpened;
+};
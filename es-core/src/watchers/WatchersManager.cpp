@@ -1,6 +1,13 @@
 #include "WatchersManager.h"
 #include "Log.h"
 #include <chrono>
+#include <algorithm>
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
 
 std::mutex											WatchersManager::mNotificationLock;
 std::list<IWatcherNotify*>							WatchersManager::mNotification;
@@ -36,7 +43,7 @@ void WatchersManager::pause()
 		mInstance->mPaused = true;
 	}
 
-	mInstance->mEvent.notify_all();
+	mInstance->wakeUp();
 }
 
 void WatchersManager::resume()
@@ -49,7 +56,7 @@ void WatchersManager::resume()
 		mInstance->mPaused = false;
 	}
 
-	mInstance->mEvent.notify_all();
+	mInstance->wakeUp();
 }
 
 WatchersManager::WatchersManager()
@@ -58,9 +65,62 @@ WatchersManager::WatchersManager()
 
 	mRunning = true;
 	mPaused = false;
+	mWakeUpRequested = false;
+	mCheckEnabled = false;
+	mWakeUps = 0;
+	mStartTime = std::chrono::steady_clock::now();
+
+	mEpollFd = -1;
+	mWakeFd = -1;
+
+#if defined(__linux__)
+	mEpollFd = epoll_create1(EPOLL_CLOEXEC);
+	mWakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+	if (mEpollFd >= 0 && mWakeFd >= 0)
+	{
+		struct epoll_event evt = {};
+		evt.events = EPOLLIN;
+		evt.data.fd = mWakeFd;
+		epoll_ctl(mEpollFd, EPOLL_CTL_ADD, mWakeFd, &evt);
+	}
+	else
+	{
+		LOG(LogWarning) << "WatchersManager : epoll is not available, watchers will be polled";
+
+		if (mEpollFd >= 0)
+			close(mEpollFd);
+
+		if (mWakeFd >= 0)
+			close(mWakeFd);
+
+		mEpollFd = -1;
+		mWakeFd = -1;
+	}
+#endif
+
 	mThread = new std::thread(&WatchersManager::run, this);
 }
 
+void WatchersManager::wakeUp()
+{
+	{
+		std::unique_lock<std::mutex> lock(mThreadLock);
+		mWakeUpRequested = true;
+	}
+
+	mEvent.notify_all();
+
+#if defined(__linux__)
+	if (mWakeFd >= 0)
+	{
+		uint64_t value = 1;
+		if (write(mWakeFd, &value, sizeof(value)) < 0)
+			LOG(LogDebug) << "WatchersManager : wake up already pending";
+	}
+#endif
+}
+
 void WatchersManager::RegisterComponent(IWatcher* instance)
 {
 	std::unique_lock<std::mutex> lock(mWatchersLock);
@@ -71,6 +131,9 @@ void WatchersManager::RegisterComponent(IWatcher* instance)
 		std::chrono::steady_clock::now() + std::chrono::milliseconds(instance->initialUpdateTime());
 
 	mWatchers.push_back(info);
+
+	if (mInstance != nullptr)
+		mInstance->wakeUp();
 }
 
 void WatchersManager::UnregisterComponent(IWatcher* instance)
@@ -82,6 +145,10 @@ void WatchersManager::UnregisterComponent(IWatcher* instance)
 		WatcherInfo* info = *it;
 		if (info->component == instance)
 		{
+#if defined(__linux__)
+			if (info->eventFd >= 0 && mInstance != nullptr && mInstance->mEpollFd >= 0)
+				epoll_ctl(mInstance->mEpollFd, EPOLL_CTL_DEL, info->eventFd, nullptr);
+#endif
 			mWatchers.erase(it);
 			delete info;
 			return;
@@ -98,11 +165,28 @@ void WatchersManager::ResetComponent(IWatcher* instance)
 		if (comp->component == instance)
 		{
 			comp->nextCheckTime = std::chrono::steady_clock::now();
+
+			if (mInstance != nullptr)
+				mInstance->wakeUp();
+
 			return;
 		}
 	}
 }
 
+void WatchersManager::CheckEnabledComponents()
+{
+	if (mInstance == nullptr)
+		return;
+
+	{
+		std::unique_lock<std::mutex> lock(mInstance->mThreadLock);
+		mInstance->mCheckEnabled = true;
+	}
+
+	mInstance->wakeUp();
+}
+
 void WatchersManager::RegisterNotify(IWatcherNotify* instance)
 {
 	std::unique_lock<std::mutex> lock(mNotificationLock);
@@ -149,11 +233,66 @@ WatchersManager::~WatchersManager()
 	}
 
 	mRunning = false;
-	mEvent.notify_all();
+	wakeUp();
 
 	mThread->join();
 	delete mThread;
 	mThread = nullptr;
+
+	auto seconds = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - mStartTime).count();
+	if (seconds > 0)
+		LOG(LogInfo) << "WatchersManager : " << mWakeUps << " wake ups in " << seconds << "s (" << (mWakeUps * 60 / seconds) << " per minute)";
+
+#if defined(__linux__)
+	if (mEpollFd >= 0)
+		close(mEpollFd);
+
+	if (mWakeFd >= 0)
+		close(mWakeFd);
+#endif
+}
+
+void WatchersManager::waitForEvents(const std::chrono::steady_clock::time_point& nextCheckTime, std::vector<int>& signaledFds)
+{
+#if defined(__linux__)
+	if (mEpollFd >= 0)
+	{
+		int timeout = -1;
+		if (nextCheckTime != std::chrono::steady_clock::time_point::max())
+		{
+			auto delay = std::chrono::duration_cast<std::chrono::milliseconds>(nextCheckTime - std::chrono::steady_clock::now()).count();
+			timeout = (int) std::max((long long) 0, (long long) delay + 1);
+		}
+
+		struct epoll_event events[16];
+		int count = epoll_wait(mEpollFd, events, 16, timeout);
+
+		for (int i = 0; i < count; i++)
+		{
+			if (events[i].data.fd == mWakeFd)
+			{
+				uint64_t value;
+				if (read(mWakeFd, &value, sizeof(value)) < 0)
+					continue;
+			}
+			else
+				signaledFds.push_back(events[i].data.fd);
+		}
+
+		std::unique_lock<std::mutex> lock(mThreadLock);
+		mWakeUpRequested = false;
+		return;
+	}
+#endif
+
+	std::unique_lock<std::mutex> lock(mThreadLock);
+
+	if (nextCheckTime == std::chrono::steady_clock::time_point::max())
+		mEvent.wait(lock, [this]() { return mWakeUpRequested || !mRunning; });
+	else
+		mEvent.wait_until(lock, nextCheckTime, [this]() { return mWakeUpRequested || !mRunning; });
+
+	mWakeUpRequested = false;
 }
 
 void WatchersManager::run()
@@ -166,14 +305,60 @@ void WatchersManager::run()
 
 			if (mPaused)
 				mEvent.wait(lock, [this]() { return !mPaused || !mRunning; });
-			else
-				mEvent.wait_for(lock, std::chrono::seconds(1));
 
 			if (!mRunning)
 				return;
+		}
+
+		// Register the event fds of new watchers, and find the next scheduled check
+		auto nextCheckTime = std::chrono::steady_clock::time_point::max();
+
+		{
+			std::unique_lock<std::mutex> lock(mWatchersLock);
+
+			for (auto item : mWatchers)
+			{
+				if (!item->eventFdQueried)
+				{
+					item->eventFdQueried = true;
+					item->eventFd = -1;
+
+#if defined(__linux__)
+					int fd = mEpollFd >= 0 ? item->component->eventFd() : -1;
+					if (fd >= 0)
+					{
+						struct epoll_event evt = {};
+						evt.events = EPOLLIN;
+						evt.data.fd = fd;
+
+						if (epoll_ctl(mEpollFd, EPOLL_CTL_ADD, fd, &evt) == 0)
+							item->eventFd = fd;
+					}
+#endif
+				}
+
+				if (item->nextCheckTime < nextCheckTime)
+					nextCheckTime = item->nextCheckTime;
+			}
+		}
 
+		std::vector<int> signaledFds;
+		waitForEvents(nextCheckTime, signaledFds);
+
+		mWakeUps++;
+
+		if (!mRunning)
+			return;
+
+		bool checkEnabled = false;
+
+		{
+			std::unique_lock<std::mutex> lock(mThreadLock);
 			if (mPaused)
 				continue;
+
+			checkEnabled = mCheckEnabled;
+			mCheckEnabled = false;
 		}
 
 		// Notification Lock
@@ -187,16 +372,27 @@ void WatchersManager::run()
 				if (!mRunning)
 					return;
 
-				if (!item->component->enabled())
+				bool signaled = item->eventFd >= 0 && std::find(signaledFds.cbegin(), signaledFds.cend(), item->eventFd) != signaledFds.cend();
+
+				// Always drain, or the fd stays signaled
+				if (signaled)
+					item->component->readEvents();
+
+				if (!signaled && now < item->nextCheckTime && !(checkEnabled && !item->enabled))
 					continue;
 
-				if (now < item->nextCheckTime)
+				// Disabled watchers are asked again later, or when the configuration changes
+				item->enabled = item->component->enabled();
+				if (!item->enabled)
+				{
+					item->nextCheckTime = now + std::chrono::milliseconds(std::min(item->component->updateTime(), item->component->eventUpdateTime()));
 					continue;
+				}
 
 				if (item->component->check())
 					NotifyComponentChanged(item->component);
 
-				item->nextCheckTime = now + std::chrono::milliseconds(item->component->updateTime());
+				item->nextCheckTime = now + std::chrono::milliseconds(item->eventFd >= 0 ? item->component->eventUpdateTime() : item->component->updateTime());
 			}
 		}
 	}
@@ -4,6 +4,7 @@
 #include <condition_variable>
 #include <mutex>
 #include <list>
+#include <vector>
 #include <chrono>
 
 class WatchersManager;
@@ -18,6 +19,13 @@ protected:
 	virtual bool check() = 0;
 
 	virtual int  initialUpdateTime() { return 5 * 1000; } // 15 seconds
+
+	// Event driven watchers return a file descriptor that becomes readable when something changed ( netlink socket, udev monitor, inotify... ).
+	// check() then runs when it's signaled, and every eventUpdateTime() as a safety net, instead of every updateTime().
+	// Called from the watchers thread. -1 keeps polling
+	virtual int  eventFd() { return -1; }
+	virtual void readEvents() { }						// drains the pending events of eventFd()
+	virtual int  eventUpdateTime() { return 60 * 1000; }	// 60 seconds
 };
 
 class IWatcherNotify
@@ -52,6 +60,9 @@ public:
 
 	static void ResetComponent(IWatcher* instance);
 
+	// The configuration changed : disabled watchers are asked again at once if they are enabled
+	static void CheckEnabledComponents();
+
 	static WatchersManager* getInstance();
 	static void             stop();
 	static void             pause();
@@ -66,14 +77,24 @@ private:
 
 	struct WatcherInfo
 	{
-		WatcherInfo() { component = nullptr; nextCheckTime = std::chrono::steady_clock::now(); }
+		WatcherInfo() { component = nullptr; nextCheckTime = std::chrono::steady_clock::now(); enabled = true; eventFd = -1; eventFdQueried = false; }
 
 		IWatcher*	component;
 		std::chrono::steady_clock::time_point nextCheckTime;
+		bool		enabled;	// last answer of component->enabled()
+
+		int			eventFd;
+		bool		eventFdQueried;
 	};
 
 	void NotifyComponentChanged(IWatcher* component);
 
+	// Wakes the thread up : a watcher was added or reset, or the state changed
+	void wakeUp();
+
+	// Sleeps until an event fd is signaled, the thread is woken up, or nextCheckTime
+	void waitForEvents(const std::chrono::steady_clock::time_point& nextCheckTime, std::vector<int>& signaledFds);
+
 	static std::mutex								mWatchersLock;
 	static std::list<WatcherInfo*>					mWatchers;
 
@@ -84,6 +105,15 @@ private:
 	std::condition_variable							mEvent;
 	bool											mRunning;
 	bool											mPaused;
+	bool											mWakeUpRequested;
+	bool											mCheckEnabled;
+
+	int												mEpollFd;
+	int												mWakeFd;
+
+	// Idle cost : number of times the thread woke up
+	unsigned long long								mWakeUps;
+	std::chrono::steady_clock::time_point			mStartTime;
 	
 	std::thread*									mThread;
 